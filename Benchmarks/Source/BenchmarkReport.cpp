@@ -0,0 +1,41 @@
+#include "BenchmarkReport.hpp"
+#include "Logger.hpp"
+#include <fstream>
+
+using namespace RightEngine;
+
+void BenchmarkReport::Add(const std::string& benchmark,
+                          const std::string& metric,
+                          size_t entities,
+                          double value,
+                          const std::string& unit)
+{
+    m_results.push_back({ benchmark, metric, entities, value, unit });
+}
+
+bool BenchmarkReport::Write(const std::filesystem::path& path) const
+{
+    std::ofstream file(path);
+    if (!file)
+    {
+        R_CORE_ERROR("Failed to open benchmark report {0}", path.generic_u8string());
+        return false;
+    }
+
+    file.precision(9);
+    // Names are engine identifiers, so nothing needs escaping
+    file << "{\n  \"results\": [";
+    for (size_t i = 0; i < m_results.size(); i++)
+    {
+        const auto& result = m_results[i];
+        file << (i == 0 ? "\n" : ",\n")
+             << "    { \"benchmark\": \"" << result.benchmark
+             << "\", \"metric\": \"" << result.metric
+             << "\", \"entities\": " << result.entities
+             << ", \"value\": " << result.value
+             << ", \"unit\": \"" << result.unit << "\" }";
+    }
+    file << "\n  ]\n}\n";
+    R_CORE_INFO("Benchmark report is written to {0}", path.generic_u8string());
+    return true;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace RightEngine
+{
+    // Flat list of measurements, written as JSON so runs can be compared over time
+    class BenchmarkReport
+    {
+    public:
+        void Add(const std::string& benchmark, const std::string& metric, size_t entities, double value, const std::string& unit);
+
+        bool Write(const std::filesystem::path& path) const;
+
+    private:
+        struct Result
+        {
+            std::string benchmark;
+            std::string metric;
+            size_t entities;
+            double value;
+            std::string unit;
+        };
+
+        std::vector<Result> m_results;
+    };
+}
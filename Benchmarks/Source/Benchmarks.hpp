@@ -0,0 +1,23 @@
+#pragma once
+
+#include "BenchmarkReport.hpp"
+#include <cstddef>
+
+namespace RightEngine
+{
+    struct BenchmarkSettings
+    {
+        // Largest scene size, smaller ones are a power of 10 steps down to 1k
+        size_t maxEntities{ 1000000 };
+        size_t iterations{ 20 };
+    };
+
+    void RunTransformBenchmark(const BenchmarkSettings& settings, BenchmarkReport& report);
+    // TRS to matrix composition of maxEntities transforms, glm per entity against SoA SIMD batches
+    void RunTrsBenchmark(const BenchmarkSettings& settings, BenchmarkReport& report);
+    /*
+     * Generated stress scenes: update, render extraction, culling, serialization and asset lookups.
+     * Mesh assets are CPU only placeholders, so it runs without a GPU device
+     */
+    void RunSceneBenchmark(const BenchmarkSettings& settings, BenchmarkReport& report);
+}
@@ -0,0 +1,230 @@
+#include "Benchmarks.hpp"
+#include "Logger.hpp"
+#include "Timer.hpp"
+#include "Scene.hpp"
+#include "Entity.hpp"
+#include "SceneGenerator.hpp"
+#include "SceneSerializer.hpp"
+#include "AssetManager.hpp"
+#include "CullingStream.hpp"
+#include "Application.hpp"
+#include "ThreadService.hpp"
+#include <filesystem>
+
+using namespace RightEngine;
+
+namespace
+{
+    constexpr size_t C_MIN_ENTITIES = 1000;
+    constexpr size_t C_MESH_VARIANTS = 16;
+    // Every update moves this share of top level entities together with their subtrees
+    constexpr size_t C_MOVING_PERIOD = 100;
+    constexpr size_t C_CULLING_GROUPS_PER_BATCH = 256;
+    constexpr float C_FRAME_TIME = 1.0f / 60.0f;
+
+    struct DrawItem
+    {
+        glm::mat4 transform;
+        AssetHandle mesh;
+        AssetHandle material;
+    };
+
+    struct Frame
+    {
+        std::vector<DrawItem> draws;
+        CullingStream bounds;
+        std::vector<uint8_t> visibilityMasks;
+        std::vector<uint32_t> visibleDraws;
+    };
+
+    // Meshes without GPU data, bounds system and culling only read their bounds
+    std::vector<AssetHandle> CreatePlaceholderMeshes()
+    {
+        std::vector<AssetHandle> meshes;
+        for (size_t i = 0; i < C_MESH_VARIANTS; i++)
+        {
+            const std::string path = "/Benchmark/Mesh" + std::to_string(i);
+            if (auto mesh = AssetManager::Get().GetAsset<MeshNode>(path))
+            {
+                meshes.push_back({ mesh->guid });
+                continue;
+            }
+            auto mesh = std::make_shared<MeshNode>();
+            const glm::vec3 extent(0.5f + static_cast<float>(i) * 0.1f);
+            mesh->bounds = AABB(-extent, extent);
+            mesh->boundingSphere = { glm::vec3(0.0f), glm::length(extent) };
+            meshes.push_back(AssetManager::Get().CacheAsset(mesh, path, AssetType::MESH));
+        }
+        return meshes;
+    }
+
+    template<typename F>
+    double MeasureMilliseconds(size_t iterations, F&& f)
+    {
+        Timer timer;
+        for (size_t i = 0; i < iterations; i++)
+        {
+            f(i);
+        }
+        timer.Stop();
+        return timer.TimeInMilliseconds() / static_cast<double>(iterations);
+    }
+
+    // Same data the editor gathers for SceneRenderer::SubmitMesh
+    void Extract(const std::shared_ptr<Scene>& scene, Frame& frame)
+    {
+        frame.draws.clear();
+        frame.bounds.Clear();
+        auto& registry = scene->GetRegistry();
+        for (const auto entity : registry.view<MeshComponent, TransformComponent, BoundsComponent>())
+        {
+            const auto& mc = registry.get<MeshComponent>(entity);
+            if (!mc.isVisible)
+            {
+                continue;
+            }
+            frame.draws.push_back({ registry.get<TransformComponent>(entity).GetWorldTransformMatrix(), mc.mesh, mc.material });
+            frame.bounds.Push(registry.get<BoundsComponent>(entity).worldBounds);
+        }
+    }
+
+    void Cull(const Frustum& frustum, Frame& frame)
+    {
+        frame.visibleDraws.clear();
+        frame.visibilityMasks.resize(frame.bounds.GetGroupCount());
+        Instance().Service<ThreadService>().ParallelFor(frame.bounds.GetGroupCount(),
+                                                        C_CULLING_GROUPS_PER_BATCH,
+                                                        [&](size_t begin, size_t end)
+        {
+            frame.bounds.Cull(frustum, begin, end, frame.visibilityMasks.data());
+        });
+        frame.bounds.GatherVisible(frame.visibilityMasks, frame.visibleDraws);
+    }
+
+    Frustum GetCameraFrustum(const std::shared_ptr<Scene>& scene)
+    {
+        auto& registry = scene->GetRegistry();
+        for (const auto entity : registry.view<CameraComponent>())
+        {
+            const auto& camera = registry.get<CameraComponent>(entity);
+            if (camera.isPrimary)
+            {
+                const glm::vec3 position = registry.get<TransformComponent>(entity).GetWorldPosition();
+                return Frustum::FromMatrix(camera.GetProjectionMatrix() * camera.GetViewMatrix(position));
+            }
+        }
+        R_CORE_ASSERT(false, "");
+        return {};
+    }
+}
+
+void RightEngine::RunSceneBenchmark(const BenchmarkSettings& settings, BenchmarkReport& report)
+{
+    const auto meshes = CreatePlaceholderMeshes();
+    // Materials are never resolved, only renderer and serializer read them
+    const std::vector<AssetHandle> materials = { { xg::newGuid() }, { xg::newGuid() } };
+    const auto scenePath = std::filesystem::temp_directory_path() / "RightBenchmark.scene";
+
+    for (size_t entityCount = C_MIN_ENTITIES; entityCount <= settings.maxEntities; entityCount *= 10)
+    {
+        const auto add = [&](const std::string& metric, double value, const std::string& unit)
+        {
+            report.Add("scene", metric, entityCount, value, unit);
+        };
+
+        SceneGeneratorSettings generatorSettings;
+        generatorSettings.entityCount = entityCount;
+        generatorSettings.meshes = meshes;
+        generatorSettings.materials = materials;
+
+        Timer timer;
+        auto scene = SceneGenerator::Generate(generatorSettings);
+        add("generate", timer.TimeInMilliseconds(), "ms");
+
+        // First update creates all bounds proxies
+        timer.Start();
+        scene->OnUpdate(C_FRAME_TIME);
+        add("first_update", timer.TimeInMilliseconds(), "ms");
+
+        add("static_update", MeasureMilliseconds(settings.iterations, [&](size_t)
+        {
+            scene->OnUpdate(C_FRAME_TIME);
+        }), "ms");
+
+        const auto topLevel = scene->GetRootNode().GetChildren();
+        const double dynamicUpdateTime = MeasureMilliseconds(settings.iterations, [&](size_t iteration)
+        {
+            for (size_t i = iteration % C_MOVING_PERIOD; i < topLevel.size(); i += C_MOVING_PERIOD)
+            {
+                auto& transform = topLevel[i].GetComponent<TransformComponent>();
+                transform.SetPosition(transform.GetPosition() + glm::vec3(0.01f, 0.0f, 0.0f));
+            }
+            scene->OnUpdate(C_FRAME_TIME);
+        });
+        add("dynamic_update", dynamicUpdateTime, "ms");
+
+        // Play mode snapshot, the clone is destroyed within the measured iteration like on leaving play mode
+        add("clone", MeasureMilliseconds(settings.iterations, [&](size_t)
+        {
+            const auto clone = scene->Clone();
+            R_CORE_ASSERT(clone->GetRegistry().alive() == scene->GetRegistry().alive(), "");
+        }), "ms");
+
+        Frame frame;
+        add("extraction", MeasureMilliseconds(settings.iterations, [&](size_t)
+        {
+            Extract(scene, frame);
+        }), "ms");
+
+        const Frustum frustum = GetCameraFrustum(scene);
+        add("culling", MeasureMilliseconds(settings.iterations, [&](size_t)
+        {
+            Cull(frustum, frame);
+        }), "ms");
+        add("visible_draws", static_cast<double>(frame.visibleDraws.size()), "draws");
+
+        size_t bvhVisible = 0;
+        add("bvh_frustum_query", MeasureMilliseconds(settings.iterations, [&](size_t)
+        {
+            bvhVisible = 0;
+            scene->QueryFrustum(frustum, [&](entt::entity)
+            {
+                bvhVisible++;
+            });
+        }), "ms");
+
+        // Renderer resolves the mesh of every draw each frame
+        auto& assetManager = AssetManager::Get();
+        size_t resolved = 0;
+        add("asset_lookup", MeasureMilliseconds(settings.iterations, [&](size_t)
+        {
+            for (const auto& draw : frame.draws)
+            {
+                resolved += assetManager.GetAsset<MeshNode>(draw.mesh) != nullptr;
+            }
+        }), "ms");
+
+        R_CORE_ASSERT(resolved == frame.draws.size() * settings.iterations, "");
+        R_CORE_INFO("{0} entities: dynamic update {1:.3f} ms, {2} of {3} draws visible, BVH reports {4}",
+                    entityCount,
+                    dynamicUpdateTime,
+                    frame.visibleDraws.size(),
+                    frame.draws.size(),
+                    bvhVisible);
+
+        // Serialized scenes only reference loaded assets, placeholders aren't real files, so meshes are left out
+        generatorSettings.meshes.clear();
+        SceneSerializer saveSerializer(SceneGenerator::Generate(generatorSettings));
+        timer.Start();
+        saveSerializer.Serialize(scenePath);
+        add("save", timer.TimeInMilliseconds(), "ms");
+        add("file_size", static_cast<double>(std::filesystem::file_size(scenePath)) / (1024.0 * 1024.0), "MB");
+
+        SceneSerializer loadSerializer(Scene::Create(true));
+        timer.Start();
+        loadSerializer.Deserialize(scenePath);
+        add("load", timer.TimeInMilliseconds(), "ms");
+    }
+
+    std::filesystem::remove(scenePath);
+}
@@ -0,0 +1,77 @@
+#include "Benchmarks.hpp"
+#include "Logger.hpp"
+#include "Path.hpp"
+#include "Application.hpp"
+#include "ThreadService.hpp"
+#include <easyargs.h>
+#include <algorithm>
+#include <functional>
+#include <unordered_map>
+
+using namespace RightEngine;
+
+std::string G_ASSET_DIR = ASSETS_DIR;
+std::string G_CONFIG_DIR = CONFIG_DIR;
+
+// Headless engine benchmarks, doesn't create window or GPU device
+int main(int argc, char* argv[])
+{
+    Log::Init();
+
+    const std::unordered_map<std::string, std::function<void(const BenchmarkSettings&, BenchmarkReport&)>> benchmarks =
+    {
+        { "transform", RunTransformBenchmark },
+        { "trs", RunTrsBenchmark },
+        { "scene", RunSceneBenchmark },
+    };
+
+    EasyArgs easyArgs(argc, argv);
+    easyArgs.Version("0.0.1");
+    easyArgs.Value("-b", "--benchmark", "Name of the benchmark to run [transform|trs|scene], all are run when empty.", false);
+    easyArgs.Value("-e", "--entities", "Largest amount of entities in the scene.", false);
+    easyArgs.Value("-i", "--iterations", "Amount of measured iterations per configuration.", false);
+    easyArgs.Value("-o", "--output", "Path of the JSON report, it isn't written when empty.", false);
+
+    BenchmarkSettings settings;
+    const std::string entities = easyArgs.GetValueFor("-e");
+    if (!entities.empty())
+    {
+        settings.maxEntities = std::stoull(entities);
+    }
+    const std::string iterations = easyArgs.GetValueFor("-i");
+    if (!iterations.empty())
+    {
+        settings.iterations = std::max<size_t>(std::stoull(iterations), 1);
+    }
+
+    Path::Init();
+    Instance().RegisterService<ThreadService>();
+
+    BenchmarkReport report;
+    const std::string name = easyArgs.GetValueFor("-b");
+    if (name.empty())
+    {
+        for (const auto& [benchmarkName, benchmark] : benchmarks)
+        {
+            R_CORE_INFO("Running {0} benchmark", benchmarkName);
+            benchmark(settings, report);
+        }
+    }
+    else
+    {
+        const auto benchmarkIt = benchmarks.find(name);
+        if (benchmarkIt == benchmarks.end())
+        {
+            R_CORE_ERROR("Unknown benchmark {0}", name);
+            return 1;
+        }
+        benchmarkIt->second(settings, report);
+    }
+
+    const std::string output = easyArgs.GetValueFor("-o");
+    if (!output.empty() && !report.Write(output))
+    {
+        return 1;
+    }
+    return 0;
+}
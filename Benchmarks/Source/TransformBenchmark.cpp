@@ -0,0 +1,101 @@
+#include "Benchmarks.hpp"
+#include "Logger.hpp"
+#include "Timer.hpp"
+#include "Scene.hpp"
+#include "Entity.hpp"
+#include "Application.hpp"
+#include "ThreadService.hpp"
+
+using namespace RightEngine;
+
+namespace
+{
+    constexpr size_t C_MIN_ENTITIES = 1000;
+    // Wide and shallow like crowds or debris under a few grouping nodes, 1M entities give 7 levels
+    constexpr size_t C_FANOUT = 8;
+
+    std::shared_ptr<Scene> CreateScene(size_t entityCount)
+    {
+        auto scene = Scene::Create(true);
+        std::vector<Entity> entities;
+        entities.reserve(entityCount);
+        entities.push_back(scene->GetRootNode());
+        for (size_t i = 1; i < entityCount; i++)
+        {
+            auto entity = scene->CreateEntity();
+            auto& transform = entity.GetComponent<TransformComponent>();
+            transform.SetPosition(glm::vec3(static_cast<float>(i % C_FANOUT), 1.0f, 0.0f));
+            transform.SetRotationRadians(glm::vec3(0.0f, 0.1f, 0.0f));
+            entities[(i - 1) / C_FANOUT].AddChild(entity);
+            entities.push_back(entity);
+        }
+        return scene;
+    }
+
+    // Average milliseconds of the full hierarchy propagation
+    double Measure(TransformSystem& system, const std::shared_ptr<Scene>& scene, size_t iterations)
+    {
+        auto& root = scene->GetRootNode().GetComponent<TransformComponent>();
+        // Warm up, also flattens the hierarchy
+        system.Update(scene->GetRegistry(), scene->GetRootNode().GetHandle());
+
+        Timer timer;
+        for (size_t i = 0; i < iterations; i++)
+        {
+            // Moving the root makes every entity dirty
+            root.SetPosition(glm::vec3(static_cast<float>(i), 0.0f, 0.0f));
+            system.Update(scene->GetRegistry(), scene->GetRootNode().GetHandle());
+        }
+        timer.Stop();
+        return timer.TimeInMilliseconds() / static_cast<double>(iterations);
+    }
+
+    double MeasureStatic(TransformSystem& system, const std::shared_ptr<Scene>& scene, size_t iterations)
+    {
+        Timer timer;
+        for (size_t i = 0; i < iterations; i++)
+        {
+            system.Update(scene->GetRegistry(), scene->GetRootNode().GetHandle());
+        }
+        timer.Stop();
+        return timer.TimeInMilliseconds() / static_cast<double>(iterations);
+    }
+}
+
+void RightEngine::RunTransformBenchmark(const BenchmarkSettings& settings, BenchmarkReport& report)
+{
+    const size_t maxThreads = Instance().Service<ThreadService>().GetWorkerCount() + 1;
+    std::vector<size_t> threadCounts;
+    for (size_t threads = 1; threads < maxThreads; threads *= 2)
+    {
+        threadCounts.push_back(threads);
+    }
+    threadCounts.push_back(maxThreads);
+
+    for (size_t entityCount = C_MIN_ENTITIES; entityCount <= settings.maxEntities; entityCount *= 10)
+    {
+        const auto scene = CreateScene(entityCount);
+
+        double singleThreadTime = 0.0;
+        for (const size_t threads : threadCounts)
+        {
+            TransformSystem system;
+            system.SetMaxThreadCount(threads);
+            const double time = Measure(system, scene, settings.iterations);
+            if (threads == 1)
+            {
+                singleThreadTime = time;
+                const double staticTime = MeasureStatic(system, scene, settings.iterations);
+                report.Add("transform", "static_frame", entityCount, staticTime, "ms");
+                R_CORE_INFO("{0} entities, static frame {1:.4f} ms", entityCount, staticTime);
+            }
+            report.Add("transform", "update_" + std::to_string(threads) + "_threads", entityCount, time, "ms");
+            R_CORE_INFO("{0} entities, {1} threads: {2:.3f} ms, {3:.1f} M transforms/s, {4:.2f}x",
+                        entityCount,
+                        threads,
+                        time,
+                        static_cast<double>(entityCount) / time / 1000.0,
+                        singleThreadTime / time);
+        }
+    }
+}
@@ -0,0 +1,91 @@
+#include "Benchmarks.hpp"
+#include "Logger.hpp"
+#include "Timer.hpp"
+#include "Components.hpp"
+#include "TransformStreams.hpp"
+#include <algorithm>
+#include <random>
+
+using namespace RightEngine;
+
+namespace
+{
+    template<typename F>
+    double MeasureMatricesPerSecond(size_t count, size_t iterations, F&& f)
+    {
+        Timer timer;
+        for (size_t i = 0; i < iterations; i++)
+        {
+            f();
+        }
+        timer.Stop();
+        return static_cast<double>(count * iterations) / timer.TimeInSeconds();
+    }
+}
+
+void RightEngine::RunTrsBenchmark(const BenchmarkSettings& settings, BenchmarkReport& report)
+{
+    const size_t count = settings.maxEntities;
+
+    std::mt19937 random(42);
+    std::uniform_real_distribution<float> distribution(-10.0f, 10.0f);
+    std::vector<TransformComponent> transforms(count);
+    TransformStreams streams;
+    streams.Resize(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        auto& transform = transforms[i];
+        transform.SetPosition({ distribution(random), distribution(random), distribution(random) });
+        transform.SetRotationRadians(glm::vec3(distribution(random), distribution(random), distribution(random)) * 0.3f);
+        transform.SetScale(glm::abs(glm::vec3(distribution(random), distribution(random), distribution(random))) * 0.1f + 0.1f);
+        streams.Set(i, transform.GetPosition(), glm::quat(transform.GetRotation()), transform.GetScale());
+    }
+
+    std::vector<glm::mat4> glmResult(count);
+    const double glmRate = MeasureMatricesPerSecond(count, settings.iterations, [&]()
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            glmResult[i] = transforms[i].GetLocalTransformMatrix();
+        }
+    });
+
+    std::vector<glm::mat4> simdResult(count);
+    const double simdRate = MeasureMatricesPerSecond(count, settings.iterations, [&]()
+    {
+        ComposeTransforms(streams, 0, count, simdResult.data());
+    });
+
+    std::vector<uint32_t> indices(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        indices[i] = static_cast<uint32_t>(i);
+    }
+    std::vector<glm::mat4> gatherResult(count);
+    const double gatherRate = MeasureMatricesPerSecond(count, settings.iterations, [&]()
+    {
+        ComposeTransforms(streams, indices.data(), count, gatherResult.data());
+    });
+
+    float maxError = 0.0f;
+    for (size_t i = 0; i < count; i++)
+    {
+        for (int c = 0; c < 4; c++)
+        {
+            const glm::vec4 difference = glm::abs(glmResult[i][c] - simdResult[i][c]);
+            maxError = std::max({ maxError, difference.x, difference.y, difference.z, difference.w });
+        }
+    }
+
+    report.Add("trs", "glm", count, glmRate / 1.0e6, "M/s");
+    report.Add("trs", "soa_simd", count, simdRate / 1.0e6, "M/s");
+    report.Add("trs", "soa_simd_gather", count, gatherRate / 1.0e6, "M/s");
+    R_CORE_INFO("{0} matrices, glm: {1:.1f} M/s, SoA SIMD: {2:.1f} M/s ({3:.2f}x), SoA SIMD gather: {4:.1f} M/s ({5:.2f}x), max error {6}",
+                count,
+                glmRate / 1.0e6,
+                simdRate / 1.0e6,
+                simdRate / glmRate,
+                gatherRate / 1.0e6,
+                gatherRate / glmRate,
+                maxError);
+}
@@ -0,0 +1,91 @@
+#include "Logger.hpp"
+#include "Path.hpp"
+#include "Timer.hpp"
+#include "Application.hpp"
+#include "ThreadService.hpp"
+#include "ShaderCompiler.hpp"
+#include "AssetCooker.hpp"
+#include <easyargs.h>
+#include <algorithm>
+
+using namespace RightEngine;
+
+std::string G_ASSET_DIR = ASSETS_DIR;
+std::string G_CONFIG_DIR = CONFIG_DIR;
+
+namespace
+{
+    const char* StatusName(AssetCookStatus status)
+    {
+        switch (status)
+        {
+            case AssetCookStatus::COOKED:
+                return "Cooked";
+            case AssetCookStatus::SKIPPED:
+                return "Up to date";
+            case AssetCookStatus::FAILED:
+                return "Failed";
+        }
+        return "";
+    }
+}
+
+// Headless cooker, doesn't create window or GPU device
+int main(int argc, char* argv[])
+{
+    Log::Init();
+
+    EasyArgs easyArgs(argc, argv);
+    easyArgs.Version("0.0.1");
+    easyArgs.Value("-a", "--assets", "Absolute path to the asset root which will be cooked.", false);
+    easyArgs.Value("-f", "--force", "Cook all assets even if sources were not changed [true|false].", false);
+
+    const std::string assetDir = easyArgs.GetValueFor("-a");
+    if (!assetDir.empty())
+    {
+        G_ASSET_DIR = assetDir;
+    }
+
+    AssetCookerSettings settings;
+    settings.force = easyArgs.GetValueFor("-f") == "true";
+
+    Path::Init();
+    ShaderCompiler::Init();
+    Instance().RegisterService<ThreadService>();
+
+    R_CORE_INFO("Cooking assets from {0}", G_ASSET_DIR);
+    Timer timer;
+    AssetCooker cooker(settings);
+    auto results = cooker.Cook();
+    timer.Stop();
+
+    std::sort(results.begin(), results.end(), [](const auto& a, const auto& b)
+    {
+        return a.time > b.time;
+    });
+
+    size_t cooked = 0;
+    size_t skipped = 0;
+    size_t failed = 0;
+    for (const auto& result : results)
+    {
+        switch (result.status)
+        {
+            case AssetCookStatus::COOKED:
+                cooked++;
+                break;
+            case AssetCookStatus::SKIPPED:
+                skipped++;
+                break;
+            case AssetCookStatus::FAILED:
+                failed++;
+                break;
+        }
+        R_CORE_INFO("[{0}] {1:.2f} ms {2}", StatusName(result.status), result.time, result.path);
+    }
+
+    R_CORE_INFO("Cooked {0}, up to date {1}, failed {2} assets for {3:.2f} s",
+                cooked, skipped, failed, timer.TimeInSeconds());
+
+    return failed == 0 ? 0 : 1;
+}
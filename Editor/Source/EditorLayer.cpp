@@ -10,6 +10,8 @@
 #include "AssetManager.hpp"
 #include "KeyCodes.hpp"
 #include "SceneRenderer.hpp"
+#include "RenderThread.hpp"
+#include "RenderProxy.hpp"
 #include "MouseEvent.hpp"
 #include "SceneSerializer.hpp"
 #include "Filesystem.hpp"
@@ -65,14 +67,188 @@ namespace
 
     LayerSceneData sceneData;
 
-    void ImGuiAddTreeNodeChildren(const std::shared_ptr<Entity>& node, const std::shared_ptr<Scene>& scene)
+    // Written by editor systems during Scene::OnUpdate and copied into the frame packet after it
+    struct FrameData
+    {
+        CameraData cameraData{};
+        std::vector<LightData> lightData;
+        AssetHandle environmentHandle;
+    };
+
+    FrameData frameData;
+    RenderProxyExtractor proxyExtractor;
+
+    // Camera ray through a point of the viewport image, in pixels from its top left corner
+    Ray ViewportRay(const glm::vec2& position)
+    {
+        const auto& camera = frameData.cameraData;
+        const glm::vec2 ndc(position.x / sceneData.viewportSize.x * 2.0f - 1.0f,
+                            1.0f - position.y / sceneData.viewportSize.y * 2.0f);
+        const glm::vec4 farPoint = glm::inverse(camera.projection * camera.view) * glm::vec4(ndc, 1.0f, 1.0f);
+
+        Ray ray;
+        ray.origin = camera.position;
+        ray.direction = glm::normalize(glm::vec3(farPoint) / farPoint.w - camera.position);
+        return ray;
+    }
+
+    // Main thread, the packet must not reference anything the next update may change
+    void ExtractFramePacket(RightEngine::Scene& scene, FramePacket& packet)
+    {
+        packet.camera = frameData.cameraData;
+        packet.environment = AssetManager::Get().GetAsset<EnvironmentContext>(frameData.environmentHandle);
+        packet.lights = frameData.lightData;
+        packet.settings = sceneData.rendererSettings;
+
+        proxyExtractor.Extract(scene, packet.proxies);
+        packet.meshAssets = proxyExtractor.GetMeshes().GetAssets();
+        packet.materialAssets = proxyExtractor.GetMaterials().GetAssets();
+        auto& registry = scene.GetRegistry();
+        for (const uint32_t proxy : packet.proxies.animated)
+        {
+            packet.skinningPalettes.push_back(registry.get<AnimatorComponent>(packet.proxies.entities[proxy]).palette);
+        }
+    }
+
+    // Render thread
+    void RenderFramePacket(const FramePacket& packet)
+    {
+        auto& renderer = *sceneData.renderer;
+        renderer.SetUIPassCallback([&packet](const std::shared_ptr<CommandBuffer>& cmd)
+                                   {
+                                       sceneData.imGuiLayer->Draw(packet.ui, cmd);
+                                   });
+        renderer.BeginScene(packet.camera, packet.environment, packet.lights, packet.settings);
+        const auto& proxies = packet.proxies;
+        const std::vector<glm::vec4> bindPose;
+        // Animated proxy indices are ascending
+        size_t animated = 0;
+        for (size_t i = 0; i < proxies.count; i++)
+        {
+            const bool isAnimated = animated < proxies.animated.size() && proxies.animated[animated] == i;
+            renderer.SubmitMeshNode(*packet.meshAssets[proxies.meshIds[i]],
+                                    *packet.materialAssets[proxies.materialIds[i]],
+                                    proxies.transforms[i],
+                                    isAnimated ? packet.skinningPalettes[animated++] : bindPose,
+                                    proxies.tints[i],
+                                    proxies.occluders[i] != 0);
+        }
+        for (const auto& batch : proxies.staticBatches)
+        {
+            renderer.SubmitMesh(*batch.mesh, *packet.materialAssets[batch.materialId], glm::mat4(1.0f));
+        }
+        renderer.EndScene();
+    }
+
+    void RegisterEditorSystems(RightEngine::Scene& scene)
+    {
+        auto& scheduler = scene.GetSystemScheduler();
+
+        // Reads input and viewport state, so it can't leave the main thread
+        scheduler.Register({ "Editor camera",
+                             {},
+                             ComponentTypes<CameraComponent, TransformComponent>(),
+                             true,
+                             [](RightEngine::Scene& scene, float deltaTime)
+                             {
+                                 auto& registry = scene.GetRegistry();
+                                 frameData.cameraData = {};
+                                 for (const auto eCamera : registry.view<CameraComponent>())
+                                 {
+                                     auto& camera = registry.get<CameraComponent>(eCamera);
+                                     auto& transform = registry.get<TransformComponent>(eCamera);
+                                     camera.Rotate(glm::degrees(transform.GetRotation()));
+                                     camera.OnUpdate(deltaTime);
+                                     if (camera.isPrimary)
+                                     {
+                                         camera.isActive = Input::IsMouseButtonDown(MouseButton::Right) && sceneData.isViewportHovered;
+                                         if (camera.isActive)
+                                         {
+                                             glm::vec3 position = transform.GetPosition();
+                                             if (Input::IsKeyDown(R_KEY_W))
+                                             {
+                                                 position = camera.Move(R_KEY_W, position);
+                                             }
+                                             if (Input::IsKeyDown(R_KEY_S))
+                                             {
+                                                 position = camera.Move(R_KEY_S, position);
+                                             }
+                                             if (Input::IsKeyDown(R_KEY_A))
+                                             {
+                                                 position = camera.Move(R_KEY_A, position);
+                                             }
+                                             if (Input::IsKeyDown(R_KEY_D))
+                                             {
+                                                 position = camera.Move(R_KEY_D, position);
+                                             }
+                                             transform.SetPosition(position);
+                                         }
+                                         frameData.cameraData.position = transform.GetWorldPosition();
+                                         frameData.cameraData.view = camera.GetViewMatrix(frameData.cameraData.position);
+                                         frameData.cameraData.projection = camera.GetProjectionMatrix();
+                                         frameData.cameraData.zNear = camera.zNear;
+                                         frameData.cameraData.zFar = camera.zFar;
+                                     }
+                                 }
+                             } });
+
+        scheduler.Register({ "Lights",
+                             ComponentTypes<TransformComponent, LightComponent>(),
+                             {},
+                             false,
+                             [](RightEngine::Scene& scene, float)
+                             {
+                                 auto& registry = scene.GetRegistry();
+                                 frameData.lightData.clear();
+                                 for (const auto& entityID: registry.view<LightComponent>())
+                                 {
+                                     const auto& transform = registry.get<TransformComponent>(entityID);
+                                     const auto& light = registry.get<LightComponent>(entityID);
+                                     LightData shaderLight{};
+                                     shaderLight.type = static_cast<int>(light.type);
+                                     shaderLight.position = glm::vec4(transform.GetWorldPosition(), 1);
+                                     shaderLight.color = glm::vec4(light.color, 1);
+                                     shaderLight.intensity = light.intensity;
+                                     shaderLight.radiusInner = light.innerRadius;
+                                     shaderLight.radiusOuter = light.outerRadius;
+                                     shaderLight.rotation = glm::vec4(transform.GetRotation(), 1);
+
+                                     float near_plane = sceneData.lightOrtho.nearPlane, far_plane = sceneData.lightOrtho.farPlane;
+                                     auto lightProj = glm::ortho(sceneData.lightOrtho.left, sceneData.lightOrtho.right, sceneData.lightOrtho.bottom, sceneData.lightOrtho.top, near_plane, far_plane);
+                                     lightProj[1][1] *= -1;
+                                     const auto lightView = glm::lookAt(glm::vec3(shaderLight.position),glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+                                     shaderLight.lightSpace = lightProj * lightView;
+
+                                     frameData.lightData.emplace_back(shaderLight);
+                                 }
+                             } });
+
+        scheduler.Register({ "Skybox",
+                             ComponentTypes<SkyboxComponent>(),
+                             {},
+                             false,
+                             [](RightEngine::Scene& scene, float)
+                             {
+                                 auto& registry = scene.GetRegistry();
+                                 frameData.environmentHandle = {};
+                                 for (const auto& entityID: registry.view<SkyboxComponent>())
+                                 {
+                                     R_CORE_ASSERT(!frameData.environmentHandle.guid.isValid(), "")
+                                     const auto& skybox = registry.get<SkyboxComponent>(entityID);
+                                     frameData.environmentHandle = skybox.environmentHandle;
+                                     R_CORE_ASSERT(frameData.environmentHandle.guid.isValid(), "")
+                                 }
+                             } });
+    }
+
+    void ImGuiAddTreeNodeChildren(Entity node, const std::shared_ptr<Scene>& scene)
     {
         auto& ss = Instance().Service<SelectionService>();
-        for (const auto& entity: node->GetChildren())
+        for (const auto& entity: node.GetChildren())
         {
-            const auto& tag = entity->GetComponent<TagComponent>();
+            const auto& tag = entity.GetComponent<TagComponent>();
             ImGuiTreeNodeFlags node_flags = ImGuiTreeNodeFlags_OpenOnArrow;
-            bool node_open = ImGui::TreeNodeEx((char*) tag.guid.str().c_str(), node_flags, "%s", tag.name.c_str());
+            bool node_open = ImGui::TreeNodeEx(reinterpret_cast<const void*>(static_cast<uintptr_t>(tag.uiId)), node_flags, "%s", tag.name.c_str());
             if (ImGui::IsItemClicked())
             {
                 ss.Entity(entity);
@@ -96,16 +272,15 @@ namespace
 
             if (destroyEntity)
             {
-                const auto children = entity->GetChildren();
-                const auto parentNode = entity->GetParent();
+                const auto children = entity.GetChildren();
+                const auto parentNode = entity.GetParent();
                 for (const auto& child: children)
                 {
-                    parentNode->AddChild(child);
+                    parentNode.AddChild(child);
                 }
 
                 scene->DestroyEntity(entity);
-                parentNode->RemoveChild(entity);
-                ss.Entity(nullptr);
+                ss.Entity({});
                 return;
             }
         }
@@ -126,6 +301,41 @@ void EditorLayer::Scene(const std::shared_ptr<RightEngine::Scene>& scene)
     m_propertyPanel.SetScene(scene);
 }
 
+void EditorLayer::SwapScene(const std::shared_ptr<RightEngine::Scene>& scene)
+{
+    auto& ss = Instance().Service<SelectionService>();
+    const auto selected = ss.Entity();
+    // Selection follows the guid, handles of the same entity may differ between scenes
+    const auto selectedGuid = selected ? selected.GetComponent<TagComponent>().guid : xg::Guid();
+    m_scene = scene;
+    m_propertyPanel.SetScene(scene);
+    ss.Entity(selectedGuid.isValid() ? scene->FindEntity(selectedGuid) : RightEngine::Entity());
+}
+
+void EditorLayer::EnterPlayMode()
+{
+    if (IsPlaying())
+    {
+        return;
+    }
+    RightEngine::Timer timer;
+    m_editScene = m_scene;
+    SwapScene(m_editScene->Clone());
+    R_INFO("[EditorLayer] Entered play mode in {}ms", timer.TimeInMilliseconds());
+}
+
+void EditorLayer::ExitPlayMode()
+{
+    if (!IsPlaying())
+    {
+        return;
+    }
+    // Snapshot streams on its own, its loads must not outlive it
+    m_scene->CancelAssetLoading();
+    SwapScene(m_editScene);
+    m_editScene = nullptr;
+}
+
 void EditorLayer::AddCommand(EditorCommand&& command)
 {
     std::lock_guard l(m_editorCommandMutex);
@@ -171,140 +381,67 @@ void EditorLayer::OnAttach()
     EventDispatcher::Get().Subscribe(MouseMovedEvent::descriptor, EVENT_CALLBACK(EditorLayer::OnEvent));
     sceneData.imGuiLayer = std::make_shared<ImGuiLayer>(sceneData.renderer->GetPass(PassType::UI));
     Application::Get().PushOverlay(sceneData.imGuiLayer);
-    sceneData.renderer->SetUIPassCallback([&](const std::shared_ptr<CommandBuffer>& cmd)
-                                          {
-                                              sceneData.imGuiLayer->Begin();
-                                              OnImGuiRender();
-                                              sceneData.imGuiLayer->End(cmd);
-                                          });
+    m_renderThread.Start(RenderFramePacket);
 
     auto& ss = Instance().Service<SelectionService>();
-    ss.SelectEntityCallback([=](std::shared_ptr<Entity> entity)
+    ss.SelectEntityCallback([=](Entity entity)
         {
             m_propertyPanel.SetSelectedEntity(entity);
         });
     ss.DeselectEntityCallback([=]()
         {
-            m_propertyPanel.SetSelectedEntity(nullptr);
+            m_propertyPanel.SetSelectedEntity({});
         });
 
+    // Property panel shows source panorama of the skybox
+    AssetManager::Get().GetLoader<EnvironmentMapLoader>()->SetRetainEquirectangular(true);
     LoadDefaultScene();
     R_INFO("[EditorLayer] Layer was successfully attached for {}s", timer.TimeInSeconds());
 }
 
+void EditorLayer::OnDetach()
+{
+    m_renderThread.Stop();
+}
+
 void EditorLayer::OnUpdate(float ts)
 {
     if (m_newScene)
     {
+        if (m_editScene)
+        {
+            m_editScene->CancelAssetLoading();
+            m_editScene = nullptr;
+        }
+        if (m_scene)
+        {
+            m_scene->CancelAssetLoading();
+            // Entity handles don't keep the scene alive
+            Instance().Service<SelectionService>().Entity({});
+        }
         m_scene = m_newScene;
         m_newScene = nullptr;
+        RegisterEditorSystems(*m_scene);
     }
     if (sceneData.newViewportSize.x != 0 && sceneData.newViewportSize.y != 0)
     {
+        // Render targets are only recreated while the render thread is idle
+        m_renderThread.Flush();
         sceneData.renderer->Resize(sceneData.newViewportSize.x, sceneData.newViewportSize.y);
         sceneData.newViewportSize = { 0, 0 };
     }
 
     m_scene->OnUpdate(ts);
 
-    CameraData cameraData{};
-    for (const auto eCamera : m_scene->GetRegistry().view<CameraComponent>())
-    {
-        auto& camera = m_scene->GetRegistry().get<CameraComponent>(eCamera);
-        auto& transform = m_scene->GetRegistry().get<TransformComponent>(eCamera);
-        camera.Rotate(glm::degrees(transform.rotation));
-        camera.OnUpdate(ts);
-        if (camera.isPrimary)
-        {
-            camera.isActive = Input::IsMouseButtonDown(MouseButton::Right) && sceneData.isViewportHovered;
-            if (camera.isActive)
-            {
-                glm::vec3 position = transform.position;
-                if (Input::IsKeyDown(R_KEY_W))
-                {
-                    position = camera.Move(R_KEY_W, position);
-                }
-                if (Input::IsKeyDown(R_KEY_S))
-                {
-                    position = camera.Move(R_KEY_S, position);
-                }
-                if (Input::IsKeyDown(R_KEY_A))
-                {
-                    position = camera.Move(R_KEY_A, position);
-                }
-                if (Input::IsKeyDown(R_KEY_D))
-                {
-                    position = camera.Move(R_KEY_D, position);
-                }
-                transform.position = position;
-            }
-            cameraData.position = transform.GetWorldPosition();
-            cameraData.view = camera.GetViewMatrix(cameraData.position);
-            cameraData.projection = camera.GetProjectionMatrix();
-        }
-    }
-
-    std::vector<LightData> lightData;
-    for (const auto& entityID: m_scene->GetRegistry().view<LightComponent>())
-    {
-        const auto& transform = m_scene->GetRegistry().get<TransformComponent>(entityID);
-        const auto& light = m_scene->GetRegistry().get<LightComponent>(entityID);
-        LightData shaderLight{};
-        shaderLight.type = static_cast<int>(light.type);
-        shaderLight.position = glm::vec4(transform.GetWorldPosition(), 1);
-        shaderLight.color = glm::vec4(light.color, 1);
-        shaderLight.intensity = light.intensity;
-        shaderLight.radiusInner = light.innerRadius;
-        shaderLight.radiusOuter = light.outerRadius;
-        shaderLight.rotation = glm::vec4(transform.rotation, 1);
-
-        CameraComponent camera;
-        camera.Rotate(shaderLight.rotation);
-        float near_plane = sceneData.lightOrtho.nearPlane, far_plane = sceneData.lightOrtho.farPlane;
-        auto lightProj = glm::ortho(sceneData.lightOrtho.left, sceneData.lightOrtho.right, sceneData.lightOrtho.bottom, sceneData.lightOrtho.top, near_plane, far_plane);
-        lightProj[1][1] *= -1;
-        // const auto lightView = camera.GetViewMatrix(shaderLight.position);
-        const auto lightView = glm::lookAt(glm::vec3(shaderLight.position),glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-        shaderLight.lightSpace = lightProj * lightView;
-
-        lightData.emplace_back(shaderLight);
-    }
-
-    auto& assetManager = AssetManager::Get();
-
-    AssetHandle environmentHandle;
-    for (const auto& entityID: m_scene->GetRegistry().view<SkyboxComponent>())
-    {
-        R_CORE_ASSERT(!environmentHandle.guid.isValid(), "")
-        const auto& skybox = m_scene->GetRegistry().get<SkyboxComponent>(entityID);
-        environmentHandle = skybox.environmentHandle;
-        R_CORE_ASSERT(environmentHandle.guid.isValid(), "")
-    }
-
+    // UI is built on the main thread, while the previous frame may be still rendered
     sceneData.renderer->SetScene(m_scene);
-    sceneData.renderer->BeginScene(cameraData,
-                                   assetManager.GetAsset<EnvironmentContext>(environmentHandle),
-                                   lightData,
-                                   sceneData.rendererSettings);
-
-    for (auto& entity: m_scene->GetRegistry().view<MeshComponent>())
-    {
-        const auto& tag = m_scene->GetRegistry().get<TagComponent>(entity);
-        const auto& transform = m_scene->GetRegistry().get<TransformComponent>(entity);
-        const auto& meshComponent = m_scene->GetRegistry().get<MeshComponent>(entity);
-        const auto& materialRef = meshComponent.material;
-        if (!meshComponent.isVisible)
-        {
-            continue;
-        }
-
-        sceneData.renderer->SubmitMeshNode(assetManager.GetAsset<MeshNode>(meshComponent.mesh),
-                                           assetManager.GetAsset<Material>(materialRef),
-                                           transform.GetWorldTransformMatrix());
-    }
-
-    sceneData.renderer->EndScene();
+    sceneData.imGuiLayer->Begin();
+    OnImGuiRender();
 
+    auto& packet = m_renderThread.BeginPacket();
+    ExtractFramePacket(*m_scene, packet);
+    packet.ui = sceneData.imGuiLayer->End();
+    m_renderThread.SubmitPacket();
 
     std::vector<EditorCommand> queue;
     {
@@ -388,6 +525,12 @@ void EditorLayer::OnImGuiRender()
                 SceneSerializer serializer(m_scene);
                 serializer.Serialize(sceneData.scenePath);
             }
+            if (ImGui::MenuItem("Save As World Partition"))
+            {
+                sceneData.scenePath = Filesystem::SaveFileDialog({ "All Files(*.*)", "*.*"});
+                SceneSerializer serializer(m_scene);
+                serializer.SerializePartitioned(sceneData.scenePath);
+            }
             if (ImGui::MenuItem("Load"))
             {
                 SceneSerializer serializer(Scene::Create());
@@ -407,6 +550,15 @@ void EditorLayer::OnImGuiRender()
             ImGui::EndMenu();
         }
 
+        if (ImGui::MenuItem(IsPlaying() ? "Stop" : "Play"))
+        {
+            // Scene is swapped after the frame packet was extracted from the current one
+            AddCommand([this]()
+                {
+                    IsPlaying() ? ExitPlayMode() : EnterPlayMode();
+                });
+        }
+
         if (ImGui::BeginMenu("Tools"))
         {
             if (ImGui::MenuItem("ImGui Demo window"))
@@ -433,7 +585,7 @@ void EditorLayer::OnImGuiRender()
     if (ImGui::TreeNodeEx("Root", ImGuiTreeNodeFlags_OpenOnArrow))
     {
         ImGui::PushStyleVar(ImGuiStyleVar_IndentSpacing, ImGui::GetFontSize() * 3);
-        const auto& node = m_scene->GetRootNode();
+        const auto node = m_scene->GetRootNode();
         ImGuiAddTreeNodeChildren(node, m_scene);
         ImGui::TreePop();
         ImGui::PopStyleVar();
@@ -454,23 +606,18 @@ void EditorLayer::OnImGuiRender()
     ImGui::Begin("Viewport");
     if (sceneData.isViewportHovered && ImGui::IsMouseClicked(0))
     {
-        auto pos = ImGui::GetMousePos();
-        auto rectPos = ImGui::GetWindowPos();
-        glm::vec2 pickPos = { pos.x - rectPos.x, pos.y - rectPos.y };
+        const auto pos = ImGui::GetMousePos();
+        const auto rectPos = ImGui::GetWindowPos();
+        const auto contentMin = ImGui::GetWindowContentRegionMin();
+        const glm::vec2 pickPos = { pos.x - rectPos.x - contentMin.x, pos.y - rectPos.y - contentMin.y };
         AddCommand([this, pickPos]()
             {
-                auto id = sceneData.renderer->Pick(m_scene, pickPos);
-				const auto entities = m_scene->GetRootNode()->GetAllChildren();
-                std::shared_ptr<Entity> selectedEntity;
-				for (const auto& entity : entities)
-				{
-                    auto& tag = entity->GetComponent<TagComponent>();
-                    if (tag.colorId == id)
-                    {
-                        selectedEntity = entity;
-                        break;
-                    }
-				}
+                Entity selectedEntity;
+                RaycastHit hit;
+                if (m_scene->Raycast(ViewportRay(pickPos), hit))
+                {
+                    selectedEntity = Entity(hit.entity, m_scene.get());
+                }
                 auto& ss = Instance().Service<SelectionService>();
                 ss.Entity(selectedEntity);
             });
@@ -546,7 +693,7 @@ void EditorLayer::OnImGuiRender()
         glm::mat4 cameraView = camera.GetViewMatrix(cameraPos);
         glm::mat4 cameraProjection = camera.GetProjectionMatrix();
 
-        auto& entityTransformComponent = selectedEntity->GetComponent<TransformComponent>();
+        auto& entityTransformComponent = selectedEntity.GetComponent<TransformComponent>();
         glm::mat4 entityTransform = entityTransformComponent.GetWorldTransformMatrix();
 
         ImGuizmo::Manipulate(glm::value_ptr(cameraView), glm::value_ptr(cameraProjection),
@@ -555,13 +702,21 @@ void EditorLayer::OnImGuiRender()
 
         if (ImGuizmo::IsUsing())
         {
+            // Gizmo works in world space, while the component stores transform relative to the parent
+            const auto parent = selectedEntity.GetParent();
+            if (parent)
+            {
+                const auto& parentTransform = parent.GetComponent<TransformComponent>().GetWorldTransformMatrix();
+                entityTransform = glm::inverse(parentTransform) * entityTransform;
+            }
+
             glm::vec3 position, rotation, scale;
             Utils::DecomposeTransform(entityTransform, position, rotation, scale);
 
-            auto deltaRotation = rotation - entityTransformComponent.rotation;
-            entityTransformComponent.position = position;
-            entityTransformComponent.SetRotationRadians(entityTransformComponent.rotation + deltaRotation);
-            entityTransformComponent.scale = scale;
+            auto deltaRotation = rotation - entityTransformComponent.GetRotation();
+            entityTransformComponent.SetPosition(position);
+            entityTransformComponent.SetRotationRadians(entityTransformComponent.GetRotation() + deltaRotation);
+            entityTransformComponent.SetScale(scale);
         }
     }
 
@@ -583,7 +738,26 @@ void EditorLayer::OnImGuiRender()
 
     for (const auto& pass : sceneData.renderer->GetPassInfo())
     {
-        ImGui::Text("%s: %.2fms", pass.m_name.c_str(), pass.m_time);
+        if (pass.m_visibleCount + pass.m_culledCount > 0)
+        {
+            ImGui::Text("%s: %.2fms, %zu drawn, %zu culled (%zu occluded), %zu draw calls",
+                        pass.m_name.c_str(),
+                        pass.m_time,
+                        pass.m_visibleCount,
+                        pass.m_culledCount,
+                        pass.m_occludedCount,
+                        pass.m_drawCallCount);
+        }
+        else
+        {
+            ImGui::Text("%s: %.2fms", pass.m_name.c_str(), pass.m_time);
+        }
+    }
+
+    ImGui::Separator();
+    for (const auto& system : m_scene->GetSystemScheduler().GetTimings())
+    {
+        ImGui::Text("%s: %.2fms", system.name.c_str(), system.time);
     }
 
     ImGui::End();
@@ -614,7 +788,7 @@ bool EditorLayer::OnEvent(const Event& event)
             auto& transform = m_scene->GetRegistry().get<TransformComponent>(eCamera);
             if (camera.isPrimary)
             {
-                auto rotation = camera.Rotate(mouseMovedEvent.GetX(), mouseMovedEvent.GetY(), glm::degrees(transform.rotation));
+                auto rotation = camera.Rotate(mouseMovedEvent.GetX(), mouseMovedEvent.GetY(), glm::degrees(transform.GetRotation()));
                 transform.SetRotationRadians(glm::radians(rotation));
                 break;
             }
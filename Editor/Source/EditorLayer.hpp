@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Core.hpp"
+#include "RenderThread.hpp"
 #include "Panels/ContentBrowserPanel.hpp"
 #include "Panels/PropertyPanel.hpp"
 #include "Panels/RenderDebugPanel.hpp"
@@ -13,6 +14,7 @@ namespace editor
         EditorLayer() : Layer("Game") {}
 
         virtual void OnAttach() override;
+        virtual void OnDetach() override;
         virtual void OnUpdate(float ts) override;
         virtual void OnImGuiRender();
         bool OnEvent(const Event& event);
@@ -23,15 +25,27 @@ namespace editor
         void NewScene();
         void OpenScene(const fs::path& path);
 
+        // Play mode runs a snapshot of the edited scene, stopping it restores the scene as it was before play
+        void EnterPlayMode();
+        void ExitPlayMode();
+        bool IsPlaying() const
+        { return m_editScene != nullptr; }
+
     private:
         void Scene(const std::shared_ptr<RightEngine::Scene>& scene);
+        // Selection and property panel follow the entity with the same id in the scene
+        void SwapScene(const std::shared_ptr<RightEngine::Scene>& scene);
         std::shared_ptr<RightEngine::Scene> m_scene;
         std::shared_ptr<RightEngine::Scene> m_newScene;
+        // Edited scene while m_scene is its play mode snapshot
+        std::shared_ptr<RightEngine::Scene> m_editScene;
 
         ContentBrowserPanel m_contentBrowser;
         PropertyPanel m_propertyPanel;
         RenderDebugPanel m_renderDebugPanel;
 
+        RightEngine::RenderThread m_renderThread;
+
         using EditorCommand = std::function<void()>;
         std::vector<EditorCommand> m_editorCommands;
         std::recursive_mutex m_editorCommandMutex;
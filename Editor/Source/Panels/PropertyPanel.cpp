@@ -174,6 +174,59 @@ namespace
 		
 	}
 
+	// Occlusion, roughness and metallic share one packed texture, so changing any source repacks it
+	void DrawOrmSourceTab(const std::string& label,
+	                      std::string& sourcePath,
+	                      const std::shared_ptr<Material>& material)
+	{
+		auto& assetManager = AssetManager::Get();
+		ImGui::LabelText("", label.c_str());
+		ImGui::TextUnformatted(sourcePath.empty() ? "None" : fs::path(sourcePath).filename().string().c_str());
+		ImGuiLayer::Image(assetManager.GetAsset<Texture>(material->textureData.orm), ImVec2(64, 64), ImVec2(0, 1),
+		                  ImVec2(1, 0));
+
+		const auto repack = [&assetManager, material]()
+		{
+			auto& ts = Instance().Service<ThreadService>();
+			ts.AddBackgroundTask([&assetManager, material, sources = material->textureData.ormSources]()
+				{
+					material->textureData.orm = assetManager.GetLoader<TextureLoader>()->LoadOrm(sources);
+				});
+		};
+
+		if (ImGui::IsItemClicked(1))
+		{
+			sourcePath.clear();
+			repack();
+			return;
+		}
+
+		if (ImGui::BeginDragDropTarget())
+		{
+			const auto payload = ImGui::AcceptDragDropPayload(editor::C_CONTENT_BROWSER_DND_NAME);
+			if (!payload)
+			{
+				ImGui::EndDragDropTarget();
+				return;
+			}
+			static char pathBuff[256]{};
+			memset(pathBuff, 0, 256);
+			memcpy(pathBuff, payload->Data, payload->DataSize);
+			fs::path path = pathBuff;
+			if (!path.has_extension())
+			{
+				ImGui::EndDragDropTarget();
+				return;
+			}
+			if (path.extension() == ".png" || path.extension() == ".jpg")
+			{
+				sourcePath = path.generic_string();
+				repack();
+			}
+			ImGui::EndDragDropTarget();
+		}
+	}
+
 	std::string LightTypeToStr(LightType type)
 	{
 		switch (type)
@@ -211,21 +264,21 @@ namespace editor
 		scene = aScene;
 	}
 
-	void PropertyPanel::SetSelectedEntity(const std::shared_ptr<Entity>& entity)
+	void PropertyPanel::SetSelectedEntity(Entity entity)
 	{
 		selectedEntity = entity;
 	}
 
 	template <class T>
-	void DrawComponent(const std::string& componentName, const std::shared_ptr<Entity>& entity,
+	void DrawComponent(const std::string& componentName, Entity entity,
 	                   std::function<void(T&)> uiFunction)
 	{
 		const ImGuiTreeNodeFlags treeNodeFlags = ImGuiTreeNodeFlags_DefaultOpen | ImGuiTreeNodeFlags_Framed
 			| ImGuiTreeNodeFlags_SpanAvailWidth | ImGuiTreeNodeFlags_AllowItemOverlap
 			| ImGuiTreeNodeFlags_FramePadding;
-		if (entity->HasComponent<T>())
+		if (entity.HasComponent<T>())
 		{
-			auto& component = entity->GetComponent<T>();
+			auto& component = entity.GetComponent<T>();
 			bool open = ImGui::TreeNodeEx((void*)typeid(T).hash_code(), treeNodeFlags, componentName.c_str());
 
 			ImGui::SameLine();
@@ -251,7 +304,7 @@ namespace editor
 
 			if (removeComponent)
 			{
-				entity->RemoveComponent<T>();
+				entity.RemoveComponent<T>();
 			}
 		}
 	}
@@ -268,21 +321,24 @@ namespace editor
 			if (ImGui::BeginPopup("AddComponent"))
 			{
 				DisplayAddComponentEntry<MeshComponent>("Mesh");
+				DisplayAddComponentEntry<AnimatorComponent>("Animator");
 				DisplayAddComponentEntry<CameraComponent>("Camera");
 				DisplayAddComponentEntry<LightComponent>("Light");
 
 				ImGui::EndPopup();
 			}
 
-			DrawComponent<TagComponent>("Tag", selectedEntity, [](auto& component)
+			DrawComponent<TagComponent>("Tag", selectedEntity, [this](auto& component)
 			{
 				const size_t bufSize = 256;
 				char buf[bufSize];
 				R_CORE_ASSERT(component.name.size() < bufSize, "");
-				snprintf(buf, bufSize, component.name.c_str());
-				ImGui::InputText("Entity Name", buf, bufSize);
-				//TODO: Change name only if buf was changed
-				component.name = std::string(buf);
+				snprintf(buf, bufSize, "%s", component.name.c_str());
+				// Renamed through the scene, so its name index follows
+				if (ImGui::InputText("Entity Name", buf, bufSize))
+				{
+					scene->RenameEntity(selectedEntity, buf);
+				}
 				ImGui::Separator();
 				ImGui::Separator();
 				ImGui::LabelText("GUID", "%s", component.guid.str().c_str());
@@ -290,16 +346,26 @@ namespace editor
 
 			DrawComponent<TransformComponent>("Transform", selectedEntity, [](auto& component)
 			{
-				auto& position = component.position;
+				// Setters are called only on change, so untouched transforms stay clean
+				auto position = component.GetPosition();
 				DrawVec3Control("Position", position);
-				auto rotation = glm::degrees(component.rotation);
+				if (position != component.GetPosition())
+				{
+					component.SetPosition(position);
+				}
+				const auto oldRotation = glm::degrees(component.GetRotation());
+				auto rotation = oldRotation;
 				DrawVec3Control("Rotation", rotation);
-				if (rotation != component.rotation)
+				if (rotation != oldRotation)
 				{
 					component.SetRotationDegree(rotation);
 				}
-				auto& scale = component.scale;
+				auto scale = component.GetScale();
 				DrawVec3Control("Scale", scale);
+				if (scale != component.GetScale())
+				{
+					component.SetScale(scale);
+				}
 			});
 
 			DrawComponent<SkyboxComponent>("Skybox", selectedEntity, [this](auto& component)
@@ -307,6 +373,30 @@ namespace editor
 				auto& assetManager = AssetManager::Get();
 				const auto& currentEnvironment = assetManager.GetAsset<EnvironmentContext>(component.environmentHandle);
 				ImGui::LabelText("Image name", "%s", currentEnvironment->name.c_str());
+
+				auto settings = currentEnvironment->settings;
+				bool settingsChanged = false;
+				const char* sizeNames[] = { "512", "1024", "2048", "4096" };
+				const uint32_t sizes[] = { 512, 1024, 2048, 4096 };
+				int currentSize = 0;
+				for (int i = 0; i < IM_ARRAYSIZE(sizes); i++)
+				{
+					if (sizes[i] == settings.environmentSize)
+					{
+						currentSize = i;
+					}
+				}
+				if (ImGui::Combo("Resolution", &currentSize, sizeNames, IM_ARRAYSIZE(sizeNames)))
+				{
+					settings.environmentSize = sizes[currentSize];
+					settingsChanged = true;
+				}
+				settingsChanged |= ImGui::Checkbox("Compress", &settings.compress);
+				if (settingsChanged)
+				{
+					component.environmentHandle = assetManager.GetLoader<EnvironmentMapLoader>()->Reload(component.environmentHandle, settings);
+				}
+
 				ImGui::Separator();
 				ImGuiLayer::Image(currentEnvironment->equirectangularTexture, ImVec2(512, 256), ImVec2(0, 1),
 				                  ImVec2(1, 0));
@@ -368,12 +458,16 @@ namespace editor
 				bool isVisible = component.isVisible;
 				ImGui::Checkbox("Is visible", &isVisible);
 				component.isVisible = isVisible;
+				ImGui::Checkbox("Is occluder", &component.isOccluder);
+				ImGui::Checkbox("Is static", &component.isStatic);
+				ImGui::ColorEdit4("Tint", &component.tint.x);
 				ImGui::Separator();
 
-				if (ImGui::BeginTable("split", 2, ImGuiTableFlags_Resizable | ImGuiTableFlags_NoSavedSettings))
+				// Material may be still streamed in
+				auto& materialRef = component.material;
+				auto material = AssetManager::Get().GetAsset<Material>(materialRef);
+				if (material && ImGui::BeginTable("split", 2, ImGuiTableFlags_Resizable | ImGuiTableFlags_NoSavedSettings))
 				{
-					auto& materialRef = component.material;
-					auto material = AssetManager::Get().GetAsset<Material>(materialRef);
 					ImGui::TableNextColumn();
 					DrawMaterialEditorTab("Albedo", true, material->textureData.albedo, textures, component);
 					ImGui::TableNextColumn();
@@ -383,18 +477,19 @@ namespace editor
 					DrawMaterialEditorTab("Normal", true, material->textureData.normal, textures, component);
 					ImGui::TableNextColumn();
 
+					auto& ormSources = material->textureData.ormSources;
 					ImGui::TableNextColumn();
-					DrawMaterialEditorTab("Metallic", true, material->textureData.metallic, textures, component);
+					DrawOrmSourceTab("Metallic", ormSources.metallic, material);
 					ImGui::TableNextColumn();
 					ImGui::SliderFloat("Metallic", &material->materialData.metallic,0, 1);
 
 					ImGui::TableNextColumn();
-					DrawMaterialEditorTab("Roughness", true, material->textureData.roughness, textures, component);
+					DrawOrmSourceTab("Roughness", ormSources.roughness, material);
 					ImGui::TableNextColumn();
 					ImGui::SliderFloat("Roughness", &material->materialData.roughness,0, 1);
 
 					ImGui::TableNextColumn();
-					DrawMaterialEditorTab("AO", true, material->textureData.ao, textures, component);
+					DrawOrmSourceTab("AO", ormSources.occlusion, material);
 					ImGui::TableNextColumn();
 
 
@@ -402,6 +497,43 @@ namespace editor
 				}
 			});
 
+			DrawComponent<AnimatorComponent>("Animator", selectedEntity, [this](auto& component)
+			{
+				std::shared_ptr<MeshNode> meshNode;
+				if (selectedEntity.HasComponent<MeshComponent>())
+				{
+					meshNode = AssetManager::Get().GetAsset<MeshNode>(selectedEntity.GetComponent<MeshComponent>().mesh);
+				}
+				if (!meshNode || meshNode->animations.empty())
+				{
+					ImGui::Text("Mesh has no animations");
+					return;
+				}
+
+				const auto& animations = meshNode->animations;
+				const bool isClipValid = component.clip >= 0 && component.clip < animations.size();
+				if (ImGui::BeginCombo("Clip", isClipValid ? animations[component.clip].name.c_str() : ""))
+				{
+					for (int32_t i = 0; i < animations.size(); i++)
+					{
+						bool isSelected = component.clip == i;
+						if (ImGui::Selectable(animations[i].name.c_str(), isSelected) && !isSelected)
+						{
+							component.Play(i);
+						}
+						if (isSelected)
+						{
+							ImGui::SetItemDefaultFocus();
+						}
+					}
+					ImGui::EndCombo();
+				}
+
+				ImGui::SliderFloat("Speed", &component.speed, 0.0f, 3.0f);
+				ImGui::Checkbox("Loop", &component.loop);
+				ImGui::Checkbox("Is playing", &component.isPlaying);
+			});
+
 			DrawComponent<CameraComponent>("Camera", selectedEntity, [this](auto& component)
 			{
 				ImGui::Checkbox("Is primary", &component.isPrimary);
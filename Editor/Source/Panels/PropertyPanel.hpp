@@ -17,7 +17,7 @@ namespace editor
         PropertyPanel(const std::shared_ptr<RightEngine::Scene>& aScene);
 
         void SetScene(const std::shared_ptr<RightEngine::Scene>& aScene);
-        void SetSelectedEntity(const std::shared_ptr<RightEngine::Entity>& entity);
+        void SetSelectedEntity(RightEngine::Entity entity);
 
         void OnImGuiRender();
 
@@ -27,18 +27,18 @@ namespace editor
         template<typename T>
         void DisplayAddComponentEntry(const std::string& entryName)
         {
-            if (!selectedEntity->HasComponent<T>())
+            if (!selectedEntity.HasComponent<T>())
             {
                 if (ImGui::MenuItem(entryName.c_str()))
                 {
-                    selectedEntity->AddComponent<T>();
+                    selectedEntity.AddComponent<T>();
                     ImGui::CloseCurrentPopup();
                 }
             }
         }
 
         std::shared_ptr<RightEngine::Scene> scene;
-        std::shared_ptr<RightEngine::Entity> selectedEntity;
+        RightEngine::Entity selectedEntity;
         std::unordered_map<std::string, RightEngine::AssetHandle> environmentMaps;
         std::unordered_map<std::string, RightEngine::AssetHandle> meshes;
         std::unordered_map<std::string, RightEngine::AssetHandle> textures;
@@ -11,7 +11,7 @@ void SelectionService::OnUpdate(float dt)
 SelectionService::~SelectionService()
 {}
 
-void SelectionService::Entity(const std::shared_ptr<RightEngine::Entity>& entity)
+void SelectionService::Entity(RightEngine::Entity entity)
 {
 	m_entity = entity;
 	if (entity && m_selectEntityCallback)
@@ -24,11 +24,11 @@ void SelectionService::Entity(const std::shared_ptr<RightEngine::Entity>& entity
 	}
 }
 
-std::shared_ptr<RightEngine::Entity> SelectionService::Entity() const
+RightEngine::Entity SelectionService::Entity() const
 {
-	if (m_entity.expired())
+	if (!m_entity)
 	{
-		return nullptr;
+		return {};
 	}
-	return m_entity.lock();
+	return m_entity;
 }
@@ -11,10 +11,12 @@ namespace editor
 		virtual void OnRegister() override;
 		virtual ~SelectionService();
 
-		void Entity(const std::shared_ptr<RightEngine::Entity>& entity);
-		std::shared_ptr<RightEngine::Entity> Entity() const;
+		// Empty entity deselects
+		void Entity(RightEngine::Entity entity);
+		// Empty when nothing is selected or selected entity was destroyed
+		RightEngine::Entity Entity() const;
 
-		using SelectCallback = std::function<void(std::shared_ptr<RightEngine::Entity>)>;
+		using SelectCallback = std::function<void(RightEngine::Entity)>;
 		using DeselectCallback = std::function<void()>;
 
 		void SelectEntityCallback(SelectCallback&& cb)
@@ -28,7 +30,7 @@ namespace editor
 		}
 
 	private:
-		std::weak_ptr<RightEngine::Entity> m_entity;
+		RightEngine::Entity m_entity;
 		SelectCallback m_selectEntityCallback;
 		DeselectCallback m_deselectEntityCallback;
 	};
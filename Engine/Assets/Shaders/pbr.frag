@@ -8,6 +8,7 @@ struct VertexOutput
     vec3 WorldPos;
     mat3 TBN;
     vec4 CameraPosition;
+    vec4 Tint;
 };
 
 layout(location = 0) in VertexOutput Output;
@@ -21,9 +22,8 @@ layout (binding = 2) uniform UBMaterialData
 
 layout(binding = 3) uniform sampler2D	u_Albedo;
 layout(binding = 4) uniform sampler2D	u_Normal;
-layout(binding = 5) uniform sampler2D	u_Metallic;
-layout(binding = 6) uniform sampler2D	u_Roughness;
-layout(binding = 7) uniform sampler2D	u_AO;
+// R - occlusion, G - roughness, B - metallic
+layout(binding = 5) uniform sampler2D	u_ORM;
 layout(binding = 8) uniform samplerCube u_IrradianceMap;
 layout(binding = 9) uniform samplerCube u_PrefilterMap;
 layout(binding = 10) uniform sampler2D	u_BRDFLUT;
@@ -41,11 +41,36 @@ struct Light
     mat4	lightSpace;
 };
 
-layout(binding = 11) uniform LightBuffer
+// Directional lights go first, point lights are only reached through the light clusters
+layout(std430, binding = 11) readonly buffer LightBuffer
 {
-    Light	u_Light[30];
-    int		u_LightsAmount;
-    vec3	dummy;
+    Light	u_Lights[];
+};
+
+struct Cluster
+{
+    uint	Offset;
+    uint	Count;
+};
+
+layout(std430, binding = 15) readonly buffer ClusterBuffer
+{
+    Cluster	u_Clusters[];
+};
+
+layout(std430, binding = 16) readonly buffer LightIndexBuffer
+{
+    uint	u_LightIndices[];
+};
+
+layout(binding = 17) uniform UBClusterData
+{
+    vec4	u_ViewDepthRow;
+    vec2	u_TileSize;
+    float	u_SliceScale;
+    float	u_SliceBias;
+    // XYZ - tiles and depth slices, W - amount of directional lights
+    uvec4	u_ClusterGrid;
 };
 
 float CalculateDirectionalShadow(vec4 fragPosLightSpace, vec4 lightPos, vec3 fragPos)
@@ -178,6 +203,27 @@ vec3 specularContribution(vec3 L, vec3 V, vec3 N, vec3 F0, float metallic, float
 	return color;
 }
 
+// Fades out between inner and outer radius, so nothing is lost outside of the light clusters
+vec3 pointLightContribution(vec3 V, vec3 N, vec3 F0, float metallic, float roughness, Light light, vec3 albedo)
+{
+	vec3 toLight = vec3(light.position) - Output.WorldPos;
+	float distance = length(toLight);
+	float attenuation = 1.0 - smoothstep(light.radiusInner, light.radiusOuter, distance);
+	if (attenuation <= 0.0)
+	{
+		return vec3(0.0);
+	}
+	return specularContribution(toLight / distance, V, N, F0, metallic, roughness, light, albedo) * attenuation;
+}
+
+Cluster getCluster()
+{
+	float depth = max(dot(u_ViewDepthRow, vec4(Output.WorldPos, 1.0)), 1e-4);
+	uint slice = uint(clamp(floor(log(depth) * u_SliceScale + u_SliceBias), 0.0, float(u_ClusterGrid.z - 1u)));
+	uvec2 tile = min(uvec2(gl_FragCoord.xy / u_TileSize), u_ClusterGrid.xy - 1u);
+	return u_Clusters[tile.x + u_ClusterGrid.x * (tile.y + u_ClusterGrid.y * slice)];
+}
+
 vec3 calculateNormal()
 {
 	if (texture(u_Normal, Output.UV).xyz == vec3(1))
@@ -195,20 +241,29 @@ void main()
 	vec3 V = normalize(vec3(Output.CameraPosition) - Output.WorldPos);
 	vec3 R = reflect(-V, N); 
 
-	vec3 albedo = pow(texture(u_Albedo, Output.UV).rgb, vec3(2.2)) * vec3(u_AlbedoV);
-	float metallic = u_MetallicV;
-	float roughness = u_RoughnessV;
+	vec3 albedo = pow(texture(u_Albedo, Output.UV).rgb, vec3(2.2)) * vec3(u_AlbedoV) * Output.Tint.rgb;
+	vec3 orm = texture(u_ORM, Output.UV).rgb;
+	float ao = orm.r;
+	float roughness = orm.g * u_RoughnessV;
+	float metallic = orm.b * u_MetallicV;
 
 	vec3 F0 = vec3(0.04); 
 	F0 = mix(F0, albedo, metallic);
 
 	vec3 Lo = vec3(0.0);
-	for(int i = 0; i < u_LightsAmount; i++) {
-		Light light = u_Light[i];
+	for (uint i = 0u; i < u_ClusterGrid.w; i++)
+	{
+		Light light = u_Lights[i];
 		vec3 L = normalize(vec3(light.position) - Output.WorldPos);
-		vec4 fragPosLightSpace = light.lightSpace * vec4(Output.WorldPos, 1.0f);
 		Lo += specularContribution(L, V, N, F0, metallic, roughness, light, albedo);
-	}   
+	}
+
+	Cluster cluster = getCluster();
+	for (uint i = 0u; i < cluster.Count; i++)
+	{
+		Light light = u_Lights[u_LightIndices[cluster.Offset + i]];
+		Lo += pointLightContribution(V, N, F0, metallic, roughness, light, albedo);
+	}
 	
 	vec2 brdf = texture(u_BRDFLUT, vec2(max(dot(N, V), 0.0), roughness)).rg;
 	vec3 reflection = prefilteredReflection(R, roughness).rgb;	
@@ -225,7 +280,7 @@ void main()
 	// Ambient part
 	vec3 kD = 1.0 - F;
 	kD *= 1.0 - metallic;	  
-	vec3 ambient = (kD * diffuse + specular) * texture(u_AO, Output.UV).rrr;
+	vec3 ambient = (kD * diffuse + specular) * ao;
 	
 	vec3 color = ambient + Lo;
 
@@ -4,10 +4,19 @@ layout(location = 1) in vec3 aNormal;
 layout(location = 2) in vec2 aUv;
 layout(location = 3) in vec3 aTangent;
 layout(location = 4) in vec3 aBiTangent;
+layout(location = 5) in uvec4 aJoints;
+layout(location = 6) in vec4 aWeights;
 
-layout(binding = 0) uniform UBTransformData
+struct InstanceData
 {
-    mat4 u_Transform;
+    mat4 Transform;
+    vec4 Tint;
+};
+
+// Instanced draws start gl_InstanceIndex from their first instance
+layout(std430, binding = 0) readonly buffer InstanceBuffer
+{
+    InstanceData u_Instances[];
 };
 
 layout(binding = 1) uniform UBCameraData
@@ -16,6 +25,15 @@ layout(binding = 1) uniform UBCameraData
     vec4 u_CameraPosition;
 };
 
+// Set by the skinned pipelines, static meshes skip skinning and the palette entirely
+layout(constant_id = 0) const bool C_SKINNED = false;
+
+// 3 rows of the affine skinning matrix per joint, skinned meshes without animation use the identity palette
+layout(binding = 14) uniform UBSkinningData
+{
+    vec4 u_JointRows[256 * 3];
+};
+
 struct VertexOutput
 {
     vec2 UV;
@@ -23,22 +41,56 @@ struct VertexOutput
     vec3 WorldPos;
     mat3 TBN;
     vec4 CameraPosition;
+    vec4 Tint;
 };
 
 layout(location = 0) out VertexOutput Output;
 
+mat3x4 GetSkinningRows()
+{
+    mat3x4 rows = mat3x4(0.0);
+    for (int i = 0; i < 4; i++)
+    {
+        uint joint = aJoints[i] * 3u;
+        rows[0] += u_JointRows[joint] * aWeights[i];
+        rows[1] += u_JointRows[joint + 1] * aWeights[i];
+        rows[2] += u_JointRows[joint + 2] * aWeights[i];
+    }
+    return rows;
+}
+
+vec3 Skin(mat3x4 rows, vec4 v)
+{
+    return vec3(dot(rows[0], v), dot(rows[1], v), dot(rows[2], v));
+}
+
 void main()
 {
+    vec3 position = aPosition;
+    vec3 normal = aNormal;
+    vec3 tangent = aTangent;
+    vec3 bitangent = aBiTangent;
+    if (C_SKINNED)
+    {
+        mat3x4 skinning = GetSkinningRows();
+        position = Skin(skinning, vec4(aPosition, 1.0));
+        normal = Skin(skinning, vec4(aNormal, 0.0));
+        tangent = Skin(skinning, vec4(aTangent, 0.0));
+        bitangent = Skin(skinning, vec4(aBiTangent, 0.0));
+    }
+
+    mat4 transform = u_Instances[gl_InstanceIndex].Transform;
     Output.UV = aUv;
-    Output.Normal = mat3(u_Transform) * aNormal;
-    Output.WorldPos = vec3(u_Transform * vec4(aPosition, 1.0));
+    Output.Normal = mat3(transform) * normal;
+    Output.WorldPos = vec3(transform * vec4(position, 1.0));
 
-    vec3 T = normalize(vec3(u_Transform * vec4(aTangent,   0.0)));
-    vec3 B = normalize(vec3(u_Transform * vec4(aBiTangent, 0.0)));
-    vec3 N = normalize(vec3(u_Transform * vec4(aNormal,    0.0)));
+    vec3 T = normalize(vec3(transform * vec4(tangent,   0.0)));
+    vec3 B = normalize(vec3(transform * vec4(bitangent, 0.0)));
+    vec3 N = normalize(vec3(transform * vec4(normal,    0.0)));
     mat3 TBN = mat3(T, B, N);
     Output.TBN = TBN;
     Output.CameraPosition = u_CameraPosition;
+    Output.Tint = u_Instances[gl_InstanceIndex].Tint;
 
     gl_Position = u_ViewProjection * vec4(Output.WorldPos, 1.0);
 }
\ No newline at end of file
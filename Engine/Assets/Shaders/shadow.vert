@@ -4,10 +4,28 @@ layout(location = 1) in vec3 aNormal;
 layout(location = 2) in vec2 aUv;
 layout(location = 3) in vec3 aTangent;
 layout(location = 4) in vec3 aBiTangent;
+layout(location = 5) in uvec4 aJoints;
+layout(location = 6) in vec4 aWeights;
 
-layout(binding = 0) uniform UBTransformData
+struct InstanceData
 {
-    mat4 u_Transform;
+    mat4 Transform;
+    vec4 Tint;
+};
+
+// Instanced draws start gl_InstanceIndex from their first instance
+layout(std430, binding = 0) readonly buffer InstanceBuffer
+{
+    InstanceData u_Instances[];
+};
+
+// Set by the skinned pipelines, static meshes skip skinning and the palette entirely
+layout(constant_id = 0) const bool C_SKINNED = false;
+
+// 3 rows of the affine skinning matrix per joint, skinned meshes without animation use the identity palette
+layout(binding = 14) uniform UBSkinningData
+{
+    vec4 u_JointRows[256 * 3];
 };
 
 layout(push_constant) uniform ConstantBuffer
@@ -16,7 +34,31 @@ layout(push_constant) uniform ConstantBuffer
     mat4 dummy1;
 };
 
+mat3x4 GetSkinningRows()
+{
+    mat3x4 rows = mat3x4(0.0);
+    for (int i = 0; i < 4; i++)
+    {
+        uint joint = aJoints[i] * 3u;
+        rows[0] += u_JointRows[joint] * aWeights[i];
+        rows[1] += u_JointRows[joint + 1] * aWeights[i];
+        rows[2] += u_JointRows[joint + 2] * aWeights[i];
+    }
+    return rows;
+}
+
+vec3 Skin(mat3x4 rows, vec4 v)
+{
+    return vec3(dot(rows[0], v), dot(rows[1], v), dot(rows[2], v));
+}
+
 void main()
 {
-    gl_Position = u_LightSpaceMatrix * u_Transform * vec4(aPosition, 1.0);
+    vec3 position = aPosition;
+    if (C_SKINNED)
+    {
+        position = Skin(GetSkinningRows(), vec4(aPosition, 1.0));
+    }
+    mat4 transform = u_Instances[gl_InstanceIndex].Transform;
+    gl_Position = u_LightSpaceMatrix * transform * vec4(position, 1.0);
 }  
\ No newline at end of file
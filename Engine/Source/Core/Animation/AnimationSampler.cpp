@@ -0,0 +1,222 @@
+#include "AnimationSampler.hpp"
+#include "Simd.hpp"
+#include "Assert.hpp"
+#include <glm/gtc/quaternion.hpp>
+#include <algorithm>
+
+using namespace RightEngine;
+
+namespace
+{
+    constexpr float C_INT16_MAX = 32767.0f;
+    constexpr float C_UINT16_MAX = 65535.0f;
+
+    int16_t QuantizeSnorm(float value)
+    {
+        return static_cast<int16_t>(std::lround(std::clamp(value, -1.0f, 1.0f) * C_INT16_MAX));
+    }
+
+    uint16_t QuantizeUnorm(float value, float min, float extent)
+    {
+        if (extent <= 0.0f)
+        {
+            return 0;
+        }
+        return static_cast<uint16_t>(std::lround(std::clamp((value - min) / extent, 0.0f, 1.0f) * C_UINT16_MAX));
+    }
+
+    glm::mat4 Compose(const JointPose& pose)
+    {
+        const float x = pose.rotation.x;
+        const float y = pose.rotation.y;
+        const float z = pose.rotation.z;
+        const float w = pose.rotation.w;
+
+        glm::mat4 transform;
+        transform[0] = glm::vec4(1.0f - 2.0f * (y * y + z * z), 2.0f * (x * y + w * z), 2.0f * (x * z - w * y), 0.0f) * pose.scale.x;
+        transform[1] = glm::vec4(2.0f * (x * y - w * z), 1.0f - 2.0f * (x * x + z * z), 2.0f * (y * z + w * x), 0.0f) * pose.scale.y;
+        transform[2] = glm::vec4(2.0f * (x * z + w * y), 2.0f * (y * z - w * x), 1.0f - 2.0f * (x * x + y * y), 0.0f) * pose.scale.z;
+        transform[3] = glm::vec4(glm::vec3(pose.translation), 1.0f);
+        return transform;
+    }
+}
+
+AnimationClip AnimationSampler::Compress(const std::string& name,
+                                         float duration,
+                                         uint32_t jointCount,
+                                         const std::vector<JointPose>& frames)
+{
+    R_CORE_ASSERT(jointCount > 0 && !frames.empty() && frames.size() % jointCount == 0, "");
+
+    AnimationClip clip;
+    clip.name = name;
+    clip.duration = duration;
+    clip.jointCount = jointCount;
+    clip.frameCount = static_cast<uint32_t>(frames.size() / jointCount);
+    clip.ranges.resize(jointCount);
+    clip.keys.resize(frames.size());
+
+    for (uint32_t joint = 0; joint < jointCount; joint++)
+    {
+        glm::vec3 translationMin(frames[joint].translation);
+        glm::vec3 translationMax(translationMin);
+        glm::vec3 scaleMin(frames[joint].scale);
+        glm::vec3 scaleMax(scaleMin);
+        for (uint32_t frame = 1; frame < clip.frameCount; frame++)
+        {
+            const auto& pose = frames[frame * jointCount + joint];
+            translationMin = glm::min(translationMin, glm::vec3(pose.translation));
+            translationMax = glm::max(translationMax, glm::vec3(pose.translation));
+            scaleMin = glm::min(scaleMin, glm::vec3(pose.scale));
+            scaleMax = glm::max(scaleMax, glm::vec3(pose.scale));
+        }
+
+        auto& range = clip.ranges[joint];
+        range.translationMin = glm::vec4(translationMin, 0.0f);
+        range.translationExtent = glm::vec4(translationMax - translationMin, 0.0f);
+        range.scaleMin = glm::vec4(scaleMin, 0.0f);
+        range.scaleExtent = glm::vec4(scaleMax - scaleMin, 0.0f);
+    }
+
+    for (uint32_t joint = 0; joint < jointCount; joint++)
+    {
+        const auto& range = clip.ranges[joint];
+        glm::vec4 previousRotation = frames[joint].rotation;
+        for (uint32_t frame = 0; frame < clip.frameCount; frame++)
+        {
+            const auto& pose = frames[frame * jointCount + joint];
+            auto& key = clip.keys[frame * jointCount + joint];
+
+            // Neighbour keys are kept in the same hemisphere, so sampling can interpolate them without a sign check
+            glm::vec4 rotation = glm::normalize(pose.rotation);
+            if (glm::dot(rotation, previousRotation) < 0.0f)
+            {
+                rotation = -rotation;
+            }
+            previousRotation = rotation;
+
+            for (int c = 0; c < 4; c++)
+            {
+                key.rotation[c] = QuantizeSnorm(rotation[c]);
+            }
+            for (int c = 0; c < 3; c++)
+            {
+                key.translation[c] = QuantizeUnorm(pose.translation[c], range.translationMin[c], range.translationExtent[c]);
+                key.scale[c] = QuantizeUnorm(pose.scale[c], range.scaleMin[c], range.scaleExtent[c]);
+            }
+            key.translation[3] = 0;
+            key.scale[3] = 0;
+        }
+    }
+
+    return clip;
+}
+
+void AnimationSampler::Sample(const AnimationClip& clip, float time, JointPose* pose)
+{
+    R_CORE_ASSERT(clip.frameCount > 0, "");
+
+    const float frame = std::clamp(time, 0.0f, clip.duration) * C_ANIMATION_SAMPLE_RATE;
+    const uint32_t frame0 = std::min(static_cast<uint32_t>(frame), clip.frameCount - 1);
+    const uint32_t frame1 = std::min(frame0 + 1, clip.frameCount - 1);
+    const simd::Float4 alpha = simd::Splat(std::clamp(frame - static_cast<float>(frame0), 0.0f, 1.0f));
+    const simd::Float4 unormScale = simd::Splat(1.0f / C_UINT16_MAX);
+
+    const QuantizedJointKey* keys0 = clip.keys.data() + static_cast<size_t>(frame0) * clip.jointCount;
+    const QuantizedJointKey* keys1 = clip.keys.data() + static_cast<size_t>(frame1) * clip.jointCount;
+    for (uint32_t joint = 0; joint < clip.jointCount; joint++)
+    {
+        const auto& key0 = keys0[joint];
+        const auto& key1 = keys1[joint];
+        const auto& range = clip.ranges[joint];
+
+        // Normalization also removes the snorm scale
+        const simd::Float4 rotation = simd::Normalize4(simd::Lerp(simd::LoadInt16x4(key0.rotation),
+                                                                  simd::LoadInt16x4(key1.rotation),
+                                                                  alpha));
+        const simd::Float4 translation = simd::Mul(simd::Lerp(simd::LoadUint16x4(key0.translation),
+                                                              simd::LoadUint16x4(key1.translation),
+                                                              alpha),
+                                                   unormScale);
+        const simd::Float4 scale = simd::Mul(simd::Lerp(simd::LoadUint16x4(key0.scale),
+                                                        simd::LoadUint16x4(key1.scale),
+                                                        alpha),
+                                             unormScale);
+
+        auto& jointPose = pose[joint];
+        simd::Store(&jointPose.rotation.x, rotation);
+        simd::Store(&jointPose.translation.x, simd::MulAdd(translation,
+                                                           simd::Load(&range.translationExtent.x),
+                                                           simd::Load(&range.translationMin.x)));
+        simd::Store(&jointPose.scale.x, simd::MulAdd(scale,
+                                                     simd::Load(&range.scaleExtent.x),
+                                                     simd::Load(&range.scaleMin.x)));
+    }
+}
+
+void AnimationSampler::Blend(const JointPose* from, const JointPose* to, float weight, uint32_t jointCount, JointPose* pose)
+{
+    const simd::Float4 alpha = simd::Splat(weight);
+    const simd::Float4 zero = simd::Splat(0.0f);
+    for (uint32_t joint = 0; joint < jointCount; joint++)
+    {
+        const simd::Float4 rotationFrom = simd::Load(&from[joint].rotation.x);
+        simd::Float4 rotationTo = simd::Load(&to[joint].rotation.x);
+        if (simd::GetX(simd::Dot4(rotationFrom, rotationTo)) < 0.0f)
+        {
+            rotationTo = simd::Sub(zero, rotationTo);
+        }
+
+        auto& jointPose = pose[joint];
+        simd::Store(&jointPose.rotation.x, simd::Normalize4(simd::Lerp(rotationFrom, rotationTo, alpha)));
+        simd::Store(&jointPose.translation.x, simd::Lerp(simd::Load(&from[joint].translation.x),
+                                                         simd::Load(&to[joint].translation.x),
+                                                         alpha));
+        simd::Store(&jointPose.scale.x, simd::Lerp(simd::Load(&from[joint].scale.x),
+                                                   simd::Load(&to[joint].scale.x),
+                                                   alpha));
+    }
+}
+
+void AnimationSampler::BuildPalette(const Skeleton& skeleton, const JointPose* pose, glm::mat4* models, glm::vec4* palette)
+{
+    const size_t jointCount = skeleton.GetJointCount();
+    for (size_t joint = 0; joint < jointCount; joint++)
+    {
+        const glm::mat4 local = Compose(pose[joint]);
+        const int32_t parent = skeleton.parents[joint];
+        // Global inverse is folded into the roots, so it isn't multiplied for every joint
+        const glm::mat4& parentModel = parent < 0 ? skeleton.globalInverse : models[parent];
+        simd::MulMat4(&parentModel[0][0], &local[0][0], &models[joint][0][0]);
+
+        glm::mat4 skinning;
+        simd::MulMat4(&models[joint][0][0], &skeleton.inverseBindPoses[joint][0][0], &skinning[0][0]);
+        for (int row = 0; row < 3; row++)
+        {
+            palette[joint * 3 + row] = glm::vec4(skinning[0][row], skinning[1][row], skinning[2][row], skinning[3][row]);
+        }
+    }
+}
+
+JointPose AnimationSampler::Decompose(const glm::mat4& transform)
+{
+    JointPose pose;
+    glm::vec3 scale(glm::length(glm::vec3(transform[0])),
+                    glm::length(glm::vec3(transform[1])),
+                    glm::length(glm::vec3(transform[2])));
+    if (glm::determinant(glm::mat3(transform)) < 0.0f)
+    {
+        scale.x = -scale.x;
+    }
+
+    // Degenerate axes keep the rotation part finite
+    const glm::vec3 divisor = glm::mix(scale, glm::vec3(1.0f), glm::equal(scale, glm::vec3(0.0f)));
+    glm::mat3 rotation(glm::vec3(transform[0]) / divisor.x,
+                       glm::vec3(transform[1]) / divisor.y,
+                       glm::vec3(transform[2]) / divisor.z);
+    const glm::quat quaternion = glm::normalize(glm::quat_cast(rotation));
+    pose.rotation = glm::vec4(quaternion.x, quaternion.y, quaternion.z, quaternion.w);
+    pose.translation = glm::vec4(glm::vec3(transform[3]), 0.0f);
+    pose.scale = glm::vec4(scale, 0.0f);
+    return pose;
+}
@@ -0,0 +1,123 @@
+#include "AnimationSystem.hpp"
+#include "AnimationSampler.hpp"
+#include "AssetManager.hpp"
+#include "ThreadService.hpp"
+#include "Application.hpp"
+#include "MeshLoader.hpp"
+#include <algorithm>
+#include <cmath>
+
+using namespace RightEngine;
+
+namespace
+{
+    // Instance with a typical humanoid rig takes a few microseconds, smaller batches cost more to schedule than to run
+    constexpr size_t C_MIN_INSTANCES_PER_BATCH = 16;
+
+    struct AnimationJob
+    {
+        AnimatorComponent* animator;
+        std::shared_ptr<MeshNode> mesh;
+    };
+
+    struct AnimationScratch
+    {
+        std::vector<JointPose> pose;
+        std::vector<JointPose> previousPose;
+        std::vector<glm::mat4> models;
+    };
+
+    float AdvanceTime(float time, float deltaTime, float duration, bool loop)
+    {
+        time += deltaTime;
+        if (duration <= 0.0f)
+        {
+            return 0.0f;
+        }
+        if (loop)
+        {
+            time = std::fmod(time, duration);
+            return time < 0.0f ? time + duration : time;
+        }
+        return std::clamp(time, 0.0f, duration);
+    }
+
+    bool IsValidClip(const MeshNode& mesh, int32_t clip)
+    {
+        return clip >= 0 && clip < static_cast<int32_t>(mesh.animations.size());
+    }
+
+    void Animate(const AnimationJob& job, float deltaTime, AnimationScratch& scratch)
+    {
+        auto& animator = *job.animator;
+        const auto& mesh = *job.mesh;
+        const auto& skeleton = *mesh.skeleton;
+        const size_t jointCount = skeleton.GetJointCount();
+
+        scratch.pose.resize(jointCount);
+        scratch.models.resize(jointCount);
+        animator.palette.resize(jointCount * 3);
+
+        if (!IsValidClip(mesh, animator.clip))
+        {
+            std::copy(skeleton.bindPose.begin(), skeleton.bindPose.end(), scratch.pose.begin());
+            AnimationSampler::BuildPalette(skeleton, scratch.pose.data(), scratch.models.data(), animator.palette.data());
+            return;
+        }
+
+        const float step = animator.isPlaying ? deltaTime * animator.speed : 0.0f;
+        const auto& clip = mesh.animations[animator.clip];
+        animator.time = AdvanceTime(animator.time, step, clip.duration, animator.loop);
+        AnimationSampler::Sample(clip, animator.time, scratch.pose.data());
+
+        if (IsValidClip(mesh, animator.previousClip) && animator.fadeTime < animator.fadeDuration)
+        {
+            const auto& previousClip = mesh.animations[animator.previousClip];
+            animator.previousTime = AdvanceTime(animator.previousTime, step, previousClip.duration, animator.loop);
+            animator.fadeTime += deltaTime;
+
+            scratch.previousPose.resize(jointCount);
+            AnimationSampler::Sample(previousClip, animator.previousTime, scratch.previousPose.data());
+            const float weight = std::min(animator.fadeTime / animator.fadeDuration, 1.0f);
+            AnimationSampler::Blend(scratch.previousPose.data(),
+                                    scratch.pose.data(),
+                                    weight,
+                                    static_cast<uint32_t>(jointCount),
+                                    scratch.pose.data());
+        }
+        else
+        {
+            animator.previousClip = -1;
+        }
+
+        AnimationSampler::BuildPalette(skeleton, scratch.pose.data(), scratch.models.data(), animator.palette.data());
+    }
+}
+
+void AnimationSystem::Update(entt::registry& registry, float deltaTime)
+{
+    auto& am = AssetManager::Get();
+    std::vector<AnimationJob> jobs;
+    for (const auto entity : registry.view<AnimatorComponent, MeshComponent>())
+    {
+        auto& animator = registry.get<AnimatorComponent>(entity);
+        const auto& mc = registry.get<MeshComponent>(entity);
+        auto mesh = am.GetAsset<MeshNode>(mc.mesh);
+        if (!mesh || !mesh->skeleton)
+        {
+            animator.palette.clear();
+            continue;
+        }
+        jobs.push_back({ &animator, std::move(mesh) });
+    }
+
+    auto& ts = Instance().Service<ThreadService>();
+    ts.ParallelFor(jobs.size(), C_MIN_INSTANCES_PER_BATCH, [&jobs, deltaTime](size_t begin, size_t end)
+    {
+        thread_local AnimationScratch scratch;
+        for (size_t i = begin; i < end; i++)
+        {
+            Animate(jobs[i], deltaTime, scratch);
+        }
+    });
+}
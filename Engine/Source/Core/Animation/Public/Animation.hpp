@@ -0,0 +1,67 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace RightEngine
+{
+    // Vertex joint indices are stored as bytes and palettes have fixed size on GPU
+    constexpr uint32_t C_MAX_JOINTS = 256;
+    // Clips are resampled to uniform frames at import, so sampling never searches for keys
+    constexpr float C_ANIMATION_SAMPLE_RATE = 30.0f;
+
+    // Local joint transform, rotation is a quaternion stored as xyzw. W of translation and scale is unused
+    struct alignas(16) JointPose
+    {
+        glm::vec4 rotation{ 0.0f, 0.0f, 0.0f, 1.0f };
+        glm::vec4 translation{ 0.0f };
+        glm::vec4 scale{ 1.0f };
+    };
+
+    struct Skeleton
+    {
+        std::vector<std::string> jointNames;
+        // Parent always precedes its children, root has -1
+        std::vector<int32_t> parents;
+        std::vector<glm::mat4> inverseBindPoses;
+        std::vector<JointPose> bindPose;
+        // Brings model space joints back to the space of the mesh vertices
+        glm::mat4 globalInverse{ 1.0f };
+
+        size_t GetJointCount() const
+        { return parents.size(); }
+    };
+
+    /*
+     * 24 bytes per joint per frame. Rotation is snorm, translation and scale are unorm
+     * in the per joint range of the clip, w components are padding for 8 byte SIMD loads
+     */
+    struct QuantizedJointKey
+    {
+        int16_t rotation[4];
+        uint16_t translation[4];
+        uint16_t scale[4];
+    };
+
+    struct JointKeyRange
+    {
+        glm::vec4 translationMin{ 0.0f };
+        glm::vec4 translationExtent{ 0.0f };
+        glm::vec4 scaleMin{ 1.0f };
+        glm::vec4 scaleExtent{ 0.0f };
+    };
+
+    struct AnimationClip
+    {
+        std::string name;
+        // In seconds
+        float duration{ 0.0f };
+        uint32_t frameCount{ 0 };
+        uint32_t jointCount{ 0 };
+        std::vector<JointKeyRange> ranges;
+        // Frame major, all joints of a frame are adjacent in memory
+        std::vector<QuantizedJointKey> keys;
+    };
+}
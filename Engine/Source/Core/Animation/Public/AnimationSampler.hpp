@@ -0,0 +1,32 @@
+#pragma once
+
+#include "Animation.hpp"
+
+namespace RightEngine
+{
+    /*
+     * Hot animation math, all poses are arrays of skeleton joint count elements.
+     * Functions don't allocate, so they can be called from any amount of worker threads
+     */
+    class AnimationSampler
+    {
+    public:
+        // Frames are frame major uniformly sampled local poses with C_ANIMATION_SAMPLE_RATE
+        static AnimationClip Compress(const std::string& name,
+                                      float duration,
+                                      uint32_t jointCount,
+                                      const std::vector<JointPose>& frames);
+
+        // Time is clamped to the clip duration
+        static void Sample(const AnimationClip& clip, float time, JointPose* pose);
+
+        static void Blend(const JointPose* from, const JointPose* to, float weight, uint32_t jointCount, JointPose* pose);
+
+        /*
+         * Writes 3 rows of the affine skinning matrix per joint, models is a scratch array of joint count matrices
+         */
+        static void BuildPalette(const Skeleton& skeleton, const JointPose* pose, glm::mat4* models, glm::vec4* palette);
+
+        static JointPose Decompose(const glm::mat4& transform);
+    };
+}
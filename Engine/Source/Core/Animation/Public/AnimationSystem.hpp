@@ -0,0 +1,16 @@
+#pragma once
+
+#include <entt.hpp>
+
+namespace RightEngine
+{
+    /*
+     * Advances AnimatorComponents and writes their skinning palettes. Instances are independent,
+     * so they are sampled in parallel on ThreadService
+     */
+    class AnimationSystem
+    {
+    public:
+        static void Update(entt::registry& registry, float deltaTime);
+    };
+}
@@ -0,0 +1,323 @@
+#include "AssetCooker.hpp"
+#include "CookedCache.hpp"
+#include "CookedFormat.hpp"
+#include "TextureLoader.hpp"
+#include "MeshLoader.hpp"
+#include "ShaderCompiler.hpp"
+#include "SceneSerializer.hpp"
+#include "Application.hpp"
+#include "ThreadService.hpp"
+#include "Path.hpp"
+#include "Timer.hpp"
+#include "Logger.hpp"
+#include <taskflow/taskflow.hpp>
+#include <filesystem>
+#include <algorithm>
+#include <cctype>
+
+using namespace RightEngine;
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    std::string ToLower(std::string str)
+    {
+        std::transform(str.begin(), str.end(), str.begin(), [](unsigned char c) { return std::tolower(c); });
+        return str;
+    }
+
+    ShaderType GetShaderType(const std::string& path)
+    {
+        return ToLower(fs::path(path).extension().string()) == ".vert" ? ShaderType::VERTEX : ShaderType::FRAGMENT;
+    }
+
+    std::string HashSource(const std::string& path)
+    {
+        return path.empty() ? std::string() : CookedCache::HashFile(Path::Absolute(path));
+    }
+
+    template<typename F>
+    void CookInParallel(size_t count, std::vector<AssetCookResult>& results, F&& cookFn)
+    {
+        const size_t offset = results.size();
+        results.resize(offset + count);
+
+        tf::Taskflow taskflow;
+        taskflow.for_each_index(static_cast<size_t>(0), count, static_cast<size_t>(1), [&](size_t i)
+        {
+            results[offset + i] = cookFn(i);
+        });
+        Instance().Service<ThreadService>().AddBackgroundTaskflow(std::move(taskflow)).wait();
+    }
+}
+
+AssetCooker::AssetCooker(const AssetCookerSettings& settings) : m_settings(settings)
+{
+}
+
+std::vector<AssetCookResult> AssetCooker::Cook()
+{
+    m_index.Load(Path::Absolute(C_ASSET_INDEX_PATH));
+
+    std::vector<AssetCookResult> results;
+    const auto sources = GatherSources();
+    CookInParallel(sources.size(), results, [&](size_t i)
+    {
+        return CookAsset(sources[i].first, sources[i].second);
+    });
+
+    // ORM packing reads already cooked sources through CookedCache, so the index must be on disk first
+    m_index.Save(Path::Absolute(C_ASSET_INDEX_PATH));
+
+    const auto ormSources = GatherOrmSources();
+    CookInParallel(ormSources.size(), results, [&](size_t i)
+    {
+        return CookOrm(ormSources[i]);
+    });
+
+    m_index.Save(Path::Absolute(C_ASSET_INDEX_PATH));
+    return results;
+}
+
+AssetType AssetCooker::GetSourceType(const std::string& path)
+{
+    const auto extension = ToLower(fs::path(path).extension().string());
+
+    if (extension == ".png" || extension == ".jpg" || extension == ".jpeg" || extension == ".tga" || extension == ".bmp")
+    {
+        return AssetType::IMAGE;
+    }
+    if (extension == ".hdr")
+    {
+        return AssetType::ENVIRONMENT_MAP;
+    }
+    if (extension == ".fbx" || extension == ".obj" || extension == ".gltf" || extension == ".glb" || extension == ".dae")
+    {
+        return AssetType::MESH;
+    }
+    if (extension == ".vert" || extension == ".frag")
+    {
+        return AssetType::SHADER;
+    }
+    return AssetType::NONE;
+}
+
+std::vector<std::pair<std::string, AssetType>> AssetCooker::GatherSources()
+{
+    std::vector<std::pair<std::string, AssetType>> sources;
+    m_scenes.clear();
+    const fs::path cookedDir = Path::Absolute(C_COOKED_DIR);
+
+    for (const auto& root : m_settings.roots)
+    {
+        const fs::path rootDir = Path::Absolute(root);
+        if (!fs::is_directory(rootDir))
+        {
+            R_CORE_WARN("Cook root {0} doesn't exist", root);
+            continue;
+        }
+
+        for (auto it = fs::recursive_directory_iterator(rootDir); it != fs::recursive_directory_iterator(); ++it)
+        {
+            if (it->is_directory())
+            {
+                std::error_code ec;
+                if (fs::equivalent(it->path(), cookedDir, ec))
+                {
+                    it.disable_recursion_pending();
+                }
+                continue;
+            }
+
+            if (ToLower(it->path().extension().string()) == ".scene")
+            {
+                m_scenes.push_back(it->path());
+                continue;
+            }
+
+            const auto type = GetSourceType(it->path().string());
+            if (type == AssetType::NONE)
+            {
+                continue;
+            }
+
+            auto enginePath = root;
+            if (enginePath.back() != '/')
+            {
+                enginePath += '/';
+            }
+            enginePath += fs::relative(it->path(), rootDir).generic_string();
+            sources.emplace_back(enginePath, type);
+        }
+    }
+
+    return sources;
+}
+
+AssetCookResult AssetCooker::CookAsset(const std::string& path, AssetType type)
+{
+    Timer timer;
+    AssetCookResult result;
+    result.path = path;
+    result.type = type;
+
+    const auto sourcePath = Path::Absolute(path);
+    const auto sourceHash = CookedCache::HashFile(sourcePath);
+    const auto writeTime = CookedCache::WriteTime(sourcePath);
+    auto entry = m_index.Find(path);
+
+    if (!m_settings.force
+        && entry
+        && entry->sourceHash == sourceHash
+        && fs::exists(Path::Absolute(entry->cookedPath)))
+    {
+        if (entry->sourceWriteTime != writeTime)
+        {
+            // Fresh checkout of a shipped cache, refresh timestamp so runtime can skip hashing
+            entry->sourceWriteTime = writeTime;
+            m_index.Set(path, *entry);
+        }
+        result.status = AssetCookStatus::SKIPPED;
+        result.time = timer.TimeInMilliseconds();
+        return result;
+    }
+
+    const auto cookedPath = CookedCache::CookedPath(path, type);
+    bool cooked = false;
+    switch (type)
+    {
+        case AssetType::IMAGE:
+        case AssetType::ENVIRONMENT_MAP:
+            cooked = CookTexture(path, cookedPath);
+            break;
+        case AssetType::MESH:
+            cooked = CookMesh(path, cookedPath);
+            break;
+        case AssetType::SHADER:
+            cooked = CookShader(path, cookedPath);
+            break;
+        default:
+            R_CORE_ASSERT(false, "");
+    }
+
+    result.time = timer.TimeInMilliseconds();
+    if (!cooked)
+    {
+        R_CORE_ERROR("Failed to cook {0}", path);
+        result.status = AssetCookStatus::FAILED;
+        return result;
+    }
+
+    AssetIndexEntry newEntry;
+    newEntry.type = type;
+    newEntry.sourceHash = sourceHash;
+    newEntry.sourceSize = fs::file_size(sourcePath);
+    newEntry.sourceWriteTime = writeTime;
+    newEntry.cookedPath = cookedPath;
+    newEntry.cookTime = result.time;
+    m_index.Set(path, newEntry);
+
+    result.status = AssetCookStatus::COOKED;
+    return result;
+}
+
+std::vector<OrmSources> AssetCooker::GatherOrmSources() const
+{
+    std::vector<OrmSources> ormSources;
+    for (const auto& scene : m_scenes)
+    {
+        for (const auto& sources : SceneSerializer::GetOrmSources(scene))
+        {
+            if (std::find(ormSources.begin(), ormSources.end(), sources) == ormSources.end())
+            {
+                ormSources.push_back(sources);
+            }
+        }
+    }
+    return ormSources;
+}
+
+AssetCookResult AssetCooker::CookOrm(const OrmSources& sources)
+{
+    Timer timer;
+    AssetCookResult result;
+    result.path = sources.GetKey();
+    result.type = AssetType::IMAGE;
+
+    const auto sourceHash = CookedCache::CombineHashes({ HashSource(sources.occlusion),
+                                                         HashSource(sources.roughness),
+                                                         HashSource(sources.metallic) });
+    const auto entry = m_index.Find(result.path);
+    if (!m_settings.force
+        && entry
+        && entry->sourceHash == sourceHash
+        && fs::exists(Path::Absolute(entry->cookedPath)))
+    {
+        result.status = AssetCookStatus::SKIPPED;
+        result.time = timer.TimeInMilliseconds();
+        return result;
+    }
+
+    const TextureLoader loader;
+    const auto [data, descriptor] = loader.PackOrm(sources);
+    const auto cookedPath = CookedCache::CookedOrmPath(sources);
+    const bool cooked = CookedFormat::WriteTexture(Path::Absolute(cookedPath), descriptor, data);
+
+    result.time = timer.TimeInMilliseconds();
+    if (!cooked)
+    {
+        R_CORE_ERROR("Failed to cook {0}", result.path);
+        result.status = AssetCookStatus::FAILED;
+        return result;
+    }
+
+    // Packed texture has no single source file, freshness is checked only by the combined hash
+    AssetIndexEntry newEntry;
+    newEntry.type = AssetType::IMAGE;
+    newEntry.sourceHash = sourceHash;
+    newEntry.cookedPath = cookedPath;
+    newEntry.cookTime = result.time;
+    m_index.Set(result.path, newEntry);
+
+    result.status = AssetCookStatus::COOKED;
+    return result;
+}
+
+// Textures are cooked with default loader options, so runtime can only use them for default loads.
+// Environment maps are cooked as decoded equirectangular data, IBL convolution still requires GPU and stays at runtime
+bool AssetCooker::CookTexture(const std::string& path, const std::string& cookedPath) const
+{
+    const TextureLoader loader;
+    auto [data, descriptor] = loader.LoadTextureData(path);
+    if (data.empty())
+    {
+        return false;
+    }
+    return CookedFormat::WriteTexture(Path::Absolute(cookedPath), descriptor, data);
+}
+
+bool AssetCooker::CookMesh(const std::string& path, const std::string& cookedPath) const
+{
+    MeshNodeData meshNode;
+    if (!MeshLoader::Import(path, meshNode))
+    {
+        return false;
+    }
+    return CookedFormat::WriteMesh(Path::Absolute(cookedPath), meshNode);
+}
+
+bool AssetCooker::CookShader(const std::string& path, const std::string& cookedPath) const
+{
+    const auto source = ShaderCompiler::ReadSource(path);
+    if (source.empty())
+    {
+        return false;
+    }
+    const auto spirv = ShaderCompiler::Compile(GetShaderType(path), source, path);
+    if (spirv.empty())
+    {
+        return false;
+    }
+    return CookedFormat::WriteShader(Path::Absolute(cookedPath), spirv);
+}
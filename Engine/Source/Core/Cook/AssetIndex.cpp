@@ -0,0 +1,111 @@
+#include "AssetIndex.hpp"
+#include "CookedFormat.hpp"
+#include "Logger.hpp"
+#include <yaml-cpp/yaml.h>
+#include <filesystem>
+#include <fstream>
+#include <map>
+
+using namespace RightEngine;
+
+bool AssetIndex::Load(const std::string& path)
+{
+    std::lock_guard lock(m_mutex);
+    m_entries.clear();
+
+    if (!std::filesystem::exists(path))
+    {
+        return false;
+    }
+
+    YAML::Node data;
+    try
+    {
+        data = YAML::LoadFile(path);
+    }
+    catch (YAML::ParserException e)
+    {
+        R_CORE_ERROR("Failed to load asset index '{0}'\n     {1}", path, e.what());
+        return false;
+    }
+
+    if (!data["Version"] || data["Version"].as<uint32_t>() != C_COOKED_FORMAT_VERSION)
+    {
+        R_CORE_WARN("Asset index '{0}' was cooked with other format version, ignoring it", path);
+        return false;
+    }
+
+    for (const auto& asset : data["Assets"])
+    {
+        AssetIndexEntry entry;
+        entry.type = static_cast<AssetType>(asset["Type"].as<uint32_t>());
+        entry.sourceHash = asset["Hash"].as<std::string>();
+        entry.sourceSize = asset["Size"].as<uint64_t>();
+        entry.sourceWriteTime = asset["Write time"].as<int64_t>();
+        entry.cookedPath = asset["Cooked"].as<std::string>();
+        entry.cookTime = asset["Cook time"].as<double>();
+        m_entries[asset["Path"].as<std::string>()] = entry;
+    }
+
+    return true;
+}
+
+bool AssetIndex::Save(const std::string& path) const
+{
+    std::lock_guard lock(m_mutex);
+
+    // Sorted output keeps the index diffable between cooks
+    const std::map<std::string, AssetIndexEntry> sortedEntries(m_entries.begin(), m_entries.end());
+
+    YAML::Emitter output;
+    output << YAML::BeginMap;
+    output << YAML::Key << "Version" << YAML::Value << C_COOKED_FORMAT_VERSION;
+    output << YAML::Key << "Assets" << YAML::Value << YAML::BeginSeq;
+    for (const auto& [assetPath, entry] : sortedEntries)
+    {
+        output << YAML::BeginMap;
+        output << YAML::Key << "Path" << YAML::Value << assetPath;
+        output << YAML::Key << "Type" << YAML::Value << static_cast<uint32_t>(entry.type);
+        output << YAML::Key << "Hash" << YAML::Value << entry.sourceHash;
+        output << YAML::Key << "Size" << YAML::Value << entry.sourceSize;
+        output << YAML::Key << "Write time" << YAML::Value << entry.sourceWriteTime;
+        output << YAML::Key << "Cooked" << YAML::Value << entry.cookedPath;
+        output << YAML::Key << "Cook time" << YAML::Value << entry.cookTime;
+        output << YAML::EndMap;
+    }
+    output << YAML::EndSeq;
+    output << YAML::EndMap;
+
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path());
+    std::ofstream fout(path);
+    if (!fout.is_open())
+    {
+        R_CORE_ERROR("Can't write asset index to {0}", path);
+        return false;
+    }
+    fout << output.c_str();
+    return true;
+}
+
+std::optional<AssetIndexEntry> AssetIndex::Find(const std::string& assetPath) const
+{
+    std::lock_guard lock(m_mutex);
+    const auto entryIt = m_entries.find(assetPath);
+    if (entryIt == m_entries.end())
+    {
+        return std::nullopt;
+    }
+    return entryIt->second;
+}
+
+void AssetIndex::Set(const std::string& assetPath, const AssetIndexEntry& entry)
+{
+    std::lock_guard lock(m_mutex);
+    m_entries[assetPath] = entry;
+}
+
+size_t AssetIndex::Size() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_entries.size();
+}
@@ -0,0 +1,173 @@
+#include "CookedCache.hpp"
+#include "CookedFormat.hpp"
+#include "Path.hpp"
+#include "Logger.hpp"
+#include <sha256.h>
+#include <filesystem>
+#include <fstream>
+
+using namespace RightEngine;
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    const char* CookedExtension(AssetType type)
+    {
+        switch (type)
+        {
+            case AssetType::IMAGE:
+            case AssetType::ENVIRONMENT_MAP:
+                return ".rtex";
+            case AssetType::MESH:
+                return ".rmsh";
+            case AssetType::SHADER:
+                return ".spv";
+            default:
+                R_CORE_ASSERT(false, "");
+                return "";
+        }
+    }
+}
+
+CookedCache& CookedCache::Get()
+{
+    static CookedCache instance;
+    return instance;
+}
+
+bool CookedCache::LoadTexture(const std::string& path, TextureDescriptor& descriptor, std::vector<uint8_t>& data)
+{
+    const auto entry = FindFresh(path);
+    return entry && CookedFormat::ReadTexture(Path::Absolute(entry->cookedPath), descriptor, data);
+}
+
+bool CookedCache::LoadMesh(const std::string& path, MeshNodeData& meshNode)
+{
+    const auto entry = FindFresh(path);
+    return entry && CookedFormat::ReadMesh(Path::Absolute(entry->cookedPath), meshNode);
+}
+
+bool CookedCache::LoadShader(const std::string& path, std::vector<uint32_t>& spirv)
+{
+    const auto entry = FindFresh(path);
+    return entry && CookedFormat::ReadShader(Path::Absolute(entry->cookedPath), spirv);
+}
+
+bool CookedCache::LoadOrm(const OrmSources& sources, TextureDescriptor& descriptor, std::vector<uint8_t>& data)
+{
+    LoadIndex();
+    const auto entry = m_index.Find(sources.GetKey());
+    if (!entry)
+    {
+        return false;
+    }
+
+    const auto hash = CombineHashes({ SourceHash(sources.occlusion),
+                                      SourceHash(sources.roughness),
+                                      SourceHash(sources.metallic) });
+    return hash == entry->sourceHash && CookedFormat::ReadTexture(Path::Absolute(entry->cookedPath), descriptor, data);
+}
+
+std::string CookedCache::CookedPath(const std::string& path, AssetType type)
+{
+    R_CORE_ASSERT(!path.empty() && path.front() == '/', "");
+    return C_COOKED_DIR + path + CookedExtension(type);
+}
+
+std::string CookedCache::CookedOrmPath(const OrmSources& sources)
+{
+    const auto key = sources.GetKey();
+    return std::string(C_COOKED_DIR) + "/ORM/" + SHA256()(key.data(), key.size()).substr(0, 16) + ".rtex";
+}
+
+std::string CookedCache::CombineHashes(const std::vector<std::string>& hashes)
+{
+    SHA256 sha256;
+    for (const auto& hash : hashes)
+    {
+        sha256.add(hash.data(), hash.size());
+        sha256.add("|", 1);
+    }
+    return sha256.getHash();
+}
+
+std::string CookedCache::HashFile(const std::string& absolutePath)
+{
+    std::ifstream file(absolutePath, std::ios::binary);
+    if (!file.is_open())
+    {
+        return {};
+    }
+
+    SHA256 sha256;
+    std::vector<char> chunk(1 << 16);
+    while (file)
+    {
+        file.read(chunk.data(), chunk.size());
+        sha256.add(chunk.data(), static_cast<size_t>(file.gcount()));
+    }
+    return sha256.getHash();
+}
+
+int64_t CookedCache::WriteTime(const std::string& absolutePath)
+{
+    std::error_code ec;
+    const auto time = fs::last_write_time(absolutePath, ec);
+    return ec ? 0 : static_cast<int64_t>(time.time_since_epoch().count());
+}
+
+void CookedCache::LoadIndex()
+{
+    std::call_once(m_loadIndexFlag, [this]()
+    {
+        if (m_index.Load(Path::Absolute(C_ASSET_INDEX_PATH)))
+        {
+            R_CORE_INFO("Loaded cooked asset index with {0} entries", m_index.Size());
+        }
+    });
+}
+
+std::optional<AssetIndexEntry> CookedCache::FindFresh(const std::string& path)
+{
+    LoadIndex();
+
+    auto entry = m_index.Find(path);
+    if (!entry)
+    {
+        return std::nullopt;
+    }
+
+    const auto sourcePath = Path::Absolute(path);
+    std::error_code ec;
+    const auto sourceSize = fs::file_size(sourcePath, ec);
+    if (ec || sourceSize != entry->sourceSize)
+    {
+        return std::nullopt;
+    }
+
+    // Write time check is enough for caches cooked on this machine,
+    // shipped caches have other timestamps, so contents hash is compared for them
+    const auto writeTime = WriteTime(sourcePath);
+    if (writeTime != entry->sourceWriteTime)
+    {
+        if (HashFile(sourcePath) != entry->sourceHash)
+        {
+            return std::nullopt;
+        }
+        entry->sourceWriteTime = writeTime;
+        m_index.Set(path, *entry);
+    }
+
+    return entry;
+}
+
+std::string CookedCache::SourceHash(const std::string& path)
+{
+    if (path.empty())
+    {
+        return {};
+    }
+    const auto entry = FindFresh(path);
+    return entry ? entry->sourceHash : HashFile(Path::Absolute(path));
+}
@@ -0,0 +1,327 @@
+#include "CookedFormat.hpp"
+#include "Logger.hpp"
+#include "Assert.hpp"
+#include <filesystem>
+#include <fstream>
+
+using namespace RightEngine;
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    constexpr uint32_t C_TEXTURE_MAGIC = 0x58455452; // RTEX
+    constexpr uint32_t C_MESH_MAGIC = 0x48534D52; // RMSH
+    constexpr uint32_t C_SHADER_MAGIC = 0x56505352; // RSPV
+
+    struct CookedHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+    };
+
+    struct CookedTextureHeader
+    {
+        int32_t width;
+        int32_t height;
+        int32_t componentAmount;
+        int32_t mipLevels;
+        uint32_t format;
+        uint64_t dataSize;
+    };
+
+    template<typename T>
+    void Write(std::ofstream& stream, const T& value)
+    {
+        stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template<typename T>
+    void WriteArray(std::ofstream& stream, const std::vector<T>& values)
+    {
+        Write(stream, static_cast<uint64_t>(values.size()));
+        stream.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+    }
+
+    template<typename T>
+    bool Read(std::ifstream& stream, T& value)
+    {
+        return static_cast<bool>(stream.read(reinterpret_cast<char*>(&value), sizeof(T)));
+    }
+
+    template<typename T>
+    bool ReadArray(std::ifstream& stream, std::vector<T>& values)
+    {
+        uint64_t size = 0;
+        if (!Read(stream, size))
+        {
+            return false;
+        }
+        values.resize(size);
+        return static_cast<bool>(stream.read(reinterpret_cast<char*>(values.data()), size * sizeof(T)));
+    }
+
+    void WriteString(std::ofstream& stream, const std::string& value)
+    {
+        Write(stream, static_cast<uint32_t>(value.size()));
+        stream.write(value.data(), value.size());
+    }
+
+    bool ReadString(std::ifstream& stream, std::string& value)
+    {
+        uint32_t size = 0;
+        if (!Read(stream, size))
+        {
+            return false;
+        }
+        value.resize(size);
+        return static_cast<bool>(stream.read(value.data(), size));
+    }
+
+    // Artifacts are written next to the destination and renamed afterwards,
+    // so an interrupted cook never leaves a truncated file under the final name
+    template<typename F>
+    bool WriteFile(const std::string& path, uint32_t magic, F&& writeFn)
+    {
+        const fs::path finalPath(path);
+        fs::create_directories(finalPath.parent_path());
+        const fs::path tmpPath = finalPath.string() + ".tmp";
+        {
+            std::ofstream stream(tmpPath, std::ios::binary | std::ios::trunc);
+            if (!stream.is_open())
+            {
+                R_CORE_ERROR("Can't open cooked file {0} for writing", tmpPath.generic_u8string());
+                return false;
+            }
+            Write(stream, CookedHeader{ magic, C_COOKED_FORMAT_VERSION });
+            writeFn(stream);
+            if (!stream)
+            {
+                R_CORE_ERROR("Failed to write cooked file {0}", tmpPath.generic_u8string());
+                return false;
+            }
+        }
+        std::error_code ec;
+        fs::rename(tmpPath, finalPath, ec);
+        return !ec;
+    }
+
+    bool OpenFile(const std::string& path, uint32_t magic, std::ifstream& stream)
+    {
+        stream.open(path, std::ios::binary);
+        if (!stream.is_open())
+        {
+            return false;
+        }
+        CookedHeader header{};
+        if (!Read(stream, header) || header.magic != magic)
+        {
+            R_CORE_WARN("File {0} is not a cooked asset of the expected type", path);
+            return false;
+        }
+        return header.version == C_COOKED_FORMAT_VERSION;
+    }
+
+    void WriteMeshNode(std::ofstream& stream, const MeshNodeData& node)
+    {
+        Write(stream, static_cast<uint32_t>(node.meshes.size()));
+        for (const auto& mesh : node.meshes)
+        {
+            WriteArray(stream, mesh.vertices);
+            WriteArray(stream, mesh.indexes);
+            Write(stream, mesh.bounds);
+            Write(stream, mesh.boundingSphere);
+            WriteArray(stream, mesh.occluder.positions);
+            WriteArray(stream, mesh.occluder.indices);
+        }
+        Write(stream, static_cast<uint32_t>(node.children.size()));
+        for (const auto& child : node.children)
+        {
+            WriteMeshNode(stream, child);
+        }
+        Write(stream, node.bounds);
+        Write(stream, node.boundingSphere);
+    }
+
+    void WriteSkinning(std::ofstream& stream, const MeshNodeData& node)
+    {
+        const auto& skeleton = node.skeleton;
+        Write(stream, static_cast<uint32_t>(skeleton.GetJointCount()));
+        for (const auto& name : skeleton.jointNames)
+        {
+            WriteString(stream, name);
+        }
+        WriteArray(stream, skeleton.parents);
+        WriteArray(stream, skeleton.inverseBindPoses);
+        WriteArray(stream, skeleton.bindPose);
+        Write(stream, skeleton.globalInverse);
+
+        Write(stream, static_cast<uint32_t>(node.animations.size()));
+        for (const auto& animation : node.animations)
+        {
+            WriteString(stream, animation.name);
+            Write(stream, animation.duration);
+            Write(stream, animation.frameCount);
+            Write(stream, animation.jointCount);
+            WriteArray(stream, animation.ranges);
+            WriteArray(stream, animation.keys);
+        }
+    }
+
+    bool ReadSkinning(std::ifstream& stream, MeshNodeData& node)
+    {
+        auto& skeleton = node.skeleton;
+        uint32_t jointCount = 0;
+        if (!Read(stream, jointCount))
+        {
+            return false;
+        }
+        skeleton.jointNames.resize(jointCount);
+        for (auto& name : skeleton.jointNames)
+        {
+            if (!ReadString(stream, name))
+            {
+                return false;
+            }
+        }
+        if (!ReadArray(stream, skeleton.parents)
+            || !ReadArray(stream, skeleton.inverseBindPoses)
+            || !ReadArray(stream, skeleton.bindPose)
+            || !Read(stream, skeleton.globalInverse))
+        {
+            return false;
+        }
+
+        uint32_t animationsAmount = 0;
+        if (!Read(stream, animationsAmount))
+        {
+            return false;
+        }
+        node.animations.resize(animationsAmount);
+        for (auto& animation : node.animations)
+        {
+            if (!ReadString(stream, animation.name)
+                || !Read(stream, animation.duration)
+                || !Read(stream, animation.frameCount)
+                || !Read(stream, animation.jointCount)
+                || !ReadArray(stream, animation.ranges)
+                || !ReadArray(stream, animation.keys))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool ReadMeshNode(std::ifstream& stream, MeshNodeData& node)
+    {
+        uint32_t meshesAmount = 0;
+        if (!Read(stream, meshesAmount))
+        {
+            return false;
+        }
+        node.meshes.resize(meshesAmount);
+        for (auto& mesh : node.meshes)
+        {
+            if (!ReadArray(stream, mesh.vertices)
+                || !ReadArray(stream, mesh.indexes)
+                || !Read(stream, mesh.bounds)
+                || !Read(stream, mesh.boundingSphere)
+                || !ReadArray(stream, mesh.occluder.positions)
+                || !ReadArray(stream, mesh.occluder.indices))
+            {
+                return false;
+            }
+        }
+        uint32_t childrenAmount = 0;
+        if (!Read(stream, childrenAmount))
+        {
+            return false;
+        }
+        node.children.resize(childrenAmount);
+        for (auto& child : node.children)
+        {
+            if (!ReadMeshNode(stream, child))
+            {
+                return false;
+            }
+        }
+        return Read(stream, node.bounds) && Read(stream, node.boundingSphere);
+    }
+}
+
+bool CookedFormat::WriteTexture(const std::string& path, const TextureDescriptor& descriptor, const std::vector<uint8_t>& data)
+{
+    return WriteFile(path, C_TEXTURE_MAGIC, [&](std::ofstream& stream)
+    {
+        CookedTextureHeader header{};
+        header.width = descriptor.width;
+        header.height = descriptor.height;
+        header.componentAmount = descriptor.componentAmount;
+        header.mipLevels = descriptor.mipLevels;
+        header.format = static_cast<uint32_t>(descriptor.format);
+        header.dataSize = data.size();
+        Write(stream, header);
+        stream.write(reinterpret_cast<const char*>(data.data()), data.size());
+    });
+}
+
+bool CookedFormat::ReadTexture(const std::string& path, TextureDescriptor& descriptor, std::vector<uint8_t>& data)
+{
+    std::ifstream stream;
+    if (!OpenFile(path, C_TEXTURE_MAGIC, stream))
+    {
+        return false;
+    }
+
+    CookedTextureHeader header{};
+    if (!Read(stream, header))
+    {
+        return false;
+    }
+    descriptor.width = header.width;
+    descriptor.height = header.height;
+    descriptor.componentAmount = header.componentAmount;
+    descriptor.mipLevels = header.mipLevels;
+    descriptor.format = static_cast<Format>(header.format);
+    data.resize(header.dataSize);
+    return static_cast<bool>(stream.read(reinterpret_cast<char*>(data.data()), data.size()));
+}
+
+bool CookedFormat::WriteMesh(const std::string& path, const MeshNodeData& meshNode)
+{
+    return WriteFile(path, C_MESH_MAGIC, [&](std::ofstream& stream)
+    {
+        WriteMeshNode(stream, meshNode);
+        WriteSkinning(stream, meshNode);
+    });
+}
+
+bool CookedFormat::ReadMesh(const std::string& path, MeshNodeData& meshNode)
+{
+    std::ifstream stream;
+    if (!OpenFile(path, C_MESH_MAGIC, stream))
+    {
+        return false;
+    }
+    return ReadMeshNode(stream, meshNode) && ReadSkinning(stream, meshNode);
+}
+
+bool CookedFormat::WriteShader(const std::string& path, const std::vector<uint32_t>& spirv)
+{
+    R_CORE_ASSERT(!spirv.empty(), "");
+    return WriteFile(path, C_SHADER_MAGIC, [&](std::ofstream& stream)
+    {
+        WriteArray(stream, spirv);
+    });
+}
+
+bool CookedFormat::ReadShader(const std::string& path, std::vector<uint32_t>& spirv)
+{
+    std::ifstream stream;
+    if (!OpenFile(path, C_SHADER_MAGIC, stream))
+    {
+        return false;
+    }
+    return ReadArray(stream, spirv) && !spirv.empty();
+}
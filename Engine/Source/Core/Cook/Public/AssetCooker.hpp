@@ -0,0 +1,60 @@
+#pragma once
+
+#include "AssetIndex.hpp"
+#include "Material.hpp"
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace RightEngine
+{
+    struct AssetCookerSettings
+    {
+        // Engine paths of directories which will be walked recursively
+        std::vector<std::string> roots{ "/", "/Engine/Shaders" };
+        // Cook everything even if source hash wasn't changed
+        bool force{ false };
+    };
+
+    enum class AssetCookStatus
+    {
+        COOKED = 0,
+        SKIPPED,
+        FAILED
+    };
+
+    struct AssetCookResult
+    {
+        std::string path;
+        AssetType type{ AssetType::NONE };
+        AssetCookStatus status{ AssetCookStatus::FAILED };
+        double time{ 0.0 };
+    };
+
+    /*
+     * Offline content processing, doesn't require window or GPU device.
+     * Assets are cooked in parallel on ThreadService, so it must be registered before Cook call
+     */
+    class AssetCooker
+    {
+    public:
+        AssetCooker(const AssetCookerSettings& settings);
+
+        std::vector<AssetCookResult> Cook();
+
+        static AssetType GetSourceType(const std::string& path);
+
+    private:
+        std::vector<std::pair<std::string, AssetType>> GatherSources();
+        std::vector<OrmSources> GatherOrmSources() const;
+        AssetCookResult CookAsset(const std::string& path, AssetType type);
+        AssetCookResult CookOrm(const OrmSources& sources);
+        bool CookTexture(const std::string& path, const std::string& cookedPath) const;
+        bool CookMesh(const std::string& path, const std::string& cookedPath) const;
+        bool CookShader(const std::string& path, const std::string& cookedPath) const;
+
+        AssetCookerSettings m_settings;
+        AssetIndex m_index;
+        std::vector<std::filesystem::path> m_scenes;
+    };
+}
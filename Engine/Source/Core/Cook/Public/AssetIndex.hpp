@@ -0,0 +1,44 @@
+#pragma once
+
+#include "AssetBase.hpp"
+#include <string>
+#include <optional>
+#include <mutex>
+#include <unordered_map>
+
+namespace RightEngine
+{
+    struct AssetIndexEntry
+    {
+        AssetType type{ AssetType::NONE };
+        // SHA256 of the source file contents
+        std::string sourceHash;
+        uint64_t sourceSize{ 0 };
+        int64_t sourceWriteTime{ 0 };
+        // Engine path of the cooked artifact
+        std::string cookedPath;
+        double cookTime{ 0.0 };
+    };
+
+    /*
+     * Maps engine paths of source assets to their cooked artifacts, stored as YAML next to the artifacts
+     */
+    class AssetIndex
+    {
+    public:
+        /*
+         * Path must be an absolute. Missing, broken or outdated index is loaded as empty one
+         */
+        bool Load(const std::string& path);
+        bool Save(const std::string& path) const;
+
+        std::optional<AssetIndexEntry> Find(const std::string& assetPath) const;
+        void Set(const std::string& assetPath, const AssetIndexEntry& entry);
+
+        size_t Size() const;
+
+    private:
+        std::unordered_map<std::string, AssetIndexEntry> m_entries;
+        mutable std::mutex m_mutex;
+    };
+}
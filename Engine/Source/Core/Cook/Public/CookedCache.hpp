@@ -0,0 +1,62 @@
+#pragma once
+
+#include "AssetIndex.hpp"
+#include "Texture.hpp"
+#include "MeshLoader.hpp"
+#include "Material.hpp"
+#include <string>
+#include <vector>
+#include <optional>
+#include <mutex>
+
+namespace RightEngine
+{
+    constexpr const char* C_COOKED_DIR = "/Cooked";
+    constexpr const char* C_ASSET_INDEX_PATH = "/Cooked/AssetIndex.yaml";
+
+    /*
+     * Runtime access to the artifacts produced by the cooker. All paths are in engine format.
+     * Every Load call returns false if the asset wasn't cooked or its source was changed after cooking,
+     * loaders must fallback to importing the source in that case
+     */
+    class CookedCache
+    {
+    public:
+        static CookedCache& Get();
+
+        bool LoadTexture(const std::string& path, TextureDescriptor& descriptor, std::vector<uint8_t>& data);
+        bool LoadMesh(const std::string& path, MeshNodeData& meshNode);
+        bool LoadShader(const std::string& path, std::vector<uint32_t>& spirv);
+        bool LoadOrm(const OrmSources& sources, TextureDescriptor& descriptor, std::vector<uint8_t>& data);
+
+        static std::string CookedPath(const std::string& path, AssetType type);
+        static std::string CookedOrmPath(const OrmSources& sources);
+
+        /*
+         * Packed ORM texture is stale when any of its sources changes, so it's indexed by hash of all source hashes
+         */
+        static std::string CombineHashes(const std::vector<std::string>& hashes);
+
+        /*
+         * Gets absolute path and returns SHA256 of the file contents, empty string if file can't be read
+         */
+        static std::string HashFile(const std::string& absolutePath);
+        static int64_t WriteTime(const std::string& absolutePath);
+
+        CookedCache(const CookedCache& other) = delete;
+        CookedCache& operator=(const CookedCache& other) = delete;
+        CookedCache(CookedCache&& other) = delete;
+        CookedCache& operator=(CookedCache&& other) = delete;
+
+    private:
+        AssetIndex m_index;
+        std::once_flag m_loadIndexFlag;
+
+        CookedCache() = default;
+        ~CookedCache() = default;
+
+        void LoadIndex();
+        std::optional<AssetIndexEntry> FindFresh(const std::string& path);
+        std::string SourceHash(const std::string& path);
+    };
+}
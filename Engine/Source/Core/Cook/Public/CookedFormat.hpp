@@ -0,0 +1,28 @@
+#pragma once
+
+#include "Texture.hpp"
+#include "MeshLoader.hpp"
+#include <string>
+#include <vector>
+
+namespace RightEngine
+{
+    // Must be bumped on every binary layout change, files with other version are treated as not cooked
+    constexpr uint32_t C_COOKED_FORMAT_VERSION = 5;
+
+    /*
+     * Binary layout of the cooked artifacts. All paths are absolute
+     */
+    class CookedFormat
+    {
+    public:
+        static bool WriteTexture(const std::string& path, const TextureDescriptor& descriptor, const std::vector<uint8_t>& data);
+        static bool ReadTexture(const std::string& path, TextureDescriptor& descriptor, std::vector<uint8_t>& data);
+
+        static bool WriteMesh(const std::string& path, const MeshNodeData& meshNode);
+        static bool ReadMesh(const std::string& path, MeshNodeData& meshNode);
+
+        static bool WriteShader(const std::string& path, const std::vector<uint32_t>& spirv);
+        static bool ReadShader(const std::string& path, std::vector<uint32_t>& spirv);
+    };
+}
@@ -0,0 +1,248 @@
+#include "AssetLoadQueue.hpp"
+#include "Application.hpp"
+#include "ThreadService.hpp"
+#include "Assert.hpp"
+#include <algorithm>
+
+using namespace RightEngine;
+
+namespace
+{
+    // Dependencies gate their dependents, so they are bumped a bit above the most important one
+    constexpr float C_DEPENDENCY_PRIORITY_BIAS = 0.01f;
+    constexpr int C_MAX_DEPENDENCY_DEPTH = 8;
+
+    bool IsCritical(const AssetLoadRequest& request)
+    {
+        return request.priority >= C_CRITICAL_LOAD_PRIORITY;
+    }
+}
+
+std::shared_ptr<AssetLoadQueue> AssetLoadQueue::Create(std::vector<AssetLoadRequest>&& requests)
+{
+    std::shared_ptr<AssetLoadQueue> queue(new AssetLoadQueue());
+    auto& entries = queue->m_entries;
+    for (auto& request : requests)
+    {
+        R_CORE_ASSERT(request.load, "");
+        const auto guid = request.guid;
+        entries[guid].request = std::move(request);
+    }
+
+    for (int depth = 0; depth < C_MAX_DEPENDENCY_DEPTH; depth++)
+    {
+        bool changed = false;
+        for (const auto& [guid, entry] : entries)
+        {
+            for (const auto& dependency : entry.request.dependencies)
+            {
+                const auto dependencyIt = entries.find(dependency);
+                if (dependencyIt == entries.end() || dependency == guid)
+                {
+                    continue;
+                }
+                const float priority = entry.request.priority + C_DEPENDENCY_PRIORITY_BIAS;
+                if (dependencyIt->second.request.priority < priority)
+                {
+                    dependencyIt->second.request.priority = priority;
+                    changed = true;
+                }
+            }
+        }
+        if (!changed)
+        {
+            break;
+        }
+    }
+
+    for (auto& [guid, entry] : entries)
+    {
+        for (const auto& dependency : entry.request.dependencies)
+        {
+            const auto dependencyIt = entries.find(dependency);
+            if (dependencyIt == entries.end() || dependency == guid)
+            {
+                continue;
+            }
+            entry.dependencyCount++;
+            dependencyIt->second.dependents.push_back(guid);
+        }
+        if (IsCritical(entry.request))
+        {
+            queue->m_pendingCritical++;
+        }
+    }
+
+    queue->m_maxRunning = std::max<size_t>(Instance().Service<ThreadService>().GetWorkerCount(), 1);
+    for (const auto& [guid, entry] : entries)
+    {
+        if (entry.dependencyCount == 0)
+        {
+            queue->PushReady(guid);
+        }
+    }
+
+    queue->Pump();
+    return queue;
+}
+
+void AssetLoadQueue::WaitCritical()
+{
+    std::unique_lock lock(m_mutex);
+    m_condition.wait(lock, [this]()
+    {
+        return m_pendingCritical == 0;
+    });
+}
+
+void AssetLoadQueue::Wait()
+{
+    std::unique_lock lock(m_mutex);
+    m_condition.wait(lock, [this]()
+    {
+        return m_entries.empty();
+    });
+}
+
+void AssetLoadQueue::Cancel()
+{
+    {
+        std::lock_guard lock(m_mutex);
+        m_cancelled = true;
+        m_ready.clear();
+        m_pendingCritical = 0;
+        for (auto it = m_entries.begin(); it != m_entries.end();)
+        {
+            if (it->second.running)
+            {
+                if (IsCritical(it->second.request))
+                {
+                    m_pendingCritical++;
+                }
+                ++it;
+                continue;
+            }
+            it = m_entries.erase(it);
+        }
+    }
+    m_condition.notify_all();
+}
+
+bool AssetLoadQueue::IsFinished() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_entries.empty();
+}
+
+size_t AssetLoadQueue::GetPendingCount() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_entries.size();
+}
+
+void AssetLoadQueue::Pump()
+{
+    std::vector<xg::Guid> started;
+    {
+        std::lock_guard lock(m_mutex);
+        xg::Guid guid;
+        while (!m_cancelled && m_running < m_maxRunning && PopReady(guid))
+        {
+            auto& entry = m_entries.at(guid);
+            entry.running = true;
+            m_running++;
+            if (!IsCritical(entry.request))
+            {
+                m_runningBackground++;
+            }
+            started.push_back(guid);
+        }
+    }
+
+    auto& ts = Instance().Service<ThreadService>();
+    for (const auto& guid : started)
+    {
+        ts.AddBackgroundTask([self = shared_from_this(), guid]()
+        {
+            self->Run(guid);
+        });
+    }
+}
+
+void AssetLoadQueue::Run(const xg::Guid& guid)
+{
+    std::function<void()> load;
+    {
+        std::lock_guard lock(m_mutex);
+        if (!m_cancelled)
+        {
+            load = std::move(m_entries.at(guid).request.load);
+        }
+    }
+
+    // Load itself can't be interrupted, so cancellation takes effect between requests
+    if (load)
+    {
+        load();
+    }
+
+    {
+        std::lock_guard lock(m_mutex);
+        const auto entryIt = m_entries.find(guid);
+        R_CORE_ASSERT(entryIt != m_entries.end(), "");
+        const auto& entry = entryIt->second;
+        m_running--;
+        if (IsCritical(entry.request))
+        {
+            m_pendingCritical--;
+        }
+        else
+        {
+            m_runningBackground--;
+        }
+        for (const auto& dependent : entry.dependents)
+        {
+            const auto dependentIt = m_entries.find(dependent);
+            if (dependentIt != m_entries.end() && --dependentIt->second.dependencyCount == 0 && !m_cancelled)
+            {
+                PushReady(dependent);
+            }
+        }
+        m_entries.erase(entryIt);
+    }
+
+    m_condition.notify_all();
+    Pump();
+}
+
+void AssetLoadQueue::PushReady(const xg::Guid& guid)
+{
+    m_ready.push_back(guid);
+    std::push_heap(m_ready.begin(), m_ready.end(), [this](const auto& a, const auto& b)
+    {
+        return m_entries.at(a).request.priority < m_entries.at(b).request.priority;
+    });
+}
+
+bool AssetLoadQueue::PopReady(xg::Guid& guid)
+{
+    if (m_ready.empty())
+    {
+        return false;
+    }
+
+    // Top of the heap is the most important request, so if it's a background one all the others are too
+    const auto& top = m_entries.at(m_ready.front());
+    if (!IsCritical(top.request) && m_runningBackground >= std::max<size_t>(m_maxRunning / 2, 1))
+    {
+        return false;
+    }
+
+    std::pop_heap(m_ready.begin(), m_ready.end(), [this](const auto& a, const auto& b)
+    {
+        return m_entries.at(a).request.priority < m_entries.at(b).request.priority;
+    });
+    guid = m_ready.back();
+    m_ready.pop_back();
+    return true;
+}
@@ -16,13 +16,26 @@ const AssetHandle& AssetManager::GetDefaultTexture() const
 
     if (!wasLoaded)
     {
-        defaultTexture = GetLoader<TextureLoader>()->Load("/Textures/editor_default_image.png");
+        defaultTexture = GetLoader<TextureLoader>()->Load(C_DEFAULT_TEXTURE_PATH);
         wasLoaded = true;
     }
 
     return defaultTexture;
 }
 
+const AssetHandle& AssetManager::GetDefaultOrmTexture() const
+{
+    static bool wasLoaded = false;
+
+    if (!wasLoaded)
+    {
+        defaultOrmTexture = GetLoader<TextureLoader>()->LoadOrm({});
+        wasLoaded = true;
+    }
+
+    return defaultOrmTexture;
+}
+
 const AssetHandle& AssetManager::GetDefaultMaterial() const
 {
     static bool wasLoaded = false;
@@ -7,21 +7,17 @@
 #include "String.hpp"
 #include "AssetManager.hpp"
 #include "GraphicsPipeline.hpp"
+#include "Buffer.hpp"
+#include "TextureCompressor.hpp"
 #include <glm/ext/matrix_transform.hpp>
 #include <glm/ext/matrix_clip_space.hpp>
+#include <array>
 
 using namespace RightEngine;
 
 namespace
 {
-    const uint32_t envTexWidth = 2048;
-    const uint32_t envTexHeight = 2048;
-    const uint32_t irradianceTexWidth = 64;
-    const uint32_t irradianceTexHeight = 64;
-    const uint32_t prefilterTexWidth = 128;
-    const uint32_t prefilterTexHeight = 128;
-    const uint32_t lutTexWidth = 512;
-    const uint32_t lutTexHeight = 512;
+    const uint32_t lutTexSize = 512;
 
     const glm::mat4 captureViews[] =
             {
@@ -54,6 +50,54 @@ namespace
         return splittedPath.back();
     }
 
+    // Cube is rendered from the inside, so captures don't need depth attachment.
+    // Color attachment lives only while capture pipeline is alive
+    RenderPassDescriptor CreateCaptureRenderPass(Format format, uint32_t size)
+    {
+        TextureDescriptor colorAttachmentDesc{};
+        colorAttachmentDesc.format = format;
+        colorAttachmentDesc.type = TextureType::TEXTURE_2D;
+        colorAttachmentDesc.width = size;
+        colorAttachmentDesc.height = size;
+        colorAttachmentDesc.componentAmount = format == Format::RG16_SFLOAT ? 2 : 4;
+
+        RenderPassDescriptor renderPassDescriptor{};
+        renderPassDescriptor.extent = { size, size };
+        renderPassDescriptor.offscreen = true;
+        AttachmentDescriptor color{};
+        color.texture = Device::Get()->CreateTexture(colorAttachmentDesc, {});
+        color.loadOperation = AttachmentLoadOperation::CLEAR;
+        renderPassDescriptor.colorAttachments = { color };
+        return renderPassDescriptor;
+    }
+
+    bool UseCompression(const EnvironmentMapSettings& settings)
+    {
+        return settings.compress && Device::Get()->GetInfo().textureCompressionBC;
+    }
+
+    // Reads RGBA16_SFLOAT capture back and encodes it on CPU
+    std::vector<uint8_t> CompressCapture(const std::shared_ptr<Texture>& capture)
+    {
+        const auto buffer = capture->Data();
+        const auto& descriptor = capture->GetSpecification();
+        const auto pixels = static_cast<const uint16_t*>(buffer->Map());
+        auto blocks = TextureCompressor::CompressBC6H(pixels, descriptor.width, descriptor.height);
+        buffer->UnMap();
+        return blocks;
+    }
+
+    uint32_t GetPrefilterMipLevels(uint32_t size)
+    {
+        uint32_t mipLevels = 1;
+        while (size > 1 && mipLevels < maxMipLevels)
+        {
+            size >>= 1;
+            mipLevels++;
+        }
+        return mipLevels;
+    }
+
     const float cubeVertexData[] = {
         // [position 3] [normal 3] [texture coodinate 2]
         // back face
@@ -116,17 +160,38 @@ EnvironmentMapLoader::EnvironmentMapLoader()
 //    cube = MeshBuilder::CubeGeometry();
 }
 
-AssetHandle EnvironmentMapLoader::Load(const std::string& path, bool flipVertically)
+AssetHandle EnvironmentMapLoader::Load(const std::string& path,
+                                       bool flipVertically,
+                                       const EnvironmentMapSettings& settings)
+{
+    return _Load(path, xg::newGuid(), flipVertically, settings);
+}
+
+AssetHandle EnvironmentMapLoader::Reload(const AssetHandle& handle, const EnvironmentMapSettings& settings)
 {
-    return _Load(path, xg::newGuid(), flipVertically);
+    R_CORE_ASSERT(manager, "");
+
+    const auto asset = manager->GetAsset<EnvironmentContext>(handle);
+    R_CORE_ASSERT(asset, "");
+    if (asset->settings == settings)
+    {
+        return handle;
+    }
+    return Compute(asset->path, handle.guid, settings);
 }
 
 void EnvironmentMapLoader::ComputeEnvironmentMap()
 {
-    auto& assetManager = AssetManager::Get();
-    auto loader = assetManager.GetLoader<TextureLoader>();
-    auto textureHandle = loader->Load(m_loaderContext.path, {});
-    const auto equirectMap = assetManager.GetAsset<Texture>(textureHandle);
+    const auto& settings = m_environmentContext->settings;
+    const uint32_t size = settings.environmentSize;
+
+    // Source isn't cached by asset manager, so it's released with the last reference after convolution
+    auto loader = AssetManager::Get().GetLoader<TextureLoader>();
+    auto [equirectData, equirectDesc] = loader->LoadSourceData(m_loaderContext.path);
+    equirectDesc.type = TextureType::TEXTURE_2D;
+    const auto equirectMap = Device::Get()->CreateTexture(equirectDesc, equirectData);
+    equirectData.clear();
+    equirectData.shrink_to_fit();
 
     ShaderProgramDescriptor shaderProgramDescriptor;
     ShaderDescriptor vertexShader;
@@ -145,38 +210,8 @@ void EnvironmentMapLoader::ComputeEnvironmentMap()
     shaderProgramDescriptor.reflection.buffers[{ 0, ShaderType::VERTEX }] = BufferType::UNIFORM;
     const auto shader = Device::Get()->CreateShader(shaderProgramDescriptor);
 
-    TextureDescriptor cubeDesc;
-    cubeDesc.type = TextureType::CUBEMAP;
-    cubeDesc.width = envTexWidth;
-    cubeDesc.height = envTexHeight;
-    cubeDesc.format = Format::RGBA16_SFLOAT;
-    cubeDesc.componentAmount = 3;
-    const auto cubemap = Device::Get()->CreateTexture(cubeDesc, {});
-
-    TextureDescriptor colorAttachmentDesc{};
-    colorAttachmentDesc.format = Format::RGBA16_SFLOAT;
-    colorAttachmentDesc.type = TextureType::TEXTURE_2D;
-    colorAttachmentDesc.width = envTexWidth;
-    colorAttachmentDesc.height = envTexHeight;
-    const auto colorAttachment = Device::Get()->CreateTexture(colorAttachmentDesc, {});
-    TextureDescriptor depthAttachmentDesc{};
-    depthAttachmentDesc.format = Format::D32_SFLOAT_S8_UINT;
-    depthAttachmentDesc.type = TextureType::TEXTURE_2D;
-    depthAttachmentDesc.width = envTexWidth;
-    depthAttachmentDesc.height = envTexHeight;
-    const auto depthAttachment = Device::Get()->CreateTexture(depthAttachmentDesc, {});
-
-    RenderPassDescriptor renderPassDescriptor{};
-    renderPassDescriptor.extent = { envTexWidth, envTexHeight };
-    renderPassDescriptor.offscreen = true;
-    AttachmentDescriptor depth{};
-    depth.loadOperation = AttachmentLoadOperation::CLEAR;
-    depth.texture = depthAttachment;
-    AttachmentDescriptor color{};
-    color.texture = colorAttachment;
-    color.loadOperation = AttachmentLoadOperation::CLEAR;
-    renderPassDescriptor.colorAttachments = { color };
-    renderPassDescriptor.depthStencilAttachment = { depth };
+    const auto renderPassDescriptor = CreateCaptureRenderPass(Format::RGBA16_SFLOAT, size);
+    const auto colorAttachment = renderPassDescriptor.colorAttachments.front().texture;
 
     GraphicsPipelineDescriptor pipelineDescriptor;
     pipelineDescriptor.shader = shader;
@@ -211,11 +246,19 @@ void EnvironmentMapLoader::ComputeEnvironmentMap()
     environmentCubemapDesc.type = TextureType::CUBEMAP;
     environmentCubemapDesc.componentAmount = 4;
     environmentCubemapDesc.format = Format::RGBA16_SFLOAT;
-    environmentCubemapDesc.height = envTexHeight;
-    environmentCubemapDesc.width = envTexWidth;
-    const auto environmentCubemap = Device::Get()->CreateTexture(environmentCubemapDesc, {});
-    
-    environmentCubemap->SetSampler(sampler);
+    environmentCubemapDesc.height = size;
+    environmentCubemapDesc.width = size;
+
+    // Compressed cubemap is created only when all faces are encoded, uncompressed one is filled by GPU copies
+    const bool compress = UseCompression(settings);
+    std::vector<uint8_t> compressedFaces;
+    std::shared_ptr<Texture> environmentCubemap;
+    if (!compress)
+    {
+        environmentCubemap = Device::Get()->CreateTexture(environmentCubemapDesc, {});
+        environmentCubemap->SetSampler(sampler);
+    }
+
     colorAttachment->SetSampler(sampler);
     equirectMap->SetSampler(sampler);
     
@@ -237,16 +280,33 @@ void EnvironmentMapLoader::ComputeEnvironmentMap()
         renderer.EncodeState(rendererState);
         renderer.Draw(vertexBuffer);
         renderer.EndFrame();
-        
+
+        if (compress)
+        {
+            const auto face = CompressCapture(colorAttachment);
+            compressedFaces.insert(compressedFaces.end(), face.begin(), face.end());
+            continue;
+        }
+
         TextureCopy dst;
         dst.usage = SHADER_READ_ONLY;
         dst.layerNum = i;
         dst.mipLevel = 0;
         environmentCubemap->CopyFrom(colorAttachment, src, dst);
     }
+
+    if (compress)
+    {
+        environmentCubemapDesc.format = Format::BC6H_UFLOAT;
+        environmentCubemap = Device::Get()->CreateTexture(environmentCubemapDesc, compressedFaces);
+        environmentCubemap->SetSampler(sampler);
+    }
     
     m_environmentContext->envMap = environmentCubemap;
-    m_environmentContext->equirectangularTexture = equirectMap;
+    if (m_retainEquirectangular)
+    {
+        m_environmentContext->equirectangularTexture = equirectMap;
+    }
 }
 
 void EnvironmentMapLoader::ComputeIrradianceMap()
@@ -268,31 +328,9 @@ void EnvironmentMapLoader::ComputeIrradianceMap()
     shaderProgramDescriptor.reflection.buffers[{ 0, ShaderType::VERTEX }] = BufferType::UNIFORM;
     const auto shader = Device::Get()->CreateShader(shaderProgramDescriptor);
 
-    TextureDescriptor colorAttachmentDesc{};
-    colorAttachmentDesc.format = Format::RGBA16_SFLOAT;
-    colorAttachmentDesc.type = TextureType::TEXTURE_2D;
-    colorAttachmentDesc.width = irradianceTexWidth;
-    colorAttachmentDesc.height = irradianceTexHeight;
-    const auto colorAttachment = Device::Get()->CreateTexture(colorAttachmentDesc, {});
-    TextureDescriptor depthAttachmentDesc{};
-    depthAttachmentDesc.format = Format::D32_SFLOAT_S8_UINT;
-    depthAttachmentDesc.type = TextureType::TEXTURE_2D;
-    depthAttachmentDesc.width = irradianceTexWidth;
-    depthAttachmentDesc.height = irradianceTexHeight;
-    const auto depthAttachment = Device::Get()->CreateTexture(depthAttachmentDesc, {});
-
-    RenderPassDescriptor renderPassDescriptor{};
-    renderPassDescriptor.extent = { irradianceTexWidth, irradianceTexHeight };
-    renderPassDescriptor.offscreen = true;
-    AttachmentDescriptor depth{};
-    depth.loadOperation = AttachmentLoadOperation::CLEAR;
-    depth.texture = depthAttachment;
-    AttachmentDescriptor color{};
-    color.texture = colorAttachment;
-    color.loadOperation = AttachmentLoadOperation::CLEAR;
-    renderPassDescriptor.colorAttachments = { color };
-    renderPassDescriptor.depthStencilAttachment = { depth };
-
+    const uint32_t size = m_environmentContext->settings.irradianceSize;
+    const auto renderPassDescriptor = CreateCaptureRenderPass(Format::RGBA16_SFLOAT, size);
+    const auto colorAttachment = renderPassDescriptor.colorAttachments.front().texture;
 
     GraphicsPipelineDescriptor pipelineDescriptor;
     pipelineDescriptor.shader = shader;
@@ -327,8 +365,8 @@ void EnvironmentMapLoader::ComputeIrradianceMap()
     irradianceCubemapDesc.type = TextureType::CUBEMAP;
     irradianceCubemapDesc.componentAmount = 4;
     irradianceCubemapDesc.format = Format::RGBA16_SFLOAT;
-    irradianceCubemapDesc.height = irradianceTexHeight;
-    irradianceCubemapDesc.width = irradianceTexWidth;
+    irradianceCubemapDesc.height = size;
+    irradianceCubemapDesc.width = size;
     const auto irradianceCubemap = Device::Get()->CreateTexture(irradianceCubemapDesc, {});
 
     irradianceCubemap->SetSampler(sampler);
@@ -385,31 +423,12 @@ void EnvironmentMapLoader::ComputeRadianceMap()
     shaderProgramDescriptor.reflection.buffers[{ 2, ShaderType::FRAGMENT }] = BufferType::UNIFORM;
     const auto shader = Device::Get()->CreateShader(shaderProgramDescriptor);
     
-    TextureDescriptor colorAttachmentDesc{};
-    colorAttachmentDesc.format = Format::RGBA16_SFLOAT;
-    colorAttachmentDesc.type = TextureType::TEXTURE_2D;
-    colorAttachmentDesc.width = prefilterTexWidth;
-    colorAttachmentDesc.height = prefilterTexHeight;
-    auto colorAttachment = Device::Get()->CreateTexture(colorAttachmentDesc, {});
-    TextureDescriptor depthAttachmentDesc{};
-    depthAttachmentDesc.format = Format::D32_SFLOAT_S8_UINT;
-    depthAttachmentDesc.type = TextureType::TEXTURE_2D;
-    depthAttachmentDesc.width = prefilterTexWidth;
-    depthAttachmentDesc.height = prefilterTexHeight;
-    const auto depthAttachment = Device::Get()->CreateTexture(depthAttachmentDesc, {});
-
-    RenderPassDescriptor renderPassDescriptor{};
-    renderPassDescriptor.extent = { prefilterTexWidth, prefilterTexHeight };
-    renderPassDescriptor.offscreen = true;
-    AttachmentDescriptor depth{};
-    depth.loadOperation = AttachmentLoadOperation::CLEAR;
-    depth.texture = depthAttachment;
-    AttachmentDescriptor color{};
-    color.texture = colorAttachment;
-    color.loadOperation = AttachmentLoadOperation::CLEAR;
-    renderPassDescriptor.colorAttachments = { color };
-    renderPassDescriptor.depthStencilAttachment = { depth };
-    
+    const auto& settings = m_environmentContext->settings;
+    const uint32_t size = settings.prefilterSize;
+    const uint32_t mipLevels = GetPrefilterMipLevels(size);
+    const auto renderPassDescriptor = CreateCaptureRenderPass(Format::RGBA16_SFLOAT, size);
+    auto colorAttachment = renderPassDescriptor.colorAttachments.front().texture;
+
     GraphicsPipelineDescriptor pipelineDescriptor;
     pipelineDescriptor.shader = shader;
 
@@ -452,21 +471,29 @@ void EnvironmentMapLoader::ComputeRadianceMap()
     prefilterCubemapDesc.type = TextureType::CUBEMAP;
     prefilterCubemapDesc.componentAmount = 4;
     prefilterCubemapDesc.format = Format::RGBA16_SFLOAT;
-    prefilterCubemapDesc.height = prefilterTexWidth;
-    prefilterCubemapDesc.width = prefilterTexHeight;
-    prefilterCubemapDesc.mipLevels = maxMipLevels;
-    const auto prefilterCubemap = Device::Get()->CreateTexture(prefilterCubemapDesc, {});
+    prefilterCubemapDesc.height = size;
+    prefilterCubemapDesc.width = size;
+    prefilterCubemapDesc.mipLevels = mipLevels;
+
+    // Encoded mips are gathered per face, because compressed cubemap data is stored face by face
+    const bool compress = UseCompression(settings);
+    std::array<std::vector<uint8_t>, 6> compressedFaces;
+    std::shared_ptr<Texture> prefilterCubemap;
+    if (!compress)
+    {
+        prefilterCubemap = Device::Get()->CreateTexture(prefilterCubemapDesc, {});
+        prefilterCubemap->SetSampler(sampler);
+    }
 
-    prefilterCubemap->SetSampler(sampler);
     colorAttachment->SetSampler(sampler);
     
-    for (int mipLevel = 0; mipLevel < maxMipLevels; mipLevel++)
+    for (int mipLevel = 0; mipLevel < mipLevels; mipLevel++)
     {
-        uint32_t mipWidth = prefilterTexWidth * std::pow(0.5, mipLevel);
-        uint32_t mipHeight = prefilterTexHeight * std::pow(0.5, mipLevel);
+        uint32_t mipWidth = size * std::pow(0.5, mipLevel);
+        uint32_t mipHeight = size * std::pow(0.5, mipLevel);
         pipeline->Resize(mipWidth, mipHeight);
         colorAttachment = pipeline->GetRenderPassDescriptor().colorAttachments.front().texture;
-        roughness = static_cast<float>(mipLevel) / static_cast<float>(maxMipLevels - 1);
+        roughness = static_cast<float>(mipLevel) / static_cast<float>(mipLevels - 1);
         auto roughnessPtr = roughnessBuffer->Map();
         memcpy(roughnessPtr, &roughness, sizeof(roughness));
         roughnessBuffer->UnMap();
@@ -486,6 +513,13 @@ void EnvironmentMapLoader::ComputeRadianceMap()
             renderer.EncodeState(rendererState);
             renderer.Draw(vertexBuffer);
             renderer.EndFrame();
+
+            if (compress)
+            {
+                const auto face = CompressCapture(colorAttachment);
+                compressedFaces[i].insert(compressedFaces[i].end(), face.begin(), face.end());
+                continue;
+            }
             
             TextureCopy src;
             src.usage = SHADER_READ_ONLY;
@@ -502,6 +536,19 @@ void EnvironmentMapLoader::ComputeRadianceMap()
         }
     }
     
+    if (compress)
+    {
+        std::vector<uint8_t> data;
+        data.reserve(compressedFaces.front().size() * compressedFaces.size());
+        for (const auto& face : compressedFaces)
+        {
+            data.insert(data.end(), face.begin(), face.end());
+        }
+        prefilterCubemapDesc.format = Format::BC6H_UFLOAT;
+        prefilterCubemap = Device::Get()->CreateTexture(prefilterCubemapDesc, data);
+        prefilterCubemap->SetSampler(sampler);
+    }
+
     m_environmentContext->prefilterMap = prefilterCubemap;
     R_CORE_TRACE("Finished computing irradiance map for texture \"{0}\"", m_loaderContext.path);
 }
@@ -531,31 +578,9 @@ void EnvironmentMapLoader::ComputeLUT()
     shaderProgramDescriptor.layout = layout;
     const auto shader = Device::Get()->CreateShader(shaderProgramDescriptor);
     
-    TextureDescriptor colorAttachmentDesc{};
-    colorAttachmentDesc.format = Format::RG16_SFLOAT;
-    colorAttachmentDesc.type = TextureType::TEXTURE_2D;
-    colorAttachmentDesc.width = lutTexWidth;
-    colorAttachmentDesc.height = lutTexHeight;
-    auto colorAttachment = Device::Get()->CreateTexture(colorAttachmentDesc, {});
-    TextureDescriptor depthAttachmentDesc{};
-    depthAttachmentDesc.format = Format::D32_SFLOAT_S8_UINT;
-    depthAttachmentDesc.type = TextureType::TEXTURE_2D;
-    depthAttachmentDesc.width = lutTexWidth;
-    depthAttachmentDesc.height = lutTexHeight;
-    const auto depthAttachment = Device::Get()->CreateTexture(depthAttachmentDesc, {});
-    
-    RenderPassDescriptor renderPassDescriptor{};
-    renderPassDescriptor.extent = { lutTexWidth, lutTexHeight };
-    renderPassDescriptor.offscreen = true;
-    AttachmentDescriptor depth{};
-    depth.loadOperation = AttachmentLoadOperation::CLEAR;
-    depth.texture = depthAttachment;
-    AttachmentDescriptor color{};
-    color.texture = colorAttachment;
-    color.loadOperation = AttachmentLoadOperation::CLEAR;
-    renderPassDescriptor.colorAttachments = { color };
-    renderPassDescriptor.depthStencilAttachment = { depth };
-    
+    const auto renderPassDescriptor = CreateCaptureRenderPass(Format::RG16_SFLOAT, lutTexSize);
+    const auto colorAttachment = renderPassDescriptor.colorAttachments.front().texture;
+
     GraphicsPipelineDescriptor pipelineDescriptor;
     pipelineDescriptor.shader = shader;
     
@@ -592,7 +617,10 @@ AssetHandle EnvironmentMapLoader::FinishLoading(const xg::Guid& guid)
     return manager->CacheAsset(m_environmentContext, m_loaderContext.path, AssetType::ENVIRONMENT_MAP, guid);
 }
 
-AssetHandle EnvironmentMapLoader::_Load(const std::string& path, const xg::Guid& guid, const bool flipVertically)
+AssetHandle EnvironmentMapLoader::_Load(const std::string& path,
+                                        const xg::Guid& guid,
+                                        const bool flipVertically,
+                                        const EnvironmentMapSettings& settings)
 {
     R_CORE_ASSERT(manager, "");
 
@@ -602,17 +630,32 @@ AssetHandle EnvironmentMapLoader::_Load(const std::string& path, const xg::Guid&
         return { asset->guid };
     }
 
+    return Compute(path, guid, settings);
+}
+
+AssetHandle EnvironmentMapLoader::Compute(const std::string& path,
+                                          const xg::Guid& guid,
+                                          const EnvironmentMapSettings& settings)
+{
+    R_CORE_ASSERT(settings.environmentSize > 0 && settings.irradianceSize > 0 && settings.prefilterSize > 0, "");
+
     m_environmentContext = std::make_shared<EnvironmentContext>();
     m_loaderContext.path = path;
     m_environmentContext->name = GetTextureName(path);
+    m_environmentContext->settings = settings;
     ComputeEnvironmentMap();
     ComputeIrradianceMap();
     ComputeRadianceMap();
     ComputeLUT();
-    return FinishLoading(guid);
+    const auto handle = FinishLoading(guid);
+    m_environmentContext.reset();
+    return handle;
 }
 
-AssetHandle EnvironmentMapLoader::LoadWithGUID(const std::string& path, const xg::Guid& guid, bool flipVertically)
+AssetHandle EnvironmentMapLoader::LoadWithGUID(const std::string& path,
+                                               const xg::Guid& guid,
+                                               bool flipVertically,
+                                               const EnvironmentMapSettings& settings)
 {
-    return _Load(path, guid, flipVertically);
+    return _Load(path, guid, flipVertically, settings);
 }
@@ -5,41 +5,35 @@
 #include "TextureLoader.hpp"
 #include "AssetManager.hpp"
 #include "AssetLoader.hpp"
+#include "CookedCache.hpp"
+#include "AnimationSampler.hpp"
 #include <assimp/scene.h>
 #include <assimp/Importer.hpp>
 #include <assimp/postprocess.h>
+#include <glm/gtc/type_ptr.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <unordered_set>
+#include <algorithm>
+#include <numeric>
 
 using namespace RightEngine;
 
 namespace
 {
-    struct Vertex
-    {
-        glm::vec3 position;
-        glm::vec3 normal;
-        glm::vec2 uv;
-        glm::vec3 tangent;
-        glm::vec3 biTangent;
-    };
+    // Per mesh, rasterizing occluders must stay much cheaper than drawing what they hide
+    constexpr size_t C_MAX_OCCLUDER_TRIANGLES = 256;
 
-    std::shared_ptr<Mesh> BuildMesh(const std::vector<Vertex>& vertices,
+    std::shared_ptr<Mesh> BuildMesh(const std::vector<MeshVertex>& vertices,
                                     const std::vector<uint32_t>& indexes)
     {
         R_CORE_ASSERT(!vertices.empty(), "");
-        VertexBufferLayout layout;
-        layout.Push<float>(3);
-        layout.Push<float>(3);
-        layout.Push<float>(2);
-        layout.Push<float>(3);
-        layout.Push<float>(3);
-
         auto mesh = std::make_shared<Mesh>();
         BufferDescriptor vertexBufferDescriptor{};
         vertexBufferDescriptor.type = BufferType::VERTEX;
-        vertexBufferDescriptor.size = vertices.size() * sizeof(Vertex);
+        vertexBufferDescriptor.size = vertices.size() * sizeof(MeshVertex);
         vertexBufferDescriptor.memoryType = MemoryType::CPU_GPU;
         const auto vertexBuffer = Device::Get()->CreateBuffer(vertexBufferDescriptor, vertices.data());
-        mesh->SetVertexBuffer(vertexBuffer, std::make_shared<VertexBufferLayout>(layout));
+        mesh->SetVertexBuffer(vertexBuffer, std::make_shared<VertexBufferLayout>(MeshLoader::GetVertexLayout()));
 
         if (!indexes.empty())
         {
@@ -51,8 +45,268 @@ namespace
             mesh->SetIndexBuffer(indexBuffer);
         }
 
+        // Picking only needs positions, skinned meshes are tested in bind pose
+        std::vector<glm::vec3> positions;
+        positions.reserve(vertices.size());
+        for (const auto& vertex : vertices)
+        {
+            positions.push_back(vertex.position);
+        }
+        std::vector<uint32_t> sequentialIndexes;
+        if (indexes.empty())
+        {
+            sequentialIndexes.resize(vertices.size() - vertices.size() % 3);
+            std::iota(sequentialIndexes.begin(), sequentialIndexes.end(), 0);
+        }
+        TriangleBvh triangleBvh;
+        triangleBvh.Build(positions, indexes.empty() ? sequentialIndexes : indexes);
+        mesh->SetTriangleBvh(std::move(triangleBvh));
+
         return mesh;
     }
+
+    // Assimp matrices are row major
+    glm::mat4 ToMat4(const aiMatrix4x4& matrix)
+    {
+        return glm::transpose(glm::make_mat4(&matrix.a1));
+    }
+
+    glm::vec3 ToVec3(const aiVector3D& vector)
+    {
+        return { vector.x, vector.y, vector.z };
+    }
+
+    template<typename Key>
+    const Key* FindNextKey(const Key* keys, uint32_t count, double time)
+    {
+        return std::upper_bound(keys, keys + count, time, [](double t, const Key& key)
+        {
+            return t < key.mTime;
+        });
+    }
+
+    glm::vec3 SampleKeys(const aiVectorKey* keys, uint32_t count, double time, const glm::vec3& fallback)
+    {
+        if (count == 0)
+        {
+            return fallback;
+        }
+        const auto next = FindNextKey(keys, count, time);
+        if (next == keys)
+        {
+            return ToVec3(keys[0].mValue);
+        }
+        if (next == keys + count)
+        {
+            return ToVec3(keys[count - 1].mValue);
+        }
+        const auto previous = next - 1;
+        const float alpha = static_cast<float>((time - previous->mTime) / (next->mTime - previous->mTime));
+        return glm::mix(ToVec3(previous->mValue), ToVec3(next->mValue), alpha);
+    }
+
+    glm::quat SampleKeys(const aiQuatKey* keys, uint32_t count, double time, const glm::quat& fallback)
+    {
+        const auto toQuat = [](const aiQuaternion& q) { return glm::quat(q.w, q.x, q.y, q.z); };
+        if (count == 0)
+        {
+            return fallback;
+        }
+        const auto next = FindNextKey(keys, count, time);
+        if (next == keys)
+        {
+            return toQuat(keys[0].mValue);
+        }
+        if (next == keys + count)
+        {
+            return toQuat(keys[count - 1].mValue);
+        }
+        const auto previous = next - 1;
+        const float alpha = static_cast<float>((time - previous->mTime) / (next->mTime - previous->mTime));
+        return glm::slerp(toQuat(previous->mValue), toQuat(next->mValue), alpha);
+    }
+
+    JointPose SampleChannel(const aiNodeAnim& channel, double time, const JointPose& bindPose)
+    {
+        const glm::quat bindRotation(bindPose.rotation.w, bindPose.rotation.x, bindPose.rotation.y, bindPose.rotation.z);
+        const glm::quat rotation = glm::normalize(SampleKeys(channel.mRotationKeys, channel.mNumRotationKeys, time, bindRotation));
+
+        JointPose pose;
+        pose.rotation = glm::vec4(rotation.x, rotation.y, rotation.z, rotation.w);
+        pose.translation = glm::vec4(SampleKeys(channel.mPositionKeys, channel.mNumPositionKeys, time, glm::vec3(bindPose.translation)), 0.0f);
+        pose.scale = glm::vec4(SampleKeys(channel.mScalingKeys, channel.mNumScalingKeys, time, glm::vec3(bindPose.scale)), 0.0f);
+        return pose;
+    }
+
+    void AddJoints(const aiNode* node,
+                   int32_t parent,
+                   const std::unordered_set<const aiNode*>& jointNodes,
+                   const std::unordered_map<std::string, glm::mat4>& inverseBindPoses,
+                   Skeleton& skeleton)
+    {
+        if (jointNodes.find(node) == jointNodes.end())
+        {
+            return;
+        }
+
+        const auto index = static_cast<int32_t>(skeleton.parents.size());
+        const std::string name = node->mName.C_Str();
+        const auto inverseBindPoseIt = inverseBindPoses.find(name);
+        skeleton.jointNames.push_back(name);
+        skeleton.parents.push_back(parent);
+        skeleton.inverseBindPoses.push_back(inverseBindPoseIt != inverseBindPoses.end() ? inverseBindPoseIt->second : glm::mat4(1.0f));
+        skeleton.bindPose.push_back(AnimationSampler::Decompose(ToMat4(node->mTransformation)));
+
+        for (uint32_t i = 0; i < node->mNumChildren; i++)
+        {
+            AddJoints(node->mChildren[i], index, jointNodes, inverseBindPoses, skeleton);
+        }
+    }
+
+    // Joints are bone nodes with all their ancestors, so the hierarchy stays complete
+    bool ImportSkeleton(const aiScene* scene, Skeleton& skeleton)
+    {
+        std::unordered_map<std::string, glm::mat4> inverseBindPoses;
+        for (uint32_t meshIdx = 0; meshIdx < scene->mNumMeshes; meshIdx++)
+        {
+            const aiMesh* mesh = scene->mMeshes[meshIdx];
+            for (uint32_t boneIdx = 0; boneIdx < mesh->mNumBones; boneIdx++)
+            {
+                const aiBone* bone = mesh->mBones[boneIdx];
+                inverseBindPoses.emplace(bone->mName.C_Str(), ToMat4(bone->mOffsetMatrix));
+            }
+        }
+
+        if (inverseBindPoses.empty())
+        {
+            return false;
+        }
+
+        std::unordered_set<const aiNode*> jointNodes;
+        for (const auto& [name, inverseBindPose] : inverseBindPoses)
+        {
+            for (const aiNode* node = scene->mRootNode->FindNode(name.c_str());
+                 node && jointNodes.insert(node).second;
+                 node = node->mParent)
+            {}
+        }
+
+        // Depth first order puts every parent before its children
+        AddJoints(scene->mRootNode, -1, jointNodes, inverseBindPoses, skeleton);
+        if (skeleton.GetJointCount() > C_MAX_JOINTS)
+        {
+            R_CORE_WARN("Skeleton has {0} joints, but only {1} are supported, mesh is imported as static",
+                        skeleton.GetJointCount(), C_MAX_JOINTS);
+            skeleton = {};
+            return false;
+        }
+        skeleton.globalInverse = glm::inverse(ToMat4(scene->mRootNode->mTransformation));
+        return true;
+    }
+
+    void ImportAnimations(const aiScene* scene,
+                          const Skeleton& skeleton,
+                          const std::unordered_map<std::string, uint32_t>& joints,
+                          std::vector<AnimationClip>& animations)
+    {
+        const auto jointCount = static_cast<uint32_t>(skeleton.GetJointCount());
+
+        for (uint32_t animationIdx = 0; animationIdx < scene->mNumAnimations; animationIdx++)
+        {
+            const aiAnimation* animation = scene->mAnimations[animationIdx];
+            // Some exporters don't write tick rate, 25 is the Assimp default for them
+            const double ticksPerSecond = animation->mTicksPerSecond > 0.0 ? animation->mTicksPerSecond : 25.0;
+            const float duration = static_cast<float>(animation->mDuration / ticksPerSecond);
+            const auto frameCount = std::max(2u, static_cast<uint32_t>(std::ceil(duration * C_ANIMATION_SAMPLE_RATE)) + 1);
+
+            // Joints without channel stay in the bind pose
+            std::vector<const aiNodeAnim*> channels(jointCount, nullptr);
+            for (uint32_t channelIdx = 0; channelIdx < animation->mNumChannels; channelIdx++)
+            {
+                const aiNodeAnim* channel = animation->mChannels[channelIdx];
+                const auto jointIt = joints.find(channel->mNodeName.C_Str());
+                if (jointIt != joints.end())
+                {
+                    channels[jointIt->second] = channel;
+                }
+            }
+
+            std::vector<JointPose> frames(static_cast<size_t>(frameCount) * jointCount);
+            for (uint32_t frame = 0; frame < frameCount; frame++)
+            {
+                const double time = std::min(frame / C_ANIMATION_SAMPLE_RATE, duration) * ticksPerSecond;
+                for (uint32_t joint = 0; joint < jointCount; joint++)
+                {
+                    const auto& bindPose = skeleton.bindPose[joint];
+                    frames[frame * jointCount + joint] = channels[joint] ? SampleChannel(*channels[joint], time, bindPose) : bindPose;
+                }
+            }
+
+            std::string name = animation->mName.C_Str();
+            if (name.empty())
+            {
+                name = "Animation " + std::to_string(animationIdx);
+            }
+            animations.push_back(AnimationSampler::Compress(name, duration, jointCount, frames));
+        }
+    }
+
+    void ImportSkinWeights(const aiMesh* mesh, const std::unordered_map<std::string, uint32_t>& joints, std::vector<MeshVertex>& vertices)
+    {
+        std::vector<glm::uvec4> vertexJoints(vertices.size(), glm::uvec4(0));
+        std::vector<glm::vec4> vertexWeights(vertices.size(), glm::vec4(0.0f));
+        for (uint32_t boneIdx = 0; boneIdx < mesh->mNumBones; boneIdx++)
+        {
+            const aiBone* bone = mesh->mBones[boneIdx];
+            const auto jointIt = joints.find(bone->mName.C_Str());
+            if (jointIt == joints.end())
+            {
+                continue;
+            }
+            for (uint32_t weightIdx = 0; weightIdx < bone->mNumWeights; weightIdx++)
+            {
+                const auto& vertexWeight = bone->mWeights[weightIdx];
+                auto& weights = vertexWeights[vertexWeight.mVertexId];
+                // Weights are limited on import, but the smallest one is replaced anyway to be safe
+                int smallest = 0;
+                for (int i = 1; i < 4; i++)
+                {
+                    if (weights[i] < weights[smallest])
+                    {
+                        smallest = i;
+                    }
+                }
+                if (vertexWeight.mWeight > weights[smallest])
+                {
+                    weights[smallest] = vertexWeight.mWeight;
+                    vertexJoints[vertexWeight.mVertexId][smallest] = jointIt->second;
+                }
+            }
+        }
+
+        for (size_t i = 0; i < vertices.size(); i++)
+        {
+            const float sum = vertexWeights[i].x + vertexWeights[i].y + vertexWeights[i].z + vertexWeights[i].w;
+            if (sum <= 0.0f)
+            {
+                continue;
+            }
+
+            glm::ivec4 quantized = glm::ivec4(glm::round(vertexWeights[i] / sum * 255.0f));
+            int largest = 0;
+            for (int c = 1; c < 4; c++)
+            {
+                if (quantized[c] > quantized[largest])
+                {
+                    largest = c;
+                }
+            }
+            // Rounding error goes to the largest weight, so weights always sum up to one on GPU
+            quantized[largest] += 255 - (quantized.x + quantized.y + quantized.z + quantized.w);
+            vertices[i].joints = glm::u8vec4(vertexJoints[i]);
+            vertices[i].weights = glm::u8vec4(quantized);
+        }
+    }
 }
 
 AssetHandle MeshLoader::Load(const std::string& aPath)
@@ -60,30 +314,63 @@ AssetHandle MeshLoader::Load(const std::string& aPath)
     return _Load(aPath, xg::Guid());
 }
 
-void MeshLoader::ProcessNode(const aiNode* node, const aiScene* scene, std::shared_ptr<MeshNode>& meshNode)
+void MeshLoader::ProcessNode(const aiNode* node, const aiScene* scene, const JointIndices& joints, MeshNodeData& meshNode)
 {
     for (uint32_t i = 0; i < node->mNumMeshes; i++)
     {
         aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
-        meshNode->meshes.push_back(ProcessMesh(mesh, scene));
+        meshNode.meshes.push_back(ProcessMesh(mesh, scene, joints));
     }
 
     for (uint32_t i = 0; i < node->mNumChildren; i++)
     {
-        auto newNode = std::make_shared<MeshNode>();
-        meshNode->children.push_back(newNode);
-        ProcessNode(node->mChildren[i], scene, meshNode);
+        meshNode.children.emplace_back();
+        ProcessNode(node->mChildren[i], scene, joints, meshNode);
     }
 }
 
-std::shared_ptr<Mesh> MeshLoader::ProcessMesh(const aiMesh* mesh, const aiScene* scene)
+VertexBufferLayout MeshLoader::GetVertexLayout()
 {
-    std::vector<Vertex> vertices;
-    std::vector<uint32_t> indexes;
+    VertexBufferLayout layout;
+    layout.Push<float>(3);
+    layout.Push<float>(3);
+    layout.Push<float>(2);
+    layout.Push<float>(3);
+    layout.Push<float>(3);
+    layout.Push<glm::u8vec4>(1, false);
+    layout.Push<glm::u8vec4>(1, true);
+    return layout;
+}
+
+std::shared_ptr<MeshNode> MeshLoader::BuildMeshNode(const MeshNodeData& meshNodeData)
+{
+    auto meshNode = std::make_shared<MeshNode>();
+    for (const auto& meshData : meshNodeData.meshes)
+    {
+        meshNode->meshes.push_back(BuildMesh(meshData.vertices, meshData.indexes));
+        meshNode->meshes.back()->SetBounds(meshData.bounds, meshData.boundingSphere);
+        meshNode->meshes.back()->SetOccluder(OccluderMesh(meshData.occluder));
+    }
+    for (const auto& childData : meshNodeData.children)
+    {
+        meshNode->children.push_back(BuildMeshNode(childData));
+    }
+    meshNode->bounds = meshNodeData.bounds;
+    meshNode->boundingSphere = meshNodeData.boundingSphere;
+    return meshNode;
+}
+
+MeshData MeshLoader::ProcessMesh(const aiMesh* mesh, const aiScene* scene, const JointIndices& joints)
+{
+    MeshData meshData;
+    auto& vertices = meshData.vertices;
+    auto& indexes = meshData.indexes;
+    vertices.reserve(mesh->mNumVertices);
+    indexes.reserve(mesh->mNumFaces * 3);
 
     for (uint32_t i = 0; i < mesh->mNumVertices; i++)
     {
-        Vertex vertex;
+        MeshVertex vertex;
 
         glm::vec3 vector;
         vector.x = mesh->mVertices[i].x;
@@ -135,6 +422,11 @@ std::shared_ptr<Mesh> MeshLoader::ProcessMesh(const aiMesh* mesh, const aiScene*
         vertices.push_back(vertex);
     }
 
+    if (mesh->HasBones() && !joints.empty())
+    {
+        ImportSkinWeights(mesh, joints, vertices);
+    }
+
     for (uint32_t i = 0; i < mesh->mNumFaces; i++)
     {
         aiFace face = mesh->mFaces[i];
@@ -144,8 +436,7 @@ std::shared_ptr<Mesh> MeshLoader::ProcessMesh(const aiMesh* mesh, const aiScene*
         }
     }
 
-    auto builtMesh = BuildMesh(vertices, indexes);
-    return builtMesh;
+    return meshData;
 }
 
 // Current supported path convention for model's textures is this:
@@ -211,8 +502,25 @@ AssetHandle MeshLoader::_Load(const std::string& path, const xg::Guid& guid)
     }
 
     const size_t lastDelimIndex = path.find_last_of('/');
-    std::string meshName = path.substr(lastDelimIndex, path.size() - 1 - lastDelimIndex);
     meshDir = path.substr(0, lastDelimIndex);
+
+    MeshNodeData meshData;
+    if (!CookedCache::Get().LoadMesh(path, meshData) && !Import(path, meshData))
+    {
+        return {};
+    }
+
+    auto meshTree = BuildMeshNode(meshData);
+    if (meshData.skeleton.GetJointCount() > 0)
+    {
+        meshTree->skeleton = std::make_shared<const Skeleton>(std::move(meshData.skeleton));
+        meshTree->animations = std::move(meshData.animations);
+    }
+    return manager->CacheAsset(meshTree, path, AssetType::MESH, guid);
+}
+
+bool MeshLoader::Import(const std::string& path, MeshNodeData& meshNode)
+{
     Assimp::Importer importer;
     auto scene = importer.ReadFile(Path::Absolute(path),
                                    aiProcess_Triangulate
@@ -222,15 +530,102 @@ AssetHandle MeshLoader::_Load(const std::string& path, const xg::Guid& guid)
                                    | aiProcess_GenUVCoords
                                    | aiProcess_OptimizeGraph
                                    | aiProcess_OptimizeMeshes
-                                   | aiProcess_JoinIdenticalVertices);
+                                   | aiProcess_JoinIdenticalVertices
+                                   | aiProcess_LimitBoneWeights);
 
     if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
     {
         R_CORE_ERROR("ASSIMP ERROR: {0}", importer.GetErrorString());
-        return {};
+        return false;
     }
 
-    auto meshTree = std::make_shared<MeshNode>();
-    ProcessNode(scene->mRootNode, scene, meshTree);
-    return manager->CacheAsset(meshTree, path, AssetType::MESH, guid);
+    JointIndices joints;
+    if (ImportSkeleton(scene, meshNode.skeleton))
+    {
+        for (uint32_t joint = 0; joint < meshNode.skeleton.GetJointCount(); joint++)
+        {
+            joints[meshNode.skeleton.jointNames[joint]] = joint;
+        }
+        ImportAnimations(scene, meshNode.skeleton, joints, meshNode.animations);
+    }
+
+    ProcessNode(scene->mRootNode, scene, joints, meshNode);
+    ComputeBounds(meshNode);
+    // Skinned meshes deform, so they never occlude
+    if (meshNode.skeleton.GetJointCount() == 0)
+    {
+        ComputeOccluders(meshNode);
+    }
+    return true;
+}
+
+void MeshLoader::ComputeOccluders(MeshNodeData& meshNode)
+{
+    for (auto& mesh : meshNode.meshes)
+    {
+        std::vector<glm::vec3> positions;
+        positions.reserve(mesh.vertices.size());
+        for (const auto& vertex : mesh.vertices)
+        {
+            positions.push_back(vertex.position);
+        }
+        std::vector<uint32_t> sequentialIndexes;
+        if (mesh.indexes.empty())
+        {
+            sequentialIndexes.resize(positions.size() - positions.size() % 3);
+            std::iota(sequentialIndexes.begin(), sequentialIndexes.end(), 0);
+        }
+        mesh.occluder = OccluderMesh::Build(positions, mesh.indexes.empty() ? sequentialIndexes : mesh.indexes, C_MAX_OCCLUDER_TRIANGLES);
+    }
+    for (auto& child : meshNode.children)
+    {
+        ComputeOccluders(child);
+    }
+}
+
+void MeshLoader::ComputeBounds(MeshNodeData& meshNode)
+{
+    meshNode.bounds = {};
+    for (auto& mesh : meshNode.meshes)
+    {
+        mesh.bounds = {};
+        for (const auto& vertex : mesh.vertices)
+        {
+            mesh.bounds.Extend(vertex.position);
+        }
+
+        // Center of the box with the farthest vertex is tighter than the box circumsphere and needs a single pass
+        float radiusSquared = 0.0f;
+        const glm::vec3 center = mesh.bounds.GetCenter();
+        for (const auto& vertex : mesh.vertices)
+        {
+            const glm::vec3 offset = vertex.position - center;
+            radiusSquared = std::max(radiusSquared, glm::dot(offset, offset));
+        }
+        mesh.boundingSphere = { center, std::sqrt(radiusSquared) };
+        meshNode.bounds.Extend(mesh.bounds);
+    }
+    for (auto& child : meshNode.children)
+    {
+        ComputeBounds(child);
+        meshNode.bounds.Extend(child.bounds);
+    }
+
+    meshNode.boundingSphere = { meshNode.bounds.GetCenter(), 0.0f };
+    const auto enclose = [&meshNode](const AABB& bounds, const Sphere& sphere)
+    {
+        if (bounds.IsValid())
+        {
+            const float radius = glm::length(sphere.center - meshNode.boundingSphere.center) + sphere.radius;
+            meshNode.boundingSphere.radius = std::max(meshNode.boundingSphere.radius, radius);
+        }
+    };
+    for (const auto& mesh : meshNode.meshes)
+    {
+        enclose(mesh.bounds, mesh.boundingSphere);
+    }
+    for (const auto& child : meshNode.children)
+    {
+        enclose(child.bounds, child.boundingSphere);
+    }
 }
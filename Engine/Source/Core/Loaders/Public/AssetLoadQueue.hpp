@@ -0,0 +1,72 @@
+#pragma once
+
+#include <crossguid/guid.hpp>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <unordered_map>
+#include <vector>
+
+namespace RightEngine
+{
+    // Requests with priority not lower than this one are needed for the first frame
+    constexpr float C_CRITICAL_LOAD_PRIORITY = 1.0f;
+
+    struct AssetLoadRequest
+    {
+        xg::Guid guid;
+        // Bigger is loaded earlier
+        float priority{ 0.0f };
+        // Requests which must be loaded before this one, e.g. material textures. Unknown GUIDs are treated as loaded
+        std::vector<xg::Guid> dependencies;
+        std::function<void()> load;
+    };
+
+    /*
+     * Loads assets on ThreadService, always starting the most important ready request first.
+     * Background requests never occupy more than a half of the workers, so critical ones which become ready later
+     * don't wait for the whole background tail. Cancellation drops all requests which weren't started yet
+     */
+    class AssetLoadQueue : public std::enable_shared_from_this<AssetLoadQueue>
+    {
+    public:
+        static std::shared_ptr<AssetLoadQueue> Create(std::vector<AssetLoadRequest>&& requests);
+
+        void WaitCritical();
+        void Wait();
+        void Cancel();
+
+        bool IsFinished() const;
+        size_t GetPendingCount() const;
+
+        AssetLoadQueue(const AssetLoadQueue& other) = delete;
+        AssetLoadQueue& operator=(const AssetLoadQueue& other) = delete;
+
+    private:
+        struct Entry
+        {
+            AssetLoadRequest request;
+            size_t dependencyCount{ 0 };
+            std::vector<xg::Guid> dependents;
+            bool running{ false };
+        };
+
+        std::unordered_map<xg::Guid, Entry> m_entries;
+        std::vector<xg::Guid> m_ready;
+        size_t m_running{ 0 };
+        size_t m_runningBackground{ 0 };
+        size_t m_pendingCritical{ 0 };
+        size_t m_maxRunning{ 1 };
+        bool m_cancelled{ false };
+        mutable std::mutex m_mutex;
+        std::condition_variable m_condition;
+
+        AssetLoadQueue() = default;
+
+        void Pump();
+        void Run(const xg::Guid& guid);
+        void PushReady(const xg::Guid& guid);
+        bool PopReady(xg::Guid& guid);
+    };
+}
@@ -12,6 +12,8 @@
 
 namespace RightEngine
 {
+    constexpr const char* C_DEFAULT_TEXTURE_PATH = "/Textures/editor_default_image.png";
+
     class AssetManager
     {
     public:
@@ -98,6 +100,7 @@ namespace RightEngine
         }
 
         const AssetHandle& GetDefaultTexture() const;
+        const AssetHandle& GetDefaultOrmTexture() const;
         const AssetHandle& GetDefaultMaterial() const;
         const AssetHandle& GetDefaultSkybox() const;
 
@@ -113,6 +116,7 @@ namespace RightEngine
         std::shared_mutex m_assetCacheMutex;
 
         mutable AssetHandle defaultTexture;
+        mutable AssetHandle defaultOrmTexture;
         mutable AssetHandle defaultMaterial;
         mutable AssetHandle defaultSkybox;
 
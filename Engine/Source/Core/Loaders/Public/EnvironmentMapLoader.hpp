@@ -6,6 +6,24 @@
 
 namespace RightEngine
 {
+    struct EnvironmentMapSettings
+    {
+        // Face sizes of the output cubemaps
+        uint32_t environmentSize{ 2048 };
+        uint32_t irradianceSize{ 64 };
+        uint32_t prefilterSize{ 128 };
+        // Environment and prefilter cubemaps are stored as BC6H if device supports it
+        bool compress{ true };
+
+        bool operator==(const EnvironmentMapSettings& other) const
+        {
+            return environmentSize == other.environmentSize
+                   && irradianceSize == other.irradianceSize
+                   && prefilterSize == other.prefilterSize
+                   && compress == other.compress;
+        }
+    };
+
     struct EnvironmentContext : public AssetBase
     {
         ASSET_BASE()
@@ -15,9 +33,10 @@ namespace RightEngine
         std::shared_ptr<Texture> prefilterMap;
         std::shared_ptr<Texture> brdfLut;
 
-        //TODO: Add EDITOR compile flag
+        // Source panorama, kept only if loader was asked to retain it
         std::shared_ptr<Texture> equirectangularTexture;
         std::string name;
+        EnvironmentMapSettings settings;
     };
 
     struct EnvironmentMapLoaderContext
@@ -32,8 +51,25 @@ namespace RightEngine
         EnvironmentMapLoader();
         ~EnvironmentMapLoader() = default;
 
-        AssetHandle Load(const std::string& path, bool flipVertically = false);
-        AssetHandle LoadWithGUID(const std::string& path, const xg::Guid& guid, bool flipVertically = false);
+        AssetHandle Load(const std::string& path,
+                         bool flipVertically = false,
+                         const EnvironmentMapSettings& settings = {});
+        AssetHandle LoadWithGUID(const std::string& path,
+                                 const xg::Guid& guid,
+                                 bool flipVertically = false,
+                                 const EnvironmentMapSettings& settings = {});
+
+        /*
+         * Recomputes already loaded environment with new settings, asset keeps its GUID
+         */
+        AssetHandle Reload(const AssetHandle& handle, const EnvironmentMapSettings& settings);
+
+        /*
+         * Equirectangular source is released right after convolution,
+         * editor must ask to keep it before loading environments to show their previews
+         */
+        void SetRetainEquirectangular(bool retain)
+        { m_retainEquirectangular = retain; }
 
     private:
         void ComputeEnvironmentMap();
@@ -41,10 +77,15 @@ namespace RightEngine
         void ComputeRadianceMap();
         void ComputeLUT();
         AssetHandle FinishLoading(const xg::Guid& guid);
-        AssetHandle _Load(const std::string& path, const xg::Guid& guid, bool flipVertically);
+        AssetHandle _Load(const std::string& path,
+                          const xg::Guid& guid,
+                          bool flipVertically,
+                          const EnvironmentMapSettings& settings);
+        AssetHandle Compute(const std::string& path, const xg::Guid& guid, const EnvironmentMapSettings& settings);
 
         std::shared_ptr<EnvironmentContext> m_environmentContext;
         EnvironmentMapLoaderContext m_loaderContext;
         std::shared_ptr<Texture> m_lut;
+        bool m_retainEquirectangular{ false };
     };
 }
@@ -2,7 +2,12 @@
 
 #include "AssetBase.hpp"
 #include "Components.hpp"
+#include "Animation.hpp"
+#include "Bounds.hpp"
+#include "TriangleBvh.hpp"
+#include "OcclusionBuffer.hpp"
 #include <assimp/scene.h>
+#include <glm/gtc/type_precision.hpp>
 #include <vector>
 #include <unordered_map>
 
@@ -27,10 +32,71 @@ namespace RightEngine
         const std::shared_ptr<VertexBufferLayout>& GetVertexLayout() const
         { return vertexLayout; }
 
+        // Positions in mesh space for CPU ray casts, empty for meshes created from GPU buffers only
+        const AABB& GetBounds() const
+        { return bounds; }
+        const Sphere& GetBoundingSphere() const
+        { return boundingSphere; }
+        void SetBounds(const AABB& aBounds, const Sphere& aBoundingSphere)
+        {
+            bounds = aBounds;
+            boundingSphere = aBoundingSphere;
+        }
+
+        // Empty unless the mesh was imported with an occluder
+        const OccluderMesh& GetOccluder() const
+        { return occluder; }
+        void SetOccluder(OccluderMesh&& anOccluder)
+        { occluder = std::move(anOccluder); }
+
+        const TriangleBvh& GetTriangleBvh() const
+        { return triangleBvh; }
+        void SetTriangleBvh(TriangleBvh&& aTriangleBvh)
+        { triangleBvh = std::move(aTriangleBvh); }
+
     private:
         std::shared_ptr<Buffer> vertexBuffer;
         std::shared_ptr<Buffer> indexBuffer;
         std::shared_ptr<VertexBufferLayout> vertexLayout;
+        AABB bounds;
+        Sphere boundingSphere;
+        TriangleBvh triangleBvh;
+        OccluderMesh occluder;
+    };
+
+    struct MeshVertex
+    {
+        glm::vec3 position;
+        glm::vec3 normal;
+        glm::vec2 uv;
+        glm::vec3 tangent;
+        glm::vec3 biTangent;
+        // Up to 4 skeleton joints with unorm weights, static vertices are fully bound to the root joint
+        glm::u8vec4 joints{ 0 };
+        glm::u8vec4 weights{ 255, 0, 0, 0 };
+    };
+
+    // CPU side mesh representation, produced by import or read from the cooked cache
+    struct MeshData
+    {
+        std::vector<MeshVertex> vertices;
+        std::vector<uint32_t> indexes;
+        // Mesh space, computed at import
+        AABB bounds;
+        Sphere boundingSphere;
+        OccluderMesh occluder;
+    };
+
+    struct MeshNodeData
+    {
+        std::vector<MeshData> meshes;
+        std::vector<MeshNodeData> children;
+        // Cover meshes of the node and all its children
+        AABB bounds;
+        Sphere boundingSphere;
+        // Skeleton is empty for static meshes, only the root node has skinning data
+        Skeleton skeleton;
+        std::vector<AnimationClip> animations;
     };
 
     struct MeshNode : public AssetBase
@@ -39,6 +105,11 @@ namespace RightEngine
 
         std::vector<std::shared_ptr<Mesh>> meshes;
         std::vector<std::shared_ptr<MeshNode>> children;
+        // Covers meshes of the node and all its children, skinned meshes are bounded in bind pose
+        AABB bounds;
+        Sphere boundingSphere;
+        std::shared_ptr<const Skeleton> skeleton;
+        std::vector<AnimationClip> animations;
     };
 
     class MeshLoader : public AssetLoader
@@ -54,12 +125,27 @@ namespace RightEngine
 
         AssetHandle LoadWithGUID(const std::string& path, const xg::Guid& guid);
 
+        /*
+         * Imports mesh source file without touching GPU, so it can be used by offline tools
+         */
+        static bool Import(const std::string& path, MeshNodeData& meshNode);
+
+        // Fills bounds of all meshes and nodes of the tree from vertex positions
+        static void ComputeBounds(MeshNodeData& meshNode);
+        static void ComputeOccluders(MeshNodeData& meshNode);
+
+        // Layout of MeshVertex buffers
+        static VertexBufferLayout GetVertexLayout();
+
     private:
         std::string meshDir;
         std::unordered_map<std::string, std::shared_ptr<Texture>> loadedTextures;
 
-        void ProcessNode(const aiNode* node, const aiScene* scene, std::shared_ptr<MeshNode>& meshNode);
-        std::shared_ptr<Mesh> ProcessMesh(const aiMesh* mesh, const aiScene* scene);
+        using JointIndices = std::unordered_map<std::string, uint32_t>;
+
+        static void ProcessNode(const aiNode* node, const aiScene* scene, const JointIndices& joints, MeshNodeData& meshNode);
+        static MeshData ProcessMesh(const aiMesh* mesh, const aiScene* scene, const JointIndices& joints);
+        static std::shared_ptr<MeshNode> BuildMeshNode(const MeshNodeData& meshNodeData);
         std::vector<std::shared_ptr<Texture>> LoadTextures(const aiMaterial* mat, aiTextureType type);
         AssetHandle _Load(const std::string& path, const xg::Guid& guid);
     };
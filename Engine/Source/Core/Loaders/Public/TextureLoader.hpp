@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Texture.hpp"
+#include "Material.hpp"
 #include "AssetLoader.hpp"
 #include <string>
 #include <vector>
@@ -29,10 +30,30 @@ namespace RightEngine
                                  const TextureLoaderOptions& options = {},
                                  const xg::Guid& guid = {}) const;
 
-    private:
+        /*
+         * Packs occlusion, roughness and metallic sources into a single linear RGBA8 texture.
+         * Result is cached by sources, so materials sharing the same images share the texture
+         */
+        AssetHandle LoadOrm(const OrmSources& sources) const;
+
+        /*
+         * Single channel and grayscale sources are read from R channel,
+         * colored ones are expected to be already packed in ORM layout and read from their own channel
+         */
+        std::pair<std::vector<uint8_t>, TextureDescriptor> PackOrm(const OrmSources& sources) const;
+
+        /*
+         * Decodes texture source file without touching GPU, so it can be used by offline tools
+         */
         std::pair<std::vector<uint8_t>, TextureDescriptor> LoadTextureData(const std::string& path,
                                                                            const TextureLoaderOptions& options = {}) const;
 
+        /*
+         * Same as LoadTextureData with default options, but prefers cooked data when it's up to date
+         */
+        std::pair<std::vector<uint8_t>, TextureDescriptor> LoadSourceData(const std::string& path) const;
+
+    private:
         AssetHandle _Load(const std::string& path, const TextureLoaderOptions& options, const xg::Guid& guid) const;
     };
 }
@@ -5,9 +5,12 @@
 #include "AssetManager.hpp"
 #include "Application.hpp"
 #include "ThreadService.hpp"
+#include "CookedCache.hpp"
 #include <stb_image.h>
 #include <stb_image_write.h>
 #include <fstream>
+#include <array>
+#include <algorithm>
 
 using namespace RightEngine;
 
@@ -55,6 +58,30 @@ namespace
             R_CORE_ASSERT(false, "");
         }
     }
+
+    struct OrmChannelSource
+    {
+        std::vector<uint8_t> data;
+        TextureDescriptor descriptor;
+        int channel{ 0 };
+    };
+
+    int DetectOrmChannel(const std::vector<uint8_t>& data, int componentAmount, int packedChannel)
+    {
+        if (componentAmount < 3)
+        {
+            return 0;
+        }
+
+        for (size_t i = 0; i + 2 < data.size(); i += componentAmount)
+        {
+            if (data[i] != data[i + 1] || data[i] != data[i + 2])
+            {
+                return packedChannel;
+            }
+        }
+        return 0;
+    }
 }
 
 std::pair<std::vector<uint8_t>, TextureDescriptor>TextureLoader::LoadTextureData(const std::string& path,
@@ -183,9 +210,104 @@ AssetHandle TextureLoader::_Load(const std::string& path,
         return { asset->guid };
     }
 
-    auto [data, descriptor] = LoadTextureData(path, options);
+    // Cooker bakes textures with default options only
+    const bool canUseCooked = options.chooseFormat && options.flipVertically;
+    auto [data, descriptor] = canUseCooked ? LoadSourceData(path) : LoadTextureData(path, options);
     descriptor.type = options.type;
     auto texture = Device::Get()->CreateTexture(descriptor, data);
     texture->SetSampler(Device::Get()->CreateSampler({}));
     return manager->CacheAsset(texture, path, AssetType::IMAGE, guid);
 }
+
+AssetHandle TextureLoader::LoadOrm(const OrmSources& sources) const
+{
+    R_CORE_ASSERT(manager, "");
+
+    const auto path = sources.GetKey();
+    const auto asset = manager->GetAsset<Texture>(path);
+    if (asset)
+    {
+        return { asset->guid };
+    }
+
+    std::vector<uint8_t> data;
+    TextureDescriptor descriptor;
+    if (!CookedCache::Get().LoadOrm(sources, descriptor, data))
+    {
+        std::tie(data, descriptor) = PackOrm(sources);
+    }
+    descriptor.type = TextureType::TEXTURE_2D;
+    auto texture = Device::Get()->CreateTexture(descriptor, data);
+    texture->SetSampler(Device::Get()->CreateSampler({}));
+    return manager->CacheAsset(texture, path, AssetType::IMAGE);
+}
+
+std::pair<std::vector<uint8_t>, TextureDescriptor> TextureLoader::PackOrm(const OrmSources& sources) const
+{
+    constexpr int C_ORM_COMPONENTS = 4;
+    const std::array<const std::string*, 3> paths = { &sources.occlusion, &sources.roughness, &sources.metallic };
+    std::array<OrmChannelSource, 3> channels;
+
+    TextureDescriptor descriptor;
+    descriptor.width = 1;
+    descriptor.height = 1;
+    descriptor.componentAmount = C_ORM_COMPONENTS;
+    descriptor.format = Format::RGBA8_UNORM;
+
+    for (int i = 0; i < 3; i++)
+    {
+        if (paths[i]->empty())
+        {
+            continue;
+        }
+
+        auto& channel = channels[i];
+        std::tie(channel.data, channel.descriptor) = LoadSourceData(*paths[i]);
+        if (channel.descriptor.format == Format::RGBA32_SFLOAT)
+        {
+            R_CORE_WARN("HDR texture {0} can't be packed to ORM, ignoring it", *paths[i]);
+            channel.data.clear();
+            continue;
+        }
+        channel.channel = DetectOrmChannel(channel.data, channel.descriptor.componentAmount, i);
+        descriptor.width = std::max(descriptor.width, channel.descriptor.width);
+        descriptor.height = std::max(descriptor.height, channel.descriptor.height);
+    }
+
+    std::vector<uint8_t> data(descriptor.GetTextureSize(), 255);
+    for (int i = 0; i < 3; i++)
+    {
+        const auto& channel = channels[i];
+        if (channel.data.empty())
+        {
+            continue;
+        }
+
+        // Sources of different size are nearest sampled up to the biggest one
+        const auto& srcDescriptor = channel.descriptor;
+        for (int y = 0; y < descriptor.height; y++)
+        {
+            const size_t srcY = static_cast<size_t>(y) * srcDescriptor.height / descriptor.height;
+            for (int x = 0; x < descriptor.width; x++)
+            {
+                const size_t srcX = static_cast<size_t>(x) * srcDescriptor.width / descriptor.width;
+                const size_t srcIndex = (srcY * srcDescriptor.width + srcX) * srcDescriptor.componentAmount + channel.channel;
+                const size_t dstIndex = (static_cast<size_t>(y) * descriptor.width + x) * C_ORM_COMPONENTS + i;
+                data[dstIndex] = channel.data[srcIndex];
+            }
+        }
+    }
+
+    return { data, descriptor };
+}
+
+std::pair<std::vector<uint8_t>, TextureDescriptor> TextureLoader::LoadSourceData(const std::string& path) const
+{
+    std::vector<uint8_t> data;
+    TextureDescriptor descriptor;
+    if (CookedCache::Get().LoadTexture(path, descriptor, data))
+    {
+        return { data, descriptor };
+    }
+    return LoadTextureData(path);
+}
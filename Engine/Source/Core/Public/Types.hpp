@@ -38,6 +38,7 @@ namespace RightEngine
         RGBA16_UNORM,
         RGB16_UNORM,
         BGRA8_UNORM,
+        RGBA8_UNORM,
 
         //sRGB formats
         R8_SRGB,
@@ -48,7 +49,10 @@ namespace RightEngine
         //Depth buffer formats
         D24_UNORM_S8_UINT,
         D32_SFLOAT_S8_UINT,
-        D32_SFLOAT
+        D32_SFLOAT,
+
+        //Block compressed formats
+        BC6H_UFLOAT
     };
 
     enum class PresentMode
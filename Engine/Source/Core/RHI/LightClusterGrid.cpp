@@ -0,0 +1,228 @@
+#include "LightClusterGrid.hpp"
+#include "Application.hpp"
+#include "ThreadService.hpp"
+#include "Simd.hpp"
+#include "Assert.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+using namespace RightEngine;
+
+namespace
+{
+    constexpr size_t C_GROUP_SIZE = 4;
+    // Groups of 4 lights per transform task, typical scenes are transformed on the calling thread
+    constexpr size_t C_LIGHT_GROUPS_PER_BATCH = 256;
+    constexpr uint32_t C_TILES_PER_SLICE = LightClusterGrid::C_TILES_X * LightClusterGrid::C_TILES_Y;
+}
+
+void LightClusterGrid::Build(const glm::mat4& view,
+                             const glm::mat4& projection,
+                             float zNear,
+                             float zFar,
+                             const std::vector<ClusterLight>& lights,
+                             size_t maxIndices)
+{
+    R_CORE_ASSERT(zNear > 0.0f && zFar > zNear, "");
+    m_zNear = zNear;
+    m_zFar = zFar;
+    const float logRatio = std::log(zFar / zNear);
+    m_sliceScale = static_cast<float>(C_SLICES) / logRatio;
+    m_sliceBias = -static_cast<float>(C_SLICES) * std::log(zNear) / logRatio;
+
+    const size_t groupCount = (lights.size() + C_GROUP_SIZE - 1) / C_GROUP_SIZE;
+    m_viewX.resize(groupCount * C_GROUP_SIZE);
+    m_viewY.resize(groupCount * C_GROUP_SIZE);
+    m_depth.resize(groupCount * C_GROUP_SIZE);
+    m_radius.resize(groupCount * C_GROUP_SIZE);
+    m_indices.resize(groupCount * C_GROUP_SIZE);
+
+    auto& threadService = Instance().Service<ThreadService>();
+    threadService.ParallelFor(groupCount, C_LIGHT_GROUPS_PER_BATCH, [&](size_t begin, size_t end)
+    {
+        TransformLights(view, lights, begin, end);
+    });
+
+    m_sliceRects.resize(C_SLICES);
+    m_clusters.assign(C_CLUSTER_COUNT, { 0, 0 });
+    threadService.ParallelFor(C_SLICES, 1, [&](size_t begin, size_t end)
+    {
+        for (size_t slice = begin; slice < end; slice++)
+        {
+            BuildSlice(static_cast<uint32_t>(slice), projection);
+        }
+    });
+
+    // Near slices come first, so an overflow only drops lights of the far ones
+    uint32_t offset = 0;
+    size_t droppedCount = 0;
+    for (auto& cluster : m_clusters)
+    {
+        const uint32_t count = std::min<uint32_t>(cluster.count, static_cast<uint32_t>(maxIndices - offset));
+        droppedCount += cluster.count - count;
+        cluster.offset = offset;
+        cluster.count = count;
+        offset += count;
+    }
+    if (droppedCount > 0)
+    {
+        R_CORE_WARN("Light index list is full, {0} cluster lights are dropped", droppedCount);
+    }
+
+    m_lightIndices.resize(offset);
+    threadService.ParallelFor(C_SLICES, 1, [&](size_t begin, size_t end)
+    {
+        for (size_t slice = begin; slice < end; slice++)
+        {
+            FillSlice(static_cast<uint32_t>(slice));
+        }
+    });
+}
+
+void LightClusterGrid::TransformLights(const glm::mat4& view,
+                                       const std::vector<ClusterLight>& lights,
+                                       size_t beginGroup,
+                                       size_t endGroup)
+{
+    using namespace simd;
+
+    for (size_t group = beginGroup; group < endGroup; group++)
+    {
+        float x[C_GROUP_SIZE];
+        float y[C_GROUP_SIZE];
+        float z[C_GROUP_SIZE];
+        const size_t first = group * C_GROUP_SIZE;
+        for (size_t lane = 0; lane < C_GROUP_SIZE; lane++)
+        {
+            const size_t light = first + lane;
+            const bool isPadding = light >= lights.size();
+            x[lane] = isPadding ? 0.0f : lights[light].position.x;
+            y[lane] = isPadding ? 0.0f : lights[light].position.y;
+            z[lane] = isPadding ? 0.0f : lights[light].position.z;
+            m_radius[light] = isPadding ? -1.0f : lights[light].radius;
+            m_indices[light] = isPadding ? 0 : lights[light].index;
+        }
+
+        const Float4 px = Load(x);
+        const Float4 py = Load(y);
+        const Float4 pz = Load(z);
+        const auto row = [&](int r)
+        {
+            return MulAdd(Splat(view[0][r]), px, MulAdd(Splat(view[1][r]), py, MulAdd(Splat(view[2][r]), pz, Splat(view[3][r]))));
+        };
+        Store(&m_viewX[first], row(0));
+        Store(&m_viewY[first], row(1));
+        // Camera looks down -Z, depth is positive in front of it
+        Store(&m_depth[first], Sub(Splat(0.0f), row(2)));
+    }
+}
+
+void LightClusterGrid::BuildSlice(uint32_t slice, const glm::mat4& projection)
+{
+    using namespace simd;
+
+    auto& rects = m_sliceRects[slice];
+    rects.clear();
+
+    const float ratio = m_zFar / m_zNear;
+    const Float4 sliceNear = Splat(m_zNear * std::pow(ratio, static_cast<float>(slice) / C_SLICES));
+    const Float4 sliceFar = Splat(m_zNear * std::pow(ratio, static_cast<float>(slice + 1) / C_SLICES));
+    const Float4 zero = Splat(0.0f);
+    const Float4 one = Splat(1.0f);
+    const Float4 half = Splat(0.5f);
+    const Float4 scaleX = Splat(projection[0][0]);
+    const Float4 scaleY = Splat(projection[1][1]);
+    const Float4 offsetX = Splat(projection[2][0]);
+    const Float4 offsetY = Splat(projection[2][1]);
+    const Float4 tilesX = Splat(static_cast<float>(C_TILES_X));
+    const Float4 tilesY = Splat(static_cast<float>(C_TILES_Y));
+
+    for (size_t first = 0; first < m_depth.size(); first += C_GROUP_SIZE)
+    {
+        const Float4 depth = Load(&m_depth[first]);
+        const Float4 radius = Load(&m_radius[first]);
+        // Part of the sphere bounding box inside the slice
+        const Float4 minDepth = Max(Sub(depth, radius), sliceNear);
+        const Float4 maxDepth = Min(Add(depth, radius), sliceFar);
+        const int culledMask = MoveMask(Or(Less(maxDepth, minDepth), Less(radius, zero)));
+        if (culledMask == 0xF)
+        {
+            continue;
+        }
+
+        /*
+         * NDC x of a view space point is scaleX * x / depth - offsetX, so the extremes of the clipped box
+         * are reached on its nearest or furthest face
+         */
+        const Float4 invMinDepth = Div(one, minDepth);
+        const Float4 invMaxDepth = Div(one, maxDepth);
+        const Float4 viewX = Load(&m_viewX[first]);
+        const Float4 viewY = Load(&m_viewY[first]);
+        const Float4 x0 = Sub(viewX, radius);
+        const Float4 x1 = Add(viewX, radius);
+        const Float4 y0 = Sub(viewY, radius);
+        const Float4 y1 = Add(viewY, radius);
+        const Float4 ndcMinX = Sub(Mul(scaleX, Min(Mul(x0, invMinDepth), Mul(x0, invMaxDepth))), offsetX);
+        const Float4 ndcMaxX = Sub(Mul(scaleX, Max(Mul(x1, invMinDepth), Mul(x1, invMaxDepth))), offsetX);
+        const Float4 ndcMinY = Sub(Mul(scaleY, Min(Mul(y0, invMinDepth), Mul(y0, invMaxDepth))), offsetY);
+        const Float4 ndcMaxY = Sub(Mul(scaleY, Max(Mul(y1, invMinDepth), Mul(y1, invMaxDepth))), offsetY);
+
+        // Tile rows go from the top of the image, NDC y of the unflipped projection goes up
+        float minTileX[C_GROUP_SIZE];
+        float maxTileX[C_GROUP_SIZE];
+        float minTileY[C_GROUP_SIZE];
+        float maxTileY[C_GROUP_SIZE];
+        Store(minTileX, Mul(MulAdd(ndcMinX, half, half), tilesX));
+        Store(maxTileX, Mul(MulAdd(ndcMaxX, half, half), tilesX));
+        Store(minTileY, Mul(Sub(half, Mul(ndcMaxY, half)), tilesY));
+        Store(maxTileY, Mul(Sub(half, Mul(ndcMinY, half)), tilesY));
+
+        for (size_t lane = 0; lane < C_GROUP_SIZE; lane++)
+        {
+            if ((culledMask & (1 << lane))
+                || maxTileX[lane] < 0.0f || minTileX[lane] >= static_cast<float>(C_TILES_X)
+                || maxTileY[lane] < 0.0f || minTileY[lane] >= static_cast<float>(C_TILES_Y))
+            {
+                continue;
+            }
+
+            LightRect rect;
+            rect.index = m_indices[first + lane];
+            rect.minX = static_cast<uint8_t>(std::max(minTileX[lane], 0.0f));
+            rect.maxX = static_cast<uint8_t>(std::min(maxTileX[lane], static_cast<float>(C_TILES_X - 1)));
+            rect.minY = static_cast<uint8_t>(std::max(minTileY[lane], 0.0f));
+            rect.maxY = static_cast<uint8_t>(std::min(maxTileY[lane], static_cast<float>(C_TILES_Y - 1)));
+            rects.push_back(rect);
+
+            for (uint32_t y = rect.minY; y <= rect.maxY; y++)
+            {
+                for (uint32_t x = rect.minX; x <= rect.maxX; x++)
+                {
+                    m_clusters[slice * C_TILES_PER_SLICE + y * C_TILES_X + x].count++;
+                }
+            }
+        }
+    }
+}
+
+void LightClusterGrid::FillSlice(uint32_t slice)
+{
+    std::array<uint32_t, C_TILES_PER_SLICE> filled{};
+    const uint32_t firstCluster = slice * C_TILES_PER_SLICE;
+    for (const auto& rect : m_sliceRects[slice])
+    {
+        for (uint32_t y = rect.minY; y <= rect.maxY; y++)
+        {
+            for (uint32_t x = rect.minX; x <= rect.maxX; x++)
+            {
+                const uint32_t tile = y * C_TILES_X + x;
+                const auto& cluster = m_clusters[firstCluster + tile];
+                if (filled[tile] < cluster.count)
+                {
+                    m_lightIndices[cluster.offset + filled[tile]++] = rect.index;
+                }
+            }
+        }
+    }
+}
@@ -8,8 +8,6 @@ RightEngine::TextureData::TextureData()
     auto& assetManager = AssetManager::Get();
     albedo = assetManager.GetDefaultTexture();
     normal = assetManager.GetDefaultTexture();
-    metallic = assetManager.GetDefaultTexture();
-    roughness = assetManager.GetDefaultTexture();
-    ao = assetManager.GetDefaultTexture();
+    orm = assetManager.GetDefaultOrmTexture();
 }
 
@@ -12,6 +12,8 @@ namespace RightEngine
         INDEX = BIT(3),
         UNIFORM = BIT(4),
         CONSTANT = BIT(5),
+        // Read only in shaders, for arrays too large for uniform buffers
+        STORAGE = BIT(6),
     };
 
     struct BufferDescriptor
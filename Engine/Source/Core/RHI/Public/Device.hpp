@@ -25,6 +25,7 @@ namespace RightEngine
     struct DeviceProperties
     {
         size_t minUniformBufferOffsetAlignment;
+        bool textureCompressionBC{ false };
     };
 
     class Device : public std::enable_shared_from_this<Device>
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "SceneRenderer.hpp"
+#include "RenderProxy.hpp"
+
+namespace RightEngine
+{
+    struct ImGuiDrawData;
+
+    /*
+     * Everything the render thread needs to draw one frame, extracted from the ECS at the end of the game update.
+     * Packet is immutable while the render thread owns it, assets are kept alive by it until the frame is submitted
+     */
+    struct FramePacket
+    {
+        CameraData camera{};
+        std::shared_ptr<EnvironmentContext> environment;
+        std::vector<LightData> lights;
+        SceneRendererSettings settings;
+        RenderProxies proxies;
+        // Assets indexed by proxy mesh and material ids
+        std::vector<std::shared_ptr<MeshNode>> meshAssets;
+        std::vector<std::shared_ptr<Material>> materialAssets;
+        // Copies of animator palettes, one per entry of proxies.animated
+        std::vector<std::vector<glm::vec4>> skinningPalettes;
+        std::shared_ptr<ImGuiDrawData> ui;
+        uint64_t frameIndex{ 0 };
+
+        // Drops asset references, vectors keep their capacity for the next frame
+        void Clear()
+        {
+            environment.reset();
+            lights.clear();
+            proxies.Clear();
+            meshAssets.clear();
+            materialAssets.clear();
+            skinningPalettes.clear();
+            ui.reset();
+        }
+    };
+}
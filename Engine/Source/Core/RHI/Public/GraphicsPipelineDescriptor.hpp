@@ -3,6 +3,7 @@
 #include <glm/vec2.hpp>
 #include <memory>
 #include <unordered_map>
+#include <vector>
 
 namespace RightEngine
 {
@@ -28,6 +29,8 @@ namespace RightEngine
         std::shared_ptr<Shader> shader;
         CompareOp depthCompareOp{ CompareOp::LESS };
         CullMode cullMode{ CullMode::BACK };
+        // Vertex shader specialization constants, the index is the constant_id
+        std::vector<uint32_t> vertexConstants;
     };
 
     enum class AttachmentLoadOperation
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+#include <cstdint>
+
+namespace RightEngine
+{
+    // Point light as seen by clustering, only lights within radius of a fragment contribute to it
+    struct ClusterLight
+    {
+        glm::vec3 position;
+        float radius;
+        // Index in the light buffer of the frame
+        uint32_t index;
+    };
+
+    /*
+     * View frustum split into screen tiles and exponential depth slices. Every frame lights are assigned to
+     * clusters on CPU: view space spheres are computed 4 lights at a time with SIMD, then every depth slice
+     * builds screen rects of the lights it intersects and fills its clusters independently of other slices.
+     * Result is a compact (offset, count) range per cluster into one light index list
+     */
+    class LightClusterGrid
+    {
+    public:
+        static constexpr uint32_t C_TILES_X = 16;
+        static constexpr uint32_t C_TILES_Y = 9;
+        static constexpr uint32_t C_SLICES = 24;
+        static constexpr uint32_t C_CLUSTER_COUNT = C_TILES_X * C_TILES_Y * C_SLICES;
+
+        // Cluster index of (x, y, slice) is x + C_TILES_X * (y + C_TILES_Y * slice), tile 0 is top left
+        struct Cluster
+        {
+            uint32_t offset;
+            uint32_t count;
+        };
+
+        /*
+         * Projection must be the unflipped right handed one, its depth range is only used through zNear and zFar.
+         * Indices over maxIndices are dropped from the furthest clusters
+         */
+        void Build(const glm::mat4& view,
+                   const glm::mat4& projection,
+                   float zNear,
+                   float zFar,
+                   const std::vector<ClusterLight>& lights,
+                   size_t maxIndices);
+
+        const std::vector<Cluster>& GetClusters() const
+        { return m_clusters; }
+
+        const std::vector<uint32_t>& GetLightIndices() const
+        { return m_lightIndices; }
+
+        // Slice of a positive view depth is floor(log(depth) * scale + bias)
+        float GetSliceScale() const
+        { return m_sliceScale; }
+
+        float GetSliceBias() const
+        { return m_sliceBias; }
+
+    private:
+        struct LightRect
+        {
+            uint32_t index;
+            uint8_t minX;
+            uint8_t maxX;
+            uint8_t minY;
+            uint8_t maxY;
+        };
+
+        void TransformLights(const glm::mat4& view, const std::vector<ClusterLight>& lights, size_t beginGroup, size_t endGroup);
+        void BuildSlice(uint32_t slice, const glm::mat4& projection);
+        void FillSlice(uint32_t slice);
+
+        // View space lights in SoA groups of 4, padding lanes have negative radius
+        std::vector<float> m_viewX;
+        std::vector<float> m_viewY;
+        std::vector<float> m_depth;
+        std::vector<float> m_radius;
+        std::vector<uint32_t> m_indices;
+
+        std::vector<std::vector<LightRect>> m_sliceRects;
+        std::vector<Cluster> m_clusters;
+        std::vector<uint32_t> m_lightIndices;
+        float m_zNear{ 0.1f };
+        float m_zFar{ 500.0f };
+        float m_sliceScale{ 0.0f };
+        float m_sliceBias{ 0.0f };
+    };
+}
@@ -4,6 +4,7 @@
 #include <glm/vec4.hpp>
 #include <glm/vec3.hpp>
 #include <memory>
+#include <string>
 
 namespace RightEngine
 {
@@ -14,15 +15,39 @@ namespace RightEngine
         float roughness{ 1.0f };
     };
 
+    /*
+     * Engine paths of the images packed into single ORM texture (R - occlusion, G - roughness, B - metallic).
+     * Empty path means that channel is constant 1.0, so shader falls back to material scalar values
+     */
+    struct OrmSources
+    {
+        std::string occlusion;
+        std::string roughness;
+        std::string metallic;
+
+        bool IsEmpty() const
+        { return occlusion.empty() && roughness.empty() && metallic.empty(); }
+
+        // Asset path of the packed texture
+        std::string GetKey() const
+        { return "/ORM/" + occlusion + "|" + roughness + "|" + metallic; }
+
+        bool operator==(const OrmSources& other) const
+        {
+            return occlusion == other.occlusion
+                   && roughness == other.roughness
+                   && metallic == other.metallic;
+        }
+    };
+
     struct TextureData
     {
         TextureData();
 
         AssetHandle albedo;
         AssetHandle normal;
-        AssetHandle metallic;
-        AssetHandle roughness;
-        AssetHandle ao;
+        AssetHandle orm;
+        OrmSources ormSources;
     };
 
     struct Material : public AssetBase
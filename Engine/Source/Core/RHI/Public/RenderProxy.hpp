@@ -0,0 +1,187 @@
+#pragma once
+
+#include "Scene.hpp"
+#include "MeshLoader.hpp"
+#include "Material.hpp"
+#include "AssetManager.hpp"
+#include "StaticBatcher.hpp"
+#include <unordered_map>
+#include <limits>
+#include <mutex>
+
+namespace RightEngine
+{
+    constexpr uint32_t C_INVALID_RENDER_ASSET = std::numeric_limits<uint32_t>::max();
+
+    /*
+     * Dense ids of assets referenced by render proxies. Lookups never lock or touch reference counts,
+     * so they are safe from any thread while nothing is added. Assets which are still streamed in
+     * keep their id and are resolved again at the next Refresh
+     */
+    template<typename T>
+    class RenderAssetTable
+    {
+    public:
+        // C_INVALID_RENDER_ASSET when the asset was never added
+        uint32_t Find(const xg::Guid& guid) const
+        {
+            const auto it = m_ids.find(guid);
+            return it == m_ids.end() ? C_INVALID_RENDER_ASSET : it->second;
+        }
+
+        // Main thread only
+        uint32_t Add(const xg::Guid& guid)
+        {
+            const auto [it, isAdded] = m_ids.emplace(guid, static_cast<uint32_t>(m_assets.size()));
+            if (isAdded)
+            {
+                m_guids.push_back(guid);
+                m_assets.push_back(AssetManager::Get().GetAsset<T>(AssetHandle{ guid }));
+                if (!m_assets.back())
+                {
+                    m_pending.push_back(it->second);
+                }
+            }
+            return it->second;
+        }
+
+        // Main thread only, retries assets which weren't loaded when they were added
+        void Refresh()
+        {
+            size_t pendingCount = 0;
+            for (const uint32_t id : m_pending)
+            {
+                m_assets[id] = AssetManager::Get().GetAsset<T>(AssetHandle{ m_guids[id] });
+                if (!m_assets[id])
+                {
+                    m_pending[pendingCount++] = id;
+                }
+            }
+            m_pending.resize(pendingCount);
+        }
+
+        // Main thread only, keeps assets with a set used flag, ids of the kept ones change
+        void Retain(const std::vector<uint8_t>& used)
+        {
+            const auto guids = std::move(m_guids);
+            auto assets = std::move(m_assets);
+            Clear();
+            for (size_t id = 0; id < guids.size(); id++)
+            {
+                if (!used[id])
+                {
+                    continue;
+                }
+                m_ids.emplace(guids[id], static_cast<uint32_t>(m_assets.size()));
+                if (!assets[id])
+                {
+                    m_pending.push_back(static_cast<uint32_t>(m_assets.size()));
+                }
+                m_guids.push_back(guids[id]);
+                m_assets.push_back(std::move(assets[id]));
+            }
+        }
+
+        void Clear()
+        {
+            m_ids.clear();
+            m_guids.clear();
+            m_assets.clear();
+            m_pending.clear();
+        }
+
+        // Null while the asset isn't loaded
+        const T* Get(uint32_t id) const
+        { return m_assets[id].get(); }
+
+        const std::vector<std::shared_ptr<T>>& GetAssets() const
+        { return m_assets; }
+
+        size_t GetSize() const
+        { return m_assets.size(); }
+
+    private:
+        std::unordered_map<xg::Guid, uint32_t> m_ids;
+        std::vector<xg::Guid> m_guids;
+        std::vector<std::shared_ptr<T>> m_assets;
+        std::vector<uint32_t> m_pending;
+    };
+
+    // Merged static meshes, drawn with an identity transform
+    struct StaticBatchProxy
+    {
+        std::shared_ptr<Mesh> mesh;
+        uint32_t materialId;
+    };
+
+    // Packed visible meshes of one frame, every array has one element per proxy
+    struct RenderProxies
+    {
+        std::vector<uint32_t> meshIds;
+        std::vector<uint32_t> materialIds;
+        std::vector<glm::mat4> transforms;
+        std::vector<glm::vec4> tints;
+        std::vector<AABB> bounds;
+        // Material id in the high bits and mesh id in the low ones, equal keys can share an instanced draw
+        std::vector<uint64_t> sortKeys;
+        // Non zero for meshes rasterized into the occlusion buffer
+        std::vector<uint8_t> occluders;
+        std::vector<entt::entity> entities;
+        // Proxies whose entities have an AnimatorComponent
+        std::vector<uint32_t> animated;
+        size_t count{ 0 };
+        // Entities merged into these batches have no proxies of their own
+        std::vector<StaticBatchProxy> staticBatches;
+
+        void Resize(size_t size);
+        void Clear();
+    };
+
+    /*
+     * Turns visible meshes of the scene into render proxies. An owning group keeps MeshComponents packed,
+     * so the group is split into chunks which are extracted in parallel. Chunks write their proxies in place,
+     * then are compacted into a dense prefix. Assets are resolved through the mesh and material tables,
+     * only assets seen for the first time are looked up in the AssetManager. Static entities are drawn through
+     * the batches of StaticBatcher instead
+     */
+    class RenderProxyExtractor
+    {
+    public:
+        // Main thread, the scene must not be updated meanwhile
+        void Extract(Scene& scene, RenderProxies& proxies);
+
+        const RenderAssetTable<MeshNode>& GetMeshes() const
+        { return m_meshes; }
+
+        const RenderAssetTable<Material>& GetMaterials() const
+        { return m_materials; }
+
+        const StaticBatcher& GetStaticBatcher() const
+        { return m_staticBatcher; }
+
+    private:
+        struct Chunk
+        {
+            size_t begin;
+            size_t count;
+            // Group positions of entities with assets missing from the tables
+            std::vector<uint32_t> misses;
+            // Proxy indices before compaction
+            std::vector<uint32_t> animated;
+        };
+
+        void Compact(RenderProxies& proxies);
+        // Periodically marks assets used by the proxies, unused ones are dropped before the next extraction
+        void UpdateUsage(const RenderProxies& proxies);
+
+        RenderAssetTable<MeshNode> m_meshes;
+        RenderAssetTable<Material> m_materials;
+        StaticBatcher m_staticBatcher;
+        std::vector<Chunk> m_chunks;
+        std::mutex m_chunkMutex;
+        std::vector<uint8_t> m_usedMeshes;
+        std::vector<uint8_t> m_usedMaterials;
+        bool m_isTrimNeeded{ false };
+        uint64_t m_frame{ 0 };
+    };
+}
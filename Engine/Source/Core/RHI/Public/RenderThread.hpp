@@ -0,0 +1,58 @@
+#pragma once
+
+#include "FramePacket.hpp"
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace RightEngine
+{
+    /*
+     * Records and submits frames on its own thread, so the next frame is simulated while the previous one is drawn.
+     * Main thread fills a free packet and hands it over, it is blocked only when all packets are in flight.
+     *
+     * Render thread owns command recording, per frame buffer writes and presentation. Render targets and pipelines
+     * are created and destroyed on the main thread only after Flush, assets are created by their loaders and
+     * destroyed by whoever drops the last reference, which may be the render thread releasing a packet
+     */
+    class RenderThread
+    {
+    public:
+        using RenderFunction = std::function<void(const FramePacket&)>;
+
+        // 2 packets give double buffering, 3 let the main thread run one more frame ahead
+        explicit RenderThread(size_t packetCount = 2);
+        ~RenderThread();
+
+        void Start(RenderFunction&& render);
+        // Renders all submitted packets and joins the thread
+        void Stop();
+
+        // Free packet for the main thread, waits while all packets are in flight
+        FramePacket& BeginPacket();
+        // Hands the packet from BeginPacket over, it must not be touched until BeginPacket returns it again
+        void SubmitPacket();
+        // Waits until all submitted packets are rendered
+        void Flush();
+
+        bool IsRunning() const
+        { return m_thread.joinable(); }
+
+        RenderThread(const RenderThread& other) = delete;
+        RenderThread& operator=(const RenderThread& other) = delete;
+
+    private:
+        void Run();
+
+        std::vector<FramePacket> m_packets;
+        RenderFunction m_render;
+        std::thread m_thread;
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+        uint64_t m_submitted{ 0 };
+        uint64_t m_rendered{ 0 };
+        bool m_isPacketOpen{ false };
+        bool m_stop{ false };
+    };
+}
@@ -43,10 +43,15 @@ namespace RightEngine
         void BeginFrame();
         void EndFrame();
 
-        void Draw(const std::shared_ptr<Buffer>& vertexBuffer, const std::shared_ptr<Buffer>& indexBuffer = nullptr);
+        // Instance index in shaders starts from firstInstance, so instances of a draw are found in a shared buffer
+        void Draw(const std::shared_ptr<Buffer>& vertexBuffer,
+                  const std::shared_ptr<Buffer>& indexBuffer = nullptr,
+                  uint32_t instanceCount = 1,
+                  uint32_t firstInstance = 0);
         void Draw(const MeshComponent& meshComponent);
         void Draw(const std::shared_ptr<MeshNode>& meshNode);
-        void Draw(const std::shared_ptr<Mesh>& mesh);
+        void Draw(const std::shared_ptr<Mesh>& mesh, uint32_t instanceCount = 1, uint32_t firstInstance = 0);
+        void Draw(const Mesh& mesh, uint32_t instanceCount = 1, uint32_t firstInstance = 0);
         void EncodeState(const std::shared_ptr<RendererState>& state);
 
         void SetPipeline(const std::shared_ptr<GraphicsPipeline>& aPipeline);
@@ -37,12 +37,14 @@ namespace RightEngine
         virtual void Draw(const std::shared_ptr<CommandBuffer>& cmd,
                           const std::shared_ptr<Buffer>& buffer,
                           uint32_t vertexCount,
-                          uint32_t instanceCount = 1) = 0;
+                          uint32_t instanceCount = 1,
+                          uint32_t firstInstance = 0) = 0;
         virtual void Draw(const std::shared_ptr<CommandBuffer>& cmd,
                           const std::shared_ptr<Buffer>& vertexBuffer,
                           const std::shared_ptr<Buffer>& indexBuffer,
                           uint32_t indexCount,
-                          uint32_t instanceCount = 1) = 0;
+                          uint32_t instanceCount = 1,
+                          uint32_t firstInstance = 0) = 0;
 
         virtual void EncodeState(const std::shared_ptr<CommandBuffer>& cmd,
                                  const std::shared_ptr<GraphicsPipeline>& pipeline,
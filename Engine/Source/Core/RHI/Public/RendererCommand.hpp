@@ -25,12 +25,14 @@ namespace RightEngine
         static void Draw(const std::shared_ptr<CommandBuffer>& cmd,
                          const std::shared_ptr<Buffer>& buffer,
                          uint32_t vertexCount,
-                         uint32_t instanceCount = 1);
+                         uint32_t instanceCount = 1,
+                         uint32_t firstInstance = 0);
         static void DrawIndexed(const std::shared_ptr<CommandBuffer>& cmd,
                                 const std::shared_ptr<Buffer>& vertexBuffer,
                                 const std::shared_ptr<Buffer>& indexBuffer,
                                 uint32_t indexCount,
-                                uint32_t instanceCount = 1);
+                                uint32_t instanceCount = 1,
+                                uint32_t firstInstance = 0);
 
         static void EncodeState(const std::shared_ptr<CommandBuffer>& cmd,
                                 const std::shared_ptr<GraphicsPipeline>& pipeline,
@@ -4,6 +4,10 @@
 #include "MeshLoader.hpp"
 #include "UniformBufferSet.hpp"
 #include "Renderer.hpp"
+#include "CullingStream.hpp"
+#include "OcclusionBuffer.hpp"
+#include "LightClusterGrid.hpp"
+#include <mutex>
 
 namespace RightEngine
 {
@@ -22,6 +26,7 @@ namespace RightEngine
         PRESENT
     };
 
+    // Directional lights are applied everywhere, point lights only reach fragments within radiusOuter
     struct LightData
     {
         glm::vec4 color;
@@ -39,12 +44,22 @@ namespace RightEngine
         glm::vec3 position;
         glm::mat4 view;
         glm::mat4 projection;
+        // Depth range of the projection, light clusters are sliced over it
+        float zNear{ 0.1f };
+        float zFar{ 500.0f };
     };
 
     struct PassInfo
     {
         std::string m_name;
-        double m_time;
+        double m_time{ 0.0 };
+        // Draws that passed and failed frustum culling, summed over all views of the pass
+        size_t m_visibleCount{ 0 };
+        size_t m_culledCount{ 0 };
+        // Draws inside the frustum hidden behind occluders, included in m_culledCount
+        size_t m_occludedCount{ 0 };
+        // Visible draws sharing mesh, material and palette are merged into one instanced draw call
+        size_t m_drawCallCount{ 0 };
     };
 
     class SceneRenderer
@@ -58,8 +73,18 @@ namespace RightEngine
         void SetScene(const std::shared_ptr<Scene>& aScene)
         { scene = aScene; }
 
-        void SubmitMeshNode(const std::shared_ptr<MeshNode>& meshNode, const std::shared_ptr<Material>& material, const glm::mat4& transform);
-        void SubmitMesh(const std::shared_ptr<Mesh>& mesh, const std::shared_ptr<Material>& material, const glm::mat4& transform);
+        /*
+         * Skinned meshes without palette are drawn in the bind pose, tint multiplies the material albedo.
+         * Occluders hide other draws of the PBR pass with their mesh occluders.
+         * Only pointers to the assets are kept, the caller keeps them alive until EndScene
+         */
+        void SubmitMeshNode(const MeshNode& meshNode,
+                            const Material& material,
+                            const glm::mat4& transform,
+                            const std::vector<glm::vec4>& skinningPalette = {},
+                            const glm::vec4& tint = glm::vec4(1.0f),
+                            bool isOccluder = false);
+        void SubmitMesh(const Mesh& mesh, const Material& material, const glm::mat4& transform);
 
         void BeginScene(const CameraData& cameraData,
                         const std::shared_ptr<EnvironmentContext>& environment,
@@ -72,12 +97,11 @@ namespace RightEngine
         void SetUIPassCallback(std::function<void(const std::shared_ptr<CommandBuffer>&)>&& callback)
         { uiPassCallback = callback; }
 
-        uint32_t Pick(const std::shared_ptr<Scene>& scene, const glm::vec2& pos);
-
         const std::shared_ptr<GraphicsPipeline>& GetPass(PassType type) const;
         const std::shared_ptr<Texture>& GetFinalImage() const;
 
-        const std::vector<PassInfo> GetPassInfo() const { return m_passInfo; }
+        // Copy of the last rendered frame stats, safe to read while another thread renders
+        std::vector<PassInfo> GetPassInfo() const;
 
     private:
         void CreateShaders();
@@ -86,9 +110,42 @@ namespace RightEngine
         void CreateOnscreenPasses();
         void CreateBuffers();
 
+        void SubmitMeshTree(const MeshNode& meshNode,
+                            const Material& material,
+                            const glm::mat4& transform,
+                            bool isSkinned,
+                            uint32_t paletteOffset,
+                            const glm::vec4& tint,
+                            bool isOccluder);
+        void SubmitMesh(const Mesh& mesh,
+                        const Material& material,
+                        const glm::mat4& transform,
+                        bool isSkinned,
+                        uint32_t paletteOffset,
+                        const glm::vec4& tint,
+                        bool isOccluder);
+        // Returns byte offset of the palette in the skinning buffer
+        uint32_t PushSkinningPalette(const std::vector<glm::vec4>& palette);
+        void UploadSkinningPalettes();
+
+        // Fills indices of draws whose world bounds intersect the frustum of viewProjection
+        void CullDraws(const glm::mat4& viewProjection, std::vector<uint32_t>& visibleDraws);
+        /*
+         * Rasterizes visible occluders into the occlusion buffer from the camera and removes draws hidden behind them.
+         * Only the camera view is occlusion culled, draws hidden from it may still cast visible shadows
+         */
+        void CullOccluded(std::vector<uint32_t>& visibleDraws, PassInfo& passInfo);
+        /*
+         * Groups visible draws into instanced batches and uploads their instance data after the instances
+         * already written this frame. Draws which don't fit into the instance buffer are skipped
+         */
+        void BuildInstanceBatches(std::vector<uint32_t>& visibleDraws);
+        // Orders lights of the frame, assigns point lights to clusters and uploads both
+        void UploadLights(const std::vector<LightData>& lights);
+
         // Passes
-        void ShadowPass();
-        void PBRPass();
+        void ShadowPass(PassInfo& passInfo);
+        void PBRPass(PassInfo& passInfo);
         void SkyboxPass();
         void PostprocessPass();
         void UIPass();
@@ -113,50 +170,80 @@ namespace RightEngine
         std::shared_ptr<GraphicsPipeline> postprocessPipeline;
         std::shared_ptr<GraphicsPipeline> uiPipeline;
         std::shared_ptr<GraphicsPipeline> presentPipeline;
-        std::shared_ptr<GraphicsPipeline> m_pickingPipeline;
         std::shared_ptr<GraphicsPipeline> m_shadowPipeline;
+        // Skinned variants of the PBR and shadow shaders, their passes load the attachments of the static ones
+        std::shared_ptr<GraphicsPipeline> m_skinnedPbrPipeline;
+        std::shared_ptr<GraphicsPipeline> m_skinnedShadowPipeline;
 
         // TODO: Move shaders to ShaderLibrary
         std::shared_ptr<Shader> pbrShader;
         std::shared_ptr<Shader> skyboxShader;
         std::shared_ptr<Shader> postprocessShader;
-        std::shared_ptr<Shader> m_pickingShader;
         std::shared_ptr<Shader> m_shadowShader;
 
         struct DrawCommand
         {
-            std::shared_ptr<Mesh> mesh;
-            std::shared_ptr<Material> material;
+            const Mesh* mesh;
+            const Material* material;
             glm::mat4 transform;
+            // Drawn by the skinned pipelines, static draws ignore the palette
+            bool isSkinned{ false };
+            uint32_t paletteOffset{ 0 };
+            glm::vec4 tint{ 1.0f };
+            AABB bounds;
+            bool isOccluder{ false };
         };
 
-        struct UBCameraData
+        // Matches InstanceData of pbr.vert and shadow.vert in std430 layout
+        struct InstanceData
         {
-            glm::mat4 viewProjection;
-            glm::vec4 position;
-        } cameraDataUB;
+            glm::mat4 transform;
+            glm::vec4 tint;
+        };
 
-        struct UBLightData
+        struct InstanceBatch
         {
-            LightData light[30];
-            int lightsAmount;
-            glm::vec3 dummy;
-        } lightDataUB;
+            // Any draw of the batch, they only differ by instance data
+            uint32_t draw;
+            uint32_t firstInstance;
+            uint32_t instanceCount;
+        };
 
-        struct UBTransformData
+        struct UBCameraData
         {
-            glm::mat4 transform;
-        } transformDataUB;
+            glm::mat4 viewProjection;
+            glm::vec4 position;
+        } cameraDataUB;
 
-        struct UBColorId
+        // Matches UBClusterData of pbr.frag
+        struct UBClusterData
         {
-            glm::vec4 color;
-        } colorIdUB;
+            // Dot product with a world position gives its view depth
+            glm::vec4 viewDepthRow;
+            glm::vec2 tileSize;
+            float sliceScale;
+            float sliceBias;
+            // Tiles and slices of the grid, w is the amount of directional lights at the start of the light buffer
+            glm::uvec4 grid;
+        } clusterDataUB;
 
         // Per frame data
         std::vector<DrawCommand> m_drawList;
+        CullingStream m_cullingStream;
+        std::vector<uint8_t> m_visibilityMasks;
+        std::vector<uint32_t> m_visibleDraws;
+        OcclusionBuffer m_occlusionBuffer;
+        std::vector<uint8_t> m_occlusionResults;
+        std::vector<InstanceData> m_instanceData;
+        std::vector<InstanceBatch> m_instanceBatches;
+        uint32_t m_instanceCount{ 0 };
+        std::vector<glm::vec4> m_skinningPalettes;
+        std::vector<LightData> m_lights;
+        std::vector<ClusterLight> m_clusterLights;
+        LightClusterGrid m_lightClusters;
         EnvironmentContext sceneEnvironment;
         CameraData camera;
         std::vector<PassInfo> m_passInfo;
+        mutable std::mutex m_passInfoMutex;
     };
 }
\ No newline at end of file
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "ShaderProgramDescriptor.hpp"
+#include <string>
+#include <vector>
+
+namespace RightEngine
+{
+    /*
+     * Device independent GLSL -> SPIR-V compiler, shared by runtime shader creation and the offline cooker
+     */
+    class ShaderCompiler
+    {
+    public:
+        static void Init();
+
+        /*
+         * Gets path in engine format and returns shader source code, empty string if file can't be opened
+         */
+        static std::string ReadSource(const std::string& path);
+
+        static std::vector<uint32_t> Compile(ShaderType type, const std::string& source, const std::string& name);
+    };
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "Scene.hpp"
+#include "MeshLoader.hpp"
+#include <unordered_map>
+#include <limits>
+#include <mutex>
+
+namespace RightEngine
+{
+    /*
+     * Merges small static meshes into one mesh per material and spatial cell. Vertices of members are transformed
+     * into world space on CPU, so a batch is drawn with an identity transform and culled by its own bounds.
+     * Every update compares static entities with what their batches were built from, only batches with a moved,
+     * added, changed or removed member are rebuilt
+     */
+    class StaticBatcher
+    {
+    public:
+        static constexpr uint32_t C_NO_BATCH = std::numeric_limits<uint32_t>::max();
+
+        struct Batch
+        {
+            xg::Guid material;
+            uint64_t cell{ 0 };
+            std::vector<entt::entity> members;
+            // World space vertices of all members, null for free batches
+            std::shared_ptr<Mesh> mesh;
+            bool isDirty{ false };
+        };
+
+        // Main thread, the scene must not be updated meanwhile. Batches are dropped when another scene is passed
+        void Update(Scene& scene);
+        void Clear();
+
+        // Safe from any thread between updates, batched entities must not be drawn on their own
+        bool IsBatched(entt::entity entity) const
+        {
+            const auto index = static_cast<size_t>(entt::to_entity(entity));
+            return index < m_records.size() && m_records[index].entity == entity && m_records[index].batch != C_NO_BATCH;
+        }
+
+        // Indexed by batch id, free batches have no mesh
+        const std::vector<Batch>& GetBatches() const
+        { return m_batches; }
+
+    private:
+        // What the batch of an entity was built from, indexed by entity index
+        struct Record
+        {
+            entt::entity entity{ entt::null };
+            uint32_t batch{ C_NO_BATCH };
+            uint32_t transformVersion{ 0 };
+            // Update which last saw the entity static
+            uint64_t frame{ 0 };
+            xg::Guid mesh;
+            xg::Guid material;
+            std::shared_ptr<MeshNode> meshNode;
+            // Mesh can't be merged, the entity is drawn on its own until its mesh changes
+            bool isRejected{ false };
+        };
+
+        struct BatchKey
+        {
+            xg::Guid material;
+            uint64_t cell;
+
+            bool operator==(const BatchKey& other) const
+            { return material == other.material && cell == other.cell; }
+        };
+
+        struct BatchKeyHash
+        {
+            size_t operator()(const BatchKey& key) const
+            { return std::hash<xg::Guid>()(key.material) ^ std::hash<uint64_t>()(key.cell) * 31; }
+        };
+
+        void FindChanges(Scene& scene);
+        void ApplyChange(entt::registry& registry, entt::entity entity);
+        uint32_t GetBatch(const BatchKey& key);
+        void MarkStaleBatches();
+        void RebuildBatches(entt::registry& registry);
+        // Drops members which moved to other batches or aren't static anymore
+        void FilterMembers(uint32_t batch);
+        // Fills vertices and indices with world space geometry of the batch members
+        void MergeMembers(const entt::registry& registry, const Batch& batch, MeshData& meshData) const;
+
+        const entt::registry* m_registry{ nullptr };
+        uint64_t m_frame{ 0 };
+        std::vector<Record> m_records;
+        std::vector<Batch> m_batches;
+        std::vector<uint32_t> m_freeBatches;
+        std::unordered_map<BatchKey, uint32_t, BatchKeyHash> m_batchIds;
+        std::vector<entt::entity> m_changes;
+        std::mutex m_changeMutex;
+    };
+}
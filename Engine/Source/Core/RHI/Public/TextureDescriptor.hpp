@@ -4,6 +4,9 @@ namespace RightEngine
 {
     struct TextureDescriptor
     {
+        // 4x4 pixels block of the compressed formats
+        static constexpr size_t C_COMPRESSED_BLOCK_SIZE = 16;
+
         int width{ 0 };
         int height{ 0 };
         int componentAmount{ 0 };
@@ -16,8 +19,40 @@ namespace RightEngine
          */
         inline size_t GetTextureSize() const
         {
-            const size_t size = width * height;
-            return GetPixelSize() * size;
+            return GetMipSize(0);
+        }
+
+        /**
+         * @return Size in bytes of a single layer of the mip level
+         */
+        inline size_t GetMipSize(int mipLevel) const
+        {
+            const size_t mipWidth = (width >> mipLevel) > 0 ? width >> mipLevel : 1;
+            const size_t mipHeight = (height >> mipLevel) > 0 ? height >> mipLevel : 1;
+            if (IsCompressed())
+            {
+                // Mips smaller than a block still occupy the whole block
+                return ((mipWidth + 3) / 4) * ((mipHeight + 3) / 4) * C_COMPRESSED_BLOCK_SIZE;
+            }
+            return GetPixelSize() * mipWidth * mipHeight;
+        }
+
+        /**
+         * @return Size in bytes of all layers with all mip levels, data of each layer is stored from the biggest mip to the smallest
+         */
+        inline size_t GetDataSize() const
+        {
+            size_t size = 0;
+            for (int mipLevel = 0; mipLevel < mipLevels; mipLevel++)
+            {
+                size += GetMipSize(mipLevel);
+            }
+            return size * (type == TextureType::CUBEMAP ? 6 : 1);
+        }
+
+        inline bool IsCompressed() const
+        {
+            return format == Format::BC6H_UFLOAT;
         }
 
         inline size_t GetPixelSize() const
@@ -41,6 +76,7 @@ namespace RightEngine
                 case Format::R8_SRGB:
                 case Format::RGB8_SRGB:
                 case Format::RGBA8_SRGB:
+                case Format::RGBA8_UNORM:
                     return sizeof(uint8_t) * componentAmount;
 				case Format::BGRA8_UNORM:
                     return sizeof(float) * componentAmount;
@@ -3,6 +3,7 @@
 #include "Assert.hpp"
 #include "Types.hpp"
 #include <glm/glm.hpp>
+#include <glm/gtc/type_precision.hpp>
 #include <vector>
 #include <cassert>
 
@@ -88,6 +89,15 @@ namespace RightEngine
         stride += count * VertexBufferElement::GetSizeOfType(Format::RGBA32_SFLOAT);
     }
 
+    // Normalized bytes are read as floats in [0, 1], other ones as uvec4
+    template<>
+    inline void VertexBufferLayout::Push<glm::u8vec4>(uint32_t count, bool normalized)
+    {
+        const Format format = normalized ? Format::RGBA8_UNORM : Format::RGBA8_UINT;
+        elements.push_back({ format, count, normalized });
+        stride += count * VertexBufferElement::GetSizeOfType(format);
+    }
+
     template<>
     inline void VertexBufferLayout::Push<glm::vec2>()
     {
@@ -0,0 +1,226 @@
+#include "RenderProxy.hpp"
+#include "Application.hpp"
+#include "ThreadService.hpp"
+#include <algorithm>
+
+using namespace RightEngine;
+
+namespace
+{
+    constexpr size_t C_ENTITIES_PER_CHUNK = 1024;
+    // Asset usage is only checked this often, tables of static scenes never change in between
+    constexpr uint64_t C_USAGE_PERIOD = 256;
+
+    enum class ExtractResult
+    {
+        EXTRACTED,
+        // Entity is hidden or some of its assets aren't loaded yet
+        SKIPPED,
+        // Some asset isn't in its table yet
+        MISSED
+    };
+
+    ExtractResult ExtractEntity(const RenderAssetTable<MeshNode>& meshes,
+                                const RenderAssetTable<Material>& materials,
+                                const MeshComponent& meshComponent,
+                                const TransformComponent& transform,
+                                const BoundsComponent& bounds,
+                                RenderProxies& proxies,
+                                size_t index)
+    {
+        if (!meshComponent.isVisible || !meshComponent.mesh.guid.isValid() || !meshComponent.material.guid.isValid())
+        {
+            return ExtractResult::SKIPPED;
+        }
+
+        const uint32_t meshId = meshes.Find(meshComponent.mesh.guid);
+        const uint32_t materialId = materials.Find(meshComponent.material.guid);
+        if (meshId == C_INVALID_RENDER_ASSET || materialId == C_INVALID_RENDER_ASSET)
+        {
+            return ExtractResult::MISSED;
+        }
+        if (!meshes.Get(meshId) || !materials.Get(materialId))
+        {
+            return ExtractResult::SKIPPED;
+        }
+
+        proxies.meshIds[index] = meshId;
+        proxies.materialIds[index] = materialId;
+        proxies.transforms[index] = transform.GetWorldTransformMatrix();
+        proxies.tints[index] = meshComponent.tint;
+        proxies.bounds[index] = bounds.worldBounds;
+        proxies.sortKeys[index] = static_cast<uint64_t>(materialId) << 32 | meshId;
+        proxies.occluders[index] = meshComponent.isOccluder;
+        return ExtractResult::EXTRACTED;
+    }
+
+    template<typename T>
+    void MoveRange(std::vector<T>& values, size_t begin, size_t count, size_t destination)
+    {
+        std::copy(values.begin() + begin, values.begin() + begin + count, values.begin() + destination);
+    }
+}
+
+void RenderProxies::Resize(size_t size)
+{
+    meshIds.resize(size);
+    materialIds.resize(size);
+    transforms.resize(size);
+    tints.resize(size);
+    bounds.resize(size);
+    sortKeys.resize(size);
+    occluders.resize(size);
+    entities.resize(size);
+}
+
+void RenderProxies::Clear()
+{
+    animated.clear();
+    staticBatches.clear();
+    count = 0;
+}
+
+void RenderProxyExtractor::Extract(Scene& scene, RenderProxies& proxies)
+{
+    if (m_isTrimNeeded)
+    {
+        m_meshes.Retain(m_usedMeshes);
+        m_materials.Retain(m_usedMaterials);
+        m_isTrimNeeded = false;
+    }
+    m_meshes.Refresh();
+    m_materials.Refresh();
+    m_staticBatcher.Update(scene);
+
+    auto& registry = scene.GetRegistry();
+    // Structural access happens here on the calling thread, workers only read components
+    auto group = registry.group<MeshComponent>(entt::get<TransformComponent, BoundsComponent>);
+    const auto& animators = registry.storage<AnimatorComponent>();
+
+    proxies.Clear();
+    proxies.Resize(group.size());
+    m_chunks.clear();
+    Instance().Service<ThreadService>().ParallelFor(group.size(), C_ENTITIES_PER_CHUNK, [&](size_t begin, size_t end)
+    {
+        Chunk chunk{ begin, 0 };
+        for (size_t position = begin; position < end; position++)
+        {
+            const auto entity = group[position];
+            if (m_staticBatcher.IsBatched(entity))
+            {
+                continue;
+            }
+            const auto [meshComponent, transform, bounds] = group.get<MeshComponent, TransformComponent, BoundsComponent>(entity);
+            const size_t index = begin + chunk.count;
+            const auto result = ExtractEntity(m_meshes, m_materials, meshComponent, transform, bounds, proxies, index);
+            if (result == ExtractResult::MISSED)
+            {
+                chunk.misses.push_back(static_cast<uint32_t>(position));
+                continue;
+            }
+            if (result == ExtractResult::SKIPPED)
+            {
+                continue;
+            }
+            proxies.entities[index] = entity;
+            if (animators.contains(entity))
+            {
+                chunk.animated.push_back(static_cast<uint32_t>(index));
+            }
+            chunk.count++;
+        }
+
+        std::lock_guard lock(m_chunkMutex);
+        m_chunks.push_back(std::move(chunk));
+    });
+
+    Compact(proxies);
+
+    // Entities with new assets are rare, they are extracted here after the assets get their ids
+    for (const auto& chunk : m_chunks)
+    {
+        for (const uint32_t position : chunk.misses)
+        {
+            const auto entity = group[position];
+            const auto [meshComponent, transform, bounds] = group.get<MeshComponent, TransformComponent, BoundsComponent>(entity);
+            m_meshes.Add(meshComponent.mesh.guid);
+            m_materials.Add(meshComponent.material.guid);
+            if (ExtractEntity(m_meshes, m_materials, meshComponent, transform, bounds, proxies, proxies.count) != ExtractResult::EXTRACTED)
+            {
+                continue;
+            }
+            proxies.entities[proxies.count] = entity;
+            if (animators.contains(entity))
+            {
+                proxies.animated.push_back(static_cast<uint32_t>(proxies.count));
+            }
+            proxies.count++;
+        }
+    }
+
+    for (const auto& batch : m_staticBatcher.GetBatches())
+    {
+        if (!batch.mesh)
+        {
+            continue;
+        }
+        const uint32_t materialId = m_materials.Add(batch.material);
+        if (m_materials.Get(materialId))
+        {
+            proxies.staticBatches.push_back({ batch.mesh, materialId });
+        }
+    }
+
+    if (++m_frame % C_USAGE_PERIOD == 0)
+    {
+        UpdateUsage(proxies);
+    }
+}
+
+void RenderProxyExtractor::Compact(RenderProxies& proxies)
+{
+    std::sort(m_chunks.begin(), m_chunks.end(), [](const Chunk& a, const Chunk& b)
+    {
+        return a.begin < b.begin;
+    });
+
+    // Every chunk moves towards the front, so its destination never overlaps a chunk which isn't moved yet
+    size_t destination = 0;
+    for (const auto& chunk : m_chunks)
+    {
+        if (chunk.begin != destination)
+        {
+            MoveRange(proxies.meshIds, chunk.begin, chunk.count, destination);
+            MoveRange(proxies.materialIds, chunk.begin, chunk.count, destination);
+            MoveRange(proxies.transforms, chunk.begin, chunk.count, destination);
+            MoveRange(proxies.tints, chunk.begin, chunk.count, destination);
+            MoveRange(proxies.bounds, chunk.begin, chunk.count, destination);
+            MoveRange(proxies.sortKeys, chunk.begin, chunk.count, destination);
+            MoveRange(proxies.occluders, chunk.begin, chunk.count, destination);
+            MoveRange(proxies.entities, chunk.begin, chunk.count, destination);
+        }
+        for (const uint32_t index : chunk.animated)
+        {
+            proxies.animated.push_back(static_cast<uint32_t>(index - chunk.begin + destination));
+        }
+        destination += chunk.count;
+    }
+    proxies.count = destination;
+}
+
+void RenderProxyExtractor::UpdateUsage(const RenderProxies& proxies)
+{
+    m_usedMeshes.assign(m_meshes.GetSize(), 0);
+    m_usedMaterials.assign(m_materials.GetSize(), 0);
+    for (size_t i = 0; i < proxies.count; i++)
+    {
+        m_usedMeshes[proxies.meshIds[i]] = 1;
+        m_usedMaterials[proxies.materialIds[i]] = 1;
+    }
+    for (const auto& batch : proxies.staticBatches)
+    {
+        m_usedMaterials[batch.materialId] = 1;
+    }
+    m_isTrimNeeded = std::count(m_usedMeshes.begin(), m_usedMeshes.end(), 0) > 0
+                     || std::count(m_usedMaterials.begin(), m_usedMaterials.end(), 0) > 0;
+}
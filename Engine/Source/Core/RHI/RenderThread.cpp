@@ -0,0 +1,102 @@
+#include "RenderThread.hpp"
+#include "Assert.hpp"
+
+using namespace RightEngine;
+
+RenderThread::RenderThread(size_t packetCount) : m_packets(packetCount)
+{
+    R_CORE_ASSERT(packetCount > 0, "");
+}
+
+RenderThread::~RenderThread()
+{
+    Stop();
+}
+
+void RenderThread::Start(RenderFunction&& render)
+{
+    R_CORE_ASSERT(!IsRunning(), "");
+    m_render = std::move(render);
+    m_stop = false;
+    m_thread = std::thread(&RenderThread::Run, this);
+}
+
+void RenderThread::Stop()
+{
+    if (!IsRunning())
+    {
+        return;
+    }
+    {
+        std::lock_guard lock(m_mutex);
+        m_stop = true;
+    }
+    m_condition.notify_all();
+    m_thread.join();
+}
+
+FramePacket& RenderThread::BeginPacket()
+{
+    R_CORE_ASSERT(!m_isPacketOpen, "");
+    std::unique_lock lock(m_mutex);
+    m_condition.wait(lock, [this]()
+    {
+        return m_submitted - m_rendered < m_packets.size();
+    });
+    m_isPacketOpen = true;
+    auto& packet = m_packets[m_submitted % m_packets.size()];
+    packet.frameIndex = m_submitted;
+    return packet;
+}
+
+void RenderThread::SubmitPacket()
+{
+    R_CORE_ASSERT(m_isPacketOpen, "");
+    {
+        std::lock_guard lock(m_mutex);
+        m_isPacketOpen = false;
+        m_submitted++;
+    }
+    m_condition.notify_all();
+}
+
+void RenderThread::Flush()
+{
+    std::unique_lock lock(m_mutex);
+    m_condition.wait(lock, [this]()
+    {
+        return m_rendered == m_submitted;
+    });
+}
+
+void RenderThread::Run()
+{
+    while (true)
+    {
+        uint64_t frame;
+        {
+            std::unique_lock lock(m_mutex);
+            m_condition.wait(lock, [this]()
+            {
+                return m_stop || m_rendered < m_submitted;
+            });
+            // Packets submitted before Stop are still drawn, so Stop behaves like Flush
+            if (m_rendered == m_submitted)
+            {
+                return;
+            }
+            frame = m_rendered;
+        }
+
+        auto& packet = m_packets[frame % m_packets.size()];
+        m_render(packet);
+        // Passes wait for their GPU work, so the assets of the packet are no longer in use
+        packet.Clear();
+
+        {
+            std::lock_guard lock(m_mutex);
+            m_rendered++;
+        }
+        m_condition.notify_all();
+    }
+}
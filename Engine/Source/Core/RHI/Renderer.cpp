@@ -25,17 +25,27 @@ void Renderer::EndFrame()
     RendererCommand::EndFrame(commandBuffer, pipeline);
 }
 
-void Renderer::Draw(const std::shared_ptr<Buffer>& vertexBuffer, const std::shared_ptr<Buffer>& indexBuffer)
+void Renderer::Draw(const std::shared_ptr<Buffer>& vertexBuffer,
+                    const std::shared_ptr<Buffer>& indexBuffer,
+                    uint32_t instanceCount,
+                    uint32_t firstInstance)
 {
     if (indexBuffer)
     {
-        RendererCommand::DrawIndexed(commandBuffer, vertexBuffer, indexBuffer, indexBuffer->GetDescriptor().size / sizeof(uint32_t));
+        RendererCommand::DrawIndexed(commandBuffer,
+                                     vertexBuffer,
+                                     indexBuffer,
+                                     indexBuffer->GetDescriptor().size / sizeof(uint32_t),
+                                     instanceCount,
+                                     firstInstance);
         return;
     }
     RendererCommand::Draw(commandBuffer,
                           vertexBuffer,
                           vertexBuffer->GetDescriptor().size /
-                          pipeline->GetPipelineDescriptor().shader->GetShaderProgramDescriptor().layout.GetStride());
+                          pipeline->GetPipelineDescriptor().shader->GetShaderProgramDescriptor().layout.GetStride(),
+                          instanceCount,
+                          firstInstance);
 }
 
 void Renderer::EncodeState(const std::shared_ptr<RendererState>& state)
@@ -82,7 +92,12 @@ void Renderer::Draw(const std::shared_ptr<MeshNode>& meshNode)
     }
 }
 
-void Renderer::Draw(const std::shared_ptr<Mesh>& mesh)
+void Renderer::Draw(const std::shared_ptr<Mesh>& mesh, uint32_t instanceCount, uint32_t firstInstance)
 {
-    Draw(mesh->GetVertexBuffer(), mesh->GetIndexBuffer());
+    Draw(*mesh, instanceCount, firstInstance);
+}
+
+void Renderer::Draw(const Mesh& mesh, uint32_t instanceCount, uint32_t firstInstance)
+{
+    Draw(mesh.GetVertexBuffer(), mesh.GetIndexBuffer(), instanceCount, firstInstance);
 }
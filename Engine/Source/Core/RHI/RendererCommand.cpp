@@ -39,20 +39,22 @@ void RendererCommand::Configure(const RendererSettings& settings)
 void RendererCommand::Draw(const std::shared_ptr<CommandBuffer>& cmd,
                            const std::shared_ptr<Buffer>& buffer,
                            uint32_t vertexCount,
-                           uint32_t instanceCount)
+                           uint32_t instanceCount,
+                           uint32_t firstInstance)
 {
     R_CORE_ASSERT(buffer->GetDescriptor().type == BufferType::VERTEX
                   && buffer->GetDescriptor().size > 0
                   && vertexCount > 0
                   && instanceCount > 0, "");
-    rendererAPI->Draw(cmd, buffer, vertexCount, instanceCount);
+    rendererAPI->Draw(cmd, buffer, vertexCount, instanceCount, firstInstance);
 }
 
 void RendererCommand::DrawIndexed(const std::shared_ptr<CommandBuffer>& cmd,
                                   const std::shared_ptr<Buffer>& vertexBuffer,
                                   const std::shared_ptr<Buffer>& indexBuffer,
                                   uint32_t indexCount,
-                                  uint32_t instanceCount)
+                                  uint32_t instanceCount,
+                                  uint32_t firstInstance)
 {
     R_CORE_ASSERT(vertexBuffer->GetDescriptor().type == BufferType::VERTEX
                   && indexBuffer->GetDescriptor().type == BufferType::INDEX
@@ -60,7 +62,7 @@ void RendererCommand::DrawIndexed(const std::shared_ptr<CommandBuffer>& cmd,
                   && indexBuffer->GetDescriptor().size > 0
                   && indexCount > 0
                   && instanceCount > 0, "");
-    rendererAPI->Draw(cmd, vertexBuffer, indexBuffer, indexCount, instanceCount);
+    rendererAPI->Draw(cmd, vertexBuffer, indexBuffer, indexCount, instanceCount, firstInstance);
 }
 
 void RendererCommand::EncodeState(const std::shared_ptr<CommandBuffer>& cmd,
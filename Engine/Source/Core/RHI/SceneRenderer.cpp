@@ -8,6 +8,8 @@
 #include "Timer.hpp"
 #include "RHIHelpers.hpp"
 #include <stb_image_write.h>
+#include <algorithm>
+#include <tuple>
 #include <glm/ext/matrix_clip_space.hpp>
 #include <glm/ext/matrix_transform.hpp>
 
@@ -74,33 +76,6 @@ namespace
         return AssetManager::Get().GetAsset<Texture>(handle);
     }
 
-    glm::vec4 IdToColor(uint32_t id)
-    {
-        uint32_t r = (id & 0x000000FF) >> 0;
-        uint32_t g = (id & 0x0000FF00) >> 8;
-        uint32_t b = (id & 0x00FF0000) >> 16;
-        return glm::vec4(r, g, b, 255.0f);
-    }
-
-    struct Pixel
-    {
-        uint8_t r;
-        uint8_t g;
-        uint8_t b;
-        uint8_t a;
-
-        bool Empty() const
-        {
-            return r == 0 && g == 0 && b == 0;
-        }
-    };
-
-    uint32_t ColorToId(Pixel pixel)
-    {
-        uint32_t id = pixel.b + pixel.g * 256 + pixel.r * 256 * 256;
-        return id;
-    }
-
     void SaveTexture(const std::shared_ptr<Texture>& texture)
     {
         auto buffer = texture->Data();
@@ -127,6 +102,42 @@ namespace
 
     constexpr const int C_SHADOWMAP_WIDTH = 1024;
     constexpr const int C_SHADOWMAP_HEIGHT = 1024;
+
+    constexpr const int C_SKINNING_SLOT = 14;
+    // Every palette takes a fixed slot, so shaders can declare the array size and draws only differ by offset
+    constexpr const size_t C_SKINNING_PALETTE_ROWS = C_MAX_JOINTS * 3;
+    constexpr const size_t C_SKINNING_PALETTE_SIZE = C_SKINNING_PALETTE_ROWS * sizeof(glm::vec4);
+    // First slot is always the identity palette used by skinned meshes without animation
+    constexpr const size_t C_MAX_SKINNING_PALETTES = 512;
+    // C_SKINNED specialization constant of pbr.vert and shadow.vert
+    constexpr const uint32_t C_SKINNED_CONSTANT = 1;
+
+    // Per instance transforms and overrides of all passes of the frame, instanced draws index it from their first instance
+    constexpr const uint32_t C_INSTANCE_SLOT = 0;
+    constexpr const uint32_t C_MAX_INSTANCES = 65536;
+
+    // Lights of the frame and their per cluster lists, point lights are only limited by these sizes
+    constexpr const uint32_t C_LIGHT_SLOT = 11;
+    constexpr const uint32_t C_CLUSTER_SLOT = 15;
+    constexpr const uint32_t C_LIGHT_INDEX_SLOT = 16;
+    constexpr const uint32_t C_CLUSTER_DATA_SLOT = 17;
+    constexpr const size_t C_MAX_LIGHTS = 16384;
+    constexpr const size_t C_MAX_LIGHT_INDICES = 1 << 20;
+
+    std::shared_ptr<Buffer> CreateStorageBuffer(size_t size)
+    {
+        BufferDescriptor bufferDescriptor{};
+        bufferDescriptor.size = size;
+        bufferDescriptor.type = BufferType::STORAGE;
+        bufferDescriptor.memoryType = MemoryType::CPU_GPU;
+        return Device::Get()->CreateBuffer(bufferDescriptor, nullptr);
+    }
+
+    // Groups of 4 boxes per culling task, small scenes are culled on the calling thread
+    constexpr const size_t C_CULLING_GROUPS_PER_BATCH = 256;
+    // Occlusion buffer has a pixel per C_OCCLUSION_DOWNSCALE^2 viewport pixels
+    constexpr const int C_OCCLUSION_DOWNSCALE = 4;
+    constexpr const size_t C_OCCLUSION_TESTS_PER_BATCH = 256;
 }
 
 void SceneRenderer::Init()
@@ -166,13 +177,19 @@ void SceneRenderer::CreateShaders()
 		    layout.Push<glm::vec2>();
 		    layout.Push<glm::vec3>();
 		    layout.Push<glm::vec3>();
+		    layout.Push<glm::u8vec4>(1, false);
+		    layout.Push<glm::u8vec4>(1, true);
 		    shaderProgramDescriptor.layout = layout;
-		    shaderProgramDescriptor.reflection.textures = {3, 4, 5, 6, 7, 8, 9, 10, 13};
-		    shaderProgramDescriptor.reflection.buffers[{0, ShaderType::VERTEX}] = BufferType::UNIFORM;
+		    shaderProgramDescriptor.reflection.textures = {3, 4, 5, 8, 9, 10, 13};
+		    shaderProgramDescriptor.reflection.buffers[{C_INSTANCE_SLOT, ShaderType::VERTEX}] = BufferType::STORAGE;
 		    shaderProgramDescriptor.reflection.buffers[{1, ShaderType::VERTEX}] = BufferType::UNIFORM;
+		    shaderProgramDescriptor.reflection.buffers[{C_SKINNING_SLOT, ShaderType::VERTEX}] = BufferType::UNIFORM;
 		    shaderProgramDescriptor.reflection.buffers[{2, ShaderType::FRAGMENT}] = BufferType::UNIFORM;
-		    shaderProgramDescriptor.reflection.buffers[{11, ShaderType::FRAGMENT}] = BufferType::UNIFORM;
+		    shaderProgramDescriptor.reflection.buffers[{C_LIGHT_SLOT, ShaderType::FRAGMENT}] = BufferType::STORAGE;
 		    shaderProgramDescriptor.reflection.buffers[{12, ShaderType::FRAGMENT}] = BufferType::UNIFORM;
+		    shaderProgramDescriptor.reflection.buffers[{C_CLUSTER_SLOT, ShaderType::FRAGMENT}] = BufferType::STORAGE;
+		    shaderProgramDescriptor.reflection.buffers[{C_LIGHT_INDEX_SLOT, ShaderType::FRAGMENT}] = BufferType::STORAGE;
+		    shaderProgramDescriptor.reflection.buffers[{C_CLUSTER_DATA_SLOT, ShaderType::FRAGMENT}] = BufferType::UNIFORM;
 		    pbrShader = Device::Get()->CreateShader(shaderProgramDescriptor);
 	    }
     );
@@ -218,31 +235,6 @@ void SceneRenderer::CreateShaders()
         }
 	);
 
-    //Picking
-    taskflow.emplace([=]()
-        {
-            ShaderProgramDescriptor shaderDesc{};
-		    ShaderDescriptor vertexShader;
-		    vertexShader.path = "/Engine/Shaders/Utils/picking.vert";
-		    vertexShader.type = ShaderType::VERTEX;
-		    ShaderDescriptor fragmentShader;
-		    fragmentShader.path = "/Engine/Shaders/Utils/picking.frag";
-		    fragmentShader.type = ShaderType::FRAGMENT;
-            shaderDesc.shaders = { vertexShader, fragmentShader };
-		    VertexBufferLayout layout;
-            layout.Push<glm::vec3>();
-            layout.Push<glm::vec3>();
-            layout.Push<glm::vec2>();
-            layout.Push<glm::vec3>();
-            layout.Push<glm::vec3>();
-            shaderDesc.layout = layout;
-            shaderDesc.reflection.buffers[{0, ShaderType::VERTEX}] = BufferType::UNIFORM;
-            shaderDesc.reflection.buffers[{1, ShaderType::VERTEX}] = BufferType::UNIFORM;
-            shaderDesc.reflection.buffers[{ 13, ShaderType::FRAGMENT }] = BufferType::UNIFORM;
-		    m_pickingShader = Device::Get()->CreateShader(shaderDesc);
-        }
-	);
-
     //Shadow
     taskflow.emplace([=]()
         {
@@ -256,8 +248,11 @@ void SceneRenderer::CreateShaders()
             layout.Push<glm::vec2>();
             layout.Push<glm::vec3>();
             layout.Push<glm::vec3>();
+            layout.Push<glm::u8vec4>(1, false);
+            layout.Push<glm::u8vec4>(1, true);
             desc.layout = layout;
-            desc.reflection.buffers[{0, ShaderType::VERTEX}] = BufferType::UNIFORM;
+            desc.reflection.buffers[{C_INSTANCE_SLOT, ShaderType::VERTEX}] = BufferType::STORAGE;
+            desc.reflection.buffers[{C_SKINNING_SLOT, ShaderType::VERTEX}] = BufferType::UNIFORM;
             desc.reflection.buffers[{ C_CONSTANT_BUFFER_SLOT, ShaderType::VERTEX}] = BufferType::CONSTANT;
             m_shadowShader = Device::Get()->CreateShader(desc);
         });
@@ -306,6 +301,14 @@ void SceneRenderer::CreateOffscreenPasses()
         renderPassDescriptor.colorAttachments = { color };
         renderPassDescriptor.depthStencilAttachment = { depth };
         pbrPipeline = Device::Get()->CreateGraphicsPipeline(pipelineDescriptor, renderPassDescriptor);
+
+        pipelineDescriptor.vertexConstants = { C_SKINNED_CONSTANT };
+        renderPassDescriptor.name = "PBR_skinned";
+        depth.loadOperation = AttachmentLoadOperation::LOAD;
+        color.loadOperation = AttachmentLoadOperation::LOAD;
+        renderPassDescriptor.colorAttachments = { color };
+        renderPassDescriptor.depthStencilAttachment = { depth };
+        m_skinnedPbrPipeline = Device::Get()->CreateGraphicsPipeline(pipelineDescriptor, renderPassDescriptor);
     }
 
     //Skybox
@@ -376,42 +379,6 @@ void SceneRenderer::CreateOffscreenPasses()
         postprocessPipeline = Device::Get()->CreateGraphicsPipeline(pipelineDescriptor, renderPassDescriptor);
     }
 
-    //Picking
-    {
-        TextureDescriptor colorAttachmentDesc{};
-        colorAttachmentDesc.format = Format::BGRA8_UNORM;
-        colorAttachmentDesc.type = TextureType::TEXTURE_2D;
-        colorAttachmentDesc.width = viewport.x;
-        colorAttachmentDesc.height = viewport.y;
-        colorAttachmentDesc.componentAmount = 4;
-        const auto colorAttachment = Device::Get()->CreateTexture(colorAttachmentDesc, {});
-        colorAttachment->SetSampler(defaultSampler);
-        TextureDescriptor depthAttachmentDesc{};
-        depthAttachmentDesc.format = Format::D32_SFLOAT_S8_UINT;
-        depthAttachmentDesc.type = TextureType::TEXTURE_2D;
-        depthAttachmentDesc.width = viewport.x;
-        depthAttachmentDesc.height = viewport.y;
-        const auto depthAttachment = Device::Get()->CreateTexture(depthAttachmentDesc, {});
-
-        GraphicsPipelineDescriptor pipelineDescriptor{};
-        pipelineDescriptor.shader = m_pickingShader;
-
-        RenderPassDescriptor renderPassDescriptor{};
-        renderPassDescriptor.extent = viewport;
-        renderPassDescriptor.offscreen = true;
-        renderPassDescriptor.name = "Picking";
-        AttachmentDescriptor depth{};
-        depth.loadOperation = AttachmentLoadOperation::CLEAR;
-        depth.texture = depthAttachment;
-        AttachmentDescriptor color{};
-        color.texture = colorAttachment;
-        color.loadOperation = AttachmentLoadOperation::CLEAR;
-        color.storeOperation = AttachmentStoreOperation::STORE;
-        renderPassDescriptor.colorAttachments = { color };
-        renderPassDescriptor.depthStencilAttachment = { depth };
-        m_pickingPipeline = Device::Get()->CreateGraphicsPipeline(pipelineDescriptor, renderPassDescriptor);
-    }
-
     //Shadow
     {
         TextureDescriptor depthDesc = helpers::CreateTextureDescriptor(C_SHADOWMAP_WIDTH, C_SHADOWMAP_HEIGHT, TextureType::TEXTURE_2D, Format::D32_SFLOAT);
@@ -430,6 +397,11 @@ void SceneRenderer::CreateOffscreenPasses()
         AttachmentDescriptor depthAttachment = helpers::CreateAttachmentDescriptor(depth);
         RenderPassDescriptor renderPassDecs = helpers::CreateRenderPassDescriptor({ C_SHADOWMAP_WIDTH, C_SHADOWMAP_HEIGHT }, {}, depthAttachment);
         m_shadowPipeline = Device::Get()->CreateGraphicsPipeline(pipelineDesc, renderPassDecs);
+
+        pipelineDesc.vertexConstants = { C_SKINNED_CONSTANT };
+        renderPassDecs.name = "Shadow_skinned";
+        renderPassDecs.depthStencilAttachment.loadOperation = AttachmentLoadOperation::LOAD;
+        m_skinnedShadowPipeline = Device::Get()->CreateGraphicsPipeline(pipelineDesc, renderPassDecs);
     }
 }
 
@@ -483,17 +455,27 @@ void SceneRenderer::CreateOnscreenPasses()
 void SceneRenderer::CreateBuffers()
 {
     const size_t maxEntitiesAmount = 512;
-    const size_t transformBufferSize = maxEntitiesAmount * sizeof(UBTransformData);
-    const size_t materialDataBufferSize = maxEntitiesAmount * sizeof(MaterialData);
     m_drawList.reserve(maxEntitiesAmount);
 
     uniformBufferSet = std::make_shared<UniformBufferSet>(1);
-    uniformBufferSet->Create(65536, 0);
+    uniformBufferSet->Set(CreateStorageBuffer(C_MAX_INSTANCES * sizeof(InstanceData)), 0, C_INSTANCE_SLOT);
+    uniformBufferSet->Set(CreateStorageBuffer(C_MAX_LIGHTS * sizeof(LightData)), 0, C_LIGHT_SLOT);
+    uniformBufferSet->Set(CreateStorageBuffer(LightClusterGrid::C_CLUSTER_COUNT * sizeof(LightClusterGrid::Cluster)), 0, C_CLUSTER_SLOT);
+    uniformBufferSet->Set(CreateStorageBuffer(C_MAX_LIGHT_INDICES * sizeof(uint32_t)), 0, C_LIGHT_INDEX_SLOT);
     uniformBufferSet->Create(sizeof(UBCameraData), 1);
     uniformBufferSet->Create(65536, 2);
-    uniformBufferSet->Create(sizeof(UBLightData), 11);
     uniformBufferSet->Create(sizeof(SceneRendererSettings), 12);
-    uniformBufferSet->Create(65536, 13);
+    uniformBufferSet->Create(sizeof(UBClusterData), C_CLUSTER_DATA_SLOT);
+    uniformBufferSet->Create(C_SKINNING_PALETTE_SIZE * C_MAX_SKINNING_PALETTES, C_SKINNING_SLOT);
+
+    m_skinningPalettes.reserve(C_SKINNING_PALETTE_ROWS * C_MAX_SKINNING_PALETTES);
+    for (size_t joint = 0; joint < C_MAX_JOINTS; joint++)
+    {
+        m_skinningPalettes.emplace_back(1.0f, 0.0f, 0.0f, 0.0f);
+        m_skinningPalettes.emplace_back(0.0f, 1.0f, 0.0f, 0.0f);
+        m_skinningPalettes.emplace_back(0.0f, 0.0f, 1.0f, 0.0f);
+    }
+    uniformBufferSet->Get(C_SKINNING_SLOT)->SetData(m_skinningPalettes.data(), C_SKINNING_PALETTE_SIZE);
 
     {
         BufferDescriptor bufferDescriptor{};
@@ -513,48 +495,155 @@ void SceneRenderer::CreateBuffers()
 
 }
 
-void SceneRenderer::SubmitMeshNode(const std::shared_ptr<MeshNode>& meshNode, const std::shared_ptr<Material>& material, const glm::mat4& transform)
+void SceneRenderer::SubmitMeshNode(const MeshNode& meshNode,
+                                   const Material& material,
+                                   const glm::mat4& transform,
+                                   const std::vector<glm::vec4>& skinningPalette,
+                                   const glm::vec4& tint,
+                                   bool isOccluder)
+{
+    const bool isSkinned = meshNode.skeleton && meshNode.skeleton->GetJointCount() > 0;
+    const uint32_t paletteOffset = isSkinned ? PushSkinningPalette(skinningPalette) : 0;
+    SubmitMeshTree(meshNode, material, transform, isSkinned, paletteOffset, tint, isOccluder);
+}
+
+void SceneRenderer::SubmitMesh(const Mesh& mesh, const Material& material, const glm::mat4& transform)
+{
+    SubmitMesh(mesh, material, transform, false, 0, glm::vec4(1.0f), false);
+}
+
+void SceneRenderer::SubmitMeshTree(const MeshNode& meshNode,
+                                   const Material& material,
+                                   const glm::mat4& transform,
+                                   bool isSkinned,
+                                   uint32_t paletteOffset,
+                                   const glm::vec4& tint,
+                                   bool isOccluder)
 {
-    for (const auto& mesh: meshNode->meshes)
+    for (const auto& mesh: meshNode.meshes)
     {
-        SubmitMesh(mesh, material, transform);
+        SubmitMesh(*mesh, material, transform, isSkinned, paletteOffset, tint, isOccluder);
     }
 
-    for (const auto& child: meshNode->children)
+    for (const auto& child: meshNode.children)
     {
-        SubmitMeshNode(child, material, transform);
+        SubmitMeshTree(*child, material, transform, isSkinned, paletteOffset, tint, isOccluder);
     }
 }
 
-void SceneRenderer::SubmitMesh(const std::shared_ptr<Mesh>& mesh, const std::shared_ptr<Material>& material, const glm::mat4& transform)
+void SceneRenderer::SubmitMesh(const Mesh& mesh,
+                               const Material& material,
+                               const glm::mat4& transform,
+                               bool isSkinned,
+                               uint32_t paletteOffset,
+                               const glm::vec4& tint,
+                               bool isOccluder)
 {
     DrawCommand dc;
-    dc.mesh = mesh;
-    dc.material = material;
+    dc.mesh = &mesh;
+    dc.material = &material;
     dc.transform = transform;
+    dc.isSkinned = isSkinned;
+    dc.paletteOffset = paletteOffset;
+    dc.tint = tint;
+    dc.bounds = mesh.GetBounds().Transform(transform);
+    dc.isOccluder = isOccluder && !mesh.GetOccluder().IsEmpty();
 
+    m_cullingStream.Push(dc.bounds);
     m_drawList.emplace_back(dc);
 }
 
+uint32_t SceneRenderer::PushSkinningPalette(const std::vector<glm::vec4>& palette)
+{
+    R_CORE_ASSERT(palette.size() <= C_SKINNING_PALETTE_ROWS, "");
+    // Instances over the limit are drawn in the bind pose
+    if (palette.empty() || m_skinningPalettes.size() >= C_SKINNING_PALETTE_ROWS * C_MAX_SKINNING_PALETTES)
+    {
+        return 0;
+    }
+
+    const size_t offset = m_skinningPalettes.size();
+    m_skinningPalettes.insert(m_skinningPalettes.end(), palette.begin(), palette.end());
+    m_skinningPalettes.resize(offset + C_SKINNING_PALETTE_ROWS);
+    return static_cast<uint32_t>(offset * sizeof(glm::vec4));
+}
+
+void SceneRenderer::UploadSkinningPalettes()
+{
+    // Identity palette in the first slot never changes
+    if (m_skinningPalettes.size() > C_SKINNING_PALETTE_ROWS)
+    {
+        uniformBufferSet->Get(C_SKINNING_SLOT)->SetData(m_skinningPalettes.data() + C_SKINNING_PALETTE_ROWS,
+                                                         (m_skinningPalettes.size() - C_SKINNING_PALETTE_ROWS) * sizeof(glm::vec4),
+                                                         C_SKINNING_PALETTE_SIZE);
+    }
+}
+
 void SceneRenderer::BeginScene(const CameraData& cameraData,
                                const std::shared_ptr<EnvironmentContext>& environment,
                                const std::vector<LightData>& lights,
                                const SceneRendererSettings& rendererSettings)
 {
-    R_CORE_ASSERT(lights.size() < 30, "");
     camera = cameraData;
     cameraDataUB.position = glm::vec4(camera.position, 1.0);
     auto projection = camera.projection;
     projection[1][1] *= -1;
     cameraDataUB.viewProjection = projection * camera.view;
 
-    lightDataUB.lightsAmount = lights.size();
-    memcpy(&lightDataUB.light, lights.data(), lights.size() * sizeof(LightData));
     sceneEnvironment = *environment;
 
     uniformBufferSet->Get(1)->SetData(&cameraDataUB, sizeof(cameraDataUB));
-    uniformBufferSet->Get(11)->SetData(&lightDataUB, sizeof(lightDataUB));
     uniformBufferSet->Get(12)->SetData(&rendererSettings, sizeof(rendererSettings));
+    UploadLights(lights);
+}
+
+void SceneRenderer::UploadLights(const std::vector<LightData>& lights)
+{
+    m_lights.clear();
+    m_clusterLights.clear();
+    for (const auto& light : lights)
+    {
+        if (light.type == static_cast<int>(LightType::DIRECTIONAL))
+        {
+            m_lights.push_back(light);
+        }
+    }
+    const uint32_t directionalCount = static_cast<uint32_t>(m_lights.size());
+    for (const auto& light : lights)
+    {
+        if (light.type == static_cast<int>(LightType::DIRECTIONAL))
+        {
+            continue;
+        }
+        if (m_lights.size() == C_MAX_LIGHTS)
+        {
+            R_CORE_WARN("Light buffer is full, {0} lights are skipped", lights.size() - m_lights.size());
+            break;
+        }
+        m_clusterLights.push_back({ glm::vec3(light.position), light.radiusOuter, static_cast<uint32_t>(m_lights.size()) });
+        m_lights.push_back(light);
+    }
+
+    m_lightClusters.Build(camera.view, camera.projection, camera.zNear, camera.zFar, m_clusterLights, C_MAX_LIGHT_INDICES);
+
+    clusterDataUB.viewDepthRow = -glm::vec4(camera.view[0][2], camera.view[1][2], camera.view[2][2], camera.view[3][2]);
+    clusterDataUB.tileSize = glm::vec2(viewport) / glm::vec2(LightClusterGrid::C_TILES_X, LightClusterGrid::C_TILES_Y);
+    clusterDataUB.sliceScale = m_lightClusters.GetSliceScale();
+    clusterDataUB.sliceBias = m_lightClusters.GetSliceBias();
+    clusterDataUB.grid = { LightClusterGrid::C_TILES_X, LightClusterGrid::C_TILES_Y, LightClusterGrid::C_SLICES, directionalCount };
+
+    const auto& clusters = m_lightClusters.GetClusters();
+    const auto& lightIndices = m_lightClusters.GetLightIndices();
+    if (!m_lights.empty())
+    {
+        uniformBufferSet->Get(C_LIGHT_SLOT)->SetData(m_lights.data(), m_lights.size() * sizeof(LightData));
+    }
+    uniformBufferSet->Get(C_CLUSTER_SLOT)->SetData(clusters.data(), clusters.size() * sizeof(LightClusterGrid::Cluster));
+    if (!lightIndices.empty())
+    {
+        uniformBufferSet->Get(C_LIGHT_INDEX_SLOT)->SetData(lightIndices.data(), lightIndices.size() * sizeof(uint32_t));
+    }
+    uniformBufferSet->Get(C_CLUSTER_DATA_SLOT)->SetData(&clusterDataUB, sizeof(clusterDataUB));
 }
 
 void SceneRenderer::EndScene()
@@ -562,13 +651,20 @@ void SceneRenderer::EndScene()
 	Timer timer;
     std::vector<PassInfo> passInfo;
 
+    // All palettes of the frame go to GPU with a single copy
+    UploadSkinningPalettes();
+
+    PassInfo shadowPassInfo{ "Shadow" };
     timer.Start();
-    ShadowPass();
-    passInfo.push_back({ "Shadow", timer.TimeInMilliseconds() });
+    ShadowPass(shadowPassInfo);
+    shadowPassInfo.m_time = timer.TimeInMilliseconds();
+    passInfo.push_back(shadowPassInfo);
 
+    PassInfo pbrPassInfo{ "PBR" };
     timer.Start();
-    PBRPass();
-    passInfo.push_back({ "PBR", timer.TimeInMilliseconds() });
+    PBRPass(pbrPassInfo);
+    pbrPassInfo.m_time = timer.TimeInMilliseconds();
+    passInfo.push_back(pbrPassInfo);
 
     timer.Start();
     SkyboxPass();
@@ -586,15 +682,129 @@ void SceneRenderer::EndScene()
     Present();
     passInfo.push_back({ "Present", timer.TimeInMilliseconds() });
     Clear();
+    std::lock_guard lock(m_passInfoMutex);
     m_passInfo = std::move(passInfo);
 }
 
-void SceneRenderer::ShadowPass()
+std::vector<PassInfo> SceneRenderer::GetPassInfo() const
+{
+    std::lock_guard lock(m_passInfoMutex);
+    return m_passInfo;
+}
+
+void SceneRenderer::CullDraws(const glm::mat4& viewProjection, std::vector<uint32_t>& visibleDraws)
+{
+    visibleDraws.clear();
+    if (m_drawList.empty())
+    {
+        return;
+    }
+
+    const Frustum frustum = Frustum::FromMatrix(viewProjection);
+    m_visibilityMasks.resize(m_cullingStream.GetGroupCount());
+    Instance().Service<ThreadService>().ParallelFor(m_cullingStream.GetGroupCount(),
+                                                    C_CULLING_GROUPS_PER_BATCH,
+                                                    [&](size_t begin, size_t end)
+    {
+        m_cullingStream.Cull(frustum, begin, end, m_visibilityMasks.data());
+    });
+    m_cullingStream.GatherVisible(m_visibilityMasks, visibleDraws);
+}
+
+void SceneRenderer::CullOccluded(std::vector<uint32_t>& visibleDraws, PassInfo& passInfo)
+{
+    const glm::ivec2 size = glm::max(viewport / C_OCCLUSION_DOWNSCALE, glm::ivec2(1));
+    m_occlusionBuffer.Begin(size.x, size.y, cameraDataUB.viewProjection);
+    for (const uint32_t draw : visibleDraws)
+    {
+        const auto& dc = m_drawList[draw];
+        if (dc.isOccluder)
+        {
+            m_occlusionBuffer.AddOccluder(dc.mesh->GetOccluder(), dc.transform);
+        }
+    }
+    if (m_occlusionBuffer.GetTriangleCount() == 0)
+    {
+        return;
+    }
+
+    auto& threadService = Instance().Service<ThreadService>();
+    threadService.ParallelFor(m_occlusionBuffer.GetTileRowCount(), 1, [&](size_t begin, size_t end)
+    {
+        m_occlusionBuffer.RasterizeRows(begin, end);
+    });
+
+    m_occlusionResults.resize(visibleDraws.size());
+    threadService.ParallelFor(visibleDraws.size(), C_OCCLUSION_TESTS_PER_BATCH, [&](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; i++)
+        {
+            // Simplified occluders may bulge out of their meshes, so they never hide themselves
+            const auto& dc = m_drawList[visibleDraws[i]];
+            m_occlusionResults[i] = dc.isOccluder || m_occlusionBuffer.IsVisible(dc.bounds);
+        }
+    });
+
+    size_t visibleCount = 0;
+    for (size_t i = 0; i < visibleDraws.size(); i++)
+    {
+        if (m_occlusionResults[i])
+        {
+            visibleDraws[visibleCount++] = visibleDraws[i];
+        }
+    }
+    passInfo.m_occludedCount += visibleDraws.size() - visibleCount;
+    visibleDraws.resize(visibleCount);
+}
+
+void SceneRenderer::BuildInstanceBatches(std::vector<uint32_t>& visibleDraws)
+{
+    const auto batchKey = [this](uint32_t draw)
+    {
+        const auto& dc = m_drawList[draw];
+        return std::make_tuple(dc.isSkinned, dc.mesh, dc.material, dc.paletteOffset);
+    };
+    // Skinned batches go last, submission order is kept inside a batch
+    std::sort(visibleDraws.begin(), visibleDraws.end(), [&](uint32_t a, uint32_t b)
+    {
+        return std::make_pair(batchKey(a), a) < std::make_pair(batchKey(b), b);
+    });
+
+    m_instanceBatches.clear();
+    m_instanceData.clear();
+    const uint32_t firstInstance = m_instanceCount;
+    for (const uint32_t draw : visibleDraws)
+    {
+        if (m_instanceCount == C_MAX_INSTANCES)
+        {
+            R_CORE_WARN("Instance buffer is full, {0} draws are skipped", visibleDraws.size() - m_instanceData.size());
+            break;
+        }
+        if (m_instanceBatches.empty() || batchKey(m_instanceBatches.back().draw) != batchKey(draw))
+        {
+            m_instanceBatches.push_back({ draw, m_instanceCount, 0 });
+        }
+        m_instanceBatches.back().instanceCount++;
+        const auto& dc = m_drawList[draw];
+        m_instanceData.push_back({ dc.transform, dc.tint });
+        m_instanceCount++;
+    }
+
+    if (!m_instanceData.empty())
+    {
+        uniformBufferSet->Get(C_INSTANCE_SLOT)->SetData(m_instanceData.data(),
+                                                        m_instanceData.size() * sizeof(InstanceData),
+                                                        firstInstance * sizeof(InstanceData));
+    }
+}
+
+void SceneRenderer::ShadowPass(PassInfo& passInfo)
 {
     renderer.SetPipeline(m_shadowPipeline);
     renderer.BeginFrame();
-    std::vector<std::shared_ptr<RendererState>> rendererStates(512);
-    auto& transformBuffer = uniformBufferSet->Get(0);
+    std::vector<std::shared_ptr<RendererState>> rendererStates;
+    auto& instanceBuffer = uniformBufferSet->Get(C_INSTANCE_SLOT);
+    auto& paletteBuffer = uniformBufferSet->Get(C_SKINNING_SLOT);
 
     struct ConstantBuffer
     {
@@ -603,13 +813,28 @@ void SceneRenderer::ShadowPass()
     } constantBuffer;
 
     std::vector<std::shared_ptr<Buffer>> lightBuffers;
+    // Drawn after all lights by the skinned pass, paired with the light buffer index
+    std::vector<std::pair<InstanceBatch, size_t>> skinnedBatches;
+
+    const auto drawBatch = [&](const InstanceBatch& batch, const std::shared_ptr<Buffer>& lightBuffer)
+    {
+        const auto& dc = m_drawList[batch.draw];
+        auto& rs = rendererStates.emplace_back(RendererCommand::CreateRendererState());
+        rs->SetVertexBuffer(instanceBuffer, C_INSTANCE_SLOT);
+        rs->SetVertexBuffer(paletteBuffer, C_SKINNING_SLOT, dc.paletteOffset, C_SKINNING_PALETTE_SIZE);
+        rs->SetVertexBuffer(lightBuffer, C_CONSTANT_BUFFER_SLOT, 0, 128);
 
-    for (int lightIdx = 0; lightIdx < lightDataUB.lightsAmount; lightIdx++)
+        rs->OnUpdate(renderer.GetActivePipeline());
+        renderer.EncodeState(rs);
+        renderer.Draw(*dc.mesh, batch.instanceCount, batch.firstInstance);
+    };
+
+    // Directional lights are at the start of the light list
+    for (const auto& light : m_lights)
     {
-        const auto& light = lightDataUB.light[lightIdx];
-        if (light.type != 0)
+        if (light.type != static_cast<int>(LightType::DIRECTIONAL))
         {
-            continue;
+            break;
         }
 
         constantBuffer.lightSpaceMatrix = light.lightSpace;
@@ -621,62 +846,79 @@ void SceneRenderer::ShadowPass()
         desc.type = BufferType::CONSTANT;
         lightBuffers.push_back(Device::Get()->CreateBuffer(desc, &constantBuffer));
 
-        uint32_t transformBufferOffset = 0;
-        for (int i = 0; i < m_drawList.size(); i++)
-        {
-            auto& dc = m_drawList[i];
-            const size_t transformDataSize = Device::Get()->GetAlignedGPUDataSize(sizeof(UBTransformData));
-            transformBuffer->SetData(&dc.transform, transformDataSize, transformBufferOffset);
-
-            auto& rs = rendererStates[i];
-            rs = RendererCommand::CreateRendererState();
-            rs->SetVertexBuffer(transformBuffer, 0, transformBufferOffset, sizeof(UBTransformData));
-            rs->SetVertexBuffer(lightBuffers.back(), C_CONSTANT_BUFFER_SLOT, 0, 128);
+        CullDraws(light.lightSpace, m_visibleDraws);
+        passInfo.m_visibleCount += m_visibleDraws.size();
+        passInfo.m_culledCount += m_drawList.size() - m_visibleDraws.size();
+        BuildInstanceBatches(m_visibleDraws);
+        passInfo.m_drawCallCount += m_instanceBatches.size();
 
-            rs->OnUpdate(renderer.GetActivePipeline());
-            renderer.EncodeState(rs);
-            renderer.Draw(dc.mesh);
-
-            transformBufferOffset += transformDataSize;
+        for (const auto& batch : m_instanceBatches)
+        {
+            if (m_drawList[batch.draw].isSkinned)
+            {
+                skinnedBatches.emplace_back(batch, lightBuffers.size() - 1);
+                continue;
+            }
+            drawBatch(batch, lightBuffers.back());
         }
     }
 
     renderer.EndFrame();
+
+    if (skinnedBatches.empty())
+    {
+        return;
+    }
+    renderer.SetPipeline(m_skinnedShadowPipeline);
+    renderer.BeginFrame();
+    for (const auto& [batch, lightBuffer] : skinnedBatches)
+    {
+        drawBatch(batch, lightBuffers[lightBuffer]);
+    }
+    renderer.EndFrame();
 }
 
-void SceneRenderer::PBRPass()
+void SceneRenderer::PBRPass(PassInfo& passInfo)
 {
-    renderer.SetPipeline(pbrPipeline);
-    renderer.BeginFrame();
-    std::vector<std::shared_ptr<RendererState>> rendererStates(512);
+    std::vector<std::shared_ptr<RendererState>> rendererStates;
 
-    auto& transformBuffer = uniformBufferSet->Get(0);
+    auto& instanceBuffer = uniformBufferSet->Get(C_INSTANCE_SLOT);
     auto& cameraBuffer = uniformBufferSet->Get(1);
     auto& materialBuffer = uniformBufferSet->Get(2);
-    auto& lightBuffer = uniformBufferSet->Get(11);
+    auto& lightBuffer = uniformBufferSet->Get(C_LIGHT_SLOT);
+    auto& clusterBuffer = uniformBufferSet->Get(C_CLUSTER_SLOT);
+    auto& lightIndexBuffer = uniformBufferSet->Get(C_LIGHT_INDEX_SLOT);
+    auto& clusterDataBuffer = uniformBufferSet->Get(C_CLUSTER_DATA_SLOT);
+    auto& paletteBuffer = uniformBufferSet->Get(C_SKINNING_SLOT);
+
+    // Flipped Y of the Vulkan projection only swaps the top and bottom planes
+    CullDraws(cameraDataUB.viewProjection, m_visibleDraws);
+    CullOccluded(m_visibleDraws, passInfo);
+    passInfo.m_visibleCount = m_visibleDraws.size();
+    passInfo.m_culledCount = m_drawList.size() - m_visibleDraws.size();
+    BuildInstanceBatches(m_visibleDraws);
+    passInfo.m_drawCallCount = m_instanceBatches.size();
 
-    uint32_t transformBufferOffset = 0;
     uint32_t materialBufferOffset = 0;
-    for (int i = 0; i < m_drawList.size(); i++)
+    const auto drawBatch = [&](const InstanceBatch& batch)
     {
-        auto& dc = m_drawList[i];
-        const size_t transformDataSize = Device::Get()->GetAlignedGPUDataSize(sizeof(UBTransformData));
+        const auto& dc = m_drawList[batch.draw];
         const size_t materialDataSize = Device::Get()->GetAlignedGPUDataSize(sizeof(MaterialData));
-        transformBuffer->SetData(&dc.transform, transformDataSize, transformBufferOffset);
-        materialBuffer->SetData(&dc.material->materialData, materialDataSize, materialBufferOffset);
+        materialBuffer->SetData(&dc.material->materialData, sizeof(MaterialData), materialBufferOffset);
 
-        auto& rs = rendererStates[i];
-        rs = RendererCommand::CreateRendererState();
-        rs->SetVertexBuffer(transformBuffer, 0, transformBufferOffset, sizeof(UBTransformData));
+        auto& rs = rendererStates.emplace_back(RendererCommand::CreateRendererState());
+        rs->SetVertexBuffer(instanceBuffer, C_INSTANCE_SLOT);
         rs->SetVertexBuffer(cameraBuffer, 1);
+        rs->SetVertexBuffer(paletteBuffer, C_SKINNING_SLOT, dc.paletteOffset, C_SKINNING_PALETTE_SIZE);
         rs->SetFragmentBuffer(materialBuffer, 2, materialBufferOffset, sizeof(MaterialData));
-        rs->SetFragmentBuffer(lightBuffer, 11);
+        rs->SetFragmentBuffer(lightBuffer, C_LIGHT_SLOT);
+        rs->SetFragmentBuffer(clusterBuffer, C_CLUSTER_SLOT);
+        rs->SetFragmentBuffer(lightIndexBuffer, C_LIGHT_INDEX_SLOT);
+        rs->SetFragmentBuffer(clusterDataBuffer, C_CLUSTER_DATA_SLOT);
 
         rs->SetTexture(GetTexture(dc.material->textureData.albedo), 3);
         rs->SetTexture(GetTexture(dc.material->textureData.normal), 4);
-        rs->SetTexture(GetTexture(dc.material->textureData.metallic), 5);
-        rs->SetTexture(GetTexture(dc.material->textureData.roughness), 6);
-        rs->SetTexture(GetTexture(dc.material->textureData.ao), 7);
+        rs->SetTexture(GetTexture(dc.material->textureData.orm), 5);
         rs->SetTexture(sceneEnvironment.irradianceMap, 8);
         rs->SetTexture(sceneEnvironment.prefilterMap, 9);
         rs->SetTexture(sceneEnvironment.brdfLut, 10);
@@ -684,11 +926,27 @@ void SceneRenderer::PBRPass()
 
         rs->OnUpdate(renderer.GetActivePipeline());
         renderer.EncodeState(rs);
-        renderer.Draw(dc.mesh);
+        renderer.Draw(*dc.mesh, batch.instanceCount, batch.firstInstance);
 
-        transformBufferOffset += transformDataSize;
         materialBufferOffset += materialDataSize;
+    };
+
+    // Static batches always run the PBR pass, it clears the attachments
+    const auto firstSkinned = std::partition_point(m_instanceBatches.begin(), m_instanceBatches.end(),
+                                                   [this](const InstanceBatch& batch)
+                                                   { return !m_drawList[batch.draw].isSkinned; });
+    renderer.SetPipeline(pbrPipeline);
+    renderer.BeginFrame();
+    std::for_each(m_instanceBatches.begin(), firstSkinned, drawBatch);
+    renderer.EndFrame();
+
+    if (firstSkinned == m_instanceBatches.end())
+    {
+        return;
     }
+    renderer.SetPipeline(m_skinnedPbrPipeline);
+    renderer.BeginFrame();
+    std::for_each(firstSkinned, m_instanceBatches.end(), drawBatch);
     renderer.EndFrame();
 }
 
@@ -751,6 +1009,9 @@ void SceneRenderer::Present()
 void SceneRenderer::Clear()
 {
     m_drawList.clear();
+    m_cullingStream.Clear();
+    m_instanceCount = 0;
+    m_skinningPalettes.resize(C_SKINNING_PALETTE_ROWS);
 }
 
 void SceneRenderer::Resize(int x, int y)
@@ -759,94 +1020,6 @@ void SceneRenderer::Resize(int x, int y)
     CreateOffscreenPasses();
 }
 
-uint32_t SceneRenderer::Pick(const std::shared_ptr<Scene>& scene, const glm::vec2& pos)
-{
-    CameraData cameraData{};
-    for (const auto eCamera : scene->GetRegistry().view<CameraComponent>())
-    {
-        auto& camera = scene->GetRegistry().get<CameraComponent>(eCamera);
-        auto& transform = scene->GetRegistry().get<TransformComponent>(eCamera);
-        if (camera.isPrimary)
-        {
-            cameraData.position = transform.GetWorldPosition();
-            cameraData.view = camera.GetViewMatrix(cameraData.position);
-            cameraData.projection = camera.GetProjectionMatrix();
-            break;
-        }
-    }
-
-    auto& am = AssetManager::Get();
-    std::vector<DrawCommand> drawList;
-    std::vector<UBColorId> colorIds;
-    for (const auto eMesh : scene->GetRegistry().view<MeshComponent>())
-    {
-        auto& transform = scene->GetRegistry().get<TransformComponent>(eMesh);
-        auto& mc = scene->GetRegistry().get<MeshComponent>(eMesh);
-        auto material = am.GetAsset<Material>(mc.material);
-        for (const auto& mesh : am.GetAsset<MeshNode>(mc.mesh)->meshes)
-        {
-            auto& dc = drawList.emplace_back();
-            dc.material = material;
-            dc.mesh = mesh;
-            dc.transform = transform.GetWorldTransformMatrix();
-        }
-        auto& tag = scene->GetRegistry().get<TagComponent>(eMesh);
-        colorIds.emplace_back().color = IdToColor(tag.colorId) / 255.0f;
-    }
-
-    UBCameraData ubCameraData;
-    ubCameraData.position = glm::vec4(cameraData.position, 1.0);
-    auto projection = cameraData.projection;
-    projection[1][1] *= -1;
-    ubCameraData.viewProjection = projection * cameraData.view;
-
-    uniformBufferSet->Get(1)->SetData(&ubCameraData, sizeof(ubCameraData));
-
-    renderer.SetPipeline(m_pickingPipeline);
-    renderer.BeginFrame();
-    std::vector<std::shared_ptr<RendererState>> rendererStates(512);
-
-    auto& transformBuffer = uniformBufferSet->Get(0);
-    auto& cameraBuffer = uniformBufferSet->Get(1);
-    auto& colorIdBuffer = uniformBufferSet->Get(13);
-
-    uint32_t transformBufferOffset = 0;
-    uint32_t colorIdOffset = 0;
-    const size_t transformDataSize = Device::Get()->GetAlignedGPUDataSize(sizeof(UBTransformData));
-    const size_t colorIdDataSize = Device::Get()->GetAlignedGPUDataSize(sizeof(UBColorId));
-    for (int i = 0; i < drawList.size(); i++)
-    {
-        auto& dc = drawList[i];
-        transformBuffer->SetData(&dc.transform, transformDataSize, transformBufferOffset);
-        colorIdBuffer->SetData(&colorIds[i], colorIdDataSize, colorIdOffset);
-
-        auto& rs = rendererStates[i];
-        rs = RendererCommand::CreateRendererState();
-        rs->SetVertexBuffer(transformBuffer, 0, transformBufferOffset, sizeof(UBTransformData));
-        rs->SetVertexBuffer(cameraBuffer, 1);
-        rs->SetFragmentBuffer(colorIdBuffer, 13, colorIdOffset, sizeof(MaterialData));
-
-        rs->OnUpdate(renderer.GetActivePipeline());
-        renderer.EncodeState(rs);
-        renderer.Draw(dc.mesh);
-
-        transformBufferOffset += transformDataSize;
-        colorIdOffset += colorIdDataSize;
-    }
-    renderer.EndFrame();
-
-    auto& texture = m_pickingPipeline->GetRenderPassDescriptor().colorAttachments[0].texture;
-    auto buffer = texture->Data();
-    auto ptr = buffer->Map();
-    std::vector<Pixel> pickData(buffer->GetDescriptor().size / sizeof(Pixel));
-    memcpy(pickData.data(), ptr, buffer->GetDescriptor().size);
-    buffer->UnMap();
-
-    auto pickedPixel = pickData[texture->GetSpecification().width * pos.y + pos.x];
-    uint32_t id = ColorToId(pickedPixel);
-    return ColorToId(pickedPixel);
-}
-
 const std::shared_ptr<GraphicsPipeline>& SceneRenderer::GetPass(PassType type) const
 {
     switch (type)
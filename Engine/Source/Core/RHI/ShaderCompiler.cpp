@@ -0,0 +1,134 @@
+#include "ShaderCompiler.hpp"
+#include "Assert.hpp"
+#include "Path.hpp"
+#include "Logger.hpp"
+#include <glslang/Include/glslang_c_interface.h>
+#include <StandAlone/ResourceLimits.h>
+#include <fstream>
+#include <sstream>
+
+using namespace RightEngine;
+
+namespace
+{
+    glslang_stage_t ToGlslangStage(ShaderType type)
+    {
+        switch (type)
+        {
+            case ShaderType::VERTEX:
+                return GLSLANG_STAGE_VERTEX;
+            case ShaderType::FRAGMENT:
+                return GLSLANG_STAGE_FRAGMENT;
+            default:
+                R_CORE_ASSERT(false, "");
+                return GLSLANG_STAGE_VERTEX;
+        }
+    }
+}
+
+void ShaderCompiler::Init()
+{
+    glslang_initialize_process();
+}
+
+std::string ShaderCompiler::ReadSource(const std::string& path)
+{
+    std::ifstream shaderStream(Path::Absolute(path));
+
+    if (!shaderStream.is_open())
+    {
+        R_CORE_ERROR("Can't open shader at path {0}", path);
+        return {};
+    }
+
+    std::string line;
+    std::stringstream ss;
+
+    while (std::getline(shaderStream, line))
+    {
+        ss << line << '\n';
+    }
+
+    return ss.str();
+}
+
+std::vector<uint32_t> ShaderCompiler::Compile(ShaderType type, const std::string& source, const std::string& name)
+{
+    const glslang_stage_t stage = ToGlslangStage(type);
+    const char* fileName = name.c_str();
+
+    glslang_input_t input{};
+    input.language = GLSLANG_SOURCE_GLSL;
+    input.stage = stage;
+    input.client = GLSLANG_CLIENT_VULKAN;
+#ifdef R_APPLE
+    input.client_version = GLSLANG_TARGET_VULKAN_1_0;
+#else
+    input.target_language_version = GLSLANG_TARGET_SPV_1_3;
+#endif
+    input.target_language = GLSLANG_TARGET_SPV;
+#ifdef R_APPLE
+    input.target_language_version = GLSLANG_TARGET_SPV_1_0;
+#else
+    input.target_language_version = GLSLANG_TARGET_SPV_1_3;
+#endif
+    input.code = source.c_str();
+    input.default_version = 450;
+    input.default_profile = GLSLANG_NO_PROFILE;
+    input.force_default_version_and_profile = false;
+    input.forward_compatible = false;
+    input.messages = GLSLANG_MSG_DEFAULT_BIT;
+    input.resource = reinterpret_cast<const glslang_resource_t*>(&glslang::DefaultTBuiltInResource);
+
+    glslang_shader_t* shader = glslang_shader_create(&input);
+
+    if (!glslang_shader_preprocess(shader, &input))
+    {
+        R_CORE_ERROR("Shader preprocessing failed. Shader name: {0}", fileName);
+        R_CORE_ERROR("{0}", glslang_shader_get_info_log(shader));
+        R_CORE_ERROR("{0}", glslang_shader_get_info_debug_log(shader));
+        R_CORE_ASSERT(false, "");
+        glslang_shader_delete(shader);
+        return {};
+    }
+
+    if (!glslang_shader_parse(shader, &input))
+    {
+        R_CORE_ERROR("Shader parsing failed. Shader name: {0}", fileName);
+        R_CORE_ERROR("{0}", glslang_shader_get_info_log(shader));
+        R_CORE_ERROR("{0}", glslang_shader_get_info_debug_log(shader));
+        R_CORE_ASSERT(false, "");
+        glslang_shader_delete(shader);
+        return {};
+    }
+
+    glslang_program_t* program = glslang_program_create();
+    glslang_program_add_shader(program, shader);
+
+    if (!glslang_program_link(program, GLSLANG_MSG_SPV_RULES_BIT | GLSLANG_MSG_VULKAN_RULES_BIT))
+    {
+        R_CORE_ERROR("GLSL linking failed {0}", fileName);
+        R_CORE_ERROR("{0}", glslang_program_get_info_log(program));
+        R_CORE_ERROR("{0}", glslang_program_get_info_debug_log(program));
+        R_CORE_ASSERT(false, "");
+        glslang_program_delete(program);
+        glslang_shader_delete(shader);
+        return {};
+    }
+
+    glslang_program_SPIRV_generate(program, stage);
+
+    std::vector<uint32_t> outShaderModule(glslang_program_SPIRV_get_size(program));
+    glslang_program_SPIRV_get(program, outShaderModule.data());
+
+    const char* spirv_messages = glslang_program_SPIRV_get_messages(program);
+    if (spirv_messages)
+    {
+        R_CORE_INFO("[{0}]: {1}", fileName, spirv_messages);
+    }
+
+    glslang_program_delete(program);
+    glslang_shader_delete(shader);
+
+    return outShaderModule;
+}
@@ -0,0 +1,373 @@
+#include "StaticBatcher.hpp"
+#include "WorldPartition.hpp"
+#include "AssetManager.hpp"
+#include "Application.hpp"
+#include "ThreadService.hpp"
+#include "Buffer.hpp"
+#include <algorithm>
+#include <numeric>
+
+using namespace RightEngine;
+
+namespace
+{
+    constexpr size_t C_ENTITIES_PER_CHUNK = 1024;
+    constexpr float C_CELL_SIZE = 32.0f;
+    // Larger meshes gain little from merging and would make every rebuild of their batch expensive
+    constexpr size_t C_MAX_MESH_VERTICES = 4096;
+
+    size_t GetVertexCount(const Mesh& mesh)
+    {
+        return mesh.GetVertexBuffer()->GetDescriptor().size / sizeof(MeshVertex);
+    }
+
+    size_t GetIndexCount(const Mesh& mesh)
+    {
+        const auto& indexBuffer = mesh.GetIndexBuffer();
+        return indexBuffer ? indexBuffer->GetDescriptor().size / sizeof(uint32_t) : GetVertexCount(mesh) - GetVertexCount(mesh) % 3;
+    }
+
+    bool IsBatchable(const MeshComponent& meshComponent, bool isAnimated)
+    {
+        return meshComponent.isStatic
+               && meshComponent.isVisible
+               && !meshComponent.isOccluder
+               && !isAnimated
+               && meshComponent.tint == glm::vec4(1.0f)
+               && meshComponent.mesh.guid.isValid()
+               && meshComponent.material.guid.isValid();
+    }
+
+    // Adds vertex counts of the tree, false when some mesh isn't made of MeshVertex
+    bool CountVertices(const MeshNode& meshNode, size_t& vertexCount)
+    {
+        for (const auto& mesh : meshNode.meshes)
+        {
+            if (!mesh->GetVertexBuffer() || !mesh->GetVertexLayout() || mesh->GetVertexLayout()->GetStride() != sizeof(MeshVertex))
+            {
+                return false;
+            }
+            vertexCount += GetVertexCount(*mesh);
+        }
+        return std::all_of(meshNode.children.begin(), meshNode.children.end(), [&](const auto& child)
+        {
+            return CountVertices(*child, vertexCount);
+        });
+    }
+
+    bool IsMergeable(const MeshNode& meshNode)
+    {
+        size_t vertexCount = 0;
+        return !meshNode.skeleton && CountVertices(meshNode, vertexCount) && vertexCount > 0 && vertexCount <= C_MAX_MESH_VERTICES;
+    }
+
+    void MergeMesh(const Mesh& mesh, const glm::mat4& transform, const glm::mat3& normalTransform, bool isMirrored, MeshData& meshData)
+    {
+        const size_t vertexCount = GetVertexCount(mesh);
+        const auto base = static_cast<uint32_t>(meshData.vertices.size());
+        // Mapping is thread safe, source buffers are only read
+        const auto* vertices = static_cast<const MeshVertex*>(mesh.GetVertexBuffer()->Map());
+        for (size_t i = 0; i < vertexCount; i++)
+        {
+            MeshVertex vertex = vertices[i];
+            vertex.position = transform * glm::vec4(vertex.position, 1.0f);
+            vertex.normal = glm::normalize(normalTransform * vertex.normal);
+            vertex.tangent = glm::normalize(glm::mat3(transform) * vertex.tangent);
+            vertex.biTangent = glm::normalize(glm::mat3(transform) * vertex.biTangent);
+            meshData.vertices.push_back(vertex);
+            meshData.bounds.Extend(vertex.position);
+        }
+        mesh.GetVertexBuffer()->UnMap();
+
+        const size_t first = meshData.indexes.size();
+        const size_t indexCount = GetIndexCount(mesh);
+        if (mesh.GetIndexBuffer())
+        {
+            const auto* indexes = static_cast<const uint32_t*>(mesh.GetIndexBuffer()->Map());
+            for (size_t i = 0; i < indexCount; i++)
+            {
+                meshData.indexes.push_back(base + indexes[i]);
+            }
+            mesh.GetIndexBuffer()->UnMap();
+        }
+        else
+        {
+            meshData.indexes.resize(first + indexCount);
+            std::iota(meshData.indexes.begin() + first, meshData.indexes.end(), base);
+        }
+
+        // Mirroring transforms flip the winding, which baked vertices can't undo
+        if (isMirrored)
+        {
+            for (size_t i = first; i + 2 < meshData.indexes.size(); i += 3)
+            {
+                std::swap(meshData.indexes[i + 1], meshData.indexes[i + 2]);
+            }
+        }
+    }
+
+    void MergeMeshTree(const MeshNode& meshNode, const glm::mat4& transform, MeshData& meshData)
+    {
+        const glm::mat3 normalTransform = glm::transpose(glm::inverse(glm::mat3(transform)));
+        const bool isMirrored = glm::determinant(glm::mat3(transform)) < 0.0f;
+        for (const auto& mesh : meshNode.meshes)
+        {
+            MergeMesh(*mesh, transform, normalTransform, isMirrored, meshData);
+        }
+        for (const auto& child : meshNode.children)
+        {
+            MergeMeshTree(*child, transform, meshData);
+        }
+    }
+
+    std::shared_ptr<Mesh> CreateMesh(const MeshData& meshData)
+    {
+        auto mesh = std::make_shared<Mesh>();
+        BufferDescriptor vertexBufferDescriptor{};
+        vertexBufferDescriptor.type = BufferType::VERTEX;
+        vertexBufferDescriptor.size = meshData.vertices.size() * sizeof(MeshVertex);
+        vertexBufferDescriptor.memoryType = MemoryType::CPU_GPU;
+        mesh->SetVertexBuffer(Device::Get()->CreateBuffer(vertexBufferDescriptor, meshData.vertices.data()),
+                              std::make_shared<VertexBufferLayout>(MeshLoader::GetVertexLayout()));
+
+        BufferDescriptor indexBufferDescriptor{};
+        indexBufferDescriptor.type = BufferType::INDEX;
+        indexBufferDescriptor.size = meshData.indexes.size() * sizeof(uint32_t);
+        indexBufferDescriptor.memoryType = MemoryType::CPU_GPU;
+        mesh->SetIndexBuffer(Device::Get()->CreateBuffer(indexBufferDescriptor, meshData.indexes.data()));
+
+        Sphere boundingSphere;
+        boundingSphere.center = meshData.bounds.GetCenter();
+        boundingSphere.radius = glm::length(meshData.bounds.GetExtent());
+        mesh->SetBounds(meshData.bounds, boundingSphere);
+        return mesh;
+    }
+}
+
+void StaticBatcher::Update(Scene& scene)
+{
+    auto& registry = scene.GetRegistry();
+    if (m_registry != &registry)
+    {
+        Clear();
+        m_registry = &registry;
+    }
+
+    m_frame++;
+    m_records.resize(registry.size());
+    FindChanges(scene);
+    for (const auto entity : m_changes)
+    {
+        ApplyChange(registry, entity);
+    }
+    MarkStaleBatches();
+    RebuildBatches(registry);
+}
+
+void StaticBatcher::Clear()
+{
+    m_registry = nullptr;
+    m_records.clear();
+    m_batches.clear();
+    m_freeBatches.clear();
+    m_batchIds.clear();
+    m_changes.clear();
+}
+
+void StaticBatcher::FindChanges(Scene& scene)
+{
+    auto& registry = scene.GetRegistry();
+    auto group = registry.group<MeshComponent>(entt::get<TransformComponent, BoundsComponent>);
+    const auto& animators = registry.storage<AnimatorComponent>();
+
+    m_changes.clear();
+    // Every entity owns its record, so workers never write the same one
+    Instance().Service<ThreadService>().ParallelFor(group.size(), C_ENTITIES_PER_CHUNK, [&](size_t begin, size_t end)
+    {
+        std::vector<entt::entity> changes;
+        for (size_t position = begin; position < end; position++)
+        {
+            const auto entity = group[position];
+            const auto& meshComponent = group.get<MeshComponent>(entity);
+            if (!IsBatchable(meshComponent, animators.contains(entity)))
+            {
+                continue;
+            }
+
+            auto& record = m_records[entt::to_entity(entity)];
+            record.frame = m_frame;
+            const auto& transform = group.get<TransformComponent>(entity);
+            if (record.entity != entity
+                || record.transformVersion != transform.GetWorldVersion()
+                || record.mesh != meshComponent.mesh.guid
+                || record.material != meshComponent.material.guid
+                || (record.batch == C_NO_BATCH && !record.isRejected))
+            {
+                changes.push_back(entity);
+            }
+        }
+
+        if (!changes.empty())
+        {
+            std::lock_guard lock(m_changeMutex);
+            m_changes.insert(m_changes.end(), changes.begin(), changes.end());
+        }
+    });
+}
+
+void StaticBatcher::ApplyChange(entt::registry& registry, entt::entity entity)
+{
+    const auto [meshComponent, transform, bounds] = registry.get<MeshComponent, TransformComponent, BoundsComponent>(entity);
+    auto& record = m_records[entt::to_entity(entity)];
+    // Batch of a previous entity with the same index notices it on its own, its member doesn't match the record anymore
+    const uint32_t previousBatch = record.entity == entity ? record.batch : C_NO_BATCH;
+    if (previousBatch != C_NO_BATCH)
+    {
+        m_batches[previousBatch].isDirty = true;
+    }
+
+    if (record.entity != entity || record.mesh != meshComponent.mesh.guid)
+    {
+        record.meshNode = AssetManager::Get().GetAsset<MeshNode>(meshComponent.mesh);
+    }
+    record.entity = entity;
+    record.transformVersion = transform.GetWorldVersion();
+    record.mesh = meshComponent.mesh.guid;
+    record.material = meshComponent.material.guid;
+    record.batch = C_NO_BATCH;
+    // Meshes which are still streamed in are retried next update
+    record.isRejected = record.meshNode && !IsMergeable(*record.meshNode);
+    if (!record.meshNode || record.isRejected || !bounds.worldBounds.IsValid())
+    {
+        return;
+    }
+
+    const auto cell = WorldPartition::GetCell(bounds.worldBounds.GetCenter(), C_CELL_SIZE);
+    record.batch = GetBatch({ record.material, WorldPartition::GetCellKey(cell) });
+    auto& batch = m_batches[record.batch];
+    batch.isDirty = true;
+    if (record.batch != previousBatch)
+    {
+        batch.members.push_back(entity);
+    }
+}
+
+uint32_t StaticBatcher::GetBatch(const BatchKey& key)
+{
+    const auto it = m_batchIds.find(key);
+    if (it != m_batchIds.end())
+    {
+        return it->second;
+    }
+
+    uint32_t id;
+    if (m_freeBatches.empty())
+    {
+        id = static_cast<uint32_t>(m_batches.size());
+        m_batches.emplace_back();
+    }
+    else
+    {
+        id = m_freeBatches.back();
+        m_freeBatches.pop_back();
+    }
+    m_batches[id].material = key.material;
+    m_batches[id].cell = key.cell;
+    m_batchIds.emplace(key, id);
+    return id;
+}
+
+void StaticBatcher::MarkStaleBatches()
+{
+    for (uint32_t id = 0; id < m_batches.size(); id++)
+    {
+        auto& batch = m_batches[id];
+        if (batch.isDirty || !batch.mesh)
+        {
+            continue;
+        }
+        batch.isDirty = std::any_of(batch.members.begin(), batch.members.end(), [&](entt::entity member)
+        {
+            const auto& record = m_records[entt::to_entity(member)];
+            return record.entity != member || record.frame != m_frame || record.batch != id;
+        });
+    }
+}
+
+void StaticBatcher::FilterMembers(uint32_t batch)
+{
+    auto& members = m_batches[batch].members;
+    members.erase(std::remove_if(members.begin(), members.end(), [&](entt::entity member)
+    {
+        auto& record = m_records[entt::to_entity(member)];
+        if (record.entity != member || record.batch != batch)
+        {
+            return true;
+        }
+        if (record.frame != m_frame)
+        {
+            // Entity isn't static anymore or was destroyed, it is compared from scratch once it's static again
+            record.batch = C_NO_BATCH;
+            return true;
+        }
+        return false;
+    }), members.end());
+}
+
+void StaticBatcher::RebuildBatches(entt::registry& registry)
+{
+    std::vector<uint32_t> dirtyBatches;
+    for (uint32_t id = 0; id < m_batches.size(); id++)
+    {
+        if (!m_batches[id].isDirty)
+        {
+            continue;
+        }
+        m_batches[id].isDirty = false;
+        FilterMembers(id);
+        if (m_batches[id].members.empty())
+        {
+            auto& batch = m_batches[id];
+            m_batchIds.erase({ batch.material, batch.cell });
+            batch = {};
+            m_freeBatches.push_back(id);
+            continue;
+        }
+        dirtyBatches.push_back(id);
+    }
+    if (dirtyBatches.empty())
+    {
+        return;
+    }
+
+    std::vector<MeshData> merged(dirtyBatches.size());
+    Instance().Service<ThreadService>().ParallelFor(dirtyBatches.size(), 1, [&](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; i++)
+        {
+            MergeMembers(registry, m_batches[dirtyBatches[i]], merged[i]);
+        }
+    });
+
+    // Buffers are created on the calling thread, render thread keeps replaced meshes alive through its frame packet
+    for (size_t i = 0; i < dirtyBatches.size(); i++)
+    {
+        m_batches[dirtyBatches[i]].mesh = CreateMesh(merged[i]);
+    }
+}
+
+void StaticBatcher::MergeMembers(const entt::registry& registry, const Batch& batch, MeshData& meshData) const
+{
+    size_t vertexCount = 0;
+    for (const auto member : batch.members)
+    {
+        CountVertices(*m_records[entt::to_entity(member)].meshNode, vertexCount);
+    }
+    meshData.vertices.reserve(vertexCount);
+
+    for (const auto member : batch.members)
+    {
+        const auto& transform = registry.get<TransformComponent>(member);
+        MergeMeshTree(*m_records[entt::to_entity(member)].meshNode, transform.GetWorldTransformMatrix(), meshData);
+    }
+}
@@ -13,6 +13,9 @@ unsigned int RightEngine::VertexBufferElement::GetSizeOfType(Format format)
             return 12;
         case Format::RGBA32_SFLOAT:
             return 16;
+        case Format::RGBA8_UINT:
+        case Format::RGBA8_UNORM:
+            return 4;
     }
     assert(false);
     return 0;
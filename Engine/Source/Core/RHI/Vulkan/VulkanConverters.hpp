@@ -68,12 +68,16 @@ namespace RightEngine
                     return VK_FORMAT_R16G16B16A16_UNORM;
                 case Format::BGRA8_UNORM:
                     return VK_FORMAT_B8G8R8A8_UNORM;
+                case Format::RGBA8_UNORM:
+                    return VK_FORMAT_R8G8B8A8_UNORM;
                 case Format::R8_SRGB:
                     return VK_FORMAT_R8_SRGB;
                 case Format::RGB8_SRGB:
                     return VK_FORMAT_R8G8B8_SRGB;
 				case Format::D32_SFLOAT:
                     return VK_FORMAT_D32_SFLOAT;
+                case Format::BC6H_UFLOAT:
+                    return VK_FORMAT_BC6H_UFLOAT_BLOCK;
                 default:
                     R_CORE_ASSERT(false, "");
             }
@@ -89,6 +93,8 @@ namespace RightEngine
                     return VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
                 case BufferType::UNIFORM:
                     return VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+                case BufferType::STORAGE:
+                    return VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
                 case BufferType::TRANSFER_DST:
                     return VK_BUFFER_USAGE_TRANSFER_DST_BIT;
                 case BufferType::TRANSFER_SRC:
@@ -97,6 +103,11 @@ namespace RightEngine
                 R_CORE_ASSERT(false, "");
             }
         }
+
+        inline static VkDescriptorType DescriptorType(BufferType type)
+        {
+            return type == BufferType::STORAGE ? VK_DESCRIPTOR_TYPE_STORAGE_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        }
 /*
         inline static VkMemoryPropertyFlags MemoryProperty(MemoryType type)
         {
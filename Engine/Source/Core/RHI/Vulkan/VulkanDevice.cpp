@@ -158,6 +158,10 @@ VulkanDevice::VulkanDevice(const std::shared_ptr<RenderingContext>& context,
     vkGetPhysicalDeviceProperties(physicalDevice, &deviceProps);
 
     properties.minUniformBufferOffsetAlignment = deviceProps.limits.minUniformBufferOffsetAlignment;
+
+    VkPhysicalDeviceFeatures supportedFeatures;
+    vkGetPhysicalDeviceFeatures(physicalDevice, &supportedFeatures);
+    properties.textureCompressionBC = supportedFeatures.textureCompressionBC;
 }
 
 void VulkanDevice::Init(const std::shared_ptr<VulkanRenderingContext>& context)
@@ -220,8 +224,12 @@ void VulkanDevice::CreateLogicalDevice(const std::shared_ptr<VulkanRenderingCont
         queueCreateInfos.push_back(queueCreateInfo);
     }
 
+    VkPhysicalDeviceFeatures supportedFeatures;
+    vkGetPhysicalDeviceFeatures(physicalDevice, &supportedFeatures);
+
     VkPhysicalDeviceFeatures deviceFeatures{};
     deviceFeatures.samplerAnisotropy = VK_TRUE;
+    deviceFeatures.textureCompressionBC = supportedFeatures.textureCompressionBC;
 
     VkDeviceCreateInfo createInfo{};
     createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
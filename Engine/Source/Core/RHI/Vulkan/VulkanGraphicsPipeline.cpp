@@ -35,7 +35,7 @@ namespace
             descriptorWrite.dstSet = descriptorSets[0];
             descriptorWrite.dstBinding = slot;
             descriptorWrite.dstArrayElement = 0;
-            descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+            descriptorWrite.descriptorType = VulkanConverters::DescriptorType(buffer->GetDescriptor().type);
             descriptorWrite.descriptorCount = 1;
             descriptorWrite.pBufferInfo = &bufferInfos.back();
 
@@ -186,6 +186,21 @@ void VulkanGraphicsPipeline::Init(const GraphicsPipelineDescriptor& descriptor,
     vertShaderStageInfo.module = std::static_pointer_cast<VulkanShader>(descriptor.shader)->GetShaderModule(ShaderModuleType::VERTEX);
     vertShaderStageInfo.pName = "main";
 
+    std::vector<VkSpecializationMapEntry> vertexConstantEntries;
+    for (uint32_t i = 0; i < descriptor.vertexConstants.size(); i++)
+    {
+        vertexConstantEntries.push_back({ i, static_cast<uint32_t>(i * sizeof(uint32_t)), sizeof(uint32_t) });
+    }
+    VkSpecializationInfo vertexSpecialization{};
+    if (!vertexConstantEntries.empty())
+    {
+        vertexSpecialization.mapEntryCount = static_cast<uint32_t>(vertexConstantEntries.size());
+        vertexSpecialization.pMapEntries = vertexConstantEntries.data();
+        vertexSpecialization.dataSize = descriptor.vertexConstants.size() * sizeof(uint32_t);
+        vertexSpecialization.pData = descriptor.vertexConstants.data();
+        vertShaderStageInfo.pSpecializationInfo = &vertexSpecialization;
+    }
+
     VkPipelineShaderStageCreateInfo fragShaderStageInfo{};
     fragShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
     fragShaderStageInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
@@ -380,11 +395,11 @@ void VulkanGraphicsPipeline::CreateDescriptorSets()
     std::vector<VkDescriptorSetLayoutBinding> bindings;
     for (const auto& [bufferRef, bufferType] : pipelineDescriptor.shader->GetShaderProgramDescriptor().reflection.buffers)
     {
-        if (bufferType == BufferType::UNIFORM)
+        if (bufferType == BufferType::UNIFORM || bufferType == BufferType::STORAGE)
         {
             VkDescriptorSetLayoutBinding bufferLayoutBinding{};
             bufferLayoutBinding.binding = bufferRef.slot;
-            bufferLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+            bufferLayoutBinding.descriptorType = VulkanConverters::DescriptorType(bufferType);
             bufferLayoutBinding.descriptorCount = 1;
             bufferLayoutBinding.stageFlags = bufferRef.stage == ShaderType::VERTEX ? VK_SHADER_STAGE_VERTEX_BIT : VK_SHADER_STAGE_FRAGMENT_BIT;
             bufferLayoutBinding.pImmutableSamplers = nullptr; // Optional
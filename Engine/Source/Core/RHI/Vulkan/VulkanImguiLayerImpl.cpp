@@ -139,13 +139,12 @@ void VulkanImguiLayerImpl::Begin()
     ImGuizmo::BeginFrame();
 }
 
-void VulkanImguiLayerImpl::End(const std::shared_ptr<CommandBuffer>& cmd)
+void VulkanImguiLayerImpl::Draw(const std::shared_ptr<ImGuiDrawData>& drawData, const std::shared_ptr<CommandBuffer>& cmd)
 {
-    ImGui::Render();
-    cmd->Enqueue([](auto buffer)
+    // Commands are recorded at the end of the pass, the copy must outlive it
+    cmd->Enqueue([drawData](auto buffer)
     {
-        ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(),
-                                        VK_CMD(buffer)->GetBuffer());
+        ImGui_ImplVulkan_RenderDrawData(&drawData->drawData, VK_CMD(buffer)->GetBuffer());
     });
 }
 
@@ -18,7 +18,7 @@ namespace RightEngine
         virtual void OnEvent(Event& event) override;
 
         virtual void Begin() override;
-        virtual void End(const std::shared_ptr<CommandBuffer>& cmd) override;
+        virtual void Draw(const std::shared_ptr<ImGuiDrawData>& drawData, const std::shared_ptr<CommandBuffer>& cmd) override;
 
         virtual void Image(const std::shared_ptr<Texture>& texture, const ImVec2& size, const ImVec2& uv0, const ImVec2& uv1) override;
         virtual void ImageButton(const std::shared_ptr<Texture>& texture, const ImVec2& size, const ImVec2& uv0, const ImVec2& uv1) override;
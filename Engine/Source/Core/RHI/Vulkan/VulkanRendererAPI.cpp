@@ -11,7 +11,7 @@
 #include "VulkanUtils.hpp"
 #include "ThreadService.hpp"
 #include "VulkanGraphicsPipeline.hpp"
-#include <glslang/Include/glslang_c_interface.h>
+#include "ShaderCompiler.hpp"
 #include <vk-tools/VulkanTools.h>
 
 using namespace RightEngine;
@@ -47,7 +47,7 @@ void VulkanRendererAPI::Init()
     CreateSyncObjects();
     Instance().Service<ThreadService>().AddBackgroundTask([=]()
         {
-            glslang_initialize_process();
+            ShaderCompiler::Init();
         });
 }
 
@@ -296,7 +296,8 @@ Viewport VulkanRendererAPI::GetViewport()
 void VulkanRendererAPI::Draw(const std::shared_ptr<CommandBuffer>& cmd,
                              const std::shared_ptr<Buffer>& buffer,
                              uint32_t vertexCount,
-                             uint32_t instanceCount)
+                             uint32_t instanceCount,
+                             uint32_t firstInstance)
 {
     const auto vulkanBuffer = std::static_pointer_cast<VulkanBuffer>(buffer);
     VkBuffer vertexBuffers[] = {vulkanBuffer->GetBuffer()};
@@ -308,7 +309,7 @@ void VulkanRendererAPI::Draw(const std::shared_ptr<CommandBuffer>& cmd,
                                vertexCount,
                                instanceCount,
                                0,
-                               0);
+                               firstInstance);
                  });
 }
 
@@ -316,7 +317,8 @@ void VulkanRendererAPI::Draw(const std::shared_ptr<CommandBuffer>& cmd,
                              const std::shared_ptr<Buffer>& vertexBuffer,
                              const std::shared_ptr<Buffer>& indexBuffer,
                              uint32_t indexCount,
-                             uint32_t instanceCount)
+                             uint32_t instanceCount,
+                             uint32_t firstInstance)
 {
     const auto vkVertexBuffer = std::static_pointer_cast<VulkanBuffer>(vertexBuffer);
     VkBuffer vertexBuffers[] = {vkVertexBuffer->GetBuffer()};
@@ -334,7 +336,7 @@ void VulkanRendererAPI::Draw(const std::shared_ptr<CommandBuffer>& cmd,
                                       instanceCount,
                                       0,
                                       0,
-                                      0);
+                                      firstInstance);
                  });
 }
 
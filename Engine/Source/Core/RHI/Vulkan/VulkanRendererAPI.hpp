@@ -32,11 +32,13 @@ namespace RightEngine
                           const std::shared_ptr<Buffer>& vertexBuffer,
                           const std::shared_ptr<Buffer>& indexBuffer,
                           uint32_t vertexCount,
-                          uint32_t instanceCount) override;
+                          uint32_t instanceCount,
+                          uint32_t firstInstance) override;
         virtual void Draw(const std::shared_ptr<CommandBuffer>& cmd,
                           const std::shared_ptr<Buffer>& buffer,
                           uint32_t indexCount,
-                          uint32_t instanceCount) override;
+                          uint32_t instanceCount,
+                          uint32_t firstInstance) override;
 
         virtual void EncodeState(const std::shared_ptr<CommandBuffer>& cmd,
                                  const std::shared_ptr<GraphicsPipeline>& pipeline,
@@ -3,6 +3,7 @@
 #include "VulkanBuffer.hpp"
 #include "VulkanTexture.hpp"
 #include "VulkanSampler.hpp"
+#include "VulkanConverters.hpp"
 #include "Shader.hpp"
 
 using namespace RightEngine;
@@ -62,7 +63,7 @@ void VulkanRendererState::OnUpdate(const std::shared_ptr<GraphicsPipeline>& pipe
                     descriptorWrite.dstSet = descriptorSet;
                     descriptorWrite.dstBinding = bufferRef.slot;
                     descriptorWrite.dstArrayElement = 0;
-                    descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+                    descriptorWrite.descriptorType = VulkanConverters::DescriptorType(buffer->GetDescriptor().type);
                     descriptorWrite.descriptorCount = 1;
                     descriptorWrite.pBufferInfo = &bufferInfos.back();
 
@@ -116,20 +117,39 @@ void VulkanRendererState::OnUpdate(const std::shared_ptr<GraphicsPipeline>& pipe
     {
         const auto& shaderDescriptor = pipeline->GetPipelineDescriptor().shader->GetShaderProgramDescriptor();
 
+        uint32_t storageBufferCount = 0;
+        for (const auto& [bufferRef, bufferType] : shaderDescriptor.reflection.buffers)
+        {
+            if (bufferType == BufferType::STORAGE)
+            {
+                storageBufferCount++;
+            }
+        }
+
         VkDescriptorPoolSize bufferPoolSize{};
         bufferPoolSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        bufferPoolSize.descriptorCount = shaderDescriptor.reflection.buffers.size();
+        bufferPoolSize.descriptorCount = shaderDescriptor.reflection.buffers.size() - storageBufferCount;
+
+        VkDescriptorPoolSize storageBufferPoolSize{};
+        storageBufferPoolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        storageBufferPoolSize.descriptorCount = storageBufferCount;
 
         VkDescriptorPoolSize texturePoolSize{};
         texturePoolSize.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
         texturePoolSize.descriptorCount = shaderDescriptor.reflection.textures.size();
         
-        if (bufferPoolSize.descriptorCount == 0 && texturePoolSize.descriptorCount == 0)
+        if (bufferPoolSize.descriptorCount == 0
+            && storageBufferPoolSize.descriptorCount == 0
+            && texturePoolSize.descriptorCount == 0)
         {
             return;
         }
 
         std::vector<VkDescriptorPoolSize> poolSizes;
+        if (storageBufferPoolSize.descriptorCount > 0)
+        {
+            poolSizes.push_back(storageBufferPoolSize);
+        }
         if (bufferPoolSize.descriptorCount > 0)
         {
             poolSizes.push_back(bufferPoolSize);
@@ -5,10 +5,9 @@
 #include "Device.hpp"
 #include "VulkanDevice.hpp"
 #include "VulkanConverters.hpp"
-#include <StandAlone/ResourceLimits.h>
+#include "ShaderCompiler.hpp"
+#include "CookedCache.hpp"
 #include <vulkan/vulkan.h>
-#include <fstream>
-#include <sstream>
 
 using namespace RightEngine;
 
@@ -54,126 +53,22 @@ VulkanShader::VulkanShader(const std::shared_ptr<Device>& device, const ShaderPr
         }
     }
 
-    const auto vertexShaderPath = vertexShader.path;
-    const auto fragmentShaderPath = fragmentShader.path;
-    ShaderProgramSource source = ParseShaders(vertexShaderPath, fragmentShaderPath);
-    const auto vertSpirv = CompileShader(GLSLANG_STAGE_VERTEX, source.vertexSource.c_str(), vertexShaderPath.c_str());
-    const auto fragSpirv = CompileShader(GLSLANG_STAGE_FRAGMENT, source.fragmentSource.c_str(), fragmentShaderPath.c_str());
+    const auto vertSpirv = LoadSpirv(vertexShader);
+    const auto fragSpirv = LoadSpirv(fragmentShader);
 
     vertexShaderModule = CreateShaderModule(vertSpirv);
     fragShaderModule = CreateShaderModule(fragSpirv);
 }
 
-ShaderProgramSource VulkanShader::ParseShaders(const std::string& vertexShaderPath,
-                                               const std::string& fragmentShaderPath)
+std::vector<uint32_t> VulkanShader::LoadSpirv(const ShaderDescriptor& shader) const
 {
-    std::ifstream vertexShaderStream(Path::Absolute(vertexShaderPath));
-    std::ifstream fragmentShaderStream(Path::Absolute(fragmentShaderPath));
-
-    if (!vertexShaderStream.is_open())
-    {
-        R_CORE_ERROR("Can't open vertex shader at path {0}", vertexShaderPath);
-    }
-
-    if (!fragmentShaderStream.is_open())
-    {
-        R_CORE_ERROR("Can't open fragment shader at path {0}", fragmentShaderPath);
-    }
-
-    std::string line;
-    std::stringstream ss[2];
-
-    while (std::getline(vertexShaderStream, line))
+    std::vector<uint32_t> spirv;
+    if (CookedCache::Get().LoadShader(shader.path, spirv))
     {
-        ss[0] << line << '\n';
+        return spirv;
     }
-
-    while (std::getline(fragmentShaderStream, line))
-    {
-        ss[1] << line << '\n';
-    }
-
-    return { ss[0].str(), ss[1].str() };
-}
-
-std::vector<uint32_t> VulkanShader::CompileShader(glslang_stage_t stage, const char* shaderSource, const char* fileName)
-{
-    glslang_input_t input{};
-    input.language = GLSLANG_SOURCE_GLSL;
-    input.stage = stage;
-    input.client = GLSLANG_CLIENT_VULKAN;
-#ifdef R_APPLE
-    input.client_version = GLSLANG_TARGET_VULKAN_1_0;
-#else
-    input.target_language_version = GLSLANG_TARGET_SPV_1_3;
-#endif
-    input.target_language = GLSLANG_TARGET_SPV;
-#ifdef R_APPLE
-    input.target_language_version = GLSLANG_TARGET_SPV_1_0;
-#else
-    input.target_language_version = GLSLANG_TARGET_SPV_1_3;
-#endif
-    input.code = shaderSource;
-    input.default_version = 450;
-    input.default_profile = GLSLANG_NO_PROFILE;
-    input.force_default_version_and_profile = false;
-    input.forward_compatible = false;
-    input.messages = GLSLANG_MSG_DEFAULT_BIT;
-    input.resource = reinterpret_cast<const glslang_resource_t*>(&glslang::DefaultTBuiltInResource);
-
-    glslang_shader_t* shader = glslang_shader_create(&input);
-
-    if (!glslang_shader_preprocess(shader, &input))
-    {
-        R_CORE_ERROR("Shader preprocessing failed. Shader name: {0}", fileName);
-        R_CORE_ERROR("{0}", glslang_shader_get_info_log(shader));
-        R_CORE_ERROR("{0}", glslang_shader_get_info_debug_log(shader));
-//        R_CORE_ERROR("{0}", input.code);
-        R_CORE_ASSERT(false, "");
-        glslang_shader_delete(shader);
-        return {};
-    }
-
-    if (!glslang_shader_parse(shader, &input))
-    {
-        R_CORE_ERROR("Shader parsing failed. Shader name: {0}", fileName);
-        R_CORE_ERROR("{0}", glslang_shader_get_info_log(shader));
-        R_CORE_ERROR("{0}", glslang_shader_get_info_debug_log(shader));
-        R_CORE_ASSERT(false, "");
-//        R_CORE_ERROR("{0}", glslang_shader_get_preprocessed_code(shader));
-        glslang_shader_delete(shader);
-        return {};
-    }
-
-    glslang_program_t* program = glslang_program_create();
-    glslang_program_add_shader(program, shader);
-
-    if (!glslang_program_link(program, GLSLANG_MSG_SPV_RULES_BIT | GLSLANG_MSG_VULKAN_RULES_BIT))
-    {
-        R_CORE_ERROR("GLSL linking failed {0}", fileName);
-        R_CORE_ERROR("{0}", glslang_program_get_info_log(program));
-        R_CORE_ERROR("{0}", glslang_program_get_info_debug_log(program));
-        R_CORE_ASSERT(false, "");
-        glslang_program_delete(program);
-        glslang_shader_delete(shader);
-        return {};
-    }
-
-    glslang_program_SPIRV_generate(program, stage);
-
-    std::vector<uint32_t> outShaderModule(glslang_program_SPIRV_get_size(program));
-    glslang_program_SPIRV_get(program, outShaderModule.data());
-
-    const char* spirv_messages = glslang_program_SPIRV_get_messages(program);
-    if (spirv_messages)
-    {
-        R_CORE_INFO("[{0}]: {1}", fileName, spirv_messages);
-    }
-
-    glslang_program_delete(program);
-    glslang_shader_delete(shader);
-
-    return outShaderModule;
+    const auto source = ShaderCompiler::ReadSource(shader.path);
+    return ShaderCompiler::Compile(shader.type, source, shader.path);
 }
 
 VulkanShader::~VulkanShader()
@@ -207,15 +102,15 @@ std::vector<VkVertexInputAttributeDescription> VulkanShader::GetVertexFormatAttr
     std::vector<VkVertexInputAttributeDescription> attributeDescriptions;
 
     const auto layoutElements = descriptor.layout.GetElements();
-    uint32_t offset = -layoutElements.front().GetSize();
+    uint32_t offset = 0;
     for (int i = 0; i < layoutElements.size(); i++)
     {
         VkVertexInputAttributeDescription attributeDescription;
         attributeDescription.binding = 0;
         attributeDescription.location = i;
         attributeDescription.format = VulkanConverters::Format(layoutElements[i].type);
-        attributeDescription.offset = offset + layoutElements[std::max(0, i - 1)].GetSize();
-        offset += layoutElements[i].GetSize();;
+        attributeDescription.offset = offset;
+        offset += layoutElements[i].GetSize();
 
         attributeDescriptions.emplace_back(attributeDescription);
     }
@@ -2,7 +2,6 @@
 
 #include "Shader.hpp"
 #include "Device.hpp"
-#include <glslang/Include/glslang_c_interface.h>
 #include <vulkan/vulkan.h>
 
 namespace RightEngine
@@ -12,12 +11,6 @@ namespace RightEngine
         VERTEX,
         FRAGMENT
     };
-    struct ShaderProgramSource
-    {
-        std::string vertexSource;
-        std::string fragmentSource;
-    };
-
     class VulkanShader : public Shader
     {
     public:
@@ -45,8 +38,6 @@ namespace RightEngine
         VkShaderModule vertexShaderModule;
         VkShaderModule fragShaderModule;
 
-        ShaderProgramSource ParseShaders(const std::string& vertexShaderPath, const std::string& fragmentShaderPath);
-
-        std::vector<uint32_t> CompileShader(glslang_stage_t stage, const char* shaderSource, const char* fileName);
+        std::vector<uint32_t> LoadSpirv(const ShaderDescriptor& shader) const;
     };
 }
\ No newline at end of file
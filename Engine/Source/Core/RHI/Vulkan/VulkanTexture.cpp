@@ -4,11 +4,12 @@
 #include "VulkanBuffer.hpp"
 #include "Buffer.hpp"
 #include <vk-tools/VulkanTools.h>
+#include <algorithm>
 
 using namespace RightEngine;
 namespace
 {
-    void CopyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height)
+    void CopyBufferToImage(VkBuffer buffer, VkImage image, const TextureDescriptor& descriptor, bool allSubresources)
     {
         CommandBufferDescriptor commandBufferDescriptor;
         commandBufferDescriptor.type = CommandBufferType::GRAPHICS;
@@ -17,18 +18,33 @@ namespace
 
         VulkanUtils::BeginCommandBuffer(commandBuffer, true);
 
-        VkBufferImageCopy region{};
-        region.bufferOffset = 0;
-        region.bufferRowLength = 0;
-        region.bufferImageHeight = 0;
-
-        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        region.imageSubresource.mipLevel = 0;
-        region.imageSubresource.baseArrayLayer = 0;
-        region.imageSubresource.layerCount = 1;
-
-        region.imageOffset = { 0, 0, 0 };
-        region.imageExtent = { width, height, 1 };
+        // Buffer holds either the first mip of the first layer or every mip of every layer, layer by layer
+        const uint32_t layers = allSubresources && descriptor.type == TextureType::CUBEMAP ? 6 : 1;
+        const uint32_t mipLevels = allSubresources ? descriptor.mipLevels : 1;
+        std::vector<VkBufferImageCopy> regions;
+        VkDeviceSize offset = 0;
+        for (uint32_t layer = 0; layer < layers; layer++)
+        {
+            for (uint32_t mipLevel = 0; mipLevel < mipLevels; mipLevel++)
+            {
+                VkBufferImageCopy region{};
+                region.bufferOffset = offset;
+                region.bufferRowLength = 0;
+                region.bufferImageHeight = 0;
+
+                region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+                region.imageSubresource.mipLevel = mipLevel;
+                region.imageSubresource.baseArrayLayer = layer;
+                region.imageSubresource.layerCount = 1;
+
+                region.imageOffset = { 0, 0, 0 };
+                region.imageExtent = { std::max(static_cast<uint32_t>(descriptor.width) >> mipLevel, 1u),
+                                       std::max(static_cast<uint32_t>(descriptor.height) >> mipLevel, 1u),
+                                       1 };
+                regions.push_back(region);
+                offset += descriptor.GetMipSize(mipLevel);
+            }
+        }
 
         commandBuffer->Enqueue([=](auto cmdBuffer)
                                {
@@ -37,8 +53,8 @@ namespace
                                            buffer,
                                            image,
                                            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                                           1,
-                                           &region
+                                           static_cast<uint32_t>(regions.size()),
+                                           regions.data()
                                    );
                                });
 
@@ -103,10 +119,11 @@ VulkanTexture::VulkanTexture(const std::shared_ptr<Device>& device,
 void VulkanTexture::Init(const std::shared_ptr<VulkanDevice>& device,
                          const std::vector<uint8_t>& data)
 {
+    const bool hasAllSubresources = !data.empty() && data.size() == specification.GetDataSize();
     if (!data.empty())
     {
         BufferDescriptor stagingBufferDesc;
-        stagingBufferDesc.size = specification.GetTextureSize();
+        stagingBufferDesc.size = hasAllSubresources ? specification.GetDataSize() : specification.GetTextureSize();
         stagingBufferDesc.type = BufferType::TRANSFER_SRC;
         stagingBufferDesc.memoryType = MemoryType::CPU_ONLY;
         stagingBuffer = device->CreateBuffer(stagingBufferDesc, nullptr);
@@ -135,7 +152,7 @@ void VulkanTexture::Init(const std::shared_ptr<VulkanDevice>& device,
         // TODO: Make proper validation of image usage with
         // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkGetPhysicalDeviceImageFormatProperties.html
 
-        if (specification.format == Format::R8_SRGB)
+        if (specification.format == Format::R8_SRGB || specification.IsCompressed())
         {
             imageInfo.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT
                               | VK_IMAGE_USAGE_SAMPLED_BIT
@@ -171,8 +188,8 @@ void VulkanTexture::Init(const std::shared_ptr<VulkanDevice>& device,
         {
             CopyBufferToImage(std::static_pointer_cast<VulkanBuffer>(stagingBuffer)->GetBuffer(),
                               textureImage,
-                              specification.width,
-                              specification.height);
+                              specification,
+                              hasAllSubresources);
 
             stagingBuffer.reset();
         }
@@ -0,0 +1,119 @@
+#include "BoundsSystem.hpp"
+#include "Components.hpp"
+#include "AssetManager.hpp"
+#include "MeshLoader.hpp"
+
+using namespace RightEngine;
+
+namespace
+{
+    // Small trees are cheap to query whatever their shape is
+    constexpr size_t C_MIN_PROXIES_TO_REBUILD = 64;
+    constexpr float C_REBUILD_COST_RATIO = 1.3f;
+}
+
+void BoundsSystem::Connect(entt::registry& registry)
+{
+    registry.on_construct<MeshComponent>().connect<&BoundsSystem::OnMeshConstruct>(*this);
+    registry.on_destroy<MeshComponent>().connect<&BoundsSystem::OnMeshDestroy>(*this);
+    registry.on_destroy<BoundsComponent>().connect<&BoundsSystem::OnBoundsDestroy>(*this);
+}
+
+void BoundsSystem::Disconnect(entt::registry& registry)
+{
+    registry.on_construct<MeshComponent>().disconnect(*this);
+    registry.on_destroy<MeshComponent>().disconnect(*this);
+    registry.on_destroy<BoundsComponent>().disconnect(*this);
+}
+
+void BoundsSystem::OnMeshConstruct(entt::registry& registry, entt::entity entity)
+{
+    registry.emplace_or_replace<BoundsComponent>(entity);
+}
+
+void BoundsSystem::OnMeshDestroy(entt::registry& registry, entt::entity entity)
+{
+    registry.remove<BoundsComponent>(entity);
+}
+
+void BoundsSystem::OnBoundsDestroy(entt::registry& registry, entt::entity entity)
+{
+    const auto& bounds = registry.get<BoundsComponent>(entity);
+    if (bounds.proxy >= 0)
+    {
+        m_bvh.DestroyProxy(bounds.proxy);
+    }
+}
+
+void BoundsSystem::Update(entt::registry& registry)
+{
+    auto& assetManager = AssetManager::Get();
+    for (const auto entity : registry.view<BoundsComponent, MeshComponent, TransformComponent>())
+    {
+        auto& bounds = registry.get<BoundsComponent>(entity);
+        const auto& meshComponent = registry.get<MeshComponent>(entity);
+        const auto& transform = registry.get<TransformComponent>(entity);
+
+        bool isChanged = bounds.proxy < 0;
+        if (bounds.mesh != meshComponent.mesh.guid)
+        {
+            // Meshes which are still streamed in are retried next frame
+            std::shared_ptr<MeshNode> meshNode;
+            if (meshComponent.mesh.guid.isValid())
+            {
+                meshNode = assetManager.GetAsset<MeshNode>(meshComponent.mesh);
+                if (!meshNode)
+                {
+                    continue;
+                }
+            }
+            bounds.mesh = meshComponent.mesh.guid;
+            bounds.localBounds = meshNode ? meshNode->bounds : AABB();
+            bounds.localSphere = meshNode ? meshNode->boundingSphere : Sphere();
+            isChanged = true;
+        }
+
+        if (!bounds.localBounds.IsValid())
+        {
+            if (bounds.proxy >= 0)
+            {
+                m_bvh.DestroyProxy(bounds.proxy);
+                bounds.proxy = -1;
+            }
+            continue;
+        }
+
+        if (!isChanged && bounds.transformVersion == transform.GetWorldVersion())
+        {
+            continue;
+        }
+
+        bounds.transformVersion = transform.GetWorldVersion();
+        const auto& world = transform.GetWorldTransformMatrix();
+        bounds.worldBounds = bounds.localBounds.Transform(world);
+        bounds.worldSphere = bounds.localSphere.Transform(world);
+        if (bounds.proxy < 0)
+        {
+            bounds.proxy = m_bvh.CreateProxy(bounds.worldBounds, entity);
+            m_changeCount++;
+        }
+        else if (m_bvh.MoveProxy(bounds.proxy, bounds.worldBounds))
+        {
+            m_changeCount++;
+        }
+    }
+
+    // Cost is only measured after a meaningful amount of changes, it walks the whole tree
+    const size_t proxyCount = m_bvh.GetProxyCount();
+    if (proxyCount < C_MIN_PROXIES_TO_REBUILD || m_changeCount < proxyCount / 2)
+    {
+        return;
+    }
+    m_changeCount = 0;
+    if (m_rebuildCost > 0.0f && m_bvh.GetCost() < m_rebuildCost * C_REBUILD_COST_RATIO)
+    {
+        return;
+    }
+    m_bvh.Rebuild();
+    m_rebuildCost = m_bvh.GetCost();
+}
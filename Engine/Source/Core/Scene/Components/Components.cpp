@@ -18,6 +18,30 @@ MeshComponent::MeshComponent()
     // TODO: Remove that temporary cube mesh creation in favor of proper asset management with content panel
     mesh = MeshBuilder::Cube();
 }
+
+MeshComponent::MeshComponent(const AssetHandle& aMesh, const AssetHandle& aMaterial) : mesh(aMesh), material(aMaterial)
+{
+}
+//----------------------------------------------------------------------------------------------------------------------------------------------------
+
+// Animator-------------------------------------------------------------------------------------------------------------------------------------------
+void AnimatorComponent::Play(int32_t newClip, float crossfade)
+{
+    if (crossfade > 0.0f && clip >= 0)
+    {
+        previousClip = clip;
+        previousTime = time;
+        fadeDuration = crossfade;
+        fadeTime = 0.0f;
+    }
+    else
+    {
+        previousClip = -1;
+    }
+    clip = newClip;
+    time = 0.0f;
+    isPlaying = true;
+}
 //----------------------------------------------------------------------------------------------------------------------------------------------------
 
 // Camera---------------------------------------------------------------------------------------------------------------------------------------------
@@ -134,25 +158,14 @@ glm::vec3 CameraComponent::Move(int keycode, const glm::vec3& oldPosition)
 
 glm::mat4 TransformComponent::GetLocalTransformMatrix() const
 {
-    const glm::mat4 rotationMatrix = glm::toMat4(glm::quat(rotation));
+    const glm::mat4 rotationMatrix = glm::toMat4(glm::quat(m_rotation));
 
-    return glm::translate(glm::mat4(1.0f), position) * rotationMatrix * glm::scale(glm::mat4(1.0f), scale);
+    return glm::translate(glm::mat4(1.0f), m_position) * rotationMatrix * glm::scale(glm::mat4(1.0f), m_scale);
 }
 
 const glm::mat4& TransformComponent::GetWorldTransformMatrix() const
 {
-    return transformMatrix;
-}
-
-void TransformComponent::RecalculateTransform(TransformComponent& parentTransform)
-{
-    const auto parentTransformMatrix = glm::translate(glm::mat4(1.0f), parentTransform.position);
-    transformMatrix = parentTransformMatrix * GetLocalTransformMatrix();
-}
-
-void TransformComponent::RecalculateTransform()
-{
-    transformMatrix = GetLocalTransformMatrix();
+    return m_worldMatrix;
 }
 
 //----------------------------------------------------------------------------------------------------------------------------------------------------
\ No newline at end of file
@@ -0,0 +1,433 @@
+#include "DynamicBvh.hpp"
+#include "Assert.hpp"
+
+using namespace RightEngine;
+
+namespace
+{
+    // Fat bounds margin, absolute part keeps tiny objects from reinserting every frame
+    constexpr float C_FAT_MARGIN = 0.1f;
+    constexpr float C_FAT_MARGIN_RATIO = 0.1f;
+    constexpr size_t C_SAH_BIN_COUNT = 12;
+
+    AABB Fatten(const AABB& bounds)
+    {
+        const glm::vec3 margin = glm::vec3(C_FAT_MARGIN) + (bounds.max - bounds.min) * C_FAT_MARGIN_RATIO;
+        return { bounds.min - margin, bounds.max + margin };
+    }
+}
+
+int32_t DynamicBvh::AllocateNode()
+{
+    if (m_freeList == C_NULL_NODE)
+    {
+        m_nodes.emplace_back();
+        return static_cast<int32_t>(m_nodes.size() - 1);
+    }
+
+    const int32_t node = m_freeList;
+    m_freeList = m_nodes[node].parent;
+    m_nodes[node] = Node();
+    return node;
+}
+
+void DynamicBvh::FreeNode(int32_t node)
+{
+    m_nodes[node].parent = m_freeList;
+    m_nodes[node].height = -1;
+    m_freeList = node;
+}
+
+int32_t DynamicBvh::CreateProxy(const AABB& bounds, entt::entity entity)
+{
+    R_CORE_ASSERT(bounds.IsValid(), "");
+    const int32_t proxy = AllocateNode();
+    auto& node = m_nodes[proxy];
+    node.bounds = Fatten(bounds);
+    node.tightBounds = bounds;
+    node.entity = entity;
+    node.height = 0;
+    InsertLeaf(proxy);
+    m_proxyCount++;
+    return proxy;
+}
+
+void DynamicBvh::DestroyProxy(int32_t proxy)
+{
+    R_CORE_ASSERT(proxy >= 0 && proxy < static_cast<int32_t>(m_nodes.size()) && m_nodes[proxy].IsLeaf(), "");
+    RemoveLeaf(proxy);
+    FreeNode(proxy);
+    m_proxyCount--;
+}
+
+bool DynamicBvh::MoveProxy(int32_t proxy, const AABB& bounds)
+{
+    R_CORE_ASSERT(bounds.IsValid() && m_nodes[proxy].IsLeaf(), "");
+    auto& node = m_nodes[proxy];
+    node.tightBounds = bounds;
+    if (node.bounds.Contains(bounds))
+    {
+        return false;
+    }
+
+    RemoveLeaf(proxy);
+    m_nodes[proxy].bounds = Fatten(bounds);
+    InsertLeaf(proxy);
+    return true;
+}
+
+void DynamicBvh::InsertLeaf(int32_t leaf)
+{
+    if (m_root == C_NULL_NODE)
+    {
+        m_root = leaf;
+        m_nodes[leaf].parent = C_NULL_NODE;
+        return;
+    }
+
+    // Descends while pushing the leaf down is cheaper than creating a sibling at the current level
+    const AABB leafBounds = m_nodes[leaf].bounds;
+    int32_t index = m_root;
+    while (!m_nodes[index].IsLeaf())
+    {
+        const auto& node = m_nodes[index];
+        const float area = node.bounds.GetHalfArea();
+        const float combinedArea = AABB::Union(node.bounds, leafBounds).GetHalfArea();
+        const float cost = 2.0f * combinedArea;
+        const float inheritanceCost = 2.0f * (combinedArea - area);
+
+        const auto childCost = [&](int32_t child)
+        {
+            const auto& childNode = m_nodes[child];
+            const float newArea = AABB::Union(leafBounds, childNode.bounds).GetHalfArea();
+            return (childNode.IsLeaf() ? newArea : newArea - childNode.bounds.GetHalfArea()) + inheritanceCost;
+        };
+        const float cost1 = childCost(node.child1);
+        const float cost2 = childCost(node.child2);
+
+        if (cost < cost1 && cost < cost2)
+        {
+            break;
+        }
+        index = cost1 < cost2 ? node.child1 : node.child2;
+    }
+
+    const int32_t sibling = index;
+    const int32_t oldParent = m_nodes[sibling].parent;
+    const int32_t newParent = AllocateNode();
+    auto& parentNode = m_nodes[newParent];
+    parentNode.parent = oldParent;
+    parentNode.bounds = AABB::Union(leafBounds, m_nodes[sibling].bounds);
+    parentNode.height = m_nodes[sibling].height + 1;
+    parentNode.child1 = sibling;
+    parentNode.child2 = leaf;
+    m_nodes[sibling].parent = newParent;
+    m_nodes[leaf].parent = newParent;
+
+    if (oldParent != C_NULL_NODE)
+    {
+        auto& oldParentNode = m_nodes[oldParent];
+        if (oldParentNode.child1 == sibling)
+        {
+            oldParentNode.child1 = newParent;
+        }
+        else
+        {
+            oldParentNode.child2 = newParent;
+        }
+    }
+    else
+    {
+        m_root = newParent;
+    }
+
+    Refit(m_nodes[leaf].parent);
+}
+
+void DynamicBvh::RemoveLeaf(int32_t leaf)
+{
+    if (leaf == m_root)
+    {
+        m_root = C_NULL_NODE;
+        return;
+    }
+
+    const int32_t parent = m_nodes[leaf].parent;
+    const int32_t grandParent = m_nodes[parent].parent;
+    const int32_t sibling = m_nodes[parent].child1 == leaf ? m_nodes[parent].child2 : m_nodes[parent].child1;
+
+    if (grandParent != C_NULL_NODE)
+    {
+        auto& grandParentNode = m_nodes[grandParent];
+        if (grandParentNode.child1 == parent)
+        {
+            grandParentNode.child1 = sibling;
+        }
+        else
+        {
+            grandParentNode.child2 = sibling;
+        }
+        m_nodes[sibling].parent = grandParent;
+        FreeNode(parent);
+        Refit(grandParent);
+    }
+    else
+    {
+        m_root = sibling;
+        m_nodes[sibling].parent = C_NULL_NODE;
+        FreeNode(parent);
+    }
+}
+
+void DynamicBvh::Refit(int32_t node)
+{
+    for (int32_t index = node; index != C_NULL_NODE; index = m_nodes[index].parent)
+    {
+        index = Balance(index);
+
+        auto& current = m_nodes[index];
+        const auto& child1 = m_nodes[current.child1];
+        const auto& child2 = m_nodes[current.child2];
+        current.height = 1 + std::max(child1.height, child2.height);
+        current.bounds = AABB::Union(child1.bounds, child2.bounds);
+    }
+}
+
+int32_t DynamicBvh::Balance(int32_t a)
+{
+    // Rotates the taller grandchild up when children heights differ by more than one
+    const auto& node = m_nodes[a];
+    if (node.IsLeaf() || node.height < 2)
+    {
+        return a;
+    }
+
+    const int32_t b = node.child1;
+    const int32_t c = node.child2;
+    const int32_t balance = m_nodes[c].height - m_nodes[b].height;
+    if (balance >= -1 && balance <= 1)
+    {
+        return a;
+    }
+
+    // Rotated node is promoted to the place of a, which becomes its child
+    const auto rotate = [this, a](int32_t up, int32_t other)
+    {
+        auto& nodeA = m_nodes[a];
+        auto& nodeUp = m_nodes[up];
+        const int32_t f = nodeUp.child1;
+        const int32_t g = nodeUp.child2;
+
+        nodeUp.child1 = a;
+        nodeUp.parent = nodeA.parent;
+        nodeA.parent = up;
+
+        if (nodeUp.parent != C_NULL_NODE)
+        {
+            auto& parent = m_nodes[nodeUp.parent];
+            if (parent.child1 == a)
+            {
+                parent.child1 = up;
+            }
+            else
+            {
+                parent.child2 = up;
+            }
+        }
+        else
+        {
+            m_root = up;
+        }
+
+        const bool isUpFirst = nodeA.child1 == up;
+        const auto& nodeF = m_nodes[f];
+        const auto& nodeG = m_nodes[g];
+        const auto& nodeOther = m_nodes[other];
+        // Taller grandchild stays under the promoted node, the other one replaces it under a
+        const int32_t keep = nodeF.height > nodeG.height ? f : g;
+        const int32_t move = keep == f ? g : f;
+        nodeUp.child2 = keep;
+        if (isUpFirst)
+        {
+            nodeA.child1 = move;
+        }
+        else
+        {
+            nodeA.child2 = move;
+        }
+        m_nodes[move].parent = a;
+
+        nodeA.bounds = AABB::Union(nodeOther.bounds, m_nodes[move].bounds);
+        nodeA.height = 1 + std::max(nodeOther.height, m_nodes[move].height);
+        nodeUp.bounds = AABB::Union(nodeA.bounds, m_nodes[keep].bounds);
+        nodeUp.height = 1 + std::max(nodeA.height, m_nodes[keep].height);
+    };
+
+    if (balance > 1)
+    {
+        rotate(c, b);
+        return c;
+    }
+    rotate(b, c);
+    return b;
+}
+
+float DynamicBvh::GetCost() const
+{
+    if (m_root == C_NULL_NODE)
+    {
+        return 0.0f;
+    }
+
+    const float rootArea = m_nodes[m_root].bounds.GetHalfArea();
+    if (rootArea <= 0.0f)
+    {
+        return 0.0f;
+    }
+
+    float totalArea = 0.0f;
+    for (const auto& node : m_nodes)
+    {
+        if (node.height > 0)
+        {
+            totalArea += node.bounds.GetHalfArea();
+        }
+    }
+    return totalArea / rootArea;
+}
+
+void DynamicBvh::Rebuild()
+{
+    std::vector<int32_t> leaves;
+    leaves.reserve(m_proxyCount);
+    for (size_t i = 0; i < m_nodes.size(); i++)
+    {
+        auto& node = m_nodes[i];
+        if (node.height < 0)
+        {
+            continue;
+        }
+        if (node.IsLeaf())
+        {
+            leaves.push_back(static_cast<int32_t>(i));
+        }
+        else
+        {
+            FreeNode(static_cast<int32_t>(i));
+        }
+    }
+
+    m_root = leaves.empty() ? C_NULL_NODE : BuildRange(leaves.data(), leaves.size());
+    if (m_root != C_NULL_NODE)
+    {
+        m_nodes[m_root].parent = C_NULL_NODE;
+    }
+}
+
+int32_t DynamicBvh::BuildRange(int32_t* leaves, size_t count)
+{
+    if (count == 1)
+    {
+        return leaves[0];
+    }
+
+    AABB centroidBounds;
+    for (size_t i = 0; i < count; i++)
+    {
+        centroidBounds.Extend(m_nodes[leaves[i]].bounds.GetCenter());
+    }
+
+    const glm::vec3 centroidExtent = centroidBounds.max - centroidBounds.min;
+    int axis = 0;
+    if (centroidExtent.y > centroidExtent[axis])
+    {
+        axis = 1;
+    }
+    if (centroidExtent.z > centroidExtent[axis])
+    {
+        axis = 2;
+    }
+
+    size_t splitCount = count / 2;
+    if (centroidExtent[axis] > 0.0f)
+    {
+        struct Bin
+        {
+            AABB bounds;
+            size_t count{ 0 };
+        };
+        Bin bins[C_SAH_BIN_COUNT];
+        const float binScale = static_cast<float>(C_SAH_BIN_COUNT) / centroidExtent[axis];
+        const auto binIndex = [&](int32_t leaf)
+        {
+            const float offset = (m_nodes[leaf].bounds.GetCenter()[axis] - centroidBounds.min[axis]) * binScale;
+            return std::min(static_cast<size_t>(offset), C_SAH_BIN_COUNT - 1);
+        };
+        for (size_t i = 0; i < count; i++)
+        {
+            auto& bin = bins[binIndex(leaves[i])];
+            bin.bounds.Extend(m_nodes[leaves[i]].bounds);
+            bin.count++;
+        }
+
+        // Right to left sweep stores the cost of the right side of every split plane
+        float rightCosts[C_SAH_BIN_COUNT];
+        AABB rightBounds;
+        size_t rightCount = 0;
+        for (size_t i = C_SAH_BIN_COUNT - 1; i > 0; i--)
+        {
+            rightBounds.Extend(bins[i].bounds);
+            rightCount += bins[i].count;
+            rightCosts[i] = rightCount > 0 ? rightBounds.GetHalfArea() * static_cast<float>(rightCount) : 0.0f;
+        }
+
+        AABB leftBounds;
+        size_t leftCount = 0;
+        float bestCost = std::numeric_limits<float>::max();
+        size_t bestSplit = 0;
+        for (size_t i = 1; i < C_SAH_BIN_COUNT; i++)
+        {
+            leftBounds.Extend(bins[i - 1].bounds);
+            leftCount += bins[i - 1].count;
+            if (leftCount == 0 || leftCount == count)
+            {
+                continue;
+            }
+            const float cost = leftBounds.GetHalfArea() * static_cast<float>(leftCount) + rightCosts[i];
+            if (cost < bestCost)
+            {
+                bestCost = cost;
+                bestSplit = i;
+            }
+        }
+
+        if (bestSplit > 0)
+        {
+            const auto middle = std::partition(leaves, leaves + count, [&](int32_t leaf)
+            {
+                return binIndex(leaf) < bestSplit;
+            });
+            splitCount = static_cast<size_t>(middle - leaves);
+        }
+    }
+
+    const int32_t child1 = BuildRange(leaves, splitCount);
+    const int32_t child2 = BuildRange(leaves + splitCount, count - splitCount);
+    const int32_t node = AllocateNode();
+    auto& parent = m_nodes[node];
+    parent.child1 = child1;
+    parent.child2 = child2;
+    parent.bounds = AABB::Union(m_nodes[child1].bounds, m_nodes[child2].bounds);
+    parent.height = 1 + std::max(m_nodes[child1].height, m_nodes[child2].height);
+    m_nodes[child1].parent = node;
+    m_nodes[child2].parent = node;
+    return node;
+}
+
+void DynamicBvh::Clear()
+{
+    m_nodes.clear();
+    m_root = C_NULL_NODE;
+    m_freeList = C_NULL_NODE;
+    m_proxyCount = 0;
+}
@@ -4,47 +4,120 @@
 
 using namespace RightEngine;
 
-Entity::Entity(entt::entity entityHandle, const std::shared_ptr<Scene>& scene)
+namespace
 {
-    this->entityHandle = entityHandle;
-    this->scene = scene;
+    void SetDepth(entt::registry& registry, entt::entity entity, uint32_t depth)
+    {
+        auto& relationship = registry.get<RelationshipComponent>(entity);
+        relationship.depth = depth;
+        for (auto child = relationship.firstChild; child != entt::null; child = registry.get<RelationshipComponent>(child).nextSibling)
+        {
+            SetDepth(registry, child, depth + 1);
+        }
+    }
+}
+
+void Entity::AddChild(Entity node)
+{
+    R_CORE_ASSERT(node.scene == scene && node != *this, "");
+    node.Detach();
+
+    auto& registry = scene->registry;
+    auto& relationship = registry.get<RelationshipComponent>(entityHandle);
+    auto& childRelationship = registry.get<RelationshipComponent>(node.entityHandle);
+    // Appended, so children keep the order in which they were added
+    childRelationship.parent = entityHandle;
+    childRelationship.prevSibling = relationship.lastChild;
+    childRelationship.nextSibling = entt::null;
+    if (relationship.lastChild != entt::null)
+    {
+        registry.get<RelationshipComponent>(relationship.lastChild).nextSibling = node.entityHandle;
+    }
+    else
+    {
+        relationship.firstChild = node.entityHandle;
+    }
+    relationship.lastChild = node.entityHandle;
+    relationship.childCount++;
+
+    SetDepth(registry, node.entityHandle, relationship.depth + 1);
+    scene->transformSystem.MarkHierarchyDirty();
 }
 
-void Entity::AddChild(const std::shared_ptr<Entity>& node)
+void Entity::RemoveChild(Entity node)
 {
-    children.push_back(node);
-    node->parent = shared_from_this();
+    R_CORE_ASSERT(node.GetParent() == *this, "");
+    node.Detach();
+    SetDepth(scene->registry, node.entityHandle, 0);
 }
 
-void Entity::RemoveChild(const std::shared_ptr<Entity>& node)
+void Entity::Detach()
 {
-    for (int index = 0; index < children.size(); index++)
+    auto& registry = scene->registry;
+    auto& relationship = registry.get<RelationshipComponent>(entityHandle);
+    if (relationship.parent == entt::null)
     {
-        if (node == children[index])
-        {
-            children.erase(children.begin() + index);
-            break;
-        }
+        return;
+    }
+
+    auto& parentRelationship = registry.get<RelationshipComponent>(relationship.parent);
+    if (parentRelationship.firstChild == entityHandle)
+    {
+        parentRelationship.firstChild = relationship.nextSibling;
+    }
+    if (parentRelationship.lastChild == entityHandle)
+    {
+        parentRelationship.lastChild = relationship.prevSibling;
+    }
+    if (relationship.prevSibling != entt::null)
+    {
+        registry.get<RelationshipComponent>(relationship.prevSibling).nextSibling = relationship.nextSibling;
+    }
+    if (relationship.nextSibling != entt::null)
+    {
+        registry.get<RelationshipComponent>(relationship.nextSibling).prevSibling = relationship.prevSibling;
     }
+    parentRelationship.childCount--;
+
+    relationship.parent = entt::null;
+    relationship.prevSibling = entt::null;
+    relationship.nextSibling = entt::null;
+    scene->transformSystem.MarkHierarchyDirty();
+}
+
+Entity Entity::GetParent() const
+{
+    const auto parent = scene->registry.get<RelationshipComponent>(entityHandle).parent;
+    if (parent == entt::null)
+    {
+        return {};
+    }
+    return { parent, scene };
 }
 
-const std::vector<std::shared_ptr<Entity>>& Entity::GetChildren() const
+std::vector<Entity> Entity::GetChildren() const
 {
+    std::vector<Entity> children;
+    children.reserve(scene->registry.get<RelationshipComponent>(entityHandle).childCount);
+    ForEachChild([&children](Entity child)
+    {
+        children.push_back(child);
+    });
     return children;
 }
 
-std::vector<std::shared_ptr<Entity>> Entity::GetAllChildren() const
+std::vector<Entity> Entity::GetAllChildren() const
 {
-    std::vector<std::shared_ptr<Entity>> allChildren;
+    std::vector<Entity> allChildren;
     GetAllChildren(allChildren);
     return allChildren;
 }
 
-void Entity::GetAllChildren(std::vector<std::shared_ptr<Entity>>& allChildren) const
+void Entity::GetAllChildren(std::vector<Entity>& allChildren) const
 {
-    for (const auto& node: children)
+    ForEachChild([&allChildren](Entity child)
     {
-        node->GetAllChildren(allChildren);
-        allChildren.push_back(node);
-    }
+        child.GetAllChildren(allChildren);
+        allChildren.push_back(child);
+    });
 }
@@ -0,0 +1,79 @@
+#include "EntityCommandBuffer.hpp"
+#include "Entity.hpp"
+#include "Scene.hpp"
+
+using namespace RightEngine;
+
+EntityCommandBuffer::Target::Target(const Entity& entity) : m_entity(entity.GetHandle())
+{}
+
+entt::entity EntityCommandBuffer::Target::Resolve(const std::vector<entt::entity>& created) const
+{
+    if (m_createdIndex == C_NOT_CREATED)
+    {
+        return m_entity;
+    }
+    R_CORE_ASSERT(m_createdIndex < created.size(), "");
+    return created[m_createdIndex];
+}
+
+EntityCommandBuffer::Target EntityCommandBuffer::CreateEntity(const std::string& name, bool addToRoot)
+{
+    Target target;
+    target.m_createdIndex = m_createdCount++;
+    m_commands.emplace_back([name, addToRoot](Scene& scene, entt::registry&, std::vector<entt::entity>& created)
+    {
+        created.push_back(scene.CreateEntity(name, addToRoot).GetHandle());
+    });
+    return target;
+}
+
+EntityCommandBuffer::Target EntityCommandBuffer::CreateEntityWithGuid(const std::string& name, const xg::Guid& guid, bool addToRoot)
+{
+    Target target;
+    target.m_createdIndex = m_createdCount++;
+    m_commands.emplace_back([name, guid, addToRoot](Scene& scene, entt::registry&, std::vector<entt::entity>& created)
+    {
+        created.push_back(scene.CreateEntityWithGuid(name, guid, addToRoot).GetHandle());
+    });
+    return target;
+}
+
+void EntityCommandBuffer::DestroyEntity(Target entity)
+{
+    m_commands.emplace_back([entity](Scene& scene, entt::registry& registry, std::vector<entt::entity>& created)
+    {
+        const auto handle = entity.Resolve(created);
+        // Several systems may destroy the same entity during one frame
+        if (registry.valid(handle))
+        {
+            scene.DestroyEntity({ handle, &scene });
+        }
+    });
+}
+
+void EntityCommandBuffer::AddChild(Target parent, Target child)
+{
+    m_commands.emplace_back([parent, child](Scene& scene, entt::registry& registry, std::vector<entt::entity>& created)
+    {
+        const auto parentHandle = parent.Resolve(created);
+        const auto childHandle = child.Resolve(created);
+        if (registry.valid(parentHandle) && registry.valid(childHandle))
+        {
+            Entity(parentHandle, &scene).AddChild({ childHandle, &scene });
+        }
+    });
+}
+
+void EntityCommandBuffer::Playback(Scene& scene)
+{
+    std::vector<entt::entity> created;
+    created.reserve(m_createdCount);
+    auto& registry = scene.GetRegistry();
+    for (auto& command : m_commands)
+    {
+        command(scene, registry, created);
+    }
+    m_commands.clear();
+    m_createdCount = 0;
+}
@@ -0,0 +1,137 @@
+#include "EntityIndex.hpp"
+#include "Components.hpp"
+#include "Assert.hpp"
+#include <cstring>
+
+using namespace RightEngine;
+
+namespace
+{
+    const std::vector<entt::entity> C_NO_ENTITIES;
+}
+
+void EntityIndex::Connect(entt::registry& registry)
+{
+    registry.on_construct<TagComponent>().connect<&EntityIndex::OnTagConstruct>(*this);
+    registry.on_update<TagComponent>().connect<&EntityIndex::OnTagUpdate>(*this);
+    registry.on_destroy<TagComponent>().connect<&EntityIndex::OnTagDestroy>(*this);
+}
+
+void EntityIndex::Disconnect(entt::registry& registry)
+{
+    registry.on_construct<TagComponent>().disconnect(*this);
+    registry.on_update<TagComponent>().disconnect(*this);
+    registry.on_destroy<TagComponent>().disconnect(*this);
+}
+
+entt::entity EntityIndex::Find(const xg::Guid& guid) const
+{
+    const auto it = m_guids.find(guid);
+    return it == m_guids.end() ? entt::null : it->second;
+}
+
+const std::vector<entt::entity>& EntityIndex::FindByName(const std::string& name) const
+{
+    const auto it = m_nameIds.find(name);
+    return it == m_nameIds.end() ? C_NO_ENTITIES : m_names[it->second].entities;
+}
+
+uint64_t EntityIndex::GetStableId(const xg::Guid& guid)
+{
+    // Random GUID bytes are already well mixed, folding the halves keeps them so
+    const auto& bytes = guid.bytes();
+    uint64_t low;
+    uint64_t high;
+    std::memcpy(&low, bytes.data(), sizeof(low));
+    std::memcpy(&high, bytes.data() + sizeof(low), sizeof(high));
+    return low ^ high;
+}
+
+void EntityIndex::OnTagConstruct(entt::registry& registry, entt::entity entity)
+{
+    Add(registry, entity);
+}
+
+void EntityIndex::OnTagUpdate(entt::registry& registry, entt::entity entity)
+{
+    Remove(entity);
+    Add(registry, entity);
+}
+
+void EntityIndex::OnTagDestroy(entt::registry&, entt::entity entity)
+{
+    Remove(entity);
+}
+
+void EntityIndex::Add(entt::registry& registry, entt::entity entity)
+{
+    auto& tag = registry.get<TagComponent>(entity);
+    tag.uiId = GetStableId(tag.guid);
+
+    const auto [it, isAdded] = m_guids.emplace(tag.guid, entity);
+    if (!isAdded)
+    {
+        // Latest entity wins, the previous one can still be found by name
+        R_CORE_WARN("Entity GUID {} is used by more than one entity", tag.guid.str());
+        it->second = entity;
+    }
+
+    const auto index = static_cast<size_t>(entt::to_entity(entity));
+    if (index >= m_entries.size())
+    {
+        m_entries.resize(index + 1);
+    }
+    auto& entry = m_entries[index];
+    entry.guid = tag.guid;
+    entry.name = InternName(tag.name);
+    auto& entities = m_names[entry.name].entities;
+    entry.namePosition = static_cast<uint32_t>(entities.size());
+    entities.push_back(entity);
+}
+
+void EntityIndex::Remove(entt::entity entity)
+{
+    auto& entry = m_entries[entt::to_entity(entity)];
+    const auto guidIt = m_guids.find(entry.guid);
+    if (guidIt != m_guids.end() && guidIt->second == entity)
+    {
+        m_guids.erase(guidIt);
+    }
+
+    auto& name = m_names[entry.name];
+    const entt::entity last = name.entities.back();
+    name.entities[entry.namePosition] = last;
+    m_entries[entt::to_entity(last)].namePosition = entry.namePosition;
+    name.entities.pop_back();
+    if (name.entities.empty())
+    {
+        m_nameIds.erase(name.name);
+        name.name.clear();
+        m_freeNames.push_back(entry.name);
+    }
+    entry = {};
+}
+
+uint32_t EntityIndex::InternName(const std::string& name)
+{
+    const auto it = m_nameIds.find(name);
+    if (it != m_nameIds.end())
+    {
+        return it->second;
+    }
+
+    uint32_t id;
+    if (m_freeNames.empty())
+    {
+        id = static_cast<uint32_t>(m_names.size());
+        m_names.emplace_back();
+    }
+    else
+    {
+        id = m_freeNames.back();
+        m_freeNames.pop_back();
+    }
+    m_names[id].name = name;
+    m_nameIds.emplace(name, id);
+    return id;
+}
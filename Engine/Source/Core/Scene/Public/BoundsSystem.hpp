@@ -0,0 +1,37 @@
+#pragma once
+
+#include "DynamicBvh.hpp"
+#include <entt.hpp>
+
+namespace RightEngine
+{
+    /*
+     * Keeps BoundsComponent and the scene BVH in sync with meshes and world transforms.
+     * Every update visits all mesh entities and compares their mesh and world transform version with the cached ones,
+     * only changed entities recompute bounds and move their BVH proxies.
+     * The tree is rebuilt with SAH when incremental updates made it noticeably worse than after the last rebuild
+     */
+    class BoundsSystem
+    {
+    public:
+        // Subscribes to MeshComponent and BoundsComponent lifetime, the system must outlive the registry signals
+        void Connect(entt::registry& registry);
+        // Lets pools be filled wholesale, e.g. by Scene::Clone, which copies bounds together with the BVH
+        void Disconnect(entt::registry& registry);
+
+        void Update(entt::registry& registry);
+
+        const DynamicBvh& GetBvh() const
+        { return m_bvh; }
+
+    private:
+        void OnMeshConstruct(entt::registry& registry, entt::entity entity);
+        void OnMeshDestroy(entt::registry& registry, entt::entity entity);
+        void OnBoundsDestroy(entt::registry& registry, entt::entity entity);
+
+        DynamicBvh m_bvh;
+        // Inserts and reinserts since the last rebuild
+        size_t m_changeCount{ 0 };
+        float m_rebuildCost{ 0.0f };
+    };
+}
@@ -2,8 +2,11 @@
 
 #include "Material.hpp"
 #include "EnvironmentMapLoader.hpp"
+#include "Bounds.hpp"
 #include <glm/glm.hpp>
 #include <crossguid/guid.hpp>
+#include <entt.hpp>
+#include <atomic>
 
 namespace RightEngine
 {
@@ -19,45 +22,162 @@ namespace RightEngine
 
         std::string name;
         xg::Guid guid{ xg::newGuid() };
-        uint32_t colorId;
+        // Stable across sessions unlike entity handles, derived from guid by the scene entity index for UI ids
+        uint64_t uiId{ 0 };
     };
 
-    // TODO: Add dirty flag, so we can recalculate transform only when needed
+    /*
+     * Intrusive hierarchy links, children of an entity form a doubly linked list of siblings.
+     * Must only be changed through Entity::AddChild and Entity::RemoveChild
+     */
+    struct RelationshipComponent
+    {
+        entt::entity parent{ entt::null };
+        entt::entity firstChild{ entt::null };
+        entt::entity lastChild{ entt::null };
+        entt::entity prevSibling{ entt::null };
+        entt::entity nextSibling{ entt::null };
+        uint32_t childCount{ 0 };
+        // Root and detached entities have zero depth
+        uint32_t depth{ 0 };
+    };
+
+    /*
+     * Local TRS is only changed through setters, which mark the component dirty.
+     * World matrix is written by TransformSystem, so it lags behind setters until the next Scene::OnUpdate
+     */
     struct TransformComponent
     {
     public:
         inline const glm::vec3 GetWorldPosition() const
-        { return transformMatrix[3]; }
+        { return m_worldMatrix[3]; }
+
+        const glm::vec3& GetPosition() const
+        { return m_position; }
+
+        void SetPosition(const glm::vec3& position)
+        {
+            m_position = position;
+            MarkDirty();
+        }
+
+        // In radians
+        const glm::vec3& GetRotation() const
+        { return m_rotation; }
 
         void SetRotationDegree(const glm::vec3& newRotation)
-        { rotation = glm::radians(newRotation); }
+        { SetRotationRadians(glm::radians(newRotation)); }
 
         void SetRotationRadians(const glm::vec3& newRotation)
-        { rotation = newRotation; }
+        {
+            m_rotation = newRotation;
+            MarkDirty();
+        }
+
+        const glm::vec3& GetScale() const
+        { return m_scale; }
+
+        void SetScale(const glm::vec3& scale)
+        {
+            m_scale = scale;
+            MarkDirty();
+        }
+
+        bool IsDirty() const
+        { return m_isDirty; }
+
+        // Changes every time TransformSystem writes a new world matrix, lets dependent caches skip static entities
+        uint32_t GetWorldVersion() const
+        { return m_worldVersion; }
 
         glm::mat4 GetLocalTransformMatrix() const;
 
         const glm::mat4& GetWorldTransformMatrix() const;
 
-        void RecalculateTransform(TransformComponent& parentTransform);
+    private:
+        void MarkDirty()
+        {
+            m_isDirty = true;
+            if (m_changeCount)
+            {
+                m_changeCount->fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        glm::vec3 m_position{0.0f, 0.0f, 0.0f};
+        glm::vec3 m_rotation{0.0f, 0.0f, 0.0f};
+        glm::vec3 m_scale{1.0f, 1.0f, 1.0f};
+        glm::mat4 m_worldMatrix{glm::mat4(1.0f)};
+        uint32_t m_worldVersion{ 0 };
+        bool m_isDirty{ true };
 
-        void RecalculateTransform();
+        // Counter of the TransformSystem of the owning scene, set when the component is added or replaced there.
+        // Lets the system skip frames where nothing moved without touching any component
+        std::atomic_uint32_t* m_changeCount{ nullptr };
 
-        glm::vec3 position{0.0f, 0.0f, 0.0f};
-        // In radians
-        glm::vec3 rotation{0.0f, 0.0f, 0.0f};
-        glm::vec3 scale{1.0f, 1.0f, 1.0f};
-        glm::mat4 transformMatrix{glm::mat4(1.0f)};
+        friend class TransformSystem;
     };
 
     class MeshComponent
     {
     public:
         MeshComponent();
+        // Doesn't touch default assets, so it can be used without a GPU device
+        MeshComponent(const AssetHandle& aMesh, const AssetHandle& aMaterial);
 
         AssetHandle mesh;
         AssetHandle material;
-        bool isVisible;
+        bool isVisible{ true };
+        // Mesh occluder is rasterized for CPU occlusion culling, meant for a few large meshes like buildings and terrain
+        bool isOccluder{ false };
+        // Static meshes are merged by material and cell into a few draws, moving them rebuilds their whole batch
+        bool isStatic{ false };
+        // Per instance override, entities sharing mesh and material are still drawn with one instanced draw
+        glm::vec4 tint{ 1.0f };
+    };
+
+    // Entities streamed in by a world partition cell, they are destroyed when the cell is evicted
+    struct WorldCellComponent
+    {
+        uint64_t cell{ 0 };
+    };
+
+    /*
+     * World space bounds of MeshComponent, added and removed together with it.
+     * Written by BoundsSystem, which also keeps the scene BVH in sync
+     */
+    struct BoundsComponent
+    {
+        AABB localBounds;
+        AABB worldBounds;
+        Sphere localSphere;
+        Sphere worldSphere;
+        int32_t proxy{ -1 };
+        uint32_t transformVersion{ 0 };
+        xg::Guid mesh;
+    };
+
+    // Plays animations of the skinned mesh from MeshComponent of the same entity
+    struct AnimatorComponent
+    {
+        // Starts clip from the beginning, previous one fades out during crossfade seconds
+        void Play(int32_t newClip, float crossfade = 0.2f);
+
+        // Index in the mesh animations
+        int32_t clip{ 0 };
+        // In seconds
+        float time{ 0.0f };
+        float speed{ 1.0f };
+        bool loop{ true };
+        bool isPlaying{ true };
+
+        int32_t previousClip{ -1 };
+        float previousTime{ 0.0f };
+        float fadeDuration{ 0.0f };
+        float fadeTime{ 0.0f };
+
+        // Written by AnimationSystem every frame, 3 rows of the affine skinning matrix per joint
+        std::vector<glm::vec4> palette;
     };
 
     enum class LightType
@@ -131,4 +251,20 @@ namespace RightEngine
     private:
         void UpdateVectors(const glm::vec3& rotation);
     };
+
+    template<typename... T>
+    struct ComponentTypeList
+    {};
+
+    // Every component type stored in a scene. Scene::Clone copies exactly these pools, new components must be listed here
+    using SceneComponentTypes = ComponentTypeList<TagComponent,
+                                                  RelationshipComponent,
+                                                  TransformComponent,
+                                                  MeshComponent,
+                                                  WorldCellComponent,
+                                                  BoundsComponent,
+                                                  AnimatorComponent,
+                                                  LightComponent,
+                                                  SkyboxComponent,
+                                                  CameraComponent>;
 }
@@ -0,0 +1,268 @@
+#pragma once
+
+#include "Bounds.hpp"
+#include <entt.hpp>
+#include <vector>
+#include <cstdint>
+
+namespace RightEngine
+{
+    /*
+     * Dynamic AABB tree in the spirit of Box2D's b2DynamicTree. Leaves keep fat bounds, so small movements
+     * only update the stored tight box, bigger ones remove and reinsert the leaf with the SAH insertion cost
+     * and tree rotations. Rebuild rebuilds the whole tree top-down with binned SAH when incremental updates degrade it.
+     * Queries test internal nodes with fat bounds and leaves with tight ones. Not thread safe for writes,
+     * any amount of threads may query it concurrently
+     */
+    class DynamicBvh
+    {
+    public:
+        static constexpr int32_t C_NULL_NODE = -1;
+
+        // Returns proxy id which stays valid until the proxy is destroyed
+        int32_t CreateProxy(const AABB& bounds, entt::entity entity);
+        void DestroyProxy(int32_t proxy);
+        // Returns true when the leaf had to be reinserted
+        bool MoveProxy(int32_t proxy, const AABB& bounds);
+
+        const AABB& GetBounds(int32_t proxy) const
+        { return m_nodes[proxy].tightBounds; }
+
+        entt::entity GetEntity(int32_t proxy) const
+        { return m_nodes[proxy].entity; }
+
+        size_t GetProxyCount() const
+        { return m_proxyCount; }
+
+        // Sum of internal node areas relative to the root area, lower means cheaper queries
+        float GetCost() const;
+
+        // Binned SAH rebuild from scratch, proxy ids stay valid
+        void Rebuild();
+        void Clear();
+
+        template<typename F>
+        void QueryBox(const AABB& box, F&& callback) const;
+
+        template<typename F>
+        void QuerySphere(const Sphere& sphere, F&& callback) const;
+
+        // Subtrees fully inside the frustum are reported without testing their leaves
+        template<typename F>
+        void QueryFrustum(const Frustum& frustum, F&& callback) const;
+
+        /*
+         * Callback receives the entity and the distance to its box and returns the new maximum distance,
+         * so closest hit queries can clip the rest of the traversal. Returning 0 stops the query
+         */
+        template<typename F>
+        void QueryRay(const Ray& ray, float maxDistance, F&& callback) const;
+
+    private:
+        struct Node
+        {
+            AABB bounds;
+            AABB tightBounds;
+            // Next free node while the node is in the free list
+            int32_t parent{ C_NULL_NODE };
+            int32_t child1{ C_NULL_NODE };
+            int32_t child2{ C_NULL_NODE };
+            // Leaf has zero height, free node has -1
+            int32_t height{ -1 };
+            entt::entity entity{ entt::null };
+
+            bool IsLeaf() const
+            { return child1 == C_NULL_NODE; }
+        };
+
+        int32_t AllocateNode();
+        void FreeNode(int32_t node);
+
+        void InsertLeaf(int32_t leaf);
+        void RemoveLeaf(int32_t leaf);
+        void Refit(int32_t node);
+        int32_t Balance(int32_t node);
+        int32_t BuildRange(int32_t* leaves, size_t count);
+
+        template<typename F>
+        void ForEachLeaf(int32_t node, std::vector<int32_t>& stack, F&& callback) const;
+
+        std::vector<Node> m_nodes;
+        int32_t m_root{ C_NULL_NODE };
+        int32_t m_freeList{ C_NULL_NODE };
+        size_t m_proxyCount{ 0 };
+    };
+
+    template<typename F>
+    void DynamicBvh::QueryBox(const AABB& box, F&& callback) const
+    {
+        if (m_root == C_NULL_NODE)
+        {
+            return;
+        }
+
+        std::vector<int32_t> stack;
+        stack.reserve(64);
+        stack.push_back(m_root);
+        while (!stack.empty())
+        {
+            const auto& node = m_nodes[stack.back()];
+            stack.pop_back();
+            if (!node.bounds.Overlaps(box))
+            {
+                continue;
+            }
+            if (node.IsLeaf())
+            {
+                if (node.tightBounds.Overlaps(box))
+                {
+                    callback(node.entity);
+                }
+                continue;
+            }
+            stack.push_back(node.child1);
+            stack.push_back(node.child2);
+        }
+    }
+
+    template<typename F>
+    void DynamicBvh::QuerySphere(const Sphere& sphere, F&& callback) const
+    {
+        if (m_root == C_NULL_NODE)
+        {
+            return;
+        }
+
+        std::vector<int32_t> stack;
+        stack.reserve(64);
+        stack.push_back(m_root);
+        while (!stack.empty())
+        {
+            const auto& node = m_nodes[stack.back()];
+            stack.pop_back();
+            if (!sphere.Overlaps(node.bounds))
+            {
+                continue;
+            }
+            if (node.IsLeaf())
+            {
+                if (sphere.Overlaps(node.tightBounds))
+                {
+                    callback(node.entity);
+                }
+                continue;
+            }
+            stack.push_back(node.child1);
+            stack.push_back(node.child2);
+        }
+    }
+
+    template<typename F>
+    void DynamicBvh::QueryFrustum(const Frustum& frustum, F&& callback) const
+    {
+        if (m_root == C_NULL_NODE)
+        {
+            return;
+        }
+
+        std::vector<int32_t> stack;
+        std::vector<int32_t> leafStack;
+        stack.reserve(64);
+        stack.push_back(m_root);
+        while (!stack.empty())
+        {
+            const int32_t index = stack.back();
+            const auto& node = m_nodes[index];
+            stack.pop_back();
+            if (node.IsLeaf())
+            {
+                if (frustum.Test(node.tightBounds) != FrustumTest::OUTSIDE)
+                {
+                    callback(node.entity);
+                }
+                continue;
+            }
+
+            const auto test = frustum.Test(node.bounds);
+            if (test == FrustumTest::INSIDE)
+            {
+                ForEachLeaf(index, leafStack, callback);
+            }
+            else if (test == FrustumTest::INTERSECTS)
+            {
+                stack.push_back(node.child1);
+                stack.push_back(node.child2);
+            }
+        }
+    }
+
+    template<typename F>
+    void DynamicBvh::QueryRay(const Ray& ray, float maxDistance, F&& callback) const
+    {
+        if (m_root == C_NULL_NODE)
+        {
+            return;
+        }
+
+        const glm::vec3 invDirection = ray.GetInvDirection();
+        std::vector<int32_t> stack;
+        stack.reserve(64);
+        stack.push_back(m_root);
+        while (!stack.empty())
+        {
+            const auto& node = m_nodes[stack.back()];
+            stack.pop_back();
+            if (ray.Intersect(node.bounds, invDirection, maxDistance) < 0.0f)
+            {
+                continue;
+            }
+            if (node.IsLeaf())
+            {
+                const float distance = ray.Intersect(node.tightBounds, invDirection, maxDistance);
+                if (distance >= 0.0f)
+                {
+                    maxDistance = callback(node.entity, distance);
+                    if (maxDistance <= 0.0f)
+                    {
+                        return;
+                    }
+                }
+                continue;
+            }
+
+            // Nearer child is visited first, so closest hit queries shrink maxDistance early
+            const float distance1 = ray.Intersect(m_nodes[node.child1].bounds, invDirection, maxDistance);
+            const float distance2 = ray.Intersect(m_nodes[node.child2].bounds, invDirection, maxDistance);
+            const bool isFirstNearer = distance2 < 0.0f || (distance1 >= 0.0f && distance1 <= distance2);
+            const int32_t nearChild = isFirstNearer ? node.child1 : node.child2;
+            const int32_t farChild = isFirstNearer ? node.child2 : node.child1;
+            if ((isFirstNearer ? distance2 : distance1) >= 0.0f)
+            {
+                stack.push_back(farChild);
+            }
+            if ((isFirstNearer ? distance1 : distance2) >= 0.0f)
+            {
+                stack.push_back(nearChild);
+            }
+        }
+    }
+
+    template<typename F>
+    void DynamicBvh::ForEachLeaf(int32_t node, std::vector<int32_t>& stack, F&& callback) const
+    {
+        stack.clear();
+        stack.push_back(node);
+        while (!stack.empty())
+        {
+            const auto& current = m_nodes[stack.back()];
+            stack.pop_back();
+            if (current.IsLeaf())
+            {
+                callback(current.entity);
+                continue;
+            }
+            stack.push_back(current.child1);
+            stack.push_back(current.child2);
+        }
+    }
+}
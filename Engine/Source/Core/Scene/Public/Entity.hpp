@@ -5,72 +5,106 @@
 #include "Assert.hpp"
 #include <glm/glm.hpp>
 #include <entt.hpp>
-#include <memory>
+#include <type_traits>
+#include <vector>
 
 namespace RightEngine
 {
     class Scene;
 
-    class Entity : public std::enable_shared_from_this<Entity>
+    /*
+     * Lightweight handle of the registry entity, can be freely copied and stored.
+     * Hierarchy is kept in RelationshipComponent, so handles don't own anything and must not outlive the scene.
+     * Component access goes straight to the registry without locks, threading rules are described in Scene
+     */
+    class Entity
     {
     public:
         Entity() = default;
-        Entity(entt::entity entityId, const std::shared_ptr<Scene>& scene);
-        ~Entity() = default;
+        Entity(entt::entity entityHandle, Scene* scene) : entityHandle(entityHandle), scene(scene)
+        {}
 
         template<typename T, typename... Args>
         T& AddComponent(Args&&... args)
         {
-            std::lock_guard l(m_mutex);
             R_CORE_ASSERT(!HasComponent<T>(), "Entity already has component!");
-            T& component = scene.lock()->registry.emplace<T>(entityHandle, std::forward<Args>(args)...);
-            return component;
+            return scene->registry.emplace<T>(entityHandle, std::forward<Args>(args)...);
         }
 
         template<typename T>
-        T& GetComponent()
+        T& GetComponent() const
         {
-            std::lock_guard l(m_mutex);
             R_CORE_ASSERT(HasComponent<T>(), "Entity does not have component!");
-            return scene.lock()->registry.get<T>(entityHandle);
+            return scene->registry.get<T>(entityHandle);
         }
 
         template<typename T>
-        bool HasComponent()
+        bool HasComponent() const
         {
-            std::lock_guard l(m_mutex);
-            auto ptr = scene.lock()->registry.try_get<T>(entityHandle);
-            return ptr ? true : false;
+            return scene->registry.try_get<T>(entityHandle) != nullptr;
         }
 
         template<typename T>
         void RemoveComponent()
         {
             R_CORE_ASSERT(HasComponent<T>(), "Entity does not have component!");
-            scene.lock()->registry.remove<T>(entityHandle);
+            scene->registry.remove<T>(entityHandle);
         }
 
-        void AddChild(const std::shared_ptr<Entity>& node);
-        void RemoveChild(const std::shared_ptr<Entity>& node);
+        // Child is detached from its previous parent
+        void AddChild(Entity node);
+        // Child becomes detached from the hierarchy, but stays alive
+        void RemoveChild(Entity node);
 
-        const std::vector<std::shared_ptr<Entity>>& GetChildren() const;
-        std::vector<std::shared_ptr<Entity>> GetAllChildren() const;
+        // Calls f(Entity) for direct children without allocations
+        template<typename F>
+        void ForEachChild(F&& f) const;
 
-        std::shared_ptr<Entity> GetParent() const
-        { return parent.lock(); }
+        std::vector<Entity> GetChildren() const;
+        // Depth first, children go before their parent
+        std::vector<Entity> GetAllChildren() const;
 
-    protected:
-        entt::entity entityHandle;
+        Entity GetParent() const;
 
-        std::weak_ptr<Entity> parent;
-        std::vector<std::shared_ptr<Entity>> children;
-        std::weak_ptr<Scene> scene;
+        entt::entity GetHandle() const
+        { return entityHandle; }
 
-    private:
-        void GetAllChildren(std::vector<std::shared_ptr<Entity>>& allChildren) const;
+        Scene* GetScene() const
+        { return scene; }
+
+        bool IsValid() const
+        { return scene && scene->registry.valid(entityHandle); }
+
+        explicit operator bool() const
+        { return IsValid(); }
 
-        std::recursive_mutex m_mutex;
+        bool operator==(const Entity& other) const
+        { return entityHandle == other.entityHandle && scene == other.scene; }
+
+        bool operator!=(const Entity& other) const
+        { return !(*this == other); }
+
+    private:
+        void Detach();
+        void GetAllChildren(std::vector<Entity>& allChildren) const;
 
-        friend class Scene;
+        entt::entity entityHandle{ entt::null };
+        Scene* scene{ nullptr };
     };
-}
\ No newline at end of file
+
+    static_assert(std::is_trivially_copyable_v<Entity>, "Entity must stay a plain handle");
+
+    template<typename F>
+    void Entity::ForEachChild(F&& f) const
+    {
+        auto& registry = scene->registry;
+        entt::entity child = registry.get<RelationshipComponent>(entityHandle).firstChild;
+        while (child != entt::null)
+        {
+            // Next is read first, so f is allowed to detach the child
+            const entt::entity next = registry.get<RelationshipComponent>(child).nextSibling;
+            f(Entity(child, scene));
+            child = next;
+        }
+    }
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <entt.hpp>
+#include <crossguid/guid.hpp>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace RightEngine
+{
+    class Scene;
+    class Entity;
+
+    /*
+     * Records structural changes (entity creation, destruction, component add and remove, reparenting),
+     * which are applied later with Scene::PlaybackCommands on the main thread.
+     * Every worker records into its own buffer, so recording doesn't need any synchronization
+     */
+    class EntityCommandBuffer
+    {
+    public:
+        // Existing entity or the one created earlier by the same buffer
+        class Target
+        {
+        public:
+            Target(entt::entity entity) : m_entity(entity)
+            {}
+            Target(const Entity& entity);
+
+        private:
+            Target() = default;
+
+            entt::entity Resolve(const std::vector<entt::entity>& created) const;
+
+            entt::entity m_entity{ entt::null };
+            uint32_t m_createdIndex{ C_NOT_CREATED };
+
+            static constexpr uint32_t C_NOT_CREATED = UINT32_MAX;
+
+            friend class EntityCommandBuffer;
+        };
+
+        // Returned target is only valid for commands of this buffer
+        Target CreateEntity(const std::string& name = "New entity", bool addToRoot = true);
+        Target CreateEntityWithGuid(const std::string& name, const xg::Guid& guid, bool addToRoot = true);
+        // Entity is destroyed together with its children
+        void DestroyEntity(Target entity);
+
+        template<typename T>
+        void AddComponent(Target entity, T component = {});
+
+        template<typename T>
+        void RemoveComponent(Target entity);
+
+        void AddChild(Target parent, Target child);
+
+        bool IsEmpty() const
+        { return m_commands.empty(); }
+
+        // Entities created by the buffer so far
+        uint32_t GetCreatedCount() const
+        { return m_createdCount; }
+
+        // Applies commands in recording order and clears the buffer
+        void Playback(Scene& scene);
+
+    private:
+        using Command = std::function<void(Scene&, entt::registry&, std::vector<entt::entity>&)>;
+
+        std::vector<Command> m_commands;
+        uint32_t m_createdCount{ 0 };
+    };
+
+    template<typename T>
+    void EntityCommandBuffer::AddComponent(Target entity, T component)
+    {
+        m_commands.emplace_back([entity, component = std::move(component)](Scene&, entt::registry& registry, std::vector<entt::entity>& created) mutable
+        {
+            // Entity may be destroyed by an earlier command of the same frame
+            const auto handle = entity.Resolve(created);
+            if (registry.valid(handle))
+            {
+                registry.emplace_or_replace<T>(handle, std::move(component));
+            }
+        });
+    }
+
+    template<typename T>
+    void EntityCommandBuffer::RemoveComponent(Target entity)
+    {
+        m_commands.emplace_back([entity](Scene&, entt::registry& registry, std::vector<entt::entity>& created)
+        {
+            const auto handle = entity.Resolve(created);
+            if (registry.valid(handle))
+            {
+                registry.remove<T>(handle);
+            }
+        });
+    }
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <crossguid/guid.hpp>
+#include <entt.hpp>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace RightEngine
+{
+    /*
+     * GUID and name lookups of scene entities, updated by TagComponent signals instead of walking the registry.
+     * Names are interned, so entities sharing a name share one bucket. Tags must be changed through registry patch
+     * or replace, direct writes aren't seen by the index. Also fills TagComponent::uiId
+     */
+    class EntityIndex
+    {
+    public:
+        // Subscribes to TagComponent lifetime and updates, the index must outlive the registry signals
+        void Connect(entt::registry& registry);
+        // Lets pools be filled wholesale, e.g. by Scene::Clone, which copies the index together with tags
+        void Disconnect(entt::registry& registry);
+
+        // Null when no entity has the guid
+        entt::entity Find(const xg::Guid& guid) const;
+        // Empty when no entity has the name, in no particular order
+        const std::vector<entt::entity>& FindByName(const std::string& name) const;
+
+        // Same for the same guid in every session, unlike entity handles
+        static uint64_t GetStableId(const xg::Guid& guid);
+
+    private:
+        static constexpr uint32_t C_NO_NAME = std::numeric_limits<uint32_t>::max();
+
+        struct Entry
+        {
+            xg::Guid guid;
+            uint32_t name{ C_NO_NAME };
+            // Index in the entities of the name
+            uint32_t namePosition{ 0 };
+        };
+
+        struct Name
+        {
+            std::string name;
+            std::vector<entt::entity> entities;
+        };
+
+        void OnTagConstruct(entt::registry& registry, entt::entity entity);
+        void OnTagUpdate(entt::registry& registry, entt::entity entity);
+        void OnTagDestroy(entt::registry& registry, entt::entity entity);
+
+        void Add(entt::registry& registry, entt::entity entity);
+        void Remove(entt::entity entity);
+        uint32_t InternName(const std::string& name);
+
+        std::unordered_map<xg::Guid, entt::entity> m_guids;
+        std::unordered_map<std::string, uint32_t> m_nameIds;
+        std::vector<Name> m_names;
+        std::vector<uint32_t> m_freeNames;
+        // Indexed by entity index
+        std::vector<Entry> m_entries;
+    };
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "Components.hpp"
+#include <string>
+
+namespace RightEngine
+{
+    /*
+     * Immutable template of a mesh entity. Instances only reference the shared mesh and material assets,
+     * so any number of them is drawn with one instanced draw per mesh
+     */
+    struct Prefab
+    {
+        std::string name{ "Prefab" };
+        AssetHandle mesh;
+        AssetHandle material;
+    };
+}
@@ -1,39 +1,135 @@
 #pragma once
 
 #include "Components.hpp"
+#include "Prefab.hpp"
+#include "AssetLoadQueue.hpp"
+#include "TransformSystem.hpp"
+#include "BoundsSystem.hpp"
+#include "EntityIndex.hpp"
+#include "EntityCommandBuffer.hpp"
+#include "SystemScheduler.hpp"
+#include "WorldPartition.hpp"
 #include <entt.hpp>
+#include <limits>
 
 namespace RightEngine
 {
     class Entity;
 
+    struct RaycastHit
+    {
+        entt::entity entity{ entt::null };
+        glm::vec3 position{ 0.0f };
+        float distance{ 0.0f };
+    };
+
+    /*
+     * Scene isn't internally synchronized. Structural changes (entities, components, hierarchy) are made on the main thread,
+     * systems running on workers may only read and write components of existing entities
+     * and record everything else into an EntityCommandBuffer
+     */
     class Scene : public std::enable_shared_from_this<Scene>
     {
     public:
+        virtual ~Scene();
+
         virtual void OnUpdate(float deltaTime);
 
-        const std::shared_ptr<Entity>& GetRootNode() const;
+        Entity GetRootNode() const;
 
         entt::registry& GetRegistry();
-        std::shared_ptr<Entity> CreateEntity(const std::string& name = "New entity", bool addToRoot = false);
-        std::shared_ptr<Entity> CreateEntityWithGuid(const std::string& name, const xg::Guid& guid, bool addToRoot = false);
-        void DestroyEntity(const std::shared_ptr<Entity>& node);
+        Entity CreateEntity(const std::string& name = "New entity", bool addToRoot = false);
+        Entity CreateEntityWithGuid(const std::string& name, const xg::Guid& guid, bool addToRoot = false);
+        // Instance of the prefab at the given world position, tint is its only per instance data
+        Entity Instantiate(const Prefab& prefab,
+                           const glm::vec3& position,
+                           const glm::vec4& tint = glm::vec4(1.0f),
+                           bool addToRoot = true);
+        // Destroys the entity together with all its children
+        void DestroyEntity(Entity node);
+
+        // Invalid entity when no entity has the guid
+        Entity FindEntity(const xg::Guid& guid);
+        // Entities with exactly this name, in no particular order
+        const std::vector<entt::entity>& FindEntitiesByName(const std::string& entityName) const
+        { return m_entityIndex.FindByName(entityName); }
+        // Tags are only renamed through the registry, so the name index sees the change
+        void RenameEntity(Entity entity, const std::string& entityName);
+
+        // Can be called from any thread, commands are applied at the next sync point of OnUpdate
+        void SubmitCommands(EntityCommandBuffer&& commands);
+        // Sync point, applies submitted command buffers in submission order
+        void PlaybackCommands();
+
+        // Systems registered here run every OnUpdate after the built-in transform, bounds and animation systems
+        SystemScheduler& GetSystemScheduler()
+        { return m_systemScheduler; }
+
+        /*
+         * Spatial queries over world bounds of meshes as of the last bounds update.
+         * Systems calling them must declare a read of BoundsComponent, callbacks receive entities
+         */
+        template<typename F>
+        void QueryFrustum(const Frustum& frustum, F&& callback) const
+        { m_boundsSystem.GetBvh().QueryFrustum(frustum, std::forward<F>(callback)); }
 
-        void UpdateNodeTransformRecursively(const std::shared_ptr<Entity>& node);
+        // Callback returns the new maximum distance, see DynamicBvh::QueryRay
+        template<typename F>
+        void QueryRay(const Ray& ray, float maxDistance, F&& callback) const
+        { m_boundsSystem.GetBvh().QueryRay(ray, maxDistance, std::forward<F>(callback)); }
+
+        template<typename F>
+        void QuerySphere(const Sphere& sphere, F&& callback) const
+        { m_boundsSystem.GetBvh().QuerySphere(sphere, std::forward<F>(callback)); }
+
+        template<typename F>
+        void QueryBox(const AABB& box, F&& callback) const
+        { m_boundsSystem.GetBvh().QueryBox(box, std::forward<F>(callback)); }
+
+        // Closest visible mesh triangle along the ray, direction must be normalized
+        bool Raycast(const Ray& ray, RaycastHit& hit, float maxDistance = std::numeric_limits<float>::max()) const;
 
         void SetName(std::string_view aName)
         { name = aName; }
         const std::string& GetName() const
         { return name; }
 
+        // Assets which are still streamed in after deserialization, entities referencing them must be skipped until loaded
+        void SetAssetLoadQueue(const std::shared_ptr<AssetLoadQueue>& queue)
+        { m_assetLoadQueue = queue; }
+        // Must be called when the scene is replaced, entities keep it alive so destructor isn't enough
+        void CancelAssetLoading();
+
+        // Partitioned scenes stream their cells around the primary camera at the start of OnUpdate
+        void SetWorldPartition(const std::shared_ptr<WorldPartition>& partition)
+        { m_worldPartition = partition; }
+        const std::shared_ptr<WorldPartition>& GetWorldPartition() const
+        { return m_worldPartition; }
+
         static std::shared_ptr<Scene> Create(bool empty = false);
 
+        /*
+         * Copy of the scene as of the last sync point, used as a play mode snapshot. Entities keep their ids,
+         * so hierarchy links, the transform order and the BVH are copied as they are instead of being rebuilt.
+         * Components share asset handles with the source, submitted commands and the asset load queue aren't copied
+         */
+        std::shared_ptr<Scene> Clone() const;
+
     private:
-        std::shared_ptr<Entity> rootNode;
+        entt::entity rootNode{ entt::null };
         std::string name{ "Scene" };
         entt::registry registry;
+        // Only guards submitted command buffers
         std::mutex m_mutex;
-        std::atomic_uint32_t colorId = 0;
+        std::vector<EntityCommandBuffer> m_submittedCommands;
+        std::shared_ptr<AssetLoadQueue> m_assetLoadQueue;
+        std::shared_ptr<WorldPartition> m_worldPartition;
+        TransformSystem transformSystem;
+        BoundsSystem m_boundsSystem;
+        EntityIndex m_entityIndex;
+        SystemScheduler m_systemScheduler;
+
+        Scene();
 
     private:
         friend class Entity;
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "Scene.hpp"
+#include <filesystem>
+#include <vector>
+
+namespace RightEngine
+{
+    struct SceneGeneratorSettings
+    {
+        // Root isn't counted
+        size_t entityCount{ 1000 };
+        // Levels below the root, entities which don't fit go directly under the root
+        size_t maxDepth{ 4 };
+        size_t fanOut{ 8 };
+        // Fractions of entities getting a mesh or a point light, the rest are plain grouping nodes
+        float meshFraction{ 0.8f };
+        float lightFraction{ 0.01f };
+        // Fraction of mesh entities marked static, so they are merged into static batches
+        float staticFraction{ 0.0f };
+        // Picked uniformly for mesh entities, meshes are skipped when either list is empty
+        std::vector<AssetHandle> meshes;
+        std::vector<AssetHandle> materials;
+        // Distance between neighbouring top level entities, children are placed around their parent
+        float spacing{ 4.0f };
+        uint32_t seed{ 42 };
+        // Adds a primary camera looking at the generated content and a directional light
+        bool addCameraAndSun{ true };
+    };
+
+    /*
+     * Procedural scenes of configurable size and shape for stress testing and benchmarks.
+     * Generation is deterministic for the same settings
+     */
+    class SceneGenerator
+    {
+    public:
+        static std::shared_ptr<Scene> Generate(const SceneGeneratorSettings& settings);
+
+        // Generates the scene and saves it with SceneSerializer, all referenced assets must be loaded
+        static bool GenerateFile(const SceneGeneratorSettings& settings, const std::filesystem::path& path);
+    };
+}
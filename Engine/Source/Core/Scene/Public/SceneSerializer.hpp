@@ -1,6 +1,10 @@
 #pragma once
 
 #include "Scene.hpp"
+#include "Material.hpp"
+#include "EnvironmentMapLoader.hpp"
+#include "AssetLoadQueue.hpp"
+#include "WorldPartition.hpp"
 #include <yaml-cpp/yaml.h>
 #include <unordered_map>
 #include <filesystem>
@@ -20,15 +24,18 @@ namespace RightEngine
     {
         xg::Guid albedoGuid;
         xg::Guid normalGuid;
-        xg::Guid roughnessGuid;
-        xg::Guid metallicGuid;
-        xg::Guid aoGuid;
+        OrmSources ormSources;
 
         glm::vec4 albedo;
         float roughness;
         float metallic;
     };
 
+    struct EnvironmentAssetDependency : public AssetDependency
+    {
+        EnvironmentMapSettings settings;
+    };
+
     class SceneSerializer
     {
     public:
@@ -40,14 +47,36 @@ namespace RightEngine
         bool Serialize(const fs::path& path);
         bool Deserialize(const fs::path& path);
 
+        /*
+         * Static meshes go to cell files next to the scene file, the scene file keeps the rest of entities,
+         * the cell list and assets of all cells. Such scenes are loaded with a world partition
+         */
+        bool SerializePartitioned(const fs::path& path, const WorldPartitionSettings& settings = {});
+
+        // Safe to call from any thread, entities of the cell are recorded in batches of entitiesPerBatch
+        static std::vector<EntityCommandBuffer> DeserializeCell(const fs::path& path, uint64_t cellKey, size_t entitiesPerBatch);
+
         std::shared_ptr<Scene> GetScene() { R_CORE_ASSERT(scene, ""); return scene; }
 
+        /*
+         * Returns ORM sources of all materials used by the scene file without loading it, used by offline tools
+         */
+        static std::vector<OrmSources> GetOrmSources(const fs::path& path);
+
     private:
-        void SerializeEntity(YAML::Emitter& output, const std::shared_ptr<Entity>& entity);
+        void SerializeEntity(YAML::Emitter& output, const Entity& entity);
+        // Entity and all its children, entities rejected by filter are skipped but their children are still visited
+        void SerializeEntityTree(YAML::Emitter& output,
+                                 const Entity& entity,
+                                 const std::function<bool(const Entity&)>& filter = {});
         void SerializeAssets(YAML::Emitter& output);
         void SaveMaterial(const AssetHandle& handle);
-        void DeserializeAssets(YAML::Node& node);
-        void LoadDependencies(const std::vector<std::shared_ptr<AssetDependency>>& assetDependencies);
+        std::shared_ptr<AssetLoadQueue> DeserializeAssets(YAML::Node& node,
+                                                          const std::unordered_map<xg::Guid, float>& priorities);
+        std::shared_ptr<AssetLoadQueue> LoadDependencies(const std::vector<std::shared_ptr<AssetDependency>>& assetDependencies,
+                                                         const std::unordered_map<xg::Guid, float>& priorities);
+        // Assets used by entities get their priorities from the primary camera view, unused ones are loaded last
+        std::unordered_map<xg::Guid, float> GetAssetLoadPriorities();
 
         std::shared_ptr<Scene> scene;
         std::unordered_set<xg::Guid> sceneAssets;
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <typeindex>
+#include <vector>
+
+namespace RightEngine
+{
+    class Scene;
+
+    template<typename... T>
+    std::vector<std::type_index> ComponentTypes()
+    { return { std::type_index(typeid(T))... }; }
+
+    struct SystemDescriptor
+    {
+        std::string name;
+        // Components used by the system, systems with conflicting access never run at the same time
+        std::vector<std::type_index> reads;
+        std::vector<std::type_index> writes;
+        // Systems using window, input or immediate UI state must run on the thread which updates the scene
+        bool isMainThread{ false };
+        std::function<void(Scene&, float)> update;
+    };
+
+    struct SystemTiming
+    {
+        std::string name;
+        // In milliseconds
+        float time{ 0.0f };
+    };
+
+    /*
+     * Runs registered systems once per frame as a taskflow graph on ThreadService. System depends on every system
+     * registered earlier which writes components it accesses or reads components it writes,
+     * all other systems run concurrently. Structural changes must go through EntityCommandBuffer
+     */
+    class SystemScheduler
+    {
+    public:
+        void Register(SystemDescriptor&& system);
+
+        void Run(Scene& scene, float deltaTime);
+
+        // Timings of the last Run in registration order
+        const std::vector<SystemTiming>& GetTimings() const
+        { return m_timings; }
+
+    private:
+        static bool IsConflicting(const SystemDescriptor& first, const SystemDescriptor& second);
+
+        std::vector<SystemDescriptor> m_systems;
+        std::vector<SystemTiming> m_timings;
+    };
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <vector>
+#include <cstdint>
+
+namespace RightEngine
+{
+    /*
+     * Local TRS of many entities split into one stream per scalar, so 4 entities are composed per SIMD instruction.
+     * Rotation is stored as a quaternion, Euler angles are converted once when transform changes
+     */
+    struct TransformStreams
+    {
+        std::vector<float> positionX;
+        std::vector<float> positionY;
+        std::vector<float> positionZ;
+        std::vector<float> rotationX;
+        std::vector<float> rotationY;
+        std::vector<float> rotationZ;
+        std::vector<float> rotationW;
+        std::vector<float> scaleX;
+        std::vector<float> scaleY;
+        std::vector<float> scaleZ;
+
+        void Resize(size_t size);
+
+        void Set(size_t index, const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale);
+
+        size_t Size() const
+        { return positionX.size(); }
+    };
+
+    // Writes translation * rotation * scale matrices of entities at indices to result[0, count)
+    void ComposeTransforms(const TransformStreams& streams, const uint32_t* indices, size_t count, glm::mat4* result);
+
+    // Same for the contiguous range [begin, end), result has end - begin matrices
+    void ComposeTransforms(const TransformStreams& streams, size_t begin, size_t end, glm::mat4* result);
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "TransformStreams.hpp"
+#include <entt.hpp>
+#include <glm/glm.hpp>
+#include <vector>
+#include <atomic>
+
+namespace RightEngine
+{
+    /*
+     * Keeps the scene hierarchy flattened into a breadth first array, so every parent precedes its children
+     * and world matrices are propagated in a single linear pass. Only dirty transforms and their subtrees are recalculated,
+     * frames without any transform change cost nothing.
+     * Entities of one hierarchy level are independent, so wide levels are split across ThreadService workers
+     */
+    class TransformSystem
+    {
+    public:
+        // Points TransformComponents of the registry at the change counter of this system, the system must outlive the registry signals
+        void Connect(entt::registry& registry);
+
+        // Must be called after entity was created, destroyed or reparented
+        void MarkHierarchyDirty()
+        { m_isHierarchyDirty = true; }
+
+        void Update(entt::registry& registry, entt::entity root);
+
+        size_t GetEntityCount() const
+        { return m_entities.size(); }
+
+        // Limits amount of threads working on one level including the calling one, 0 means all workers
+        void SetMaxThreadCount(size_t count)
+        { m_maxThreadCount = count; }
+
+    private:
+        /*
+         * Copies, e.g. of a cloned scene, keep their own counter, so scenes never see changes of each other.
+         * Copying counts as a change, the copied state may lag behind transforms changed before the copy
+         */
+        struct ChangeCounter
+        {
+            std::atomic_uint32_t value{ 0 };
+
+            ChangeCounter() = default;
+            ChangeCounter(const ChangeCounter&) : value(1)
+            {}
+            ChangeCounter& operator=(const ChangeCounter&)
+            {
+                value.fetch_add(1, std::memory_order_relaxed);
+                return *this;
+            }
+        };
+
+        void OnTransformChange(entt::registry& registry, entt::entity entity);
+        void Rebuild(entt::registry& registry, entt::entity root);
+        void UpdateRange(entt::registry& registry, size_t begin, size_t end, bool force);
+
+        std::vector<entt::entity> m_entities;
+        // Index of the parent in m_entities, -1 for the root
+        std::vector<int32_t> m_parents;
+        // Level i occupies [m_levelOffsets[i], m_levelOffsets[i + 1]) of m_entities
+        std::vector<size_t> m_levelOffsets;
+        // Local TRS in flat order, refreshed from a component only when it changes
+        TransformStreams m_localStreams;
+        std::vector<glm::mat4> m_worldMatrices;
+        // Byte per entity, vector<bool> bit packing is slower in the hot loop
+        std::vector<uint8_t> m_isWorldDirty;
+        ChangeCounter m_changeCount;
+        uint32_t m_lastChangeCount{ 0 };
+        size_t m_maxThreadCount{ 0 };
+        bool m_isHierarchyDirty{ true };
+    };
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "EntityCommandBuffer.hpp"
+#include <glm/glm.hpp>
+#include <entt.hpp>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace RightEngine
+{
+    class Scene;
+
+    struct WorldPartitionSettings
+    {
+        // Cells are squares on the XZ plane
+        float cellSize{ 64.0f };
+        // Cells closer to the camera than this are loaded
+        float loadRadius{ 128.0f };
+        // Loaded cells are kept until the camera is this much further, so moving along a border doesn't reload them
+        float unloadHysteresis{ 32.0f };
+        // Main thread time per frame spent on creating and destroying streamed entities, at least one batch always runs
+        double frameBudgetMs{ 2.0 };
+        // Granularity of the frame budget
+        size_t entitiesPerBatch{ 64 };
+    };
+
+    /*
+     * Streams spatial cells of a scene around the camera. Cell files are parsed into entity command buffers on
+     * ThreadService, the main thread only plays the batches back within the frame budget, nearest cells first.
+     * Entities of a cell are marked with WorldCellComponent and destroyed, also within the budget, on eviction
+     */
+    class WorldPartition
+    {
+    public:
+        explicit WorldPartition(const WorldPartitionSettings& settings = {});
+        ~WorldPartition();
+
+        void AddCell(const glm::ivec2& cell, const std::filesystem::path& path);
+
+        // Main thread, once per frame
+        void Update(Scene& scene, const glm::vec3& cameraPosition);
+        // Drops results of all loads, running ones finish on their workers
+        void Cancel();
+        /*
+         * Partition of a scene cloned from the one this partition streams, registry is the clone's one.
+         * Loaded cells stay loaded, loads in flight are restarted by the clone and their already played back entities are evicted
+         */
+        std::shared_ptr<WorldPartition> Clone(const entt::registry& registry) const;
+
+        const WorldPartitionSettings& GetSettings() const
+        { return m_settings; }
+
+        size_t GetCellCount() const
+        { return m_cells.size(); }
+        size_t GetLoadedCellCount() const;
+        size_t GetLoadingCellCount() const;
+
+        static glm::ivec2 GetCell(const glm::vec3& position, float cellSize);
+        static uint64_t GetCellKey(const glm::ivec2& cell);
+
+        WorldPartition(const WorldPartition& other) = delete;
+        WorldPartition& operator=(const WorldPartition& other) = delete;
+
+    private:
+        enum class CellState
+        {
+            UNLOADED,
+            LOADING,
+            LOADED
+        };
+
+        struct Cell
+        {
+            glm::ivec2 coord{ 0 };
+            std::filesystem::path path;
+            CellState state{ CellState::UNLOADED };
+            // Bumped on eviction, results of loads started before it are dropped
+            uint32_t generation{ 0 };
+            bool isParsed{ false };
+            std::vector<EntityCommandBuffer> batches;
+            size_t nextBatch{ 0 };
+        };
+
+        struct LoadResult
+        {
+            uint64_t key;
+            uint32_t generation;
+            std::vector<EntityCommandBuffer> batches;
+        };
+
+        // Shared with load tasks, which may outlive the partition
+        struct LoadResults
+        {
+            std::mutex mutex;
+            std::vector<LoadResult> results;
+            bool isCancelled{ false };
+        };
+
+        void CollectLoadResults();
+        void RequestLoad(uint64_t key, Cell& cell);
+        void Evict(Scene& scene, uint64_t key, Cell& cell);
+        float GetDistance(const Cell& cell, const glm::vec3& position) const;
+
+        WorldPartitionSettings m_settings;
+        std::unordered_map<uint64_t, Cell> m_cells;
+        std::shared_ptr<LoadResults> m_loadResults;
+        std::vector<entt::entity> m_pendingDestroys;
+    };
+}
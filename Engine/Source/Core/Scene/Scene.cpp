@@ -2,79 +2,260 @@
 #include "Assert.hpp"
 #include "AssetManager.hpp"
 #include "Entity.hpp"
+#include "AnimationSystem.hpp"
+#include "MeshLoader.hpp"
+#include "Application.hpp"
+#include "ThreadService.hpp"
+#include <array>
 
 using namespace RightEngine;
 
+namespace
+{
+    bool RaycastMeshNode(const MeshNode& meshNode, const Ray& ray, float& distance)
+    {
+        bool isHit = false;
+        for (const auto& mesh : meshNode.meshes)
+        {
+            isHit |= mesh->GetTriangleBvh().Intersect(ray, distance);
+        }
+        for (const auto& child : meshNode.children)
+        {
+            isHit |= RaycastMeshNode(*child, ray, distance);
+        }
+        return isHit;
+    }
+
+    // Packed order of the source pool is kept, so a group owning it doesn't have to reorder the clone's one
+    template<typename T>
+    void ClonePool(const entt::registry& source, entt::registry& destination)
+    {
+        const auto& storage = source.storage<T>();
+        if (storage.empty())
+        {
+            return;
+        }
+        // Bulk insert is a plain copy of the range for trivially copyable components
+        destination.insert<T>(storage.data(), storage.data() + storage.size(), storage.rbegin());
+    }
+
+    template<typename List>
+    struct ComponentPools;
+
+    /*
+     * Copies pools of the listed component types. Pools are independent,
+     * so they are copied concurrently, strings of tags and skinning palettes dominate big scenes
+     */
+    template<typename... T>
+    struct ComponentPools<ComponentTypeList<T...>>
+    {
+        static bool IsListed(entt::id_type id)
+        {
+            return ((id == entt::type_hash<T>::value()) || ...);
+        }
+
+        static void Clone(const entt::registry& source, entt::registry& destination)
+        {
+            // Components missing from the list would silently vanish from the clone
+            for (const auto [id, storage] : source.storage())
+            {
+                R_CORE_ASSERT(storage.empty() || IsListed(id), "Scene stores a component type missing from SceneComponentTypes");
+            }
+
+            // Creating a pool changes the registry itself, so it can't happen on workers
+            ((void) destination.storage<T>(), ...);
+            const std::array<void(*)(const entt::registry&, entt::registry&), sizeof...(T)> cloners = { &ClonePool<T>... };
+            Instance().Service<ThreadService>().ParallelFor(cloners.size(), 1, [&](size_t begin, size_t end)
+            {
+                for (size_t i = begin; i < end; i++)
+                {
+                    cloners[i](source, destination);
+                }
+            });
+        }
+    };
+
+    using SceneComponentPools = ComponentPools<SceneComponentTypes>;
+}
+
 std::shared_ptr<Scene> Scene::Create(bool empty)
 {
     auto sceneRawPtr = new Scene();
 
     std::shared_ptr<Scene> scene;
     scene.reset(sceneRawPtr);
-    scene->rootNode = scene->CreateEntity();
+    scene->rootNode = scene->CreateEntity().GetHandle();
 
     if (!empty)
     {
         auto camera = scene->CreateEntity("Editor camera");
-        auto& cc = camera->AddComponent<CameraComponent>();
+        auto& cc = camera.AddComponent<CameraComponent>();
         cc.isPrimary = true;
         auto skybox = scene->CreateEntity("Skybox");
-        auto& sc = skybox->AddComponent<SkyboxComponent>();
+        auto& sc = skybox.AddComponent<SkyboxComponent>();
         sc.environmentHandle = AssetManager::Get().GetDefaultSkybox();
-        scene->rootNode->AddChild(camera);
-        scene->rootNode->AddChild(skybox);
+        scene->GetRootNode().AddChild(camera);
+        scene->GetRootNode().AddChild(skybox);
     }
 
     return scene;
 }
 
-void RightEngine::Scene::OnUpdate(float deltaTime)
+std::shared_ptr<Scene> Scene::Clone() const
 {
-    UpdateNodeTransformRecursively(rootNode);
+    std::shared_ptr<Scene> clone(new Scene());
+    clone->name = name;
+    clone->rootNode = rootNode;
+
+    // Bounds come with their BVH proxies, signals would replace them with empty ones. Index is copied the same way.
+    // Transform signals stay connected, so copied transforms report to the change counter of the clone
+    clone->m_boundsSystem.Disconnect(clone->registry);
+    clone->m_entityIndex.Disconnect(clone->registry);
+    clone->registry.assign(registry.data(), registry.data() + registry.size(), registry.released());
+    SceneComponentPools::Clone(registry, clone->registry);
+    clone->m_boundsSystem = m_boundsSystem;
+    clone->m_boundsSystem.Connect(clone->registry);
+    clone->m_entityIndex = m_entityIndex;
+    clone->m_entityIndex.Connect(clone->registry);
+
+    clone->transformSystem = transformSystem;
+    // Systems registered by the owner of the scene run in the clone too
+    clone->m_systemScheduler = m_systemScheduler;
+    if (m_worldPartition)
+    {
+        clone->m_worldPartition = m_worldPartition->Clone(clone->registry);
+    }
+    return clone;
 }
 
-const std::shared_ptr<Entity>& Scene::GetRootNode() const
+Scene::Scene()
 {
-    return rootNode;
+    transformSystem.Connect(registry);
+    m_boundsSystem.Connect(registry);
+    m_entityIndex.Connect(registry);
+
+    m_systemScheduler.Register({ "Transform",
+                                 ComponentTypes<RelationshipComponent>(),
+                                 ComponentTypes<TransformComponent>(),
+                                 false,
+                                 [](Scene& scene, float)
+                                 {
+                                     scene.transformSystem.Update(scene.registry, scene.rootNode);
+                                 } });
+    m_systemScheduler.Register({ "Bounds",
+                                 ComponentTypes<TransformComponent, MeshComponent>(),
+                                 ComponentTypes<BoundsComponent>(),
+                                 false,
+                                 [](Scene& scene, float)
+                                 {
+                                     scene.m_boundsSystem.Update(scene.registry);
+                                 } });
+    m_systemScheduler.Register({ "Animation",
+                                 ComponentTypes<MeshComponent>(),
+                                 ComponentTypes<AnimatorComponent>(),
+                                 false,
+                                 [](Scene& scene, float deltaTime)
+                                 {
+                                     AnimationSystem::Update(scene.registry, deltaTime);
+                                 } });
 }
 
-std::shared_ptr<Entity> Scene::CreateEntity(const std::string& name, bool addToRoot)
+Scene::~Scene()
 {
-    std::shared_ptr<Entity> entity = std::make_shared<Entity>(registry.create(), shared_from_this());
-    entity->AddComponent<TransformComponent>();
-    auto& tag = entity->AddComponent<TagComponent>(name);
-    tag.colorId = colorId++;
+    CancelAssetLoading();
+}
 
-    if (addToRoot)
+void Scene::CancelAssetLoading()
+{
+    if (m_assetLoadQueue)
     {
-        rootNode->AddChild(entity);
+        m_assetLoadQueue->Cancel();
+        m_assetLoadQueue.reset();
     }
+    if (m_worldPartition)
+    {
+        m_worldPartition->Cancel();
+    }
+}
 
-    return entity;
+void RightEngine::Scene::OnUpdate(float deltaTime)
+{
+    if (m_worldPartition)
+    {
+        // World matrices of the previous update, a frame of lag only delays streaming
+        for (const auto entity : registry.view<CameraComponent>())
+        {
+            if (registry.get<CameraComponent>(entity).isPrimary)
+            {
+                m_worldPartition->Update(*this, registry.get<TransformComponent>(entity).GetWorldPosition());
+                break;
+            }
+        }
+    }
+    PlaybackCommands();
+    m_systemScheduler.Run(*this, deltaTime);
+    PlaybackCommands();
 }
 
-void Scene::DestroyEntity(const std::shared_ptr<Entity>& node)
+void Scene::SubmitCommands(EntityCommandBuffer&& commands)
 {
-    registry.destroy(node->entityHandle);
+    if (commands.IsEmpty())
+    {
+        return;
+    }
+    std::lock_guard l(m_mutex);
+    m_submittedCommands.emplace_back(std::move(commands));
 }
 
-void Scene::UpdateNodeTransformRecursively(const std::shared_ptr<Entity>& node)
+void Scene::PlaybackCommands()
 {
-    auto& transform = node->GetComponent<TransformComponent>();
-    const auto parentPtr = node->parent.lock();
-    if (parentPtr)
+    std::vector<EntityCommandBuffer> submittedCommands;
     {
-        transform.RecalculateTransform(parentPtr->GetComponent<TransformComponent>());
+        std::lock_guard l(m_mutex);
+        submittedCommands = std::move(m_submittedCommands);
+        m_submittedCommands.clear();
     }
-    else
+
+    for (auto& commands : submittedCommands)
     {
-        transform.RecalculateTransform();
+        commands.Playback(*this);
     }
+}
 
-    for (const auto& child: node->children)
+Entity Scene::GetRootNode() const
+{
+    return { rootNode, const_cast<Scene*>(this) };
+}
+
+Entity Scene::CreateEntity(const std::string& name, bool addToRoot)
+{
+    return CreateEntityWithGuid(name, xg::newGuid(), addToRoot);
+}
+
+Entity Scene::Instantiate(const Prefab& prefab, const glm::vec3& position, const glm::vec4& tint, bool addToRoot)
+{
+    auto entity = CreateEntity(prefab.name, addToRoot);
+    entity.GetComponent<TransformComponent>().SetPosition(position);
+    auto& meshComponent = entity.AddComponent<MeshComponent>(prefab.mesh, prefab.material);
+    meshComponent.tint = tint;
+    return entity;
+}
+
+void Scene::DestroyEntity(Entity node)
+{
+    const auto parent = node.GetParent();
+    if (parent)
+    {
+        parent.RemoveChild(node);
+    }
+
+    auto children = node.GetAllChildren();
+    children.push_back(node);
+    for (const auto& entity : children)
     {
-        UpdateNodeTransformRecursively(child);
+        registry.destroy(entity.GetHandle());
     }
+    transformSystem.MarkHierarchyDirty();
 }
 
 entt::registry& Scene::GetRegistry()
@@ -82,12 +263,72 @@ entt::registry& Scene::GetRegistry()
     return registry;
 }
 
-std::shared_ptr<Entity> Scene::CreateEntityWithGuid(const std::string& name, const xg::Guid& guid, bool addToRoot)
+Entity Scene::CreateEntityWithGuid(const std::string& name, const xg::Guid& guid, bool addToRoot)
 {
-    std::lock_guard l(m_mutex);
-    auto entity = CreateEntity(name, addToRoot);
-    auto& tag = entity->GetComponent<TagComponent>();
-    tag.guid = guid;
+    Entity entity(registry.create(), this);
+    entity.AddComponent<RelationshipComponent>();
+    entity.AddComponent<TransformComponent>();
+    // Tag gets its guid before construction, so the entity index sees it right away
+    entity.AddComponent<TagComponent>(name, guid);
+
+    if (addToRoot)
+    {
+        GetRootNode().AddChild(entity);
+    }
 
     return entity;
 }
+
+Entity Scene::FindEntity(const xg::Guid& guid)
+{
+    return { m_entityIndex.Find(guid), this };
+}
+
+void Scene::RenameEntity(Entity entity, const std::string& entityName)
+{
+    registry.patch<TagComponent>(entity.GetHandle(), [&entityName](TagComponent& tag)
+    {
+        tag.name = entityName;
+    });
+}
+
+bool Scene::Raycast(const Ray& ray, RaycastHit& hit, float maxDistance) const
+{
+    auto& assetManager = AssetManager::Get();
+    float closestDistance = maxDistance;
+    entt::entity closestEntity = entt::null;
+    QueryRay(ray, maxDistance, [&](entt::entity entity, float)
+    {
+        const auto& meshComponent = registry.get<MeshComponent>(entity);
+        if (!meshComponent.isVisible || !meshComponent.mesh.guid.isValid())
+        {
+            return closestDistance;
+        }
+        const auto meshNode = assetManager.GetAsset<MeshNode>(meshComponent.mesh);
+        if (!meshNode)
+        {
+            return closestDistance;
+        }
+
+        // Triangles are tested in mesh space, direction isn't renormalized, so distances stay in world units
+        const glm::mat4 worldToLocal = glm::inverse(registry.get<TransformComponent>(entity).GetWorldTransformMatrix());
+        Ray localRay;
+        localRay.origin = glm::vec3(worldToLocal * glm::vec4(ray.origin, 1.0f));
+        localRay.direction = glm::vec3(worldToLocal * glm::vec4(ray.direction, 0.0f));
+        if (RaycastMeshNode(*meshNode, localRay, closestDistance))
+        {
+            closestEntity = entity;
+        }
+        return closestDistance;
+    });
+
+    if (closestEntity == entt::null)
+    {
+        return false;
+    }
+
+    hit.entity = closestEntity;
+    hit.distance = closestDistance;
+    hit.position = ray.origin + ray.direction * closestDistance;
+    return true;
+}
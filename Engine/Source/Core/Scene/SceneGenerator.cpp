@@ -0,0 +1,103 @@
+#include "SceneGenerator.hpp"
+#include "SceneSerializer.hpp"
+#include "Entity.hpp"
+#include <glm/gtc/constants.hpp>
+#include <cmath>
+#include <deque>
+#include <random>
+
+using namespace RightEngine;
+
+namespace
+{
+    struct OpenParent
+    {
+        Entity entity;
+        size_t depth;
+        size_t childCount;
+    };
+}
+
+std::shared_ptr<Scene> SceneGenerator::Generate(const SceneGeneratorSettings& settings)
+{
+    R_CORE_ASSERT(settings.fanOut > 0, "");
+
+    auto scene = Scene::Create(true);
+    scene->SetName("Stress scene");
+    auto root = scene->GetRootNode();
+
+    std::mt19937 random(settings.seed);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::uniform_real_distribution<float> offset(-1.0f, 1.0f);
+    const bool hasMeshes = !settings.meshes.empty() && !settings.materials.empty();
+
+    // Top level entities are spread over a cube, so the scene volume grows with the entity count
+    const float worldSize = settings.spacing * std::cbrt(static_cast<float>(std::max<size_t>(settings.entityCount, 1)));
+
+    // Breadth first filling keeps the hierarchy balanced, full parents are dropped from the front
+    std::deque<OpenParent> openParents;
+    openParents.push_back({ root, 0, 0 });
+    for (size_t i = 0; i < settings.entityCount; i++)
+    {
+        while (!openParents.empty() && openParents.front().childCount >= settings.fanOut)
+        {
+            openParents.pop_front();
+        }
+        const OpenParent parent = openParents.empty() ? OpenParent{ root, 0, 0 } : openParents.front();
+        if (!openParents.empty())
+        {
+            openParents.front().childCount++;
+        }
+
+        auto entity = scene->CreateEntity("Entity " + std::to_string(i));
+        parent.entity.AddChild(entity);
+
+        auto& transform = entity.GetComponent<TransformComponent>();
+        const glm::vec3 direction(offset(random), offset(random), offset(random));
+        const float extent = parent.depth == 0 ? worldSize * 0.5f : settings.spacing;
+        transform.SetPosition(direction * extent);
+        transform.SetRotationRadians(glm::vec3(0.0f, offset(random) * glm::pi<float>(), 0.0f));
+
+        const float kind = unit(random);
+        if (kind < settings.lightFraction)
+        {
+            auto& light = entity.AddComponent<LightComponent>();
+            light.type = LightType::POINT;
+            light.color = glm::vec3(unit(random), unit(random), unit(random));
+            light.intensity = 100.0f + unit(random) * 900.0f;
+        }
+        else if (hasMeshes && kind < settings.lightFraction + settings.meshFraction)
+        {
+            auto& meshComponent = entity.AddComponent<MeshComponent>(settings.meshes[random() % settings.meshes.size()],
+                                                                     settings.materials[random() % settings.materials.size()]);
+            // Random sequence of settings without static meshes stays the same
+            meshComponent.isStatic = settings.staticFraction > 0.0f && unit(random) < settings.staticFraction;
+        }
+
+        if (parent.depth + 1 < settings.maxDepth)
+        {
+            openParents.push_back({ entity, parent.depth + 1, 0 });
+        }
+    }
+
+    if (settings.addCameraAndSun)
+    {
+        auto sun = scene->CreateEntity("Sun", true);
+        sun.GetComponent<TransformComponent>().SetRotationRadians(glm::vec3(-0.8f, 0.4f, 0.0f));
+        sun.AddComponent<LightComponent>().type = LightType::DIRECTIONAL;
+
+        auto camera = scene->CreateEntity("Camera", true);
+        camera.GetComponent<TransformComponent>().SetPosition(glm::vec3(0.0f, worldSize * 0.25f, worldSize));
+        auto& cc = camera.AddComponent<CameraComponent>();
+        cc.isPrimary = true;
+        cc.zFar = worldSize * 3.0f;
+    }
+
+    return scene;
+}
+
+bool SceneGenerator::GenerateFile(const SceneGeneratorSettings& settings, const std::filesystem::path& path)
+{
+    SceneSerializer serializer(Generate(settings));
+    return serializer.Serialize(path);
+}
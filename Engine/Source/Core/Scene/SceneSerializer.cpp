@@ -2,13 +2,15 @@
 #include "Path.hpp"
 #include "Entity.hpp"
 #include "AssetManager.hpp"
-#include "MaterialLoader.hpp"
 #include "Timer.hpp"
 #include "Application.hpp"
-#include "ThreadService.hpp"
 #include "TextureLoader.hpp"
-#include <taskflow/taskflow.hpp>
+#include "AssetLoadQueue.hpp"
 #include <fstream>
+#include <map>
+#include <algorithm>
+#include <optional>
+#include <cmath>
 
 using namespace RightEngine;
 
@@ -37,6 +39,29 @@ namespace YAML
         }
     };
 
+    template<>
+    struct convert<glm::ivec2>
+    {
+        static Node encode(const glm::ivec2& rhs)
+        {
+            Node node;
+            node.push_back(rhs.x);
+            node.push_back(rhs.y);
+            node.SetStyle(EmitterStyle::Flow);
+            return node;
+        }
+
+        static bool decode(const Node& node, glm::ivec2& rhs)
+        {
+            if (!node.IsSequence() || node.size() != 2)
+                return false;
+
+            rhs.x = node[0].as<int32_t>();
+            rhs.y = node[1].as<int32_t>();
+            return true;
+        }
+    };
+
     template<>
     struct convert<glm::vec3>
     {
@@ -113,6 +138,13 @@ namespace YAML
         return out;
     }
 
+    Emitter& operator<<(YAML::Emitter& out, const glm::ivec2& v)
+    {
+        out << YAML::Flow;
+        out << YAML::BeginSeq << v.x << v.y << YAML::EndSeq;
+        return out;
+    }
+
     Emitter& operator<<(YAML::Emitter& out, const glm::vec3& v)
     {
         out << YAML::Flow;
@@ -145,15 +177,15 @@ namespace
 
     template<typename T>
     void SerializeComponent(YAML::Emitter& output,
-                            const std::shared_ptr<Entity>& entity,
+                            const Entity& entity,
                             const std::string& componentName,
                             std::function<void(const T&)> componentCallback)
     {
-        if (entity->HasComponent<T>())
+        if (entity.HasComponent<T>())
         {
             output << YAML::Key << componentName;
             output << YAML::BeginMap;
-            componentCallback(entity->GetComponent<T>());
+            componentCallback(entity.GetComponent<T>());
             output << YAML::EndMap;
         }
     }
@@ -195,9 +227,13 @@ namespace
             {
                 SerializeKeyValue(output, "Albedo GUID", materialPtr->textureData.albedo.guid);
                 SerializeKeyValue(output, "Normal GUID", materialPtr->textureData.normal.guid);
-                SerializeKeyValue(output, "Roughness GUID", materialPtr->textureData.roughness.guid);
-                SerializeKeyValue(output, "Metallic GUID", materialPtr->textureData.metallic.guid);
-                SerializeKeyValue(output, "AO GUID", materialPtr->textureData.ao.guid);
+                SerializeList(output, "ORM Sources", [&]()
+                {
+                    const auto& ormSources = materialPtr->textureData.ormSources;
+                    SerializeKeyValue(output, "Occlusion", ormSources.occlusion);
+                    SerializeKeyValue(output, "Roughness", ormSources.roughness);
+                    SerializeKeyValue(output, "Metallic", ormSources.metallic);
+                });
             });
 
             SerializeList(output, "Material Data", [&]()
@@ -207,9 +243,239 @@ namespace
                 SerializeKeyValue(output, "Metallic", materialPtr->materialData.metallic);
             });
         }
+        if (assetPtr->type == AssetType::ENVIRONMENT_MAP)
+        {
+            const auto environmentPtr = AssetManager::Get().GetAsset<EnvironmentContext>({ guid });
+
+            SerializeList(output, "Environment Settings", [&]()
+            {
+                const auto& settings = environmentPtr->settings;
+                SerializeKeyValue(output, "Environment Size", settings.environmentSize);
+                SerializeKeyValue(output, "Irradiance Size", settings.irradianceSize);
+                SerializeKeyValue(output, "Prefilter Size", settings.prefilterSize);
+                SerializeKeyValue(output, "Compress", settings.compress);
+            });
+        }
         output << YAML::EndMap;
         output << YAML::EndMap;
     }
+
+    struct LoadCamera
+    {
+        glm::vec3 position;
+        // World space, camera front is relative to the parent of the camera
+        glm::vec3 front;
+        const CameraComponent& camera;
+    };
+
+    // World matrices are only written by the first TransformSystem update, so they are composed from the parent chain here
+    const glm::mat4& GetWorldMatrix(const entt::registry& registry,
+                                    entt::entity entity,
+                                    std::unordered_map<entt::entity, glm::mat4>& worldMatrices)
+    {
+        const auto it = worldMatrices.find(entity);
+        if (it != worldMatrices.end())
+        {
+            return it->second;
+        }
+
+        glm::mat4 world = registry.get<TransformComponent>(entity).GetLocalTransformMatrix();
+        const entt::entity parent = registry.get<RelationshipComponent>(entity).parent;
+        if (parent != entt::null)
+        {
+            world = GetWorldMatrix(registry, parent, worldMatrices) * world;
+        }
+        return worldMatrices.emplace(entity, world).first->second;
+    }
+
+    // Visible entities below this fraction of the screen height are streamed in after the first frame
+    constexpr float C_MIN_CRITICAL_COVERAGE = 0.005f;
+
+    /*
+     * Visible entities get priority in [C_CRITICAL_LOAD_PRIORITY, C_CRITICAL_LOAD_PRIORITY + 1), others in [0, 1).
+     * Within each range bigger on screen and closer entities go first
+     */
+    float GetLoadPriority(const LoadCamera& loadCamera, const glm::mat4& world)
+    {
+        // Meshes don't have bounds, so the longest world axis stands for the bounding sphere radius
+        const float radius = std::max({ glm::length(glm::vec3(world[0])), glm::length(glm::vec3(world[1])), glm::length(glm::vec3(world[2])) });
+        const glm::vec3 toEntity = glm::vec3(world[3]) - loadCamera.position;
+        const float distance = glm::length(toEntity);
+        if (distance <= radius)
+        {
+            return C_CRITICAL_LOAD_PRIORITY + 0.99f;
+        }
+
+        const auto& camera = loadCamera.camera;
+        const float halfFov = camera.GetFOV(true) * 0.5f;
+        const float angularRadius = std::asin(radius / distance);
+        const float coverage = std::min(angularRadius / halfFov, 1.0f);
+        const float closeness = 1.0f / (1.0f + distance);
+        const float priority = std::min(0.5f * coverage + 0.5f * closeness, 0.99f);
+
+        // Sphere is tested against the cone around the frustum diagonal
+        const float halfDiagonalFov = std::atan(std::tan(halfFov) * std::sqrt(1.0f + camera.aspectRatio * camera.aspectRatio));
+        const float angle = std::acos(glm::clamp(glm::dot(toEntity / distance, loadCamera.front), -1.0f, 1.0f));
+        const bool isVisible = angle - angularRadius <= halfDiagonalFov && distance - radius <= camera.zFar;
+        if (isVisible && coverage >= C_MIN_CRITICAL_COVERAGE)
+        {
+            return C_CRITICAL_LOAD_PRIORITY + priority;
+        }
+        return priority;
+    }
+
+    std::unordered_map<xg::Guid, std::string> GetAssetPaths(const YAML::Node& assets)
+    {
+        std::unordered_map<xg::Guid, std::string> assetPaths;
+        for (auto assetIt : assets)
+        {
+            auto asset = assetIt["Asset"];
+            assetPaths[asset["GUID"].as<xg::Guid>()] = asset["Path"].as<std::string>();
+        }
+        return assetPaths;
+    }
+
+    // Older scenes store separate occlusion/roughness/metallic textures, they are resolved through scene asset list
+    OrmSources DeserializeOrmSources(const YAML::Node& textureData,
+                                     const std::unordered_map<xg::Guid, std::string>& assetPaths)
+    {
+        OrmSources sources;
+        auto ormSources = textureData["ORM Sources"];
+        if (ormSources)
+        {
+            sources.occlusion = ormSources["Occlusion"].as<std::string>();
+            sources.roughness = ormSources["Roughness"].as<std::string>();
+            sources.metallic = ormSources["Metallic"].as<std::string>();
+            return sources;
+        }
+
+        const auto resolvePath = [&](const std::string& key) -> std::string
+        {
+            auto guidNode = textureData[key];
+            if (!guidNode)
+            {
+                return {};
+            }
+            const auto pathIt = assetPaths.find(guidNode.as<xg::Guid>());
+            if (pathIt == assetPaths.end() || pathIt->second == C_DEFAULT_TEXTURE_PATH)
+            {
+                return {};
+            }
+            return pathIt->second;
+        };
+
+        sources.occlusion = resolvePath("AO GUID");
+        sources.roughness = resolvePath("Roughness GUID");
+        sources.metallic = resolvePath("Metallic GUID");
+        return sources;
+    }
+
+    // Only records commands, so it can run on any thread
+    EntityCommandBuffer::Target DeserializeEntity(const YAML::Node& entity, EntityCommandBuffer& commands)
+    {
+        auto tagComponent = entity["Tag component"];
+        auto name = tagComponent["Name"].as<std::string>();
+        auto tag = tagComponent["GUID"].as<std::string>();
+
+        const auto sceneEntity = commands.CreateEntityWithGuid(name, xg::Guid(tag), true);
+
+        auto transformComponent = entity["Transform component"];
+        R_CORE_ASSERT(transformComponent.IsDefined(), "");
+
+        TransformComponent tc;
+        tc.SetPosition(transformComponent["Position"].as<glm::vec3>());
+        tc.SetRotationRadians(transformComponent["Rotation"].as<glm::vec3>());
+        tc.SetScale(transformComponent["Scale"].as<glm::vec3>());
+        commands.AddComponent(sceneEntity, tc);
+
+        // TODO: Implement validation of all handles
+        auto meshComponent = entity["Mesh component"];
+        if (meshComponent)
+        {
+            MeshComponent mc({ meshComponent["Mesh GUID"].as<xg::Guid>() }, { meshComponent["Material GUID"].as<xg::Guid>() });
+            mc.isVisible = meshComponent["Is visible"].as<bool>();
+            if (meshComponent["Tint"])
+            {
+                mc.tint = meshComponent["Tint"].as<glm::vec4>();
+            }
+            if (meshComponent["Is occluder"])
+            {
+                mc.isOccluder = meshComponent["Is occluder"].as<bool>();
+            }
+            if (meshComponent["Is static"])
+            {
+                mc.isStatic = meshComponent["Is static"].as<bool>();
+            }
+            commands.AddComponent(sceneEntity, mc);
+        }
+
+        auto animatorComponent = entity["Animator component"];
+        if (animatorComponent)
+        {
+            AnimatorComponent ac;
+            ac.clip = animatorComponent["Clip"].as<int32_t>();
+            ac.speed = animatorComponent["Speed"].as<float>();
+            ac.loop = animatorComponent["Loop"].as<bool>();
+            ac.isPlaying = animatorComponent["Playing"].as<bool>();
+            commands.AddComponent(sceneEntity, ac);
+        }
+
+        auto lightComponent = entity["Light component"];
+        if (lightComponent)
+        {
+            LightComponent lc;
+            lc.type = static_cast<LightType>(lightComponent["Type"].as<uint32_t>());
+            lc.color = lightComponent["Color"].as<glm::vec3>();
+            lc.intensity = lightComponent["Intensity"].as<float>();
+            lc.outerRadius = lightComponent["Outer Radius"].as<float>();
+            lc.innerRadius = lightComponent["Inner Radius"].as<float>();
+            commands.AddComponent(sceneEntity, lc);
+        }
+
+        auto skyboxComponent = entity["Skybox component"];
+        if (skyboxComponent)
+        {
+            SkyboxComponent sc;
+            sc.type = static_cast<SkyboxType>(skyboxComponent["Type"].as<uint32_t>());
+            sc.environmentHandle = { skyboxComponent["Skybox GUID"].as<xg::Guid>() };
+            commands.AddComponent(sceneEntity, sc);
+        }
+
+        auto cameraComponent = entity["Camera component"];
+        if (cameraComponent)
+        {
+            CameraComponent cc;
+            cc.front = cameraComponent["Front"].as<glm::vec3>();
+            cc.worldUp = cameraComponent["World up"].as<glm::vec3>();
+            cc.up = cameraComponent["Up"].as<glm::vec3>();
+            cc.zNear = cameraComponent["Z near"].as<float>();
+            cc.zFar = cameraComponent["Z far"].as<float>();
+            cc.aspectRatio = cameraComponent["Aspect ratio"].as<float>();
+            cc.fov = cameraComponent["FOV"].as<float>();
+            cc.movementSpeed = cameraComponent["Movement speed"].as<float>();
+            cc.sensitivity = cameraComponent["Sensitivity"].as<float>();
+            cc.isActive = cameraComponent["Active"].as<bool>();
+            cc.isPrimary = cameraComponent["Primary"].as<bool>();
+            commands.AddComponent(sceneEntity, cc);
+        }
+
+        return sceneEntity;
+    }
+
+    // Static meshes are streamed, cameras, lights and skyboxes stay in the scene file
+    bool IsStreamed(const Entity& entity)
+    {
+        return entity.HasComponent<MeshComponent>()
+               && !entity.HasComponent<CameraComponent>()
+               && !entity.HasComponent<LightComponent>()
+               && !entity.HasComponent<SkyboxComponent>();
+    }
+
+    fs::path GetCellPath(const fs::path& scenePath, const glm::ivec2& cell)
+    {
+        return fs::path(scenePath.stem().generic_u8string() + "_cells")
+               / (std::to_string(cell.x) + "_" + std::to_string(cell.y) + ".cell");
+    }
 }
 
 SceneSerializer::SceneSerializer(const std::shared_ptr<Scene>& scene) : scene(scene)
@@ -218,11 +484,16 @@ SceneSerializer::SceneSerializer(const std::shared_ptr<Scene>& scene) : scene(sc
 
 bool SceneSerializer::Serialize(const fs::path& path)
 {
+    if (scene->GetWorldPartition())
+    {
+        R_CORE_WARN("Scene is partitioned, only entities of loaded cells are saved to {}", path.generic_u8string().c_str());
+    }
+
     YAML::Emitter output;
     output << YAML::BeginMap;
     output << YAML::Key << "Scene" << YAML::Value << scene->GetName();
     output << YAML::Key << "Entities" << YAML::Value << YAML::BeginSeq;
-    SerializeEntity(output, scene->GetRootNode());
+    SerializeEntityTree(output, scene->GetRootNode());
     output << YAML::EndSeq;
     output << YAML::Key << "Assets" << YAML::Value << YAML::BeginSeq;
     SerializeAssets(output);
@@ -235,6 +506,108 @@ bool SceneSerializer::Serialize(const fs::path& path)
     return true;
 }
 
+bool SceneSerializer::SerializePartitioned(const fs::path& path, const WorldPartitionSettings& settings)
+{
+    if (scene->GetWorldPartition())
+    {
+        R_CORE_WARN("Scene is partitioned, only entities of loaded cells are saved to {}", path.generic_u8string().c_str());
+    }
+
+    std::map<std::pair<int32_t, int32_t>, std::vector<Entity>> cells;
+    for (const auto& entity : scene->GetRootNode().GetAllChildren())
+    {
+        if (IsStreamed(entity))
+        {
+            const auto cell = WorldPartition::GetCell(entity.GetComponent<TransformComponent>().GetWorldPosition(), settings.cellSize);
+            cells[{ cell.x, cell.y }].push_back(entity);
+        }
+    }
+
+    fs::create_directories(path.parent_path() / GetCellPath(path, {}).parent_path());
+    for (const auto& [coord, entities] : cells)
+    {
+        const glm::ivec2 cell(coord.first, coord.second);
+        YAML::Emitter output;
+        output << YAML::BeginMap;
+        output << YAML::Key << "Cell" << YAML::Value << cell;
+        output << YAML::Key << "Entities" << YAML::Value << YAML::BeginSeq;
+        for (const auto& entity : entities)
+        {
+            SerializeEntity(output, entity);
+        }
+        output << YAML::EndSeq;
+        output << YAML::EndMap;
+
+        std::ofstream fout(path.parent_path() / GetCellPath(path, cell));
+        fout << output.c_str();
+    }
+
+    YAML::Emitter output;
+    output << YAML::BeginMap;
+    output << YAML::Key << "Scene" << YAML::Value << scene->GetName();
+    output << YAML::Key << "Entities" << YAML::Value << YAML::BeginSeq;
+    SerializeEntityTree(output, scene->GetRootNode(), [](const Entity& entity)
+    {
+        return !IsStreamed(entity);
+    });
+    output << YAML::EndSeq;
+    output << YAML::Key << "World partition" << YAML::Value << YAML::BeginMap;
+    SerializeKeyValue(output, "Cell size", settings.cellSize);
+    SerializeKeyValue(output, "Load radius", settings.loadRadius);
+    SerializeKeyValue(output, "Unload hysteresis", settings.unloadHysteresis);
+    output << YAML::Key << "Cells" << YAML::Value << YAML::BeginSeq;
+    for (const auto& [coord, entities] : cells)
+    {
+        const glm::ivec2 cell(coord.first, coord.second);
+        output << YAML::BeginMap;
+        output << YAML::Key << "Cell" << YAML::Value << YAML::BeginMap;
+        SerializeKeyValue(output, "Coordinates", cell);
+        SerializeKeyValue(output, "Path", GetCellPath(path, cell).generic_u8string());
+        SerializeKeyValue(output, "Entity count", entities.size());
+        output << YAML::EndMap;
+        output << YAML::EndMap;
+    }
+    output << YAML::EndSeq;
+    output << YAML::EndMap;
+    // Assets of all cells are listed here, SerializeEntity collected them
+    output << YAML::Key << "Assets" << YAML::Value << YAML::BeginSeq;
+    SerializeAssets(output);
+    output << YAML::EndSeq;
+    output << YAML::EndMap;
+
+    std::ofstream fout(path);
+    fout << output.c_str();
+    R_CORE_INFO("Serialized scene to {} with {} cells successfully!", path.generic_u8string().c_str(), cells.size());
+    return true;
+}
+
+std::vector<EntityCommandBuffer> SceneSerializer::DeserializeCell(const fs::path& path, uint64_t cellKey, size_t entitiesPerBatch)
+{
+    YAML::Node data;
+    try
+    {
+        data = YAML::LoadFile(path.generic_u8string());
+    }
+    catch (YAML::Exception& e)
+    {
+        R_CORE_ERROR("Failed to load cell file '{0}'\n     {1}", path.generic_u8string().c_str(), e.what());
+        return {};
+    }
+
+    std::vector<EntityCommandBuffer> batches;
+    for (auto entityIt : data["Entities"])
+    {
+        if (batches.empty() || batches.back().GetCreatedCount() >= entitiesPerBatch)
+        {
+            batches.emplace_back();
+        }
+        auto& commands = batches.back();
+        const auto entity = DeserializeEntity(entityIt["Entity"], commands);
+        commands.AddComponent(entity, WorldCellComponent{ cellKey });
+    }
+    return batches;
+}
+
 bool SceneSerializer::Deserialize(const fs::path& path)
 {
     Timer timer;
@@ -255,86 +628,91 @@ bool SceneSerializer::Deserialize(const fs::path& path)
     std::string sceneName = data["Scene"].as<std::string>();
     R_CORE_TRACE("Deserializing scene '{0}'", sceneName);
 
-    auto& ts = Instance().Service<ThreadService>();
-    auto resourceLoadFuture = ts.AddBackgroundTask([&]()
+    EntityCommandBuffer commands;
+    for (auto entityIt : data["Entities"])
     {
-    	DeserializeAssets(data);
-    });
+        DeserializeEntity(entityIt["Entity"], commands);
+    }
+    commands.Playback(*scene);
+
+    // Streamed entities aren't created here, their cells are loaded around the camera by the world partition
+    auto partitionNode = data["World partition"];
+    if (partitionNode)
+    {
+        WorldPartitionSettings settings;
+        settings.cellSize = partitionNode["Cell size"].as<float>();
+        settings.loadRadius = partitionNode["Load radius"].as<float>();
+        settings.unloadHysteresis = partitionNode["Unload hysteresis"].as<float>();
+        auto partition = std::make_shared<WorldPartition>(settings);
+        for (auto cellIt : partitionNode["Cells"])
+        {
+            auto cell = cellIt["Cell"];
+            partition->AddCell(cell["Coordinates"].as<glm::ivec2>(), path.parent_path() / cell["Path"].as<std::string>());
+        }
+        scene->SetWorldPartition(partition);
+    }
 
-    auto entities = data["Entities"];
-    for (auto entityIt : entities)
-    {
-        auto entity = entityIt["Entity"];
-
-		    auto tagComponent = entity["Tag component"];
-		    auto name = tagComponent["Name"].as<std::string>();
-		    auto tag = tagComponent["GUID"].as<std::string>();
-
-		    auto entityPtr = scene->CreateEntityWithGuid(name, xg::Guid(tag), true);
-
-		    auto transformComponent = entity["Transform component"];
-		    R_CORE_ASSERT(transformComponent.IsDefined(), "");
-
-		    auto& tc = entityPtr->GetComponent<TransformComponent>();
-		    tc.position = transformComponent["Position"].as<glm::vec3>();
-		    tc.rotation = transformComponent["Rotation"].as<glm::vec3>();
-		    tc.scale = transformComponent["Scale"].as<glm::vec3>();
-
-		    // TODO: Implement validation of all handles
-		    auto& am = AssetManager::Get();
-		    auto meshComponent = entity["Mesh component"];
-		    if (meshComponent)
-		    {
-		        auto& mc = entityPtr->AddComponent<MeshComponent>();
-		        mc.material = { meshComponent["Material GUID"].as<xg::Guid>() };
-		        mc.mesh = { meshComponent["Mesh GUID"].as<xg::Guid>() };
-		        mc.isVisible = { meshComponent["Is visible"].as<bool>() };
-		    }
-
-		    auto lightComponent = entity["Light component"];
-		    if (lightComponent)
-		    {
-		        auto& lc = entityPtr->AddComponent<LightComponent>();
-		        lc.type = static_cast<LightType>(lightComponent["Type"].as<uint32_t>());
-		        lc.color = lightComponent["Color"].as<glm::vec3>();
-		        lc.intensity = lightComponent["Intensity"].as<float>();
-		        lc.outerRadius = lightComponent["Outer Radius"].as<float>();
-		        lc.innerRadius = lightComponent["Inner Radius"].as<float>();
-		    }
-
-		    auto skyboxComponent = entity["Skybox component"];
-		    if (skyboxComponent)
-		    {
-		        auto& sc = entityPtr->AddComponent<SkyboxComponent>();
-		        sc.type = static_cast<SkyboxType>(skyboxComponent["Type"].as<uint32_t>());
-		        sc.environmentHandle = { skyboxComponent["Skybox GUID"].as<xg::Guid>() };
-		    }
-
-		    auto cameraComponent = entity["Camera component"];
-		    if (cameraComponent)
-		    {
-		        auto& cc = entityPtr->AddComponent<CameraComponent>();
-		        cc.front = cameraComponent["Front"].as<glm::vec3>();
-		        cc.worldUp = cameraComponent["World up"].as<glm::vec3>();
-		        cc.up = cameraComponent["Up"].as<glm::vec3>();
-		        cc.zNear = cameraComponent["Z near"].as<float>();
-		        cc.zFar = cameraComponent["Z far"].as<float>();
-		        cc.aspectRatio = cameraComponent["Aspect ratio"].as<float>();
-		        cc.fov = cameraComponent["FOV"].as<float>();
-		        cc.movementSpeed = cameraComponent["Movement speed"].as<float>();
-		        cc.sensitivity = cameraComponent["Sensitivity"].as<float>();
-		        cc.isActive = cameraComponent["Active"].as<bool>();
-		        cc.isPrimary = cameraComponent["Primary"].as<bool>();
-		    }
-    }
-    resourceLoadFuture.wait();
-    R_CORE_INFO("Loaded scene {} successfully for {}s", path.generic_u8string().c_str(), timer.TimeInSeconds());
+    // Only assets visible from the primary camera are waited for, the rest is streamed in behind the first frame
+    auto assetLoadQueue = DeserializeAssets(data, GetAssetLoadPriorities());
+    scene->SetAssetLoadQueue(assetLoadQueue);
+    assetLoadQueue->WaitCritical();
+    R_CORE_INFO("Loaded scene {} successfully for {}s, {} assets are streamed in background",
+                path.generic_u8string().c_str(), timer.TimeInSeconds(), assetLoadQueue->GetPendingCount());
     return true;
 }
 
-void SceneSerializer::SerializeEntity(YAML::Emitter& output, const std::shared_ptr<Entity>& entity)
+std::unordered_map<xg::Guid, float> SceneSerializer::GetAssetLoadPriorities()
 {
-    R_CORE_ASSERT(entity->HasComponent<TagComponent>(), "");
+    auto& registry = scene->GetRegistry();
+    std::unordered_map<entt::entity, glm::mat4> worldMatrices;
+    std::optional<LoadCamera> loadCamera;
+    for (const auto entity : registry.view<CameraComponent>())
+    {
+        const auto& camera = registry.get<CameraComponent>(entity);
+        if (camera.isPrimary)
+        {
+            const auto parent = registry.get<RelationshipComponent>(entity).parent;
+            const glm::mat4 parentWorld = parent != entt::null ? GetWorldMatrix(registry, parent, worldMatrices) : glm::mat4(1.0f);
+            loadCamera.emplace(LoadCamera{ glm::vec3(GetWorldMatrix(registry, entity, worldMatrices)[3]),
+                                           glm::normalize(glm::mat3(parentWorld) * camera.front),
+                                           camera });
+            break;
+        }
+    }
+
+    std::unordered_map<xg::Guid, float> priorities;
+    const auto raisePriority = [&priorities](const xg::Guid& guid, float priority)
+    {
+        auto& current = priorities[guid];
+        current = std::max(current, priority);
+    };
+
+    for (const auto entity : registry.view<MeshComponent>())
+    {
+        const auto& mc = registry.get<MeshComponent>(entity);
+        if (!mc.isVisible)
+        {
+            continue;
+        }
+        const float priority = loadCamera
+                               ? GetLoadPriority(*loadCamera, GetWorldMatrix(registry, entity, worldMatrices))
+                               : C_CRITICAL_LOAD_PRIORITY;
+        raisePriority(mc.mesh.guid, priority);
+        raisePriority(mc.material.guid, priority);
+    }
+
+    // Skybox covers the whole screen
+    for (const auto entity : registry.view<SkyboxComponent>())
+    {
+        raisePriority(registry.get<SkyboxComponent>(entity).environmentHandle.guid, C_CRITICAL_LOAD_PRIORITY + 1.0f);
+    }
+
+    return priorities;
+}
+
+void SceneSerializer::SerializeEntity(YAML::Emitter& output, const Entity& entity)
+{
+    R_CORE_ASSERT(entity.HasComponent<TagComponent>(), "");
 
     output << YAML::BeginMap;
     output << YAML::Key << "Entity" << YAML::Value << YAML::BeginMap;
@@ -347,9 +725,9 @@ void SceneSerializer::SerializeEntity(YAML::Emitter& output, const std::shared_p
 
     SerializeComponent<TransformComponent>(output, entity, "Transform component", [&](const auto& component)
     {
-        SerializeKeyValue(output, "Position", component.position);
-        SerializeKeyValue(output, "Rotation", component.rotation);
-        SerializeKeyValue(output, "Scale", component.scale);
+        SerializeKeyValue(output, "Position", component.GetPosition());
+        SerializeKeyValue(output, "Rotation", component.GetRotation());
+        SerializeKeyValue(output, "Scale", component.GetScale());
     });
 
     SerializeComponent<MeshComponent>(output, entity, "Mesh component", [&](const auto& component)
@@ -357,10 +735,21 @@ void SceneSerializer::SerializeEntity(YAML::Emitter& output, const std::shared_p
         SerializeKeyValue(output, "Mesh GUID", component.mesh.guid);
         SerializeKeyValue(output, "Material GUID", component.material.guid);
         SerializeKeyValue(output, "Is visible", component.isVisible);
+        SerializeKeyValue(output, "Tint", component.tint);
+        SerializeKeyValue(output, "Is occluder", component.isOccluder);
+        SerializeKeyValue(output, "Is static", component.isStatic);
         sceneAssets.insert(component.mesh.guid);
         SaveMaterial(component.material);
     });
 
+    SerializeComponent<AnimatorComponent>(output, entity, "Animator component", [&](const auto& component)
+    {
+        SerializeKeyValue(output, "Clip", component.clip);
+        SerializeKeyValue(output, "Speed", component.speed);
+        SerializeKeyValue(output, "Loop", component.loop);
+        SerializeKeyValue(output, "Playing", component.isPlaying);
+    });
+
     SerializeComponent<LightComponent>(output, entity, "Light component", [&](const auto& component)
     {
         SerializeKeyValue(output, "Type", static_cast<int>(component.type));
@@ -394,11 +783,21 @@ void SceneSerializer::SerializeEntity(YAML::Emitter& output, const std::shared_p
 
     output << YAML::EndMap;
     output << YAML::EndMap;
+}
 
-    for (const auto& child : entity->GetChildren())
+void SceneSerializer::SerializeEntityTree(YAML::Emitter& output,
+                                          const Entity& entity,
+                                          const std::function<bool(const Entity&)>& filter)
+{
+    if (!filter || filter(entity))
     {
-        SerializeEntity(output, child);
+        SerializeEntity(output, entity);
     }
+
+    entity.ForEachChild([&](const Entity& child)
+    {
+        SerializeEntityTree(output, child, filter);
+    });
 }
 
 void SceneSerializer::SerializeAssets(YAML::Emitter& output)
@@ -416,80 +815,95 @@ void SceneSerializer::SaveMaterial(const AssetHandle& handle)
 
     sceneAssets.insert(assetPtr->textureData.albedo.guid);
     sceneAssets.insert(assetPtr->textureData.normal.guid);
-    sceneAssets.insert(assetPtr->textureData.roughness.guid);
-    sceneAssets.insert(assetPtr->textureData.metallic.guid);
-    sceneAssets.insert(assetPtr->textureData.ao.guid);
 
     sceneAssets.insert(handle.guid);
 }
 
-void SceneSerializer::LoadDependencies(const std::vector<std::shared_ptr<AssetDependency>>& assetDependencies)
+std::shared_ptr<AssetLoadQueue> SceneSerializer::LoadDependencies(const std::vector<std::shared_ptr<AssetDependency>>& assetDependencies,
+                                                                  const std::unordered_map<xg::Guid, float>& priorities)
 {
-    tf::Taskflow taskflow;
     auto& am = AssetManager::Get();
-    taskflow.for_each(
-        assetDependencies.begin(), assetDependencies.end(), [&am](const auto dep)
+    std::vector<AssetLoadRequest> requests;
+    requests.reserve(assetDependencies.size());
+    for (const auto& dep : assetDependencies)
+    {
+        auto& request = requests.emplace_back();
+        request.guid = dep->guid;
+        const auto priorityIt = priorities.find(dep->guid);
+        request.priority = priorityIt != priorities.end() ? priorityIt->second : 0.0f;
+
+        switch (dep->type)
         {
-            switch (dep->type)
-            {
-            case AssetType::MESH:
-            {
-                auto loader = am.GetLoader<MeshLoader>();
-                loader->LoadWithGUID(dep->path, dep->guid);
-                break;
-            }
-            case AssetType::ENVIRONMENT_MAP:
+        case AssetType::MESH:
+        {
+            request.load = [&am, dep]()
             {
-                auto loader = am.GetLoader<EnvironmentMapLoader>();
-                loader->LoadWithGUID(dep->path, dep->guid);
-                break;
-            }
-            case AssetType::SHADER:
-                break;
-            case AssetType::IMAGE:
+                am.GetLoader<MeshLoader>()->LoadWithGUID(dep->path, dep->guid);
+            };
+            break;
+        }
+        case AssetType::ENVIRONMENT_MAP:
+        {
+            request.load = [&am, dep]()
             {
-                auto loader = am.GetLoader<TextureLoader>();
-                loader->LoadWithGUID(dep->path, {}, dep->guid);
-                break;
-            }
-            case AssetType::MATERIAL:
+                auto environmentDep = std::static_pointer_cast<EnvironmentAssetDependency>(dep);
+                am.GetLoader<EnvironmentMapLoader>()->LoadWithGUID(dep->path, dep->guid, false, environmentDep->settings);
+            };
+            break;
+        }
+        case AssetType::SHADER:
+            request.load = []() {};
+            break;
+        case AssetType::IMAGE:
+        {
+            request.load = [&am, dep]()
             {
-                break;
-            }
-            default:
-                R_CORE_ASSERT(false, "")
-            }
+                am.GetLoader<TextureLoader>()->LoadWithGUID(dep->path, {}, dep->guid);
+            };
+            break;
         }
-    );
-
-    Instance().Service<ThreadService>().AddBackgroundTaskflow(std::move(taskflow)).wait();
-
-    // We must load materials only after other resources was load to be sure that all default ones will be properly set up
-    for (const auto dep : assetDependencies)
-    {
-        if (dep->type == AssetType::MATERIAL)
+        case AssetType::MATERIAL:
         {
-            auto loader = am.GetLoader<MaterialLoader>();
-            const auto ah = loader->LoadWithGUID(dep->guid);
-            auto material = am.GetAsset<Material>(ah);
-            R_CORE_ASSERT(material, "");
+            // Material waits for its textures, so renderer never sees it half loaded
             auto materialDep = std::static_pointer_cast<MaterialAssetDependency>(dep);
             R_CORE_ASSERT(materialDep, "");
-            material->textureData.albedo = { materialDep->albedoGuid };
-            material->textureData.normal = { materialDep->normalGuid };
-            material->textureData.roughness = { materialDep->roughnessGuid };
-            material->textureData.metallic = { materialDep->metallicGuid };
-            material->textureData.ao = { materialDep->aoGuid };
-            material->materialData.albedo = materialDep->albedo;
-            material->materialData.metallic = materialDep->metallic;
-            material->materialData.roughness = materialDep->roughness;
+            request.dependencies = { materialDep->albedoGuid, materialDep->normalGuid };
+            request.load = [&am, materialDep]()
+            {
+                // Material is filled before caching, because renderer may already draw the streamed part of the scene
+                auto material = am.GetAsset<Material>({ materialDep->guid });
+                const bool isCached = material != nullptr;
+                if (!isCached)
+                {
+                    material = std::make_shared<Material>();
+                }
+                material->textureData.albedo = { materialDep->albedoGuid };
+                material->textureData.normal = { materialDep->normalGuid };
+                material->textureData.ormSources = materialDep->ormSources;
+                material->textureData.orm = am.GetLoader<TextureLoader>()->LoadOrm(materialDep->ormSources);
+                material->materialData.albedo = materialDep->albedo;
+                material->materialData.metallic = materialDep->metallic;
+                material->materialData.roughness = materialDep->roughness;
+                if (!isCached)
+                {
+                    am.CacheAsset(material, materialDep->guid.str(), AssetType::MATERIAL, materialDep->guid);
+                }
+            };
+            break;
+        }
+        default:
+            R_CORE_ASSERT(false, "")
         }
     }
+
+    return AssetLoadQueue::Create(std::move(requests));
 }
 
-void SceneSerializer::DeserializeAssets(YAML::Node& node)
+std::shared_ptr<AssetLoadQueue> SceneSerializer::DeserializeAssets(YAML::Node& node,
+                                                                   const std::unordered_map<xg::Guid, float>& priorities)
 {
     auto assets = node["Assets"];
+    const auto assetPaths = GetAssetPaths(assets);
     std::vector<std::shared_ptr<AssetDependency>> dependencies;
 
     for (auto assetIt : assets)
@@ -502,6 +916,10 @@ void SceneSerializer::DeserializeAssets(YAML::Node& node)
         {
             dependency = std::make_shared<MaterialAssetDependency>();
         }
+        else if (type == AssetType::ENVIRONMENT_MAP)
+        {
+            dependency = std::make_shared<EnvironmentAssetDependency>();
+        }
         else
         {
             dependency = std::make_shared<AssetDependency>();
@@ -518,9 +936,7 @@ void SceneSerializer::DeserializeAssets(YAML::Node& node)
             auto textureData = asset["Texture Data"];
             materialDependency->albedoGuid = textureData["Albedo GUID"].as<xg::Guid>();
             materialDependency->normalGuid = textureData["Normal GUID"].as<xg::Guid>();
-            materialDependency->roughnessGuid = textureData["Roughness GUID"].as<xg::Guid>();
-            materialDependency->metallicGuid = textureData["Metallic GUID"].as<xg::Guid>();
-            materialDependency->aoGuid = textureData["AO GUID"].as<xg::Guid>();
+            materialDependency->ormSources = DeserializeOrmSources(textureData, assetPaths);
 
             auto materialData = asset["Material Data"];
             materialDependency->albedo = materialData["Albedo"].as<glm::vec4>();
@@ -528,8 +944,55 @@ void SceneSerializer::DeserializeAssets(YAML::Node& node)
             materialDependency->roughness = materialData["Roughness"].as<float>();
         }
 
+        // Scenes saved before environment settings were introduced use the defaults
+        auto environmentSettings = asset["Environment Settings"];
+        if (type == AssetType::ENVIRONMENT_MAP && environmentSettings)
+        {
+            auto environmentDependency = std::static_pointer_cast<EnvironmentAssetDependency>(dependency);
+            auto& settings = environmentDependency->settings;
+            settings.environmentSize = environmentSettings["Environment Size"].as<uint32_t>(settings.environmentSize);
+            settings.irradianceSize = environmentSettings["Irradiance Size"].as<uint32_t>(settings.irradianceSize);
+            settings.prefilterSize = environmentSettings["Prefilter Size"].as<uint32_t>(settings.prefilterSize);
+            settings.compress = environmentSettings["Compress"].as<bool>(settings.compress);
+        }
+
         dependencies.push_back(dependency);
     }
 
-    LoadDependencies(dependencies);
+    return LoadDependencies(dependencies, priorities);
+}
+
+std::vector<OrmSources> SceneSerializer::GetOrmSources(const fs::path& path)
+{
+    YAML::Node data;
+    try
+    {
+        data = YAML::LoadFile(path.generic_u8string());
+    }
+    catch (YAML::ParserException e)
+    {
+        R_CORE_ERROR("Failed to load scene file '{0}'\n     {1}", path.generic_u8string().c_str(), e.what());
+        return {};
+    }
+
+    auto assets = data["Assets"];
+    const auto assetPaths = GetAssetPaths(assets);
+    std::vector<OrmSources> ormSources;
+
+    for (auto assetIt : assets)
+    {
+        auto asset = assetIt["Asset"];
+        if (static_cast<AssetType>(asset["Type"].as<uint32_t>()) != AssetType::MATERIAL)
+        {
+            continue;
+        }
+
+        const auto sources = DeserializeOrmSources(asset["Texture Data"], assetPaths);
+        if (!sources.IsEmpty() && std::find(ormSources.begin(), ormSources.end(), sources) == ormSources.end())
+        {
+            ormSources.push_back(sources);
+        }
+    }
+
+    return ormSources;
 }
@@ -0,0 +1,141 @@
+#include "SystemScheduler.hpp"
+#include "Application.hpp"
+#include "ThreadService.hpp"
+#include "Timer.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+
+using namespace RightEngine;
+
+namespace
+{
+    bool Intersects(const std::vector<std::type_index>& a, const std::vector<std::type_index>& b)
+    {
+        return std::any_of(a.begin(), a.end(), [&b](const auto& type)
+        {
+            return std::find(b.begin(), b.end(), type) != b.end();
+        });
+    }
+
+    // Jobs of main thread systems, executed by the thread which waits for the graph
+    struct MainThreadQueue
+    {
+        std::mutex mutex;
+        std::condition_variable condition;
+        std::deque<std::function<void()>> jobs;
+        bool isFinished{ false };
+
+        void Push(std::function<void()>&& job)
+        {
+            {
+                std::lock_guard l(mutex);
+                jobs.emplace_back(std::move(job));
+            }
+            condition.notify_one();
+        }
+
+        void Finish()
+        {
+            {
+                std::lock_guard l(mutex);
+                isFinished = true;
+            }
+            condition.notify_one();
+        }
+
+        void Drain()
+        {
+            std::unique_lock l(mutex);
+            while (true)
+            {
+                condition.wait(l, [this]() { return isFinished || !jobs.empty(); });
+                if (jobs.empty())
+                {
+                    return;
+                }
+                auto job = std::move(jobs.front());
+                jobs.pop_front();
+                l.unlock();
+                job();
+                l.lock();
+            }
+        }
+    };
+}
+
+void SystemScheduler::Register(SystemDescriptor&& system)
+{
+    R_CORE_ASSERT(system.update, "");
+    m_systems.emplace_back(std::move(system));
+}
+
+bool SystemScheduler::IsConflicting(const SystemDescriptor& first, const SystemDescriptor& second)
+{
+    return Intersects(first.writes, second.writes)
+        || Intersects(first.writes, second.reads)
+        || Intersects(first.reads, second.writes);
+}
+
+void SystemScheduler::Run(Scene& scene, float deltaTime)
+{
+    m_timings.resize(m_systems.size());
+    if (m_systems.empty())
+    {
+        return;
+    }
+
+    MainThreadQueue mainThreadQueue;
+    tf::Taskflow taskflow;
+    std::vector<tf::Task> tasks;
+    tasks.reserve(m_systems.size());
+    for (size_t i = 0; i < m_systems.size(); i++)
+    {
+        auto& system = m_systems[i];
+        auto& timing = m_timings[i];
+        timing.name = system.name;
+
+        const auto update = [&system, &timing, &scene, deltaTime]()
+        {
+            Timer timer;
+            system.update(scene, deltaTime);
+            timer.Stop();
+            timing.time = static_cast<float>(timer.TimeInMilliseconds());
+        };
+
+        if (system.isMainThread)
+        {
+            tasks.emplace_back(taskflow.emplace([update, &mainThreadQueue]()
+            {
+                std::promise<void> promise;
+                auto future = promise.get_future();
+                mainThreadQueue.Push([&update, &promise]()
+                {
+                    update();
+                    promise.set_value();
+                });
+                future.wait();
+            }).name(system.name));
+        }
+        else
+        {
+            tasks.emplace_back(taskflow.emplace(update).name(system.name));
+        }
+
+        // Graph is rebuilt every frame, so it always matches the registered systems
+        for (size_t dependency = 0; dependency < i; dependency++)
+        {
+            if (IsConflicting(m_systems[dependency], system))
+            {
+                tasks[dependency].precede(tasks.back());
+            }
+        }
+    }
+
+    auto& ts = Instance().Service<ThreadService>();
+    auto future = ts.Run(taskflow, [&mainThreadQueue]() { mainThreadQueue.Finish(); });
+    mainThreadQueue.Drain();
+    future.wait();
+}
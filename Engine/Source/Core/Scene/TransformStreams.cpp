@@ -0,0 +1,153 @@
+#include "TransformStreams.hpp"
+#include "Simd.hpp"
+#include <array>
+
+using namespace RightEngine;
+
+namespace
+{
+    constexpr size_t C_LANES = 4;
+
+    /*
+     * Lanes hold 4 entities, so every matrix element is computed for all of them at once
+     * and the transposes turn element vectors back into matrix columns
+     */
+    template<typename LoadLanes>
+    void ComposeBatch(LoadLanes&& load, glm::mat4* result)
+    {
+        using namespace simd;
+
+        const Float4 x = load(0);
+        const Float4 y = load(1);
+        const Float4 z = load(2);
+        const Float4 w = load(3);
+        const Float4 two = Splat(2.0f);
+        const Float4 one = Splat(1.0f);
+
+        const Float4 xx = Mul(x, x);
+        const Float4 yy = Mul(y, y);
+        const Float4 zz = Mul(z, z);
+        const Float4 xy = Mul(x, y);
+        const Float4 xz = Mul(x, z);
+        const Float4 yz = Mul(y, z);
+        const Float4 wx = Mul(w, x);
+        const Float4 wy = Mul(w, y);
+        const Float4 wz = Mul(w, z);
+
+        const Float4 scaleX = load(4);
+        const Float4 scaleY = load(5);
+        const Float4 scaleZ = load(6);
+
+        Float4 column0[4] = { Mul(Sub(one, Mul(two, Add(yy, zz))), scaleX),
+                              Mul(Mul(two, Add(xy, wz)), scaleX),
+                              Mul(Mul(two, Sub(xz, wy)), scaleX),
+                              Splat(0.0f) };
+        Float4 column1[4] = { Mul(Mul(two, Sub(xy, wz)), scaleY),
+                              Mul(Sub(one, Mul(two, Add(xx, zz))), scaleY),
+                              Mul(Mul(two, Add(yz, wx)), scaleY),
+                              Splat(0.0f) };
+        Float4 column2[4] = { Mul(Mul(two, Add(xz, wy)), scaleZ),
+                              Mul(Mul(two, Sub(yz, wx)), scaleZ),
+                              Mul(Sub(one, Mul(two, Add(xx, yy))), scaleZ),
+                              Splat(0.0f) };
+        Float4 column3[4] = { load(7), load(8), load(9), one };
+
+        Float4* columns[4] = { column0, column1, column2, column3 };
+        for (size_t c = 0; c < 4; c++)
+        {
+            Float4* column = columns[c];
+            Transpose4(column[0], column[1], column[2], column[3]);
+            for (size_t lane = 0; lane < C_LANES; lane++)
+            {
+                Store(&result[lane][c][0], column[lane]);
+            }
+        }
+    }
+
+    // Order matches the stream indices of ComposeBatch
+    using StreamPointers = std::array<const float*, 10>;
+
+    StreamPointers GetStreams(const TransformStreams& streams)
+    {
+        return { streams.rotationX.data(), streams.rotationY.data(), streams.rotationZ.data(), streams.rotationW.data(),
+                 streams.scaleX.data(), streams.scaleY.data(), streams.scaleZ.data(),
+                 streams.positionX.data(), streams.positionY.data(), streams.positionZ.data() };
+    }
+
+    glm::mat4 ComposeScalar(const TransformStreams& streams, size_t index)
+    {
+        const glm::quat rotation(streams.rotationW[index], streams.rotationX[index], streams.rotationY[index], streams.rotationZ[index]);
+        glm::mat4 transform = glm::mat4_cast(rotation);
+        transform[0] *= streams.scaleX[index];
+        transform[1] *= streams.scaleY[index];
+        transform[2] *= streams.scaleZ[index];
+        transform[3] = glm::vec4(streams.positionX[index], streams.positionY[index], streams.positionZ[index], 1.0f);
+        return transform;
+    }
+}
+
+void TransformStreams::Resize(size_t size)
+{
+    positionX.resize(size);
+    positionY.resize(size);
+    positionZ.resize(size);
+    rotationX.resize(size);
+    rotationY.resize(size);
+    rotationZ.resize(size);
+    rotationW.resize(size, 1.0f);
+    scaleX.resize(size, 1.0f);
+    scaleY.resize(size, 1.0f);
+    scaleZ.resize(size, 1.0f);
+}
+
+void TransformStreams::Set(size_t index, const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale)
+{
+    positionX[index] = position.x;
+    positionY[index] = position.y;
+    positionZ[index] = position.z;
+    rotationX[index] = rotation.x;
+    rotationY[index] = rotation.y;
+    rotationZ[index] = rotation.z;
+    rotationW[index] = rotation.w;
+    scaleX[index] = scale.x;
+    scaleY[index] = scale.y;
+    scaleZ[index] = scale.z;
+}
+
+void RightEngine::ComposeTransforms(const TransformStreams& streams, const uint32_t* indices, size_t count, glm::mat4* result)
+{
+    const StreamPointers pointers = GetStreams(streams);
+    size_t i = 0;
+    for (; i + C_LANES <= count; i += C_LANES)
+    {
+        const uint32_t* lanes = indices + i;
+        ComposeBatch([&pointers, lanes](size_t stream)
+        {
+            const float* values = pointers[stream];
+            return simd::Set(values[lanes[0]], values[lanes[1]], values[lanes[2]], values[lanes[3]]);
+        }, result + i);
+    }
+
+    for (; i < count; i++)
+    {
+        result[i] = ComposeScalar(streams, indices[i]);
+    }
+}
+
+void RightEngine::ComposeTransforms(const TransformStreams& streams, size_t begin, size_t end, glm::mat4* result)
+{
+    const StreamPointers pointers = GetStreams(streams);
+    size_t i = begin;
+    for (; i + C_LANES <= end; i += C_LANES)
+    {
+        ComposeBatch([&pointers, i](size_t stream)
+        {
+            return simd::Load(pointers[stream] + i);
+        }, result + (i - begin));
+    }
+
+    for (; i < end; i++)
+    {
+        result[i - begin] = ComposeScalar(streams, i);
+    }
+}
@@ -0,0 +1,166 @@
+#include "TransformSystem.hpp"
+#include "Components.hpp"
+#include "Application.hpp"
+#include "ThreadService.hpp"
+#include "Simd.hpp"
+
+using namespace RightEngine;
+
+namespace
+{
+    // Transform takes ~100 ns, so a batch is big enough to hide the scheduling cost and small enough to balance levels
+    constexpr size_t C_MIN_ENTITIES_PER_BATCH = 1024;
+    // Dirty entities are gathered and composed together, so SIMD lanes are filled even when dirty ones are sparse
+    constexpr size_t C_COMPOSE_BATCH_SIZE = 64;
+}
+
+void TransformSystem::Connect(entt::registry& registry)
+{
+    // Replaced components come from outside of the scene, e.g. from command buffers, so they need the counter too
+    registry.on_construct<TransformComponent>().connect<&TransformSystem::OnTransformChange>(*this);
+    registry.on_update<TransformComponent>().connect<&TransformSystem::OnTransformChange>(*this);
+}
+
+void TransformSystem::OnTransformChange(entt::registry& registry, entt::entity entity)
+{
+    auto& transform = registry.get<TransformComponent>(entity);
+    transform.m_changeCount = &m_changeCount.value;
+    // Component may have been changed before it got the counter
+    if (transform.m_isDirty)
+    {
+        m_changeCount.value.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void TransformSystem::Update(entt::registry& registry, entt::entity root)
+{
+    const bool isRebuilt = m_isHierarchyDirty;
+    if (m_isHierarchyDirty)
+    {
+        Rebuild(registry, root);
+        m_isHierarchyDirty = false;
+    }
+
+    const uint32_t changeCount = m_changeCount.value.load(std::memory_order_relaxed);
+    if (!isRebuilt && changeCount == m_lastChangeCount)
+    {
+        return;
+    }
+    m_lastChangeCount = changeCount;
+
+    auto& ts = Instance().Service<ThreadService>();
+    const size_t maxThreads = m_maxThreadCount == 0 ? ts.GetWorkerCount() + 1 : m_maxThreadCount;
+    // Levels are processed one after another, so every parent is final before its children read it
+    for (size_t level = 0; level + 1 < m_levelOffsets.size(); level++)
+    {
+        const size_t levelBegin = m_levelOffsets[level];
+        const size_t levelSize = m_levelOffsets[level + 1] - levelBegin;
+        if (levelSize < C_MIN_ENTITIES_PER_BATCH * 2 || maxThreads <= 1)
+        {
+            UpdateRange(registry, levelBegin, levelBegin + levelSize, isRebuilt);
+            continue;
+        }
+
+        const size_t batchSize = std::max(C_MIN_ENTITIES_PER_BATCH, (levelSize + maxThreads - 1) / maxThreads);
+        ts.ParallelFor(levelSize, batchSize, [&](size_t begin, size_t end)
+        {
+            UpdateRange(registry, levelBegin + begin, levelBegin + end, isRebuilt);
+        });
+    }
+}
+
+void TransformSystem::UpdateRange(entt::registry& registry, size_t begin, size_t end, bool force)
+{
+    uint32_t indices[C_COMPOSE_BATCH_SIZE];
+    TransformComponent* transforms[C_COMPOSE_BATCH_SIZE];
+    glm::mat4 locals[C_COMPOSE_BATCH_SIZE];
+    size_t batchSize = 0;
+
+    const auto flush = [&]()
+    {
+        ComposeTransforms(m_localStreams, indices, batchSize, locals);
+        for (size_t k = 0; k < batchSize; k++)
+        {
+            const uint32_t i = indices[k];
+            const int32_t parent = m_parents[i];
+            if (parent >= 0)
+            {
+                simd::MulMat4(&m_worldMatrices[parent][0][0], &locals[k][0][0], &m_worldMatrices[i][0][0]);
+            }
+            else
+            {
+                m_worldMatrices[i] = locals[k];
+            }
+            transforms[k]->m_worldMatrix = m_worldMatrices[i];
+            transforms[k]->m_worldVersion++;
+        }
+        batchSize = 0;
+    };
+
+    for (size_t i = begin; i < end; i++)
+    {
+        auto& transform = registry.get<TransformComponent>(m_entities[i]);
+        if (force || transform.m_isDirty)
+        {
+            // Euler angles are converted only when they change
+            m_localStreams.Set(i, transform.m_position, glm::quat(transform.m_rotation), transform.m_scale);
+            transform.m_isDirty = false;
+            m_isWorldDirty[i] = true;
+        }
+        else
+        {
+            // Parent is always processed before, so its flag already covers the whole path to the root
+            const int32_t parent = m_parents[i];
+            m_isWorldDirty[i] = parent >= 0 && m_isWorldDirty[parent];
+        }
+
+        if (!m_isWorldDirty[i])
+        {
+            continue;
+        }
+
+        indices[batchSize] = static_cast<uint32_t>(i);
+        transforms[batchSize] = &transform;
+        if (++batchSize == C_COMPOSE_BATCH_SIZE)
+        {
+            flush();
+        }
+    }
+    flush();
+}
+
+void TransformSystem::Rebuild(entt::registry& registry, entt::entity root)
+{
+    m_entities.clear();
+    m_parents.clear();
+    m_levelOffsets.clear();
+
+    if (registry.valid(root))
+    {
+        m_entities.push_back(root);
+        m_parents.push_back(-1);
+        m_levelOffsets.push_back(0);
+    }
+
+    // Breadth first order keeps hierarchy levels contiguous
+    size_t levelEnd = m_entities.size();
+    for (size_t i = 0; i < m_entities.size(); i++)
+    {
+        const auto& relationship = registry.get<RelationshipComponent>(m_entities[i]);
+        for (auto child = relationship.firstChild; child != entt::null; child = registry.get<RelationshipComponent>(child).nextSibling)
+        {
+            m_entities.push_back(child);
+            m_parents.push_back(static_cast<int32_t>(i));
+        }
+
+        if (i + 1 == levelEnd)
+        {
+            m_levelOffsets.push_back(levelEnd);
+            levelEnd = m_entities.size();
+        }
+    }
+
+    m_localStreams.Resize(m_entities.size());
+    m_worldMatrices.resize(m_entities.size());
+    m_isWorldDirty.resize(m_entities.size());
+}
@@ -0,0 +1,273 @@
+#include "WorldPartition.hpp"
+#include "Scene.hpp"
+#include "Entity.hpp"
+#include "SceneSerializer.hpp"
+#include "Application.hpp"
+#include "ThreadService.hpp"
+#include "Timer.hpp"
+#include "Assert.hpp"
+#include <algorithm>
+#include <cmath>
+#include <unordered_set>
+
+using namespace RightEngine;
+
+namespace
+{
+    // Destroyed entities between budget checks
+    constexpr size_t C_DESTROYS_PER_CHECK = 32;
+}
+
+WorldPartition::WorldPartition(const WorldPartitionSettings& settings) : m_settings(settings),
+                                                                        m_loadResults(std::make_shared<LoadResults>())
+{
+    R_CORE_ASSERT(m_settings.cellSize > 0.0f && m_settings.entitiesPerBatch > 0, "");
+}
+
+WorldPartition::~WorldPartition()
+{
+    Cancel();
+}
+
+void WorldPartition::AddCell(const glm::ivec2& cell, const std::filesystem::path& path)
+{
+    auto& entry = m_cells[GetCellKey(cell)];
+    entry.coord = cell;
+    entry.path = path;
+}
+
+void WorldPartition::Update(Scene& scene, const glm::vec3& cameraPosition)
+{
+    Timer timer;
+    CollectLoadResults();
+
+    const float unloadRadius = m_settings.loadRadius + m_settings.unloadHysteresis;
+    std::vector<std::pair<float, Cell*>> playbackCells;
+    for (auto& [key, cell] : m_cells)
+    {
+        const float distance = GetDistance(cell, cameraPosition);
+        if (cell.state == CellState::UNLOADED)
+        {
+            if (distance <= m_settings.loadRadius)
+            {
+                RequestLoad(key, cell);
+            }
+            continue;
+        }
+        if (distance > unloadRadius)
+        {
+            Evict(scene, key, cell);
+            continue;
+        }
+        if (cell.state == CellState::LOADING && cell.isParsed)
+        {
+            playbackCells.emplace_back(distance, &cell);
+        }
+    }
+
+    // Evicted entities go first, so memory doesn't grow while the camera moves fast
+    const auto isOverBudget = [&]()
+    {
+        return timer.TimeInMilliseconds() >= m_settings.frameBudgetMs;
+    };
+    auto& registry = scene.GetRegistry();
+    while (!m_pendingDestroys.empty() && !isOverBudget())
+    {
+        for (size_t i = 0; i < C_DESTROYS_PER_CHECK && !m_pendingDestroys.empty(); i++)
+        {
+            const auto entity = m_pendingDestroys.back();
+            m_pendingDestroys.pop_back();
+            if (registry.valid(entity))
+            {
+                scene.DestroyEntity({ entity, &scene });
+            }
+        }
+    }
+
+    std::sort(playbackCells.begin(), playbackCells.end(), [](const auto& a, const auto& b)
+    {
+        return a.first < b.first;
+    });
+    bool isFirstBatch = true;
+    for (auto& [distance, cell] : playbackCells)
+    {
+        while (cell->nextBatch < cell->batches.size() && (isFirstBatch || !isOverBudget()))
+        {
+            cell->batches[cell->nextBatch++].Playback(scene);
+            isFirstBatch = false;
+        }
+        if (cell->nextBatch < cell->batches.size())
+        {
+            break;
+        }
+        cell->state = CellState::LOADED;
+        cell->batches.clear();
+        cell->nextBatch = 0;
+    }
+}
+
+void WorldPartition::Cancel()
+{
+    {
+        std::lock_guard lock(m_loadResults->mutex);
+        m_loadResults->isCancelled = true;
+        m_loadResults->results.clear();
+    }
+    // Loads started later must not see the cancelled state
+    m_loadResults = std::make_shared<LoadResults>();
+    for (auto& [key, cell] : m_cells)
+    {
+        if (cell.state == CellState::LOADING)
+        {
+            cell.state = CellState::UNLOADED;
+            cell.generation++;
+            cell.isParsed = false;
+            cell.batches.clear();
+            cell.nextBatch = 0;
+        }
+    }
+}
+
+std::shared_ptr<WorldPartition> WorldPartition::Clone(const entt::registry& registry) const
+{
+    auto clone = std::make_shared<WorldPartition>(m_settings);
+    clone->m_pendingDestroys = m_pendingDestroys;
+    std::unordered_set<uint64_t> partialCells;
+    for (const auto& [key, cell] : m_cells)
+    {
+        auto& clonedCell = clone->m_cells[key];
+        clonedCell.coord = cell.coord;
+        clonedCell.path = cell.path;
+        clonedCell.generation = cell.generation;
+        if (cell.state == CellState::LOADED)
+        {
+            clonedCell.state = CellState::LOADED;
+        }
+        else if (cell.state == CellState::LOADING && cell.nextBatch > 0)
+        {
+            partialCells.insert(key);
+        }
+    }
+
+    if (!partialCells.empty())
+    {
+        for (const auto entity : registry.view<WorldCellComponent>())
+        {
+            if (partialCells.count(registry.get<WorldCellComponent>(entity).cell) > 0)
+            {
+                clone->m_pendingDestroys.push_back(entity);
+            }
+        }
+    }
+    return clone;
+}
+
+size_t WorldPartition::GetLoadedCellCount() const
+{
+    return std::count_if(m_cells.begin(), m_cells.end(), [](const auto& cell)
+    {
+        return cell.second.state == CellState::LOADED;
+    });
+}
+
+size_t WorldPartition::GetLoadingCellCount() const
+{
+    return std::count_if(m_cells.begin(), m_cells.end(), [](const auto& cell)
+    {
+        return cell.second.state == CellState::LOADING;
+    });
+}
+
+glm::ivec2 WorldPartition::GetCell(const glm::vec3& position, float cellSize)
+{
+    return { static_cast<int32_t>(std::floor(position.x / cellSize)), static_cast<int32_t>(std::floor(position.z / cellSize)) };
+}
+
+uint64_t WorldPartition::GetCellKey(const glm::ivec2& cell)
+{
+    return (static_cast<uint64_t>(static_cast<uint32_t>(cell.x)) << 32) | static_cast<uint32_t>(cell.y);
+}
+
+void WorldPartition::CollectLoadResults()
+{
+    std::vector<LoadResult> results;
+    {
+        std::lock_guard lock(m_loadResults->mutex);
+        results = std::move(m_loadResults->results);
+        m_loadResults->results.clear();
+    }
+
+    for (auto& result : results)
+    {
+        const auto cellIt = m_cells.find(result.key);
+        if (cellIt == m_cells.end())
+        {
+            continue;
+        }
+        auto& cell = cellIt->second;
+        if (cell.state == CellState::LOADING && cell.generation == result.generation)
+        {
+            cell.batches = std::move(result.batches);
+            cell.nextBatch = 0;
+            cell.isParsed = true;
+        }
+    }
+}
+
+void WorldPartition::RequestLoad(uint64_t key, Cell& cell)
+{
+    cell.state = CellState::LOADING;
+    cell.isParsed = false;
+    Instance().Service<ThreadService>().AddBackgroundTask([results = m_loadResults,
+                                                           key,
+                                                           generation = cell.generation,
+                                                           path = cell.path,
+                                                           entitiesPerBatch = m_settings.entitiesPerBatch]()
+    {
+        {
+            std::lock_guard lock(results->mutex);
+            if (results->isCancelled)
+            {
+                return;
+            }
+        }
+
+        // Entities and their asset handles are created here, the main thread only runs the recorded commands
+        LoadResult result{ key, generation, SceneSerializer::DeserializeCell(path, key, entitiesPerBatch) };
+        std::lock_guard lock(results->mutex);
+        if (!results->isCancelled)
+        {
+            results->results.emplace_back(std::move(result));
+        }
+    });
+}
+
+void WorldPartition::Evict(Scene& scene, uint64_t key, Cell& cell)
+{
+    // Partially played back cells have some entities already
+    if (cell.state == CellState::LOADED || cell.nextBatch > 0)
+    {
+        auto& registry = scene.GetRegistry();
+        for (const auto entity : registry.view<WorldCellComponent>())
+        {
+            if (registry.get<WorldCellComponent>(entity).cell == key)
+            {
+                m_pendingDestroys.push_back(entity);
+            }
+        }
+    }
+
+    cell.state = CellState::UNLOADED;
+    cell.generation++;
+    cell.isParsed = false;
+    cell.batches.clear();
+    cell.nextBatch = 0;
+}
+
+float WorldPartition::GetDistance(const Cell& cell, const glm::vec3& position) const
+{
+    const glm::vec2 min = glm::vec2(cell.coord) * m_settings.cellSize;
+    const glm::vec2 point(position.x, position.z);
+    const glm::vec2 closest = glm::clamp(point, min, min + glm::vec2(m_settings.cellSize));
+    return glm::length(point - closest);
+}
@@ -2,6 +2,12 @@
 
 #include "IService.hpp"
 #include <taskflow/taskflow.hpp>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
 
 namespace RightEngine
 {
@@ -13,6 +19,20 @@ namespace RightEngine
 
 		tf::Future<void> AddBackgroundTaskflow(tf::Taskflow&& taskflow);
 
+		/*
+		 * Calls f(begin, end) for batches of [0, count) on the workers and the calling thread,
+		 * returns when all batches are done. Meant for per frame work, which must not keep taskflows alive
+		 */
+		template <typename F>
+		void ParallelFor(size_t count, size_t minBatchSize, F&& f);
+
+		// Runs the taskflow owned by the caller, it must stay alive until callback is called
+		template <typename C>
+		tf::Future<void> Run(tf::Taskflow& taskflow, C&& callback);
+
+		size_t GetWorkerCount() const
+		{ return m_executor.num_workers(); }
+
 		virtual void OnRegister() override;
 		virtual void OnUpdate(float dt) override;
 
@@ -28,4 +48,58 @@ namespace RightEngine
 	{
 		return m_executor.async(f);
 	}
+
+	template <typename F>
+	void ThreadService::ParallelFor(size_t count, size_t minBatchSize, F&& f)
+	{
+		const size_t maxBatches = (count + std::max<size_t>(minBatchSize, 1) - 1) / std::max<size_t>(minBatchSize, 1);
+		const size_t batches = std::min(maxBatches, GetWorkerCount() + 1);
+		if (batches <= 1)
+		{
+			if (count > 0)
+			{
+				f(size_t{ 0 }, count);
+			}
+			return;
+		}
+
+		struct State
+		{
+			std::atomic<size_t> next{ 0 };
+			std::atomic<size_t> done{ 0 };
+		};
+
+		// Batches are claimed by whoever comes first, so the caller never waits for a batch which hasn't started.
+		// That keeps nested calls from workers deadlock free, helpers starting after the end only touch the state
+		const auto state = std::make_shared<State>();
+		const size_t batchSize = (count + batches - 1) / batches;
+		const auto run = [state, &f, batches, batchSize, count]()
+		{
+			for (size_t batch = state->next.fetch_add(1); batch < batches; batch = state->next.fetch_add(1))
+			{
+				const size_t begin = batch * batchSize;
+				if (begin < count)
+				{
+					f(begin, std::min(begin + batchSize, count));
+				}
+				state->done.fetch_add(1, std::memory_order_release);
+			}
+		};
+
+		for (size_t helper = 1; helper < batches; helper++)
+		{
+			m_executor.silent_async(run);
+		}
+		run();
+		while (state->done.load(std::memory_order_acquire) < batches)
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	template <typename C>
+	tf::Future<void> ThreadService::Run(tf::Taskflow& taskflow, C&& callback)
+	{
+		return m_executor.run(taskflow, std::forward<C>(callback));
+	}
 }
@@ -1,4 +1,5 @@
 #include "ImGuiLayer.hpp"
+#include "Assert.hpp"
 
 using namespace RightEngine;
 
@@ -32,9 +33,34 @@ void ImGuiLayer::Begin()
     impl->Begin();
 }
 
-void ImGuiLayer::End(const std::shared_ptr<CommandBuffer>& cmd)
+std::shared_ptr<ImGuiDrawData> ImGuiLayer::End()
 {
-    impl->End(cmd);
+    ImGui::Render();
+    const ImDrawData* source = ImGui::GetDrawData();
+    auto drawData = std::make_shared<ImGuiDrawData>();
+    drawData->drawData = *source;
+    drawData->drawLists.reserve(source->CmdListsCount);
+    for (int i = 0; i < source->CmdListsCount; i++)
+    {
+        drawData->drawLists.push_back(source->CmdLists[i]->CloneOutput());
+    }
+    // ImGui reuses its own lists in the next frame
+    drawData->drawData.CmdLists = drawData->drawLists.data();
+    return drawData;
+}
+
+void ImGuiLayer::Draw(const std::shared_ptr<ImGuiDrawData>& drawData, const std::shared_ptr<CommandBuffer>& cmd)
+{
+    R_CORE_ASSERT(drawData, "");
+    impl->Draw(drawData, cmd);
+}
+
+ImGuiDrawData::~ImGuiDrawData()
+{
+    for (auto drawList : drawLists)
+    {
+        IM_DELETE(drawList);
+    }
 }
 
 void ImGuiLayer::Image(const std::shared_ptr<Texture>& texture, const ImVec2& size, const ImVec2& uv0, const ImVec2& uv1)
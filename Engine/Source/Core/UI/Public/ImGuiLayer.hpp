@@ -3,9 +3,23 @@
 #include "Layer.hpp"
 #include "ImguiLayerImpl.hpp"
 #include <imgui.h>
+#include <vector>
 
 namespace RightEngine
 {
+    // Copy of the ImGui draw lists of one frame, so UI can be recorded on the render thread while the next frame is built
+    struct ImGuiDrawData
+    {
+        ImDrawData drawData;
+        std::vector<ImDrawList*> drawLists;
+
+        ImGuiDrawData() = default;
+        ~ImGuiDrawData();
+
+        ImGuiDrawData(const ImGuiDrawData& other) = delete;
+        ImGuiDrawData& operator=(const ImGuiDrawData& other) = delete;
+    };
+
     class ImGuiLayer : public Layer
     {
     public:
@@ -20,7 +34,10 @@ namespace RightEngine
         virtual void OnEvent(Event& event) override;
 
         void Begin();
-        void End(const std::shared_ptr<CommandBuffer>& cmd);
+        // Finishes the frame on the thread which built it
+        std::shared_ptr<ImGuiDrawData> End();
+        // Can be called from the render thread
+        void Draw(const std::shared_ptr<ImGuiDrawData>& drawData, const std::shared_ptr<CommandBuffer>& cmd);
 
         static void Image(const std::shared_ptr<Texture>& texture,
                           const ImVec2& size,
@@ -7,6 +7,8 @@
 
 namespace RightEngine
 {
+    struct ImGuiDrawData;
+
     class ImguiLayerImpl
     {
     public:
@@ -21,7 +23,7 @@ namespace RightEngine
         virtual void OnEvent(Event& event) = 0;
 
         virtual void Begin() = 0;
-        virtual void End(const std::shared_ptr<CommandBuffer>& cmd) = 0;
+        virtual void Draw(const std::shared_ptr<ImGuiDrawData>& drawData, const std::shared_ptr<CommandBuffer>& cmd) = 0;
 
         virtual void Image(const std::shared_ptr<Texture>& texture, const ImVec2& size, const ImVec2& uv0, const ImVec2& uv1) = 0;
         virtual void ImageButton(const std::shared_ptr<Texture>& texture, const ImVec2& size, const ImVec2& uv0, const ImVec2& uv1) = 0;
@@ -0,0 +1,55 @@
+#include "Bounds.hpp"
+
+using namespace RightEngine;
+
+AABB AABB::Transform(const glm::mat4& transform) const
+{
+    if (!IsValid())
+    {
+        return {};
+    }
+
+    // Arvo's method, every column contributes its min and max to the result independently
+    const glm::vec3 translation(transform[3]);
+    AABB result(translation, translation);
+    for (int column = 0; column < 3; column++)
+    {
+        const glm::vec3 axis(transform[column]);
+        const glm::vec3 a = axis * min[column];
+        const glm::vec3 b = axis * max[column];
+        result.min += glm::min(a, b);
+        result.max += glm::max(a, b);
+    }
+    return result;
+}
+
+Sphere Sphere::Transform(const glm::mat4& transform) const
+{
+    const float scale = std::max(glm::length(glm::vec3(transform[0])),
+                                 std::max(glm::length(glm::vec3(transform[1])), glm::length(glm::vec3(transform[2]))));
+    return { glm::vec3(transform * glm::vec4(center, 1.0f)), radius * scale };
+}
+
+Frustum Frustum::FromMatrix(const glm::mat4& viewProjection)
+{
+    // Gribb-Hartmann, rows of the column major matrix
+    const glm::vec4 row0(viewProjection[0][0], viewProjection[1][0], viewProjection[2][0], viewProjection[3][0]);
+    const glm::vec4 row1(viewProjection[0][1], viewProjection[1][1], viewProjection[2][1], viewProjection[3][1]);
+    const glm::vec4 row2(viewProjection[0][2], viewProjection[1][2], viewProjection[2][2], viewProjection[3][2]);
+    const glm::vec4 row3(viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3]);
+
+    Frustum frustum;
+    frustum.planes[0] = row3 + row0;
+    frustum.planes[1] = row3 - row0;
+    frustum.planes[2] = row3 + row1;
+    frustum.planes[3] = row3 - row1;
+    // [-1, 1] depth like glm::perspective, for [0, 1] depth the near plane is just slightly conservative
+    frustum.planes[4] = row3 + row2;
+    frustum.planes[5] = row3 - row2;
+
+    for (auto& plane : frustum.planes)
+    {
+        plane /= glm::length(glm::vec3(plane));
+    }
+    return frustum;
+}
@@ -0,0 +1,111 @@
+#include "CullingStream.hpp"
+#include "Simd.hpp"
+#include "Assert.hpp"
+
+using namespace RightEngine;
+
+namespace
+{
+    constexpr size_t C_GROUP_SIZE = 4;
+}
+
+void CullingStream::Clear()
+{
+    m_centerX.clear();
+    m_centerY.clear();
+    m_centerZ.clear();
+    m_extentX.clear();
+    m_extentY.clear();
+    m_extentZ.clear();
+    m_count = 0;
+}
+
+void CullingStream::Push(const AABB& box)
+{
+    if (m_count % C_GROUP_SIZE == 0)
+    {
+        // Padding lanes get masked out in GatherVisible
+        const size_t size = m_count + C_GROUP_SIZE;
+        m_centerX.resize(size, 0.0f);
+        m_centerY.resize(size, 0.0f);
+        m_centerZ.resize(size, 0.0f);
+        m_extentX.resize(size, 0.0f);
+        m_extentY.resize(size, 0.0f);
+        m_extentZ.resize(size, 0.0f);
+    }
+
+    // Infinite extent passes every plane
+    const glm::vec3 center = box.IsValid() ? box.GetCenter() : glm::vec3(0.0f);
+    const glm::vec3 extent = box.IsValid() ? box.GetExtent() : glm::vec3(std::numeric_limits<float>::infinity());
+    m_centerX[m_count] = center.x;
+    m_centerY[m_count] = center.y;
+    m_centerZ[m_count] = center.z;
+    m_extentX[m_count] = extent.x;
+    m_extentY[m_count] = extent.y;
+    m_extentZ[m_count] = extent.z;
+    m_count++;
+}
+
+void CullingStream::Cull(const Frustum& frustum, size_t beginGroup, size_t endGroup, uint8_t* masks) const
+{
+    using namespace simd;
+
+    R_CORE_ASSERT(endGroup <= GetGroupCount(), "");
+
+    Float4 normalX[6];
+    Float4 normalY[6];
+    Float4 normalZ[6];
+    Float4 absNormalX[6];
+    Float4 absNormalY[6];
+    Float4 absNormalZ[6];
+    Float4 offset[6];
+    for (int plane = 0; plane < 6; plane++)
+    {
+        const glm::vec4& p = frustum.planes[plane];
+        normalX[plane] = Splat(p.x);
+        normalY[plane] = Splat(p.y);
+        normalZ[plane] = Splat(p.z);
+        absNormalX[plane] = Abs(normalX[plane]);
+        absNormalY[plane] = Abs(normalY[plane]);
+        absNormalZ[plane] = Abs(normalZ[plane]);
+        offset[plane] = Splat(p.w);
+    }
+
+    for (size_t group = beginGroup; group < endGroup; group++)
+    {
+        const size_t first = group * C_GROUP_SIZE;
+        const Float4 cx = Load(&m_centerX[first]);
+        const Float4 cy = Load(&m_centerY[first]);
+        const Float4 cz = Load(&m_centerZ[first]);
+        const Float4 ex = Load(&m_extentX[first]);
+        const Float4 ey = Load(&m_extentY[first]);
+        const Float4 ez = Load(&m_extentZ[first]);
+
+        // Same test as Frustum::Test, a box is outside when distance + radius < 0 for any plane
+        Float4 outside = Splat(0.0f);
+        for (int plane = 0; plane < 6; plane++)
+        {
+            const Float4 distance = MulAdd(normalX[plane], cx, MulAdd(normalY[plane], cy, MulAdd(normalZ[plane], cz, offset[plane])));
+            const Float4 radius = MulAdd(absNormalX[plane], ex, MulAdd(absNormalY[plane], ey, Mul(absNormalZ[plane], ez)));
+            outside = Or(outside, Less(Add(distance, radius), Splat(0.0f)));
+        }
+        masks[group] = static_cast<uint8_t>(~MoveMask(outside) & 0xF);
+    }
+}
+
+void CullingStream::GatherVisible(const std::vector<uint8_t>& masks, std::vector<uint32_t>& indices) const
+{
+    R_CORE_ASSERT(masks.size() >= GetGroupCount(), "");
+    for (size_t group = 0; group < GetGroupCount(); group++)
+    {
+        const uint8_t mask = masks[group];
+        for (size_t lane = 0; lane < C_GROUP_SIZE; lane++)
+        {
+            const size_t index = group * C_GROUP_SIZE + lane;
+            if ((mask & (1u << lane)) && index < m_count)
+            {
+                indices.push_back(static_cast<uint32_t>(index));
+            }
+        }
+    }
+}
@@ -0,0 +1,353 @@
+#include "OcclusionBuffer.hpp"
+#include "Simd.hpp"
+#include "Assert.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <unordered_map>
+#include <unordered_set>
+
+using namespace RightEngine;
+
+namespace
+{
+    constexpr uint32_t C_MAX_CLUSTER_RESOLUTION = 64;
+    // Vertices closer to the camera plane than this are treated as behind it
+    constexpr float C_MIN_W = 1e-4f;
+    constexpr float C_FAR_DEPTH = std::numeric_limits<float>::max();
+    constexpr uint64_t C_FULL_MASK = ~0ull;
+
+    uint64_t GetClusterKey(const glm::uvec3& cell)
+    {
+        return static_cast<uint64_t>(cell.x) | static_cast<uint64_t>(cell.y) << 21 | static_cast<uint64_t>(cell.z) << 42;
+    }
+
+    uint64_t GetTriangleKey(uint32_t a, uint32_t b, uint32_t c)
+    {
+        // Both windings of a triangle are the same occluder
+        if (a > b) std::swap(a, b);
+        if (b > c) std::swap(b, c);
+        if (a > b) std::swap(a, b);
+        return static_cast<uint64_t>(a) | static_cast<uint64_t>(b) << 21 | static_cast<uint64_t>(c) << 42;
+    }
+
+    // Bits of columns [begin, end] in every row of a tile
+    uint64_t GetColumnsMask(uint32_t begin, uint32_t end)
+    {
+        const uint64_t row = ((1ull << (end + 1)) - 1) & ~((1ull << begin) - 1);
+        return row * 0x0101010101010101ull;
+    }
+
+    // Bits of rows [begin, end] of a tile
+    uint64_t GetRowsMask(uint32_t begin, uint32_t end)
+    {
+        const uint64_t last = end == OcclusionBuffer::C_TILE_SIZE - 1 ? C_FULL_MASK : (1ull << ((end + 1) * 8)) - 1;
+        return last & ~((1ull << (begin * 8)) - 1);
+    }
+}
+
+OccluderMesh OccluderMesh::Build(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices, size_t maxTriangles)
+{
+    if (indices.size() / 3 <= maxTriangles)
+    {
+        return { positions, indices };
+    }
+
+    AABB bounds;
+    for (const auto& position : positions)
+    {
+        bounds.Extend(position);
+    }
+    const glm::vec3 size = glm::max(bounds.max - bounds.min, glm::vec3(std::numeric_limits<float>::min()));
+
+    std::vector<uint32_t> clusters(positions.size());
+    std::unordered_map<uint64_t, uint32_t> clusterIds;
+    std::unordered_set<uint64_t> triangleKeys;
+    for (uint32_t resolution = C_MAX_CLUSTER_RESOLUTION; resolution > 0; resolution /= 2)
+    {
+        const glm::vec3 scale = static_cast<float>(resolution) / size;
+        clusterIds.clear();
+        for (size_t vertex = 0; vertex < positions.size(); vertex++)
+        {
+            const glm::uvec3 cell = glm::min(glm::uvec3((positions[vertex] - bounds.min) * scale), glm::uvec3(resolution - 1));
+            const auto [it, isAdded] = clusterIds.emplace(GetClusterKey(cell), static_cast<uint32_t>(clusterIds.size()));
+            clusters[vertex] = it->second;
+        }
+
+        OccluderMesh occluder;
+        triangleKeys.clear();
+        for (size_t i = 0; i + 2 < indices.size(); i += 3)
+        {
+            const uint32_t a = clusters[indices[i]];
+            const uint32_t b = clusters[indices[i + 1]];
+            const uint32_t c = clusters[indices[i + 2]];
+            if (a == b || b == c || a == c || !triangleKeys.insert(GetTriangleKey(a, b, c)).second)
+            {
+                continue;
+            }
+            occluder.indices.insert(occluder.indices.end(), { a, b, c });
+        }
+        if (occluder.indices.size() / 3 > maxTriangles)
+        {
+            continue;
+        }
+
+        occluder.positions.assign(clusterIds.size(), glm::vec3(0.0f));
+        std::vector<uint32_t> counts(clusterIds.size(), 0);
+        for (size_t vertex = 0; vertex < positions.size(); vertex++)
+        {
+            occluder.positions[clusters[vertex]] += positions[vertex];
+            counts[clusters[vertex]]++;
+        }
+        for (size_t cluster = 0; cluster < counts.size(); cluster++)
+        {
+            occluder.positions[cluster] /= static_cast<float>(counts[cluster]);
+        }
+        return occluder;
+    }
+    return {};
+}
+
+void OcclusionBuffer::Begin(uint32_t width, uint32_t height, const glm::mat4& viewProjection)
+{
+    R_CORE_ASSERT(width > 0 && height > 0, "");
+    m_width = width;
+    m_height = height;
+    m_tilesX = (width + C_TILE_SIZE - 1) / C_TILE_SIZE;
+    m_tilesY = (height + C_TILE_SIZE - 1) / C_TILE_SIZE;
+    m_viewProjection = viewProjection;
+    m_tiles.assign(m_tilesX * m_tilesY, { 0, C_FAR_DEPTH, 0.0f });
+    m_triangles.clear();
+    m_rowBins.resize(m_tilesY);
+    for (auto& bin : m_rowBins)
+    {
+        bin.clear();
+    }
+}
+
+void OcclusionBuffer::AddOccluder(const OccluderMesh& mesh, const glm::mat4& transform)
+{
+    const glm::mat4 modelViewProjection = m_viewProjection * transform;
+    const glm::vec2 screenScale(static_cast<float>(m_width) * 0.5f, static_cast<float>(m_height) * 0.5f);
+
+    for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3)
+    {
+        glm::vec2 screen[3];
+        float depth[3];
+        bool isBehind = false;
+        for (int vertex = 0; vertex < 3; vertex++)
+        {
+            const glm::vec4 clip = modelViewProjection * glm::vec4(mesh.positions[mesh.indices[i + vertex]], 1.0f);
+            if (clip.w < C_MIN_W)
+            {
+                isBehind = true;
+                break;
+            }
+            const float invW = 1.0f / clip.w;
+            screen[vertex] = (glm::vec2(clip.x, clip.y) * invW + 1.0f) * screenScale;
+            depth[vertex] = clip.z * invW;
+        }
+        if (isBehind)
+        {
+            continue;
+        }
+
+        const glm::vec2 edge1 = screen[1] - screen[0];
+        const glm::vec2 edge2 = screen[2] - screen[0];
+        const float area = edge1.x * edge2.y - edge1.y * edge2.x;
+        if (std::abs(area) < std::numeric_limits<float>::epsilon())
+        {
+            continue;
+        }
+
+        Triangle triangle;
+        const glm::vec2 minScreen = glm::min(screen[0], glm::min(screen[1], screen[2]));
+        const glm::vec2 maxScreen = glm::max(screen[0], glm::max(screen[1], screen[2]));
+        triangle.minX = std::max(static_cast<int32_t>(std::floor(minScreen.x)), 0);
+        triangle.minY = std::max(static_cast<int32_t>(std::floor(minScreen.y)), 0);
+        triangle.maxX = std::min(static_cast<int32_t>(std::floor(maxScreen.x)), static_cast<int32_t>(m_width) - 1);
+        triangle.maxY = std::min(static_cast<int32_t>(std::floor(maxScreen.y)), static_cast<int32_t>(m_height) - 1);
+        if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY)
+        {
+            continue;
+        }
+
+        // Both windings are rasterized, occluders are thin shells as often as closed meshes
+        const float sign = area > 0.0f ? 1.0f : -1.0f;
+        for (int edge = 0; edge < 3; edge++)
+        {
+            const glm::vec2& from = screen[edge];
+            const glm::vec2& to = screen[(edge + 1) % 3];
+            triangle.edgeA[edge] = sign * (from.y - to.y);
+            triangle.edgeB[edge] = sign * (to.x - from.x);
+            triangle.edgeC[edge] = -(triangle.edgeA[edge] * from.x + triangle.edgeB[edge] * from.y);
+        }
+        const float depth1 = depth[1] - depth[0];
+        const float depth2 = depth[2] - depth[0];
+        triangle.depthA = (depth1 * edge2.y - depth2 * edge1.y) / area;
+        triangle.depthB = (depth2 * edge1.x - depth1 * edge2.x) / area;
+        triangle.depthC = depth[0] - triangle.depthA * screen[0].x - triangle.depthB * screen[0].y;
+        triangle.maxDepth = std::max(depth[0], std::max(depth[1], depth[2]));
+
+        const auto index = static_cast<uint32_t>(m_triangles.size());
+        m_triangles.push_back(triangle);
+        for (int32_t row = triangle.minY / C_TILE_SIZE; row <= triangle.maxY / static_cast<int32_t>(C_TILE_SIZE); row++)
+        {
+            m_rowBins[row].push_back(index);
+        }
+    }
+}
+
+void OcclusionBuffer::RasterizeRows(size_t beginRow, size_t endRow)
+{
+    R_CORE_ASSERT(endRow <= m_tilesY, "");
+    for (size_t row = beginRow; row < endRow; row++)
+    {
+        for (const uint32_t index : m_rowBins[row])
+        {
+            const auto& triangle = m_triangles[index];
+            for (int32_t tileX = triangle.minX / C_TILE_SIZE; tileX <= triangle.maxX / static_cast<int32_t>(C_TILE_SIZE); tileX++)
+            {
+                RasterizeTile(triangle, tileX, static_cast<uint32_t>(row));
+            }
+        }
+    }
+}
+
+void OcclusionBuffer::RasterizeTile(const Triangle& triangle, uint32_t tileX, uint32_t tileY)
+{
+    using namespace simd;
+
+    auto& tile = m_tiles[tileY * m_tilesX + tileX];
+    const float x0 = static_cast<float>(tileX * C_TILE_SIZE);
+    const float y0 = static_cast<float>(tileY * C_TILE_SIZE);
+    const float x1 = x0 + static_cast<float>(C_TILE_SIZE);
+    const float y1 = y0 + static_cast<float>(C_TILE_SIZE);
+
+    // Depth plane is affine, so its maximum over the tile is at a corner
+    const auto depthAt = [&triangle](float x, float y)
+    {
+        return triangle.depthA * x + triangle.depthB * y + triangle.depthC;
+    };
+    const float cornerDepth = std::max(std::max(depthAt(x0, y0), depthAt(x1, y0)), std::max(depthAt(x0, y1), depthAt(x1, y1)));
+    const float depth = std::min(cornerDepth, triangle.maxDepth);
+    if (depth >= tile.depth0)
+    {
+        return;
+    }
+
+    // Pixel centers of the left and right half of a row
+    const Float4 left = Set(x0 + 0.5f, x0 + 1.5f, x0 + 2.5f, x0 + 3.5f);
+    const Float4 right = Add(left, Splat(4.0f));
+    Float4 edgeA[3];
+    for (int edge = 0; edge < 3; edge++)
+    {
+        edgeA[edge] = Splat(triangle.edgeA[edge]);
+    }
+    const Float4 zero = Splat(0.0f);
+
+    uint64_t coverage = 0;
+    for (uint32_t row = 0; row < C_TILE_SIZE; row++)
+    {
+        const float y = y0 + static_cast<float>(row) + 0.5f;
+        Float4 leftOutside = zero;
+        Float4 rightOutside = zero;
+        for (int edge = 0; edge < 3; edge++)
+        {
+            const Float4 rowOffset = Splat(triangle.edgeB[edge] * y + triangle.edgeC[edge]);
+            leftOutside = Or(leftOutside, Less(MulAdd(edgeA[edge], left, rowOffset), zero));
+            rightOutside = Or(rightOutside, Less(MulAdd(edgeA[edge], right, rowOffset), zero));
+        }
+        const uint64_t inside = ~(MoveMask(leftOutside) | MoveMask(rightOutside) << 4) & 0xFF;
+        coverage |= inside << (row * C_TILE_SIZE);
+    }
+    if (coverage == 0)
+    {
+        return;
+    }
+
+    // Working layer is dropped when merging would push it further back than the triangle improves on the tile
+    if (tile.mask != 0 && depth - tile.depth1 > tile.depth0 - depth)
+    {
+        tile.mask = 0;
+    }
+    tile.depth1 = tile.mask == 0 ? depth : std::max(tile.depth1, depth);
+    tile.mask |= coverage;
+
+    const uint64_t validMask = GetValidMask(tileX, tileY);
+    if ((tile.mask & validMask) == validMask)
+    {
+        tile.depth0 = std::min(tile.depth0, tile.depth1);
+        tile.mask = 0;
+    }
+}
+
+uint64_t OcclusionBuffer::GetValidMask(uint32_t tileX, uint32_t tileY) const
+{
+    const uint32_t columns = std::min(m_width - tileX * C_TILE_SIZE, C_TILE_SIZE);
+    const uint32_t rows = std::min(m_height - tileY * C_TILE_SIZE, C_TILE_SIZE);
+    return GetColumnsMask(0, columns - 1) & GetRowsMask(0, rows - 1);
+}
+
+bool OcclusionBuffer::IsVisible(const AABB& box) const
+{
+    if (!box.IsValid() || m_tiles.empty())
+    {
+        return true;
+    }
+
+    glm::vec2 minScreen(std::numeric_limits<float>::max());
+    glm::vec2 maxScreen(std::numeric_limits<float>::lowest());
+    float minDepth = std::numeric_limits<float>::max();
+    const glm::vec2 screenScale(static_cast<float>(m_width) * 0.5f, static_cast<float>(m_height) * 0.5f);
+    for (int corner = 0; corner < 8; corner++)
+    {
+        const glm::vec3 position((corner & 1) ? box.max.x : box.min.x,
+                                 (corner & 2) ? box.max.y : box.min.y,
+                                 (corner & 4) ? box.max.z : box.min.z);
+        const glm::vec4 clip = m_viewProjection * glm::vec4(position, 1.0f);
+        // Boxes reaching behind the camera cover an unbounded part of the screen
+        if (clip.w < C_MIN_W)
+        {
+            return true;
+        }
+        const float invW = 1.0f / clip.w;
+        const glm::vec2 screen = (glm::vec2(clip.x, clip.y) * invW + 1.0f) * screenScale;
+        minScreen = glm::min(minScreen, screen);
+        maxScreen = glm::max(maxScreen, screen);
+        minDepth = std::min(minDepth, clip.z * invW);
+    }
+
+    // Every pixel the box touches is tested, not only the ones whose centers it covers
+    const int32_t minX = std::max(static_cast<int32_t>(std::floor(minScreen.x)), 0);
+    const int32_t minY = std::max(static_cast<int32_t>(std::floor(minScreen.y)), 0);
+    const int32_t maxX = std::min(static_cast<int32_t>(std::floor(maxScreen.x)), static_cast<int32_t>(m_width) - 1);
+    const int32_t maxY = std::min(static_cast<int32_t>(std::floor(maxScreen.y)), static_cast<int32_t>(m_height) - 1);
+    if (minX > maxX || minY > maxY)
+    {
+        // Off screen boxes are left to frustum culling
+        return true;
+    }
+
+    for (int32_t tileY = minY / C_TILE_SIZE; tileY <= maxY / static_cast<int32_t>(C_TILE_SIZE); tileY++)
+    {
+        const int32_t firstY = tileY * C_TILE_SIZE;
+        const uint64_t rows = GetRowsMask(std::max(minY - firstY, 0), std::min(maxY - firstY, static_cast<int32_t>(C_TILE_SIZE) - 1));
+        for (int32_t tileX = minX / C_TILE_SIZE; tileX <= maxX / static_cast<int32_t>(C_TILE_SIZE); tileX++)
+        {
+            const int32_t firstX = tileX * C_TILE_SIZE;
+            const uint64_t rect = rows & GetColumnsMask(std::max(minX - firstX, 0),
+                                                        std::min(maxX - firstX, static_cast<int32_t>(C_TILE_SIZE) - 1));
+            const auto& tile = m_tiles[tileY * m_tilesX + tileX];
+            if ((rect & ~tile.mask) && tile.depth0 > minDepth)
+            {
+                return true;
+            }
+            if ((rect & tile.mask) && std::min(tile.depth0, tile.depth1) > minDepth)
+            {
+                return true;
+            }
+        }
+    }
+    return false;
+}
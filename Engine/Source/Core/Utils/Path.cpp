@@ -26,18 +26,19 @@ std::string Path::Absolute(const std::string& enginePath)
     {
         int kek;
     }
+    // Longest alias wins, otherwise "/" may shadow "/Engine" depending on map order
+    size_t matchedAliasSize = 0;
     for (const auto& [alias, path] : aliasMap)
     {
-	    if (enginePath.rfind(alias, 0) == 0)
+	    if (enginePath.rfind(alias, 0) == 0 && (fullPath.empty() || alias.size() > matchedAliasSize))
 	    {
-            fullPath.append(enginePath.substr(alias.size()));
-            R_CORE_ASSERT(!fullPath.empty(), "");
-            if (fullPath.at(0) != '/')
+            matchedAliasSize = alias.size();
+            fullPath = enginePath.substr(alias.size());
+            if (fullPath.empty() || fullPath.at(0) != '/')
             {
                 fullPath = '/' + fullPath;
             }
             fullPath = path + fullPath;
-            break;
 	    }
     }
     R_CORE_ASSERT(!fullPath.empty(), "");
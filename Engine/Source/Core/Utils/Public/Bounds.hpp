@@ -0,0 +1,142 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <limits>
+
+namespace RightEngine
+{
+    // Default constructed box is empty, so it can be used as a starting value for Extend
+    struct AABB
+    {
+        glm::vec3 min{ std::numeric_limits<float>::max() };
+        glm::vec3 max{ std::numeric_limits<float>::lowest() };
+
+        AABB() = default;
+        AABB(const glm::vec3& aMin, const glm::vec3& aMax) : min(aMin), max(aMax)
+        {}
+
+        bool IsValid() const
+        { return min.x <= max.x && min.y <= max.y && min.z <= max.z; }
+
+        glm::vec3 GetCenter() const
+        { return (min + max) * 0.5f; }
+
+        glm::vec3 GetExtent() const
+        { return (max - min) * 0.5f; }
+
+        // Half of the surface area, SAH only compares ratios
+        float GetHalfArea() const
+        {
+            const glm::vec3 d = max - min;
+            return d.x * d.y + d.y * d.z + d.z * d.x;
+        }
+
+        void Extend(const glm::vec3& point)
+        {
+            min = glm::min(min, point);
+            max = glm::max(max, point);
+        }
+
+        void Extend(const AABB& other)
+        {
+            min = glm::min(min, other.min);
+            max = glm::max(max, other.max);
+        }
+
+        bool Contains(const AABB& other) const
+        {
+            return glm::all(glm::lessThanEqual(min, other.min)) && glm::all(glm::greaterThanEqual(max, other.max));
+        }
+
+        bool Overlaps(const AABB& other) const
+        {
+            return glm::all(glm::lessThanEqual(min, other.max)) && glm::all(glm::greaterThanEqual(max, other.min));
+        }
+
+        // Bounds of the transformed box, tight for affine transforms
+        AABB Transform(const glm::mat4& transform) const;
+
+        static AABB Union(const AABB& a, const AABB& b)
+        { return { glm::min(a.min, b.min), glm::max(a.max, b.max) }; }
+    };
+
+    struct Sphere
+    {
+        glm::vec3 center{ 0.0f };
+        float radius{ 0.0f };
+
+        // Conservative under non-uniform scale, radius is scaled by the longest axis
+        Sphere Transform(const glm::mat4& transform) const;
+
+        bool Overlaps(const AABB& box) const
+        {
+            const glm::vec3 closest = glm::clamp(center, box.min, box.max);
+            const glm::vec3 d = closest - center;
+            return glm::dot(d, d) <= radius * radius;
+        }
+    };
+
+    struct Ray
+    {
+        glm::vec3 origin{ 0.0f };
+        // Distances are measured in direction lengths, so normalized directions give world units
+        glm::vec3 direction{ 0.0f, 0.0f, -1.0f };
+
+        /*
+         * Slab test, returns distance to the box entry point or to the origin if it is inside.
+         * Negative result means the box is missed or is further than maxDistance
+         */
+        float Intersect(const AABB& box, const glm::vec3& invDirection, float maxDistance) const
+        {
+            const glm::vec3 t0 = (box.min - origin) * invDirection;
+            const glm::vec3 t1 = (box.max - origin) * invDirection;
+            const glm::vec3 tMin = glm::min(t0, t1);
+            const glm::vec3 tMax = glm::max(t0, t1);
+            const float tNear = std::max(std::max(tMin.x, tMin.y), std::max(tMin.z, 0.0f));
+            const float tFar = std::min(std::min(tMax.x, tMax.y), std::min(tMax.z, maxDistance));
+            return tNear <= tFar ? tNear : -1.0f;
+        }
+
+        glm::vec3 GetInvDirection() const
+        { return 1.0f / direction; }
+    };
+
+    enum class FrustumTest
+    {
+        OUTSIDE,
+        INTERSECTS,
+        INSIDE
+    };
+
+    // Planes point inside, a point p is inside the plane when dot(plane.xyz, p) + plane.w >= 0
+    struct Frustum
+    {
+        glm::vec4 planes[6];
+
+        // Extracts planes from projection * view matrix, flipped Y of Vulkan projections only swaps top and bottom planes
+        static Frustum FromMatrix(const glm::mat4& viewProjection);
+
+        FrustumTest Test(const AABB& box) const
+        {
+            const glm::vec3 center = box.GetCenter();
+            const glm::vec3 extent = box.GetExtent();
+            FrustumTest result = FrustumTest::INSIDE;
+            for (const auto& plane : planes)
+            {
+                const glm::vec3 normal(plane);
+                const float distance = glm::dot(normal, center) + plane.w;
+                const float radius = glm::dot(extent, glm::abs(normal));
+                if (distance < -radius)
+                {
+                    return FrustumTest::OUTSIDE;
+                }
+                if (distance < radius)
+                {
+                    result = FrustumTest::INTERSECTS;
+                }
+            }
+            return result;
+        }
+    };
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "Bounds.hpp"
+#include <vector>
+#include <cstdint>
+
+namespace RightEngine
+{
+    /*
+     * Boxes stored as SoA centers and extents in groups of 4, so every frustum plane is tested against a whole
+     * group with one SIMD pass. Groups are independent and can be culled in parallel batches
+     */
+    class CullingStream
+    {
+    public:
+        void Clear();
+
+        // Invalid boxes are never culled
+        void Push(const AABB& box);
+
+        size_t GetCount() const
+        { return m_count; }
+
+        size_t GetGroupCount() const
+        { return m_centerX.size() / 4; }
+
+        // Writes a 4 bit visibility mask of every group in [beginGroup, endGroup) to masks
+        void Cull(const Frustum& frustum, size_t beginGroup, size_t endGroup, uint8_t* masks) const;
+
+        // Appends indices of visible boxes in ascending order
+        void GatherVisible(const std::vector<uint8_t>& masks, std::vector<uint32_t>& indices) const;
+
+    private:
+        std::vector<float> m_centerX;
+        std::vector<float> m_centerY;
+        std::vector<float> m_centerZ;
+        std::vector<float> m_extentX;
+        std::vector<float> m_extentY;
+        std::vector<float> m_extentZ;
+        size_t m_count{ 0 };
+    };
+}
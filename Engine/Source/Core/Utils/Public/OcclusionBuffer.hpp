@@ -0,0 +1,99 @@
+#pragma once
+
+#include "Bounds.hpp"
+#include <vector>
+#include <cstdint>
+
+namespace RightEngine
+{
+    // Mesh space triangle list used to occlude other meshes, much coarser than the rendered mesh
+    struct OccluderMesh
+    {
+        std::vector<glm::vec3> positions;
+        std::vector<uint32_t> indices;
+
+        bool IsEmpty() const
+        { return indices.empty(); }
+
+        /*
+         * Vertex clustering on a grid over the mesh bounds, the grid gets coarser until the result fits maxTriangles.
+         * Clustered vertices move to the average of their cluster, so the occluder may cover slightly more than the mesh
+         */
+        static OccluderMesh Build(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices, size_t maxTriangles);
+    };
+
+    /*
+     * Low resolution masked depth buffer filled with occluder triangles on CPU. Every 8x8 pixel tile keeps a coverage mask
+     * of a working layer and two conservative depths, the furthest depth of the whole tile and of the covered pixels,
+     * so triangles are merged without storing per pixel depth. Coverage is computed 4 pixels at a time with SIMD.
+     * Triangles are binned by tile rows, rows are independent and can be rasterized in parallel batches.
+     * Depth is NDC z, which is affine in screen space for perspective and orthographic projections
+     */
+    class OcclusionBuffer
+    {
+    public:
+        static constexpr uint32_t C_TILE_SIZE = 8;
+
+        // Clears the buffer and drops occluders of the previous view, dimensions are rounded up to whole tiles
+        void Begin(uint32_t width, uint32_t height, const glm::mat4& viewProjection);
+
+        // Triangles with a vertex behind the camera are skipped, occluders very close to it occlude less
+        void AddOccluder(const OccluderMesh& mesh, const glm::mat4& transform);
+
+        size_t GetTileRowCount() const
+        { return m_tilesY; }
+
+        size_t GetTriangleCount() const
+        { return m_triangles.size(); }
+
+        // Rasterizes binned triangles into tile rows [beginRow, endRow), concurrent calls must not share rows
+        void RasterizeRows(size_t beginRow, size_t endRow);
+
+        // False only when every pixel the box may cover is hidden behind rasterized occluders, safe to call concurrently
+        bool IsVisible(const AABB& box) const;
+
+    private:
+        // Screen space, edge functions and depth are planes a * x + b * y + c, edges are positive inside
+        struct Triangle
+        {
+            float edgeA[3];
+            float edgeB[3];
+            float edgeC[3];
+            float depthA;
+            float depthB;
+            float depthC;
+            // Furthest vertex depth
+            float maxDepth;
+            // Pixels the triangle may cover, clamped to the buffer
+            int32_t minX;
+            int32_t minY;
+            int32_t maxX;
+            int32_t maxY;
+        };
+
+        /*
+         * Pixels of the mask have occluders not further than min(depth0, depth1), all other pixels not further than depth0.
+         * Working layer is merged into depth0 once it covers the whole tile
+         */
+        struct Tile
+        {
+            uint64_t mask;
+            float depth0;
+            float depth1;
+        };
+
+        void RasterizeTile(const Triangle& triangle, uint32_t tileX, uint32_t tileY);
+        // Bits of pixels inside the buffer, tiles on the right and bottom border are partially outside
+        uint64_t GetValidMask(uint32_t tileX, uint32_t tileY) const;
+
+        glm::mat4 m_viewProjection{ 1.0f };
+        uint32_t m_width{ 0 };
+        uint32_t m_height{ 0 };
+        uint32_t m_tilesX{ 0 };
+        uint32_t m_tilesY{ 0 };
+        std::vector<Tile> m_tiles;
+        std::vector<Triangle> m_triangles;
+        // Triangle indices per tile row in submission order
+        std::vector<std::vector<uint32_t>> m_rowBins;
+    };
+}
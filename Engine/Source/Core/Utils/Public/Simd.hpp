@@ -0,0 +1,244 @@
+#pragma once
+
+#include <cstdint>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define R_SIMD_SSE2
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define R_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+namespace RightEngine::simd
+{
+    /*
+     * Minimal 4-wide float vector for hot CPU loops. Maps to SSE2 on x86-64 and NEON on ARM64,
+     * other targets use the scalar fallback which compilers usually vectorize themselves
+     */
+#ifdef R_SIMD_SSE2
+    using Float4 = __m128;
+
+    inline Float4 Load(const float* ptr) { return _mm_loadu_ps(ptr); }
+    inline void Store(float* ptr, Float4 v) { _mm_storeu_ps(ptr, v); }
+    inline Float4 Splat(float value) { return _mm_set1_ps(value); }
+    inline Float4 Set(float x, float y, float z, float w) { return _mm_set_ps(w, z, y, x); }
+    inline Float4 Add(Float4 a, Float4 b) { return _mm_add_ps(a, b); }
+    inline Float4 Sub(Float4 a, Float4 b) { return _mm_sub_ps(a, b); }
+    inline Float4 Mul(Float4 a, Float4 b) { return _mm_mul_ps(a, b); }
+    inline Float4 Min(Float4 a, Float4 b) { return _mm_min_ps(a, b); }
+    inline Float4 Max(Float4 a, Float4 b) { return _mm_max_ps(a, b); }
+    inline Float4 Sqrt(Float4 a) { return _mm_sqrt_ps(a); }
+    inline Float4 Div(Float4 a, Float4 b) { return _mm_div_ps(a, b); }
+    inline float GetX(Float4 a) { return _mm_cvtss_f32(a); }
+
+    // Returns the dot product in all lanes
+    inline Float4 Dot4(Float4 a, Float4 b)
+    {
+        const Float4 m = _mm_mul_ps(a, b);
+        const Float4 s = _mm_add_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 3, 0, 1)));
+        return _mm_add_ps(s, _mm_shuffle_ps(s, s, _MM_SHUFFLE(1, 0, 3, 2)));
+    }
+
+    inline Float4 SplatX(Float4 a) { return _mm_shuffle_ps(a, a, _MM_SHUFFLE(0, 0, 0, 0)); }
+    inline Float4 SplatY(Float4 a) { return _mm_shuffle_ps(a, a, _MM_SHUFFLE(1, 1, 1, 1)); }
+    inline Float4 SplatZ(Float4 a) { return _mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 2, 2, 2)); }
+    inline Float4 SplatW(Float4 a) { return _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 3, 3, 3)); }
+
+    // Four signed 16 bit integers converted to floats without normalization
+    inline Float4 LoadInt16x4(const int16_t* ptr)
+    {
+        const __m128i packed = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(ptr));
+        return _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(packed, packed), 16));
+    }
+
+    // Four unsigned 16 bit integers converted to floats without normalization
+    inline Float4 LoadUint16x4(const uint16_t* ptr)
+    {
+        const __m128i packed = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(ptr));
+        return _mm_cvtepi32_ps(_mm_unpacklo_epi16(packed, _mm_setzero_si128()));
+    }
+
+    inline void Transpose4(Float4& a, Float4& b, Float4& c, Float4& d) { _MM_TRANSPOSE4_PS(a, b, c, d); }
+
+    inline Float4 Abs(Float4 a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+    // Comparisons return all bits set in lanes where they hold
+    inline Float4 Less(Float4 a, Float4 b) { return _mm_cmplt_ps(a, b); }
+    inline Float4 Or(Float4 a, Float4 b) { return _mm_or_ps(a, b); }
+    // Bit i is set when the sign bit of lane i is set
+    inline int MoveMask(Float4 a) { return _mm_movemask_ps(a); }
+#elif defined(R_SIMD_NEON)
+    using Float4 = float32x4_t;
+
+    inline Float4 Load(const float* ptr) { return vld1q_f32(ptr); }
+    inline void Store(float* ptr, Float4 v) { vst1q_f32(ptr, v); }
+    inline Float4 Splat(float value) { return vdupq_n_f32(value); }
+    inline Float4 Set(float x, float y, float z, float w)
+    {
+        const float values[4] = { x, y, z, w };
+        return vld1q_f32(values);
+    }
+    inline Float4 Add(Float4 a, Float4 b) { return vaddq_f32(a, b); }
+    inline Float4 Sub(Float4 a, Float4 b) { return vsubq_f32(a, b); }
+    inline Float4 Mul(Float4 a, Float4 b) { return vmulq_f32(a, b); }
+    inline Float4 Min(Float4 a, Float4 b) { return vminq_f32(a, b); }
+    inline Float4 Max(Float4 a, Float4 b) { return vmaxq_f32(a, b); }
+    inline Float4 Sqrt(Float4 a) { return vsqrtq_f32(a); }
+    inline Float4 Div(Float4 a, Float4 b) { return vdivq_f32(a, b); }
+    inline float GetX(Float4 a) { return vgetq_lane_f32(a, 0); }
+
+    inline Float4 Dot4(Float4 a, Float4 b) { return vdupq_n_f32(vaddvq_f32(vmulq_f32(a, b))); }
+
+    inline Float4 SplatX(Float4 a) { return vdupq_laneq_f32(a, 0); }
+    inline Float4 SplatY(Float4 a) { return vdupq_laneq_f32(a, 1); }
+    inline Float4 SplatZ(Float4 a) { return vdupq_laneq_f32(a, 2); }
+    inline Float4 SplatW(Float4 a) { return vdupq_laneq_f32(a, 3); }
+
+    inline Float4 LoadInt16x4(const int16_t* ptr) { return vcvtq_f32_s32(vmovl_s16(vld1_s16(ptr))); }
+    inline Float4 LoadUint16x4(const uint16_t* ptr) { return vcvtq_f32_u32(vmovl_u16(vld1_u16(ptr))); }
+
+    inline void Transpose4(Float4& a, Float4& b, Float4& c, Float4& d)
+    {
+        const float32x4x2_t ab = vtrnq_f32(a, b);
+        const float32x4x2_t cd = vtrnq_f32(c, d);
+        a = vcombine_f32(vget_low_f32(ab.val[0]), vget_low_f32(cd.val[0]));
+        b = vcombine_f32(vget_low_f32(ab.val[1]), vget_low_f32(cd.val[1]));
+        c = vcombine_f32(vget_high_f32(ab.val[0]), vget_high_f32(cd.val[0]));
+        d = vcombine_f32(vget_high_f32(ab.val[1]), vget_high_f32(cd.val[1]));
+    }
+
+    inline Float4 Abs(Float4 a) { return vabsq_f32(a); }
+    inline Float4 Less(Float4 a, Float4 b) { return vreinterpretq_f32_u32(vcltq_f32(a, b)); }
+    inline Float4 Or(Float4 a, Float4 b)
+    {
+        return vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b)));
+    }
+    inline int MoveMask(Float4 a)
+    {
+        const int32_t shifts[4] = { 0, 1, 2, 3 };
+        const uint32x4_t signs = vshrq_n_u32(vreinterpretq_u32_f32(a), 31);
+        return static_cast<int>(vaddvq_u32(vshlq_u32(signs, vld1q_s32(shifts))));
+    }
+#else
+    struct Float4
+    {
+        float v[4];
+    };
+
+    inline Float4 Load(const float* ptr) { return { ptr[0], ptr[1], ptr[2], ptr[3] }; }
+    inline void Store(float* ptr, Float4 a) { for (int i = 0; i < 4; i++) ptr[i] = a.v[i]; }
+    inline Float4 Splat(float value) { return { value, value, value, value }; }
+    inline Float4 Set(float x, float y, float z, float w) { return { x, y, z, w }; }
+    inline Float4 Add(Float4 a, Float4 b) { return { a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3] }; }
+    inline Float4 Sub(Float4 a, Float4 b) { return { a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3] }; }
+    inline Float4 Mul(Float4 a, Float4 b) { return { a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3] }; }
+    inline Float4 Min(Float4 a, Float4 b) { return { std::fmin(a.v[0], b.v[0]), std::fmin(a.v[1], b.v[1]), std::fmin(a.v[2], b.v[2]), std::fmin(a.v[3], b.v[3]) }; }
+    inline Float4 Max(Float4 a, Float4 b) { return { std::fmax(a.v[0], b.v[0]), std::fmax(a.v[1], b.v[1]), std::fmax(a.v[2], b.v[2]), std::fmax(a.v[3], b.v[3]) }; }
+    inline Float4 Sqrt(Float4 a) { return { std::sqrt(a.v[0]), std::sqrt(a.v[1]), std::sqrt(a.v[2]), std::sqrt(a.v[3]) }; }
+    inline Float4 Div(Float4 a, Float4 b) { return { a.v[0] / b.v[0], a.v[1] / b.v[1], a.v[2] / b.v[2], a.v[3] / b.v[3] }; }
+    inline float GetX(Float4 a) { return a.v[0]; }
+
+    inline Float4 Dot4(Float4 a, Float4 b)
+    {
+        return Splat(a.v[0] * b.v[0] + a.v[1] * b.v[1] + a.v[2] * b.v[2] + a.v[3] * b.v[3]);
+    }
+
+    inline Float4 SplatX(Float4 a) { return Splat(a.v[0]); }
+    inline Float4 SplatY(Float4 a) { return Splat(a.v[1]); }
+    inline Float4 SplatZ(Float4 a) { return Splat(a.v[2]); }
+    inline Float4 SplatW(Float4 a) { return Splat(a.v[3]); }
+
+    inline Float4 LoadInt16x4(const int16_t* ptr)
+    {
+        return { static_cast<float>(ptr[0]), static_cast<float>(ptr[1]), static_cast<float>(ptr[2]), static_cast<float>(ptr[3]) };
+    }
+
+    inline Float4 LoadUint16x4(const uint16_t* ptr)
+    {
+        return { static_cast<float>(ptr[0]), static_cast<float>(ptr[1]), static_cast<float>(ptr[2]), static_cast<float>(ptr[3]) };
+    }
+
+    inline void Transpose4(Float4& a, Float4& b, Float4& c, Float4& d)
+    {
+        const Float4 r0 = { a.v[0], b.v[0], c.v[0], d.v[0] };
+        const Float4 r1 = { a.v[1], b.v[1], c.v[1], d.v[1] };
+        const Float4 r2 = { a.v[2], b.v[2], c.v[2], d.v[2] };
+        const Float4 r3 = { a.v[3], b.v[3], c.v[3], d.v[3] };
+        a = r0;
+        b = r1;
+        c = r2;
+        d = r3;
+    }
+
+    inline Float4 Abs(Float4 a) { return { std::fabs(a.v[0]), std::fabs(a.v[1]), std::fabs(a.v[2]), std::fabs(a.v[3]) }; }
+
+    inline float MaskLane(bool value)
+    {
+        const uint32_t bits = value ? 0xFFFFFFFFu : 0u;
+        float lane;
+        std::memcpy(&lane, &bits, sizeof(lane));
+        return lane;
+    }
+
+    inline Float4 Less(Float4 a, Float4 b)
+    {
+        return { MaskLane(a.v[0] < b.v[0]), MaskLane(a.v[1] < b.v[1]), MaskLane(a.v[2] < b.v[2]), MaskLane(a.v[3] < b.v[3]) };
+    }
+
+    inline Float4 Or(Float4 a, Float4 b)
+    {
+        Float4 result;
+        for (int i = 0; i < 4; i++)
+        {
+            uint32_t x;
+            uint32_t y;
+            std::memcpy(&x, &a.v[i], sizeof(x));
+            std::memcpy(&y, &b.v[i], sizeof(y));
+            x |= y;
+            std::memcpy(&result.v[i], &x, sizeof(x));
+        }
+        return result;
+    }
+
+    inline int MoveMask(Float4 a)
+    {
+        int mask = 0;
+        for (int i = 0; i < 4; i++)
+        {
+            uint32_t bits;
+            std::memcpy(&bits, &a.v[i], sizeof(bits));
+            mask |= static_cast<int>(bits >> 31) << i;
+        }
+        return mask;
+    }
+#endif
+
+    inline Float4 MulAdd(Float4 a, Float4 b, Float4 c) { return Add(Mul(a, b), c); }
+
+    // a + (b - a) * t
+    inline Float4 Lerp(Float4 a, Float4 b, Float4 t) { return MulAdd(Sub(b, a), t, a); }
+
+    inline Float4 Normalize4(Float4 a) { return Div(a, Sqrt(Dot4(a, a))); }
+
+    /*
+     * Column major 4x4 matrix product, columns are stored as 16 consecutive floats like glm::mat4
+     */
+    inline void MulMat4(const float* a, const float* b, float* result)
+    {
+        const Float4 a0 = Load(a);
+        const Float4 a1 = Load(a + 4);
+        const Float4 a2 = Load(a + 8);
+        const Float4 a3 = Load(a + 12);
+        for (int c = 0; c < 4; c++)
+        {
+            const Float4 column = Load(b + c * 4);
+            Float4 r = Mul(a0, SplatX(column));
+            r = MulAdd(a1, SplatY(column), r);
+            r = MulAdd(a2, SplatZ(column), r);
+            r = MulAdd(a3, SplatW(column), r);
+            Store(result + c * 4, r);
+        }
+    }
+}
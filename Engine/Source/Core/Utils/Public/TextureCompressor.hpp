@@ -0,0 +1,20 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace RightEngine
+{
+    class TextureCompressor
+    {
+    public:
+        static constexpr size_t C_BC6H_BLOCK_SIZE = 16;
+
+        /*
+         * Encodes RGBA16_SFLOAT pixels to unsigned BC6H blocks, alpha is dropped and negative values are clamped to zero.
+         * Size doesn't have to be multiple of 4, border blocks are padded with the edge pixels
+         */
+        static std::vector<uint8_t> CompressBC6H(const uint16_t* pixels, int width, int height);
+    };
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "Bounds.hpp"
+#include <vector>
+#include <cstdint>
+
+namespace RightEngine
+{
+    /*
+     * Static SAH BVH over triangles of one mesh for CPU ray casts. Every leaf holds one packet of up to 4 triangles
+     * stored lane by lane, so a leaf is tested with a single 4-wide Moller-Trumbore pass
+     */
+    class TriangleBvh
+    {
+    public:
+        void Build(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices);
+
+        /*
+         * Closest hit not further than distance, which is updated on hit.
+         * Direction doesn't need to be normalized, distance is measured in its lengths
+         */
+        bool Intersect(const Ray& ray, float& distance) const;
+
+        const AABB& GetBounds() const
+        { return m_nodes.empty() ? m_emptyBounds : m_nodes.front().bounds; }
+
+        size_t GetTriangleCount() const
+        { return m_triangleCount; }
+
+    private:
+        struct Node
+        {
+            AABB bounds;
+            // Right child for inner nodes, left one always follows its parent. Packet index for leaves
+            uint32_t index{ 0 };
+            bool isLeaf{ false };
+        };
+
+        // Unused lanes have zero edges, which never pass the determinant test
+        struct TrianglePacket
+        {
+            float v0[3][4];
+            float edge1[3][4];
+            float edge2[3][4];
+        };
+
+        struct BuildTriangle
+        {
+            AABB bounds;
+            glm::vec3 centroid;
+            uint32_t index;
+        };
+
+        void BuildNode(const std::vector<glm::vec3>& positions,
+                       const std::vector<uint32_t>& indices,
+                       BuildTriangle* triangles,
+                       size_t count);
+        bool IntersectPacket(const TrianglePacket& packet, const Ray& ray, float& distance) const;
+
+        std::vector<Node> m_nodes;
+        std::vector<TrianglePacket> m_packets;
+        size_t m_triangleCount{ 0 };
+        AABB m_emptyBounds;
+    };
+}
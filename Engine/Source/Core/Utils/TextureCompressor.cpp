@@ -0,0 +1,202 @@
+#include "TextureCompressor.hpp"
+#include <array>
+#include <algorithm>
+#include <cmath>
+
+using namespace RightEngine;
+
+namespace
+{
+    // Single region mode with untransformed 10 bit endpoints and 4 bit indices, mode bits are 00011
+    constexpr uint32_t C_BC6H_MODE = 0x03;
+    constexpr uint32_t C_BC6H_MODE_BITS = 5;
+    constexpr int C_ENDPOINT_BITS = 10;
+    constexpr int C_ENDPOINT_MAX = (1 << C_ENDPOINT_BITS) - 1;
+    constexpr uint16_t C_HALF_MAX = 0x7BFF;
+    constexpr std::array<int, 16> C_WEIGHTS = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+    using Color = std::array<float, 3>;
+    using Endpoint = std::array<int, 3>;
+
+    // BC6H interpolates half float bit patterns, so the whole encoding is done in that domain
+    uint16_t SanitizeHalf(uint16_t half)
+    {
+        if (half & 0x8000)
+        {
+            return 0;
+        }
+        return std::min(half, C_HALF_MAX);
+    }
+
+    int Quantize(float value)
+    {
+        // Inverse of the decoder unquantization ((q << 16) + 0x8000) >> 10 which is q * 64 + 32
+        const int q = static_cast<int>(std::lround((value - 32.0f) / 64.0f));
+        return std::clamp(q, 0, C_ENDPOINT_MAX);
+    }
+
+    int Unquantize(int q)
+    {
+        if (q == 0)
+        {
+            return 0;
+        }
+        if (q == C_ENDPOINT_MAX)
+        {
+            return 0xFFFF;
+        }
+        return ((q << 16) + 0x8000) >> C_ENDPOINT_BITS;
+    }
+
+    class BitWriter
+    {
+    public:
+        BitWriter(uint8_t* block) : m_block(block)
+        {
+            std::fill(m_block, m_block + TextureCompressor::C_BC6H_BLOCK_SIZE, 0);
+        }
+
+        void Write(uint32_t value, uint32_t bits)
+        {
+            for (uint32_t i = 0; i < bits; i++, m_position++)
+            {
+                if (value & (1u << i))
+                {
+                    m_block[m_position / 8] |= 1u << (m_position % 8);
+                }
+            }
+        }
+
+    private:
+        uint8_t* m_block;
+        uint32_t m_position{ 0 };
+    };
+
+    void EncodeBlock(const std::array<Color, 16>& colors, uint8_t* block)
+    {
+        Color min = colors[0];
+        Color max = colors[0];
+        Color mean{};
+        for (const auto& color : colors)
+        {
+            for (int c = 0; c < 3; c++)
+            {
+                min[c] = std::min(min[c], color[c]);
+                max[c] = std::max(max[c], color[c]);
+                mean[c] += color[c] / 16.0f;
+            }
+        }
+
+        // Bounding box diagonal is flipped for channels which go against the widest one
+        int dominant = 0;
+        for (int c = 1; c < 3; c++)
+        {
+            if (max[c] - min[c] > max[dominant] - min[dominant])
+            {
+                dominant = c;
+            }
+        }
+        for (int c = 0; c < 3; c++)
+        {
+            float covariance = 0.0f;
+            for (const auto& color : colors)
+            {
+                covariance += (color[c] - mean[c]) * (color[dominant] - mean[dominant]);
+            }
+            if (covariance < 0.0f)
+            {
+                std::swap(min[c], max[c]);
+            }
+        }
+
+        Endpoint quantizedA;
+        Endpoint quantizedB;
+        std::array<std::array<int, 3>, 16> palette;
+        for (int c = 0; c < 3; c++)
+        {
+            quantizedA[c] = Quantize(min[c]);
+            quantizedB[c] = Quantize(max[c]);
+            const int a = Unquantize(quantizedA[c]);
+            const int b = Unquantize(quantizedB[c]);
+            for (int i = 0; i < 16; i++)
+            {
+                palette[i][c] = (a * (64 - C_WEIGHTS[i]) + b * C_WEIGHTS[i] + 32) >> 6;
+            }
+        }
+
+        std::array<uint32_t, 16> indices;
+        for (int p = 0; p < 16; p++)
+        {
+            float bestError = INFINITY;
+            for (int i = 0; i < 16; i++)
+            {
+                float error = 0.0f;
+                for (int c = 0; c < 3; c++)
+                {
+                    const float diff = static_cast<float>(palette[i][c]) - colors[p][c];
+                    error += diff * diff;
+                }
+                if (error < bestError)
+                {
+                    bestError = error;
+                    indices[p] = i;
+                }
+            }
+        }
+
+        // Most significant bit of the first index is implicit zero
+        if (indices[0] >= 8)
+        {
+            std::swap(quantizedA, quantizedB);
+            for (auto& index : indices)
+            {
+                index = 15 - index;
+            }
+        }
+
+        BitWriter writer(block);
+        writer.Write(C_BC6H_MODE, C_BC6H_MODE_BITS);
+        for (int c = 0; c < 3; c++)
+        {
+            writer.Write(quantizedA[c], C_ENDPOINT_BITS);
+        }
+        for (int c = 0; c < 3; c++)
+        {
+            writer.Write(quantizedB[c], C_ENDPOINT_BITS);
+        }
+        writer.Write(indices[0], 3);
+        for (int p = 1; p < 16; p++)
+        {
+            writer.Write(indices[p], 4);
+        }
+    }
+}
+
+std::vector<uint8_t> TextureCompressor::CompressBC6H(const uint16_t* pixels, int width, int height)
+{
+    const int blocksX = (width + 3) / 4;
+    const int blocksY = (height + 3) / 4;
+    std::vector<uint8_t> blocks(static_cast<size_t>(blocksX) * blocksY * C_BC6H_BLOCK_SIZE);
+
+    std::array<Color, 16> colors;
+    for (int by = 0; by < blocksY; by++)
+    {
+        for (int bx = 0; bx < blocksX; bx++)
+        {
+            for (int p = 0; p < 16; p++)
+            {
+                const int x = std::min(bx * 4 + p % 4, width - 1);
+                const int y = std::min(by * 4 + p / 4, height - 1);
+                const uint16_t* pixel = pixels + (static_cast<size_t>(y) * width + x) * 4;
+                for (int c = 0; c < 3; c++)
+                {
+                    // Decoder scales interpolated value by 31/64 to get the half, so colors are compared before scaling
+                    colors[p][c] = static_cast<float>(SanitizeHalf(pixel[c])) * 64.0f / 31.0f;
+                }
+            }
+            EncodeBlock(colors, blocks.data() + (static_cast<size_t>(by) * blocksX + bx) * C_BC6H_BLOCK_SIZE);
+        }
+    }
+
+    return blocks;
+}
@@ -32,7 +32,7 @@ double Timer::TimeInMilliseconds()
         endTime = m_endTime;
     }
 
-    return std::chrono::duration_cast<std::chrono::milliseconds>(endTime - m_startTime).count();
+    return std::chrono::duration<double, std::milli>(endTime - m_startTime).count();
 }
 
 double Timer::TimeInSeconds()
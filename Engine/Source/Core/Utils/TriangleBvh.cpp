@@ -0,0 +1,276 @@
+#include "TriangleBvh.hpp"
+#include "Simd.hpp"
+#include "Assert.hpp"
+#include <algorithm>
+
+using namespace RightEngine;
+
+namespace
+{
+    constexpr size_t C_PACKET_SIZE = 4;
+    constexpr size_t C_SAH_BIN_COUNT = 12;
+    // Rays parallel to the triangle plane
+    constexpr float C_DETERMINANT_EPSILON = 1e-12f;
+}
+
+void TriangleBvh::Build(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices)
+{
+    R_CORE_ASSERT(indices.size() % 3 == 0, "");
+    m_nodes.clear();
+    m_packets.clear();
+    m_triangleCount = indices.size() / 3;
+    if (m_triangleCount == 0)
+    {
+        return;
+    }
+
+    std::vector<BuildTriangle> triangles(m_triangleCount);
+    for (size_t i = 0; i < m_triangleCount; i++)
+    {
+        auto& triangle = triangles[i];
+        triangle.index = static_cast<uint32_t>(i);
+        for (size_t vertex = 0; vertex < 3; vertex++)
+        {
+            triangle.bounds.Extend(positions[indices[i * 3 + vertex]]);
+        }
+        triangle.centroid = triangle.bounds.GetCenter();
+    }
+
+    m_nodes.reserve(m_triangleCount / 2 + 1);
+    m_packets.reserve((m_triangleCount + C_PACKET_SIZE - 1) / C_PACKET_SIZE);
+    BuildNode(positions, indices, triangles.data(), triangles.size());
+}
+
+void TriangleBvh::BuildNode(const std::vector<glm::vec3>& positions,
+                            const std::vector<uint32_t>& indices,
+                            BuildTriangle* triangles,
+                            size_t count)
+{
+    const size_t nodeIndex = m_nodes.size();
+    m_nodes.emplace_back();
+
+    AABB bounds;
+    AABB centroidBounds;
+    for (size_t i = 0; i < count; i++)
+    {
+        bounds.Extend(triangles[i].bounds);
+        centroidBounds.Extend(triangles[i].centroid);
+    }
+    m_nodes[nodeIndex].bounds = bounds;
+
+    if (count <= C_PACKET_SIZE)
+    {
+        m_nodes[nodeIndex].isLeaf = true;
+        m_nodes[nodeIndex].index = static_cast<uint32_t>(m_packets.size());
+        auto& packet = m_packets.emplace_back();
+        for (size_t lane = 0; lane < C_PACKET_SIZE; lane++)
+        {
+            glm::vec3 v0(0.0f);
+            glm::vec3 edge1(0.0f);
+            glm::vec3 edge2(0.0f);
+            if (lane < count)
+            {
+                const size_t first = triangles[lane].index * 3;
+                v0 = positions[indices[first]];
+                edge1 = positions[indices[first + 1]] - v0;
+                edge2 = positions[indices[first + 2]] - v0;
+            }
+            for (int axis = 0; axis < 3; axis++)
+            {
+                packet.v0[axis][lane] = v0[axis];
+                packet.edge1[axis][lane] = edge1[axis];
+                packet.edge2[axis][lane] = edge2[axis];
+            }
+        }
+        return;
+    }
+
+    const glm::vec3 centroidExtent = centroidBounds.max - centroidBounds.min;
+    int axis = 0;
+    if (centroidExtent.y > centroidExtent[axis])
+    {
+        axis = 1;
+    }
+    if (centroidExtent.z > centroidExtent[axis])
+    {
+        axis = 2;
+    }
+
+    size_t splitCount = 0;
+    if (centroidExtent[axis] > 0.0f)
+    {
+        struct Bin
+        {
+            AABB bounds;
+            size_t count{ 0 };
+        };
+        Bin bins[C_SAH_BIN_COUNT];
+        const float binScale = static_cast<float>(C_SAH_BIN_COUNT) / centroidExtent[axis];
+        const auto binIndex = [&](const BuildTriangle& triangle)
+        {
+            const float offset = (triangle.centroid[axis] - centroidBounds.min[axis]) * binScale;
+            return std::min(static_cast<size_t>(offset), C_SAH_BIN_COUNT - 1);
+        };
+        for (size_t i = 0; i < count; i++)
+        {
+            auto& bin = bins[binIndex(triangles[i])];
+            bin.bounds.Extend(triangles[i].bounds);
+            bin.count++;
+        }
+
+        float rightCosts[C_SAH_BIN_COUNT];
+        AABB rightBounds;
+        size_t rightCount = 0;
+        for (size_t i = C_SAH_BIN_COUNT - 1; i > 0; i--)
+        {
+            rightBounds.Extend(bins[i].bounds);
+            rightCount += bins[i].count;
+            rightCosts[i] = rightCount > 0 ? rightBounds.GetHalfArea() * static_cast<float>(rightCount) : 0.0f;
+        }
+
+        AABB leftBounds;
+        size_t leftCount = 0;
+        float bestCost = std::numeric_limits<float>::max();
+        size_t bestSplit = 0;
+        for (size_t i = 1; i < C_SAH_BIN_COUNT; i++)
+        {
+            leftBounds.Extend(bins[i - 1].bounds);
+            leftCount += bins[i - 1].count;
+            if (leftCount == 0 || leftCount == count)
+            {
+                continue;
+            }
+            const float cost = leftBounds.GetHalfArea() * static_cast<float>(leftCount) + rightCosts[i];
+            if (cost < bestCost)
+            {
+                bestCost = cost;
+                bestSplit = i;
+            }
+        }
+
+        if (bestSplit > 0)
+        {
+            const auto middle = std::partition(triangles, triangles + count, [&](const BuildTriangle& triangle)
+            {
+                return binIndex(triangle) < bestSplit;
+            });
+            splitCount = static_cast<size_t>(middle - triangles);
+        }
+    }
+
+    // Coincident centroids can't be separated by SAH, median split still bounds the depth
+    if (splitCount == 0 || splitCount == count)
+    {
+        splitCount = count / 2;
+        std::nth_element(triangles, triangles + splitCount, triangles + count, [axis](const auto& a, const auto& b)
+        {
+            return a.centroid[axis] < b.centroid[axis];
+        });
+    }
+
+    BuildNode(positions, indices, triangles, splitCount);
+    m_nodes[nodeIndex].index = static_cast<uint32_t>(m_nodes.size());
+    BuildNode(positions, indices, triangles + splitCount, count - splitCount);
+}
+
+bool TriangleBvh::Intersect(const Ray& ray, float& distance) const
+{
+    if (m_nodes.empty())
+    {
+        return false;
+    }
+
+    const glm::vec3 invDirection = ray.GetInvDirection();
+    bool isHit = false;
+    std::vector<uint32_t> stack;
+    stack.reserve(64);
+    stack.push_back(0);
+    while (!stack.empty())
+    {
+        const auto& node = m_nodes[stack.back()];
+        stack.pop_back();
+        if (ray.Intersect(node.bounds, invDirection, distance) < 0.0f)
+        {
+            continue;
+        }
+        if (node.isLeaf)
+        {
+            isHit |= IntersectPacket(m_packets[node.index], ray, distance);
+            continue;
+        }
+
+        const uint32_t left = static_cast<uint32_t>(&node - m_nodes.data()) + 1;
+        const uint32_t right = node.index;
+        const float leftDistance = ray.Intersect(m_nodes[left].bounds, invDirection, distance);
+        const float rightDistance = ray.Intersect(m_nodes[right].bounds, invDirection, distance);
+        // Nearer child is popped first, so the far one is often culled by the shrunk distance
+        const bool isLeftNearer = rightDistance < 0.0f || (leftDistance >= 0.0f && leftDistance <= rightDistance);
+        const float nearDistance = isLeftNearer ? leftDistance : rightDistance;
+        const float farDistance = isLeftNearer ? rightDistance : leftDistance;
+        if (farDistance >= 0.0f)
+        {
+            stack.push_back(isLeftNearer ? right : left);
+        }
+        if (nearDistance >= 0.0f)
+        {
+            stack.push_back(isLeftNearer ? left : right);
+        }
+    }
+    return isHit;
+}
+
+bool TriangleBvh::IntersectPacket(const TrianglePacket& packet, const Ray& ray, float& distance) const
+{
+    using namespace simd;
+
+    const Float4 dx = Splat(ray.direction.x);
+    const Float4 dy = Splat(ray.direction.y);
+    const Float4 dz = Splat(ray.direction.z);
+    const Float4 e1x = Load(packet.edge1[0]);
+    const Float4 e1y = Load(packet.edge1[1]);
+    const Float4 e1z = Load(packet.edge1[2]);
+    const Float4 e2x = Load(packet.edge2[0]);
+    const Float4 e2y = Load(packet.edge2[1]);
+    const Float4 e2z = Load(packet.edge2[2]);
+
+    // p = direction x edge2
+    const Float4 px = Sub(Mul(dy, e2z), Mul(dz, e2y));
+    const Float4 py = Sub(Mul(dz, e2x), Mul(dx, e2z));
+    const Float4 pz = Sub(Mul(dx, e2y), Mul(dy, e2x));
+    const Float4 determinant = MulAdd(e1x, px, MulAdd(e1y, py, Mul(e1z, pz)));
+    const Float4 invDeterminant = Div(Splat(1.0f), determinant);
+
+    const Float4 tx = Sub(Splat(ray.origin.x), Load(packet.v0[0]));
+    const Float4 ty = Sub(Splat(ray.origin.y), Load(packet.v0[1]));
+    const Float4 tz = Sub(Splat(ray.origin.z), Load(packet.v0[2]));
+    const Float4 u = Mul(MulAdd(tx, px, MulAdd(ty, py, Mul(tz, pz))), invDeterminant);
+
+    // q = t x edge1
+    const Float4 qx = Sub(Mul(ty, e1z), Mul(tz, e1y));
+    const Float4 qy = Sub(Mul(tz, e1x), Mul(tx, e1z));
+    const Float4 qz = Sub(Mul(tx, e1y), Mul(ty, e1x));
+    const Float4 v = Mul(MulAdd(dx, qx, MulAdd(dy, qy, Mul(dz, qz))), invDeterminant);
+    const Float4 t = Mul(MulAdd(e2x, qx, MulAdd(e2y, qy, Mul(e2z, qz))), invDeterminant);
+
+    float determinants[4];
+    float us[4];
+    float vs[4];
+    float ts[4];
+    Store(determinants, determinant);
+    Store(us, u);
+    Store(vs, v);
+    Store(ts, t);
+
+    bool isHit = false;
+    for (size_t lane = 0; lane < C_PACKET_SIZE; lane++)
+    {
+        if (std::abs(determinants[lane]) > C_DETERMINANT_EPSILON
+            && us[lane] >= 0.0f && vs[lane] >= 0.0f && us[lane] + vs[lane] <= 1.0f
+            && ts[lane] >= 0.0f && ts[lane] < distance)
+        {
+            distance = ts[lane];
+            isHit = true;
+        }
+    }
+    return isHit;
+}
@@ -1,15 +1,22 @@
-#include "EntryPoint.hpp"
+#include "Logger.hpp"
+#include "Path.hpp"
+#include "Application.hpp"
+#include "ThreadService.hpp"
+#include <gtest/gtest.h>
 
-void GameApplication::OnStart()
-{
-}
+using namespace RightEngine;
 
-void GameApplication::OnUpdate()
-{
-}
+std::string G_ASSET_DIR = TEST_ASSETS_DIR;
+std::string G_CONFIG_DIR = TEST_CONFIG_DIR;
 
-void GameApplication::OnDestroy()
+// Headless like the benchmarks, tests only get logging, paths and the thread service
+int main(int argc, char* argv[])
 {
-}
+    Log::Init();
+    ::testing::InitGoogleTest(&argc, argv);
+
+    Path::Init();
+    Instance().RegisterService<ThreadService>();
 
-std::string G_ASSET_DIR = TEST_ASSETS_DIR;
\ No newline at end of file
+    return RUN_ALL_TESTS();
+}
@@ -9,5 +9,6 @@ TEST(CoreTests, PathAlias)
 	const std::string engineResPath = "/Engine/Shaders/test.vert";
 	const std::string gameResPath = "/Shaders/test.vert";
 
-	EXPECT_EQ(Path::Absolute(engineResPath) == G_ENGINE_ASSET_DIR +)
+	EXPECT_EQ(Path::Absolute(engineResPath), G_ENGINE_ASSET_DIR + "/Shaders/test.vert");
+	EXPECT_EQ(Path::Absolute(gameResPath), G_ASSET_DIR + "/Shaders/test.vert");
 }
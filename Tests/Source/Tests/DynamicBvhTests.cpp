@@ -0,0 +1,166 @@
+#include "DynamicBvh.hpp"
+#include <gtest/gtest.h>
+#include <glm/ext/matrix_clip_space.hpp>
+#include <algorithm>
+#include <unordered_map>
+
+using namespace RightEngine;
+
+namespace
+{
+    AABB CreateBox(const glm::vec3& center, float halfSize)
+    {
+        return { center - glm::vec3(halfSize), center + glm::vec3(halfSize) };
+    }
+
+    std::vector<entt::entity> QueryBox(const DynamicBvh& bvh, const AABB& box)
+    {
+        std::vector<entt::entity> result;
+        bvh.QueryBox(box, [&result](entt::entity entity)
+        {
+            result.push_back(entity);
+        });
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+
+    std::vector<entt::entity> QueryBoxBruteForce(const std::unordered_map<entt::entity, AABB>& bounds, const AABB& box)
+    {
+        std::vector<entt::entity> result;
+        for (const auto& [entity, entityBounds] : bounds)
+        {
+            if (entityBounds.Overlaps(box))
+            {
+                result.push_back(entity);
+            }
+        }
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+}
+
+TEST(DynamicBvhTests, QueryBoxMatchesBruteForce)
+{
+    DynamicBvh bvh;
+    std::unordered_map<entt::entity, int32_t> proxies;
+    std::unordered_map<entt::entity, AABB> bounds;
+    for (uint32_t i = 0; i < 256; i++)
+    {
+        const auto entity = static_cast<entt::entity>(i);
+        const AABB box = CreateBox({ static_cast<float>(i % 16) * 3.0f, 0.0f, static_cast<float>(i / 16) * 3.0f }, 1.0f);
+        proxies[entity] = bvh.CreateProxy(box, entity);
+        bounds[entity] = box;
+    }
+
+    // Mix of small moves inside fat bounds, reinserting moves and removals
+    for (uint32_t i = 0; i < 256; i += 3)
+    {
+        const auto entity = static_cast<entt::entity>(i);
+        bvh.DestroyProxy(proxies[entity]);
+        proxies.erase(entity);
+        bounds.erase(entity);
+    }
+    for (uint32_t i = 1; i < 256; i += 3)
+    {
+        const auto entity = static_cast<entt::entity>(i);
+        const glm::vec3 offset = i % 2 ? glm::vec3(0.05f) : glm::vec3(20.0f, 5.0f, -7.0f);
+        const AABB box(bounds[entity].min + offset, bounds[entity].max + offset);
+        bvh.MoveProxy(proxies[entity], box);
+        bounds[entity] = box;
+    }
+    EXPECT_EQ(bvh.GetProxyCount(), bounds.size());
+
+    const AABB queries[] =
+    {
+        AABB({ -1.0f, -1.0f, -1.0f }, { 10.0f, 1.0f, 10.0f }),
+        AABB({ 20.0f, 4.0f, -10.0f }, { 40.0f, 6.0f, 20.0f }),
+        AABB({ -100.0f, -100.0f, -100.0f }, { 100.0f, 100.0f, 100.0f }),
+        AABB({ 1000.0f, 1000.0f, 1000.0f }, { 1001.0f, 1001.0f, 1001.0f }),
+    };
+    for (const auto& query : queries)
+    {
+        EXPECT_EQ(QueryBox(bvh, query), QueryBoxBruteForce(bounds, query));
+    }
+
+    bvh.Rebuild();
+    for (const auto& [entity, proxy] : proxies)
+    {
+        EXPECT_EQ(bvh.GetEntity(proxy), entity);
+        EXPECT_EQ(bvh.GetBounds(proxy).min, bounds[entity].min);
+    }
+    for (const auto& query : queries)
+    {
+        EXPECT_EQ(QueryBox(bvh, query), QueryBoxBruteForce(bounds, query));
+    }
+}
+
+TEST(DynamicBvhTests, OnlyLargeMovesReinsert)
+{
+    DynamicBvh bvh;
+    const auto entity = static_cast<entt::entity>(1);
+    const int32_t proxy = bvh.CreateProxy(CreateBox(glm::vec3(0.0f), 1.0f), entity);
+    bvh.CreateProxy(CreateBox(glm::vec3(10.0f), 1.0f), static_cast<entt::entity>(2));
+
+    EXPECT_FALSE(bvh.MoveProxy(proxy, CreateBox(glm::vec3(0.05f), 1.0f)));
+    // Leaves are tested with tight bounds, so the box isn't found where only the fat bounds reach
+    EXPECT_TRUE(QueryBox(bvh, AABB({ -1.2f, -1.2f, -1.2f }, { -1.0f, -1.0f, -1.0f })).empty());
+
+    EXPECT_TRUE(bvh.MoveProxy(proxy, CreateBox(glm::vec3(-5.0f), 1.0f)));
+    EXPECT_EQ(QueryBox(bvh, CreateBox(glm::vec3(-5.0f), 0.5f)), std::vector<entt::entity>{ entity });
+    EXPECT_TRUE(QueryBox(bvh, CreateBox(glm::vec3(0.0f), 0.5f)).empty());
+}
+
+TEST(DynamicBvhTests, QueryRayClipsToClosestHit)
+{
+    DynamicBvh bvh;
+    for (uint32_t i = 0; i < 8; i++)
+    {
+        bvh.CreateProxy(CreateBox({ 0.0f, 0.0f, -5.0f * static_cast<float>(i + 1) }, 0.5f), static_cast<entt::entity>(i));
+    }
+    bvh.CreateProxy(CreateBox({ 5.0f, 0.0f, -5.0f }, 0.5f), static_cast<entt::entity>(100));
+
+    Ray ray;
+    ray.origin = glm::vec3(0.0f);
+    ray.direction = glm::vec3(0.0f, 0.0f, -1.0f);
+    entt::entity closest = entt::null;
+    float closestDistance = std::numeric_limits<float>::max();
+    bvh.QueryRay(ray, 1000.0f, [&](entt::entity entity, float distance)
+    {
+        if (distance < closestDistance)
+        {
+            closest = entity;
+            closestDistance = distance;
+        }
+        return closestDistance;
+    });
+
+    EXPECT_EQ(closest, static_cast<entt::entity>(0));
+    EXPECT_FLOAT_EQ(closestDistance, 4.5f);
+}
+
+TEST(DynamicBvhTests, QueryFrustumSkipsBoxesOutside)
+{
+    DynamicBvh bvh;
+    std::vector<entt::entity> inside;
+    for (uint32_t i = 0; i < 32; i++)
+    {
+        const auto entity = static_cast<entt::entity>(i);
+        // Camera at the origin looks down -Z, odd boxes are behind it
+        const float z = i % 2 ? 10.0f + static_cast<float>(i) : -10.0f - static_cast<float>(i);
+        bvh.CreateProxy(CreateBox({ 0.0f, 0.0f, z }, 0.5f), entity);
+        if (i % 2 == 0)
+        {
+            inside.push_back(entity);
+        }
+    }
+
+    const Frustum frustum = Frustum::FromMatrix(glm::perspective(glm::radians(60.0f), 1.0f, 0.1f, 100.0f));
+    std::vector<entt::entity> result;
+    bvh.QueryFrustum(frustum, [&result](entt::entity entity)
+    {
+        result.push_back(entity);
+    });
+    std::sort(result.begin(), result.end());
+
+    EXPECT_EQ(result, inside);
+}
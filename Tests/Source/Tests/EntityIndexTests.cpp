@@ -0,0 +1,117 @@
+#include "EntityIndex.hpp"
+#include "Components.hpp"
+#include <gtest/gtest.h>
+#include <algorithm>
+
+using namespace RightEngine;
+
+namespace
+{
+    std::vector<entt::entity> FindByName(const EntityIndex& index, const std::string& name)
+    {
+        auto entities = index.FindByName(name);
+        std::sort(entities.begin(), entities.end());
+        return entities;
+    }
+
+    entt::entity CreateEntity(entt::registry& registry, const std::string& name)
+    {
+        const auto entity = registry.create();
+        registry.emplace<TagComponent>(entity, name, xg::newGuid());
+        return entity;
+    }
+}
+
+TEST(EntityIndexTests, FindsEntitiesByGuidAndName)
+{
+    entt::registry registry;
+    EntityIndex index;
+    index.Connect(registry);
+
+    const auto tree1 = CreateEntity(registry, "Tree");
+    const auto rock = CreateEntity(registry, "Rock");
+    const auto tree2 = CreateEntity(registry, "Tree");
+
+    for (const auto entity : { tree1, rock, tree2 })
+    {
+        const auto& tag = registry.get<TagComponent>(entity);
+        EXPECT_EQ(index.Find(tag.guid), entity);
+        EXPECT_EQ(tag.uiId, EntityIndex::GetStableId(tag.guid));
+    }
+    EXPECT_EQ(FindByName(index, "Tree"), (std::vector<entt::entity>{ tree1, tree2 }));
+    EXPECT_EQ(FindByName(index, "Rock"), std::vector<entt::entity>{ rock });
+    EXPECT_TRUE(index.FindByName("Bush").empty());
+    EXPECT_TRUE(index.Find(xg::newGuid()) == entt::null);
+
+    index.Disconnect(registry);
+}
+
+TEST(EntityIndexTests, PatchedTagsAreReindexed)
+{
+    entt::registry registry;
+    EntityIndex index;
+    index.Connect(registry);
+
+    const auto tree = CreateEntity(registry, "Tree");
+    const auto other = CreateEntity(registry, "Tree");
+    const xg::Guid oldGuid = registry.get<TagComponent>(tree).guid;
+    const xg::Guid newGuid = xg::newGuid();
+    registry.patch<TagComponent>(tree, [&newGuid](TagComponent& tag)
+    {
+        tag.name = "Bush";
+        tag.guid = newGuid;
+    });
+
+    EXPECT_EQ(FindByName(index, "Tree"), std::vector<entt::entity>{ other });
+    EXPECT_EQ(FindByName(index, "Bush"), std::vector<entt::entity>{ tree });
+    EXPECT_EQ(index.Find(newGuid), tree);
+    EXPECT_TRUE(index.Find(oldGuid) == entt::null);
+    EXPECT_EQ(registry.get<TagComponent>(tree).uiId, EntityIndex::GetStableId(newGuid));
+
+    index.Disconnect(registry);
+}
+
+TEST(EntityIndexTests, DestroyKeepsOtherEntitiesOfName)
+{
+    entt::registry registry;
+    EntityIndex index;
+    index.Connect(registry);
+
+    std::vector<entt::entity> rocks;
+    for (int i = 0; i < 4; i++)
+    {
+        rocks.push_back(CreateEntity(registry, "Rock"));
+    }
+    const xg::Guid firstGuid = registry.get<TagComponent>(rocks.front()).guid;
+
+    // Removing from the middle of the name list moves the last entity into the hole
+    registry.destroy(rocks[1]);
+    registry.destroy(rocks[0]);
+    EXPECT_EQ(FindByName(index, "Rock"), (std::vector<entt::entity>{ rocks[2], rocks[3] }));
+    EXPECT_TRUE(index.Find(firstGuid) == entt::null);
+    EXPECT_EQ(index.Find(registry.get<TagComponent>(rocks[3]).guid), rocks[3]);
+
+    registry.destroy(rocks[3]);
+    registry.destroy(rocks[2]);
+    EXPECT_TRUE(index.FindByName("Rock").empty());
+
+    // Freed name slots are reused by new names
+    const auto tree = CreateEntity(registry, "Tree");
+    const auto rock = CreateEntity(registry, "Rock");
+    EXPECT_EQ(FindByName(index, "Tree"), std::vector<entt::entity>{ tree });
+    EXPECT_EQ(FindByName(index, "Rock"), std::vector<entt::entity>{ rock });
+
+    index.Disconnect(registry);
+}
+
+TEST(EntityIndexTests, DisconnectedIndexIgnoresTags)
+{
+    entt::registry registry;
+    EntityIndex index;
+    index.Connect(registry);
+    const auto tree = CreateEntity(registry, "Tree");
+    index.Disconnect(registry);
+
+    CreateEntity(registry, "Tree");
+    EXPECT_EQ(FindByName(index, "Tree"), std::vector<entt::entity>{ tree });
+}
@@ -0,0 +1,108 @@
+#include "LightClusterGrid.hpp"
+#include <gtest/gtest.h>
+#include <glm/ext/matrix_clip_space.hpp>
+#include <glm/ext/matrix_transform.hpp>
+#include <algorithm>
+#include <cmath>
+
+using namespace RightEngine;
+
+namespace
+{
+    constexpr float C_NEAR = 0.1f;
+    constexpr float C_FAR = 100.0f;
+    constexpr size_t C_MAX_INDICES = 1 << 20;
+
+    glm::mat4 GetProjection()
+    {
+        return glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, C_NEAR, C_FAR);
+    }
+
+    uint32_t GetSlice(const LightClusterGrid& grid, float depth)
+    {
+        return static_cast<uint32_t>(std::floor(std::log(depth) * grid.GetSliceScale() + grid.GetSliceBias()));
+    }
+
+    std::vector<uint32_t> GetClusterLights(const LightClusterGrid& grid, uint32_t x, uint32_t y, uint32_t slice)
+    {
+        const auto& cluster = grid.GetClusters()[x + LightClusterGrid::C_TILES_X * (y + LightClusterGrid::C_TILES_Y * slice)];
+        const auto first = grid.GetLightIndices().begin() + cluster.offset;
+        return std::vector<uint32_t>(first, first + cluster.count);
+    }
+
+    bool HasLight(const LightClusterGrid& grid, uint32_t x, uint32_t y, uint32_t slice, uint32_t index)
+    {
+        const auto lights = GetClusterLights(grid, x, y, slice);
+        return std::find(lights.begin(), lights.end(), index) != lights.end();
+    }
+}
+
+TEST(LightClusterGridTests, LightIsInClustersAroundIt)
+{
+    LightClusterGrid grid;
+    grid.Build(glm::mat4(1.0f), GetProjection(), C_NEAR, C_FAR, { { { 0.0f, 0.0f, -10.0f }, 1.0f, 7 } }, C_MAX_INDICES);
+
+    const uint32_t slice = GetSlice(grid, 10.0f);
+    EXPECT_TRUE(HasLight(grid, LightClusterGrid::C_TILES_X / 2, LightClusterGrid::C_TILES_Y / 2, slice, 7));
+    EXPECT_FALSE(HasLight(grid, 0, 0, slice, 7));
+    EXPECT_TRUE(GetClusterLights(grid, LightClusterGrid::C_TILES_X / 2, LightClusterGrid::C_TILES_Y / 2, GetSlice(grid, 20.0f)).empty());
+    EXPECT_TRUE(GetClusterLights(grid, LightClusterGrid::C_TILES_X / 2, LightClusterGrid::C_TILES_Y / 2, GetSlice(grid, 5.0f)).empty());
+}
+
+TEST(LightClusterGridTests, LightsOutsideFrustumAreSkipped)
+{
+    LightClusterGrid grid;
+    const std::vector<ClusterLight> lights =
+    {
+        { { 0.0f, 0.0f, 10.0f }, 1.0f, 0 },
+        { { 0.0f, 0.0f, -200.0f }, 1.0f, 1 },
+        { { 100.0f, 0.0f, -10.0f }, 1.0f, 2 },
+    };
+    grid.Build(glm::mat4(1.0f), GetProjection(), C_NEAR, C_FAR, lights, C_MAX_INDICES);
+
+    EXPECT_TRUE(grid.GetLightIndices().empty());
+}
+
+TEST(LightClusterGridTests, LightsAreFoundThroughView)
+{
+    // More lights than one SIMD group, the last group is padded
+    std::vector<ClusterLight> lights;
+    for (uint32_t i = 0; i < 11; i++)
+    {
+        const float offset = static_cast<float>(i) - 5.0f;
+        lights.push_back({ { offset, offset * 0.5f, -static_cast<float>(i) * 3.0f }, 0.5f, i });
+    }
+    const glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 0.0f, 15.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    const glm::mat4 projection = GetProjection();
+    LightClusterGrid grid;
+    grid.Build(view, projection, C_NEAR, C_FAR, lights, C_MAX_INDICES);
+
+    for (const auto& light : lights)
+    {
+        const glm::vec4 viewPosition = view * glm::vec4(light.position, 1.0f);
+        const glm::vec4 clip = projection * viewPosition;
+        const glm::vec2 ndc = glm::vec2(clip) / clip.w;
+        const auto x = static_cast<uint32_t>((ndc.x * 0.5f + 0.5f) * LightClusterGrid::C_TILES_X);
+        const auto y = static_cast<uint32_t>((0.5f - ndc.y * 0.5f) * LightClusterGrid::C_TILES_Y);
+        EXPECT_TRUE(HasLight(grid, x, y, GetSlice(grid, -viewPosition.z), light.index)) << "Light " << light.index;
+    }
+}
+
+TEST(LightClusterGridTests, OverflowDropsFarClusters)
+{
+    const std::vector<ClusterLight> lights =
+    {
+        { { 0.0f, 0.0f, -50.0f }, 0.5f, 1 },
+        { { 0.0f, 0.0f, -2.0f }, 0.5f, 0 },
+    };
+    LightClusterGrid grid;
+    grid.Build(glm::mat4(1.0f), GetProjection(), C_NEAR, C_FAR, lights, C_MAX_INDICES);
+    const auto& indices = grid.GetLightIndices();
+    const auto nearCount = static_cast<size_t>(std::count(indices.begin(), indices.end(), 0u));
+    ASSERT_GT(nearCount, 0u);
+    ASSERT_GT(indices.size(), nearCount);
+
+    grid.Build(glm::mat4(1.0f), GetProjection(), C_NEAR, C_FAR, lights, nearCount);
+    EXPECT_EQ(grid.GetLightIndices().size(), nearCount);
+    EXPECT_EQ(static_cast<size_t>(std::count(grid.GetLightIndices().begin(), grid.GetLightIndices().end(), 0u)), nearCount);
+}
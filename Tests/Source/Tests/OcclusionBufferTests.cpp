@@ -0,0 +1,91 @@
+#include "OcclusionBuffer.hpp"
+#include <gtest/gtest.h>
+#include <glm/ext/matrix_clip_space.hpp>
+
+using namespace RightEngine;
+
+namespace
+{
+    // Camera at the origin looking down -Z, vertical field of view is 90 degrees
+    glm::mat4 GetViewProjection(uint32_t width, uint32_t height)
+    {
+        return glm::perspective(glm::radians(90.0f), static_cast<float>(width) / static_cast<float>(height), 0.1f, 100.0f);
+    }
+
+    // Quad facing the camera at depth z
+    OccluderMesh CreateQuad(float minX, float minY, float maxX, float maxY, float z)
+    {
+        OccluderMesh quad;
+        quad.positions = { { minX, minY, z }, { maxX, minY, z }, { maxX, maxY, z }, { minX, maxY, z } };
+        quad.indices = { 0, 1, 2, 0, 2, 3 };
+        return quad;
+    }
+
+    void Rasterize(OcclusionBuffer& buffer)
+    {
+        buffer.RasterizeRows(0, buffer.GetTileRowCount());
+    }
+}
+
+TEST(OcclusionBufferTests, BoxBehindFullScreenQuadIsCulled)
+{
+    OcclusionBuffer buffer;
+    buffer.Begin(64, 64, GetViewProjection(64, 64));
+    buffer.AddOccluder(CreateQuad(-50.0f, -50.0f, 50.0f, 50.0f, -10.0f), glm::mat4(1.0f));
+    Rasterize(buffer);
+
+    EXPECT_FALSE(buffer.IsVisible(AABB({ -1.0f, -1.0f, -20.0f }, { 1.0f, 1.0f, -18.0f })));
+}
+
+TEST(OcclusionBufferTests, BoxInFrontOfQuadIsVisible)
+{
+    OcclusionBuffer buffer;
+    buffer.Begin(64, 64, GetViewProjection(64, 64));
+    buffer.AddOccluder(CreateQuad(-50.0f, -50.0f, 50.0f, 50.0f, -10.0f), glm::mat4(1.0f));
+    Rasterize(buffer);
+
+    EXPECT_TRUE(buffer.IsVisible(AABB({ -1.0f, -1.0f, -6.0f }, { 1.0f, 1.0f, -4.0f })));
+}
+
+TEST(OcclusionBufferTests, BoxOverPartlyCoveredTileIsVisible)
+{
+    OcclusionBuffer buffer;
+    buffer.Begin(64, 64, GetViewProjection(64, 64));
+    // Right edge is at pixel 33.6, so tile columns 32 and 33 are covered and 34 to 39 aren't
+    buffer.AddOccluder(CreateQuad(-50.0f, -50.0f, 0.5f, 50.0f, -10.0f), glm::mat4(1.0f));
+    Rasterize(buffer);
+
+    // Touches pixels 28 to 35, the last two are in the uncovered part of the tile
+    EXPECT_TRUE(buffer.IsVisible(AABB({ -2.0f, -2.0f, -22.0f }, { 2.0f, 2.0f, -18.0f })));
+    // Touches pixels 28 to 32, all of them are covered
+    EXPECT_FALSE(buffer.IsVisible(AABB({ -2.0f, -2.0f, -22.0f }, { 0.0f, 2.0f, -18.0f })));
+}
+
+TEST(OcclusionBufferTests, BoxBehindCameraIsVisible)
+{
+    OcclusionBuffer buffer;
+    buffer.Begin(64, 64, GetViewProjection(64, 64));
+    buffer.AddOccluder(CreateQuad(-50.0f, -50.0f, 50.0f, 50.0f, -10.0f), glm::mat4(1.0f));
+    Rasterize(buffer);
+
+    EXPECT_TRUE(buffer.IsVisible(AABB({ -1.0f, -1.0f, -20.0f }, { 1.0f, 1.0f, 1.0f })));
+}
+
+TEST(OcclusionBufferTests, BorderTilesOfUnalignedBufferAreMerged)
+{
+    // 8x5 tiles, the last tile column has 4 pixel columns and the last tile row has 4 pixel rows
+    constexpr uint32_t width = 60;
+    constexpr uint32_t height = 36;
+    constexpr float aspect = static_cast<float>(width) / static_cast<float>(height);
+    OcclusionBuffer buffer;
+    buffer.Begin(width, height, GetViewProjection(width, height));
+    // Both quads end exactly at the screen edges, so border tiles are only fully covered inside the buffer.
+    // Unless the far quad is merged into the tile depth, the near one can't improve the border tiles
+    buffer.AddOccluder(CreateQuad(-20.0f * aspect, -20.0f, 20.0f * aspect, 20.0f, -20.0f), glm::mat4(1.0f));
+    buffer.AddOccluder(CreateQuad(-5.0f * aspect, -5.0f, 5.0f * aspect, 5.0f, -5.0f), glm::mat4(1.0f));
+    Rasterize(buffer);
+
+    // Between the quads in the corner of the last tile column and row
+    EXPECT_FALSE(buffer.IsVisible(AABB({ 10.0f, 5.0f, -10.0f }, { 12.0f, 7.0f, -8.0f })));
+    EXPECT_TRUE(buffer.IsVisible(AABB({ 2.0f, 1.0f, -4.0f }, { 3.0f, 2.0f, -3.0f })));
+}
@@ -0,0 +1,139 @@
+#include "TriangleBvh.hpp"
+#include <gtest/gtest.h>
+#include <random>
+
+using namespace RightEngine;
+
+namespace
+{
+    // Quads facing Z at z = -1, -2, ... -count
+    void CreateQuadStack(size_t count, std::vector<glm::vec3>& positions, std::vector<uint32_t>& indices)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            const float z = -static_cast<float>(i + 1);
+            const auto first = static_cast<uint32_t>(positions.size());
+            positions.insert(positions.end(), { { -1.0f, -1.0f, z }, { 1.0f, -1.0f, z }, { 1.0f, 1.0f, z }, { -1.0f, 1.0f, z } });
+            indices.insert(indices.end(), { first, first + 1, first + 2, first, first + 2, first + 3 });
+        }
+    }
+
+    // Scalar two sided Moller-Trumbore
+    bool IntersectTriangle(const Ray& ray, const glm::vec3& v0, const glm::vec3& v1, const glm::vec3& v2, float& distance)
+    {
+        const glm::vec3 edge1 = v1 - v0;
+        const glm::vec3 edge2 = v2 - v0;
+        const glm::vec3 p = glm::cross(ray.direction, edge2);
+        const float determinant = glm::dot(edge1, p);
+        if (std::abs(determinant) < 1e-8f)
+        {
+            return false;
+        }
+        const glm::vec3 t = ray.origin - v0;
+        const float u = glm::dot(t, p) / determinant;
+        const glm::vec3 q = glm::cross(t, edge1);
+        const float v = glm::dot(ray.direction, q) / determinant;
+        const float hitDistance = glm::dot(edge2, q) / determinant;
+        if (u < 0.0f || v < 0.0f || u + v > 1.0f || hitDistance < 0.0f || hitDistance >= distance)
+        {
+            return false;
+        }
+        distance = hitDistance;
+        return true;
+    }
+}
+
+TEST(TriangleBvhTests, ClosestQuadIsHit)
+{
+    std::vector<glm::vec3> positions;
+    std::vector<uint32_t> indices;
+    CreateQuadStack(10, positions, indices);
+    TriangleBvh bvh;
+    bvh.Build(positions, indices);
+    EXPECT_EQ(bvh.GetTriangleCount(), 20u);
+    EXPECT_EQ(bvh.GetBounds().min, glm::vec3(-1.0f, -1.0f, -10.0f));
+    EXPECT_EQ(bvh.GetBounds().max, glm::vec3(1.0f, 1.0f, -1.0f));
+
+    Ray ray;
+    ray.origin = glm::vec3(0.25f, 0.5f, 0.0f);
+    ray.direction = glm::vec3(0.0f, 0.0f, -1.0f);
+    float distance = std::numeric_limits<float>::max();
+    EXPECT_TRUE(bvh.Intersect(ray, distance));
+    EXPECT_FLOAT_EQ(distance, 1.0f);
+
+    // Triangles are two sided
+    ray.origin = glm::vec3(0.25f, 0.5f, -20.0f);
+    ray.direction = glm::vec3(0.0f, 0.0f, 2.0f);
+    distance = std::numeric_limits<float>::max();
+    EXPECT_TRUE(bvh.Intersect(ray, distance));
+    EXPECT_FLOAT_EQ(distance, 5.0f);
+}
+
+TEST(TriangleBvhTests, MissKeepsDistance)
+{
+    std::vector<glm::vec3> positions;
+    std::vector<uint32_t> indices;
+    CreateQuadStack(10, positions, indices);
+    TriangleBvh bvh;
+    bvh.Build(positions, indices);
+
+    Ray ray;
+    ray.origin = glm::vec3(0.0f);
+    ray.direction = glm::vec3(0.0f, 0.0f, 1.0f);
+    float distance = 100.0f;
+    EXPECT_FALSE(bvh.Intersect(ray, distance));
+    EXPECT_EQ(distance, 100.0f);
+
+    // Hits further than the given distance are ignored
+    ray.direction = glm::vec3(0.0f, 0.0f, -1.0f);
+    distance = 0.5f;
+    EXPECT_FALSE(bvh.Intersect(ray, distance));
+    EXPECT_EQ(distance, 0.5f);
+
+    TriangleBvh empty;
+    empty.Build({}, {});
+    EXPECT_FALSE(empty.Intersect(ray, distance));
+}
+
+TEST(TriangleBvhTests, MatchesBruteForce)
+{
+    std::mt19937 random(42);
+    std::uniform_real_distribution<float> coordinate(-10.0f, 10.0f);
+    std::uniform_real_distribution<float> offset(-1.0f, 1.0f);
+    std::vector<glm::vec3> positions;
+    std::vector<uint32_t> indices;
+    for (uint32_t i = 0; i < 500; i++)
+    {
+        const glm::vec3 center(coordinate(random), coordinate(random), coordinate(random));
+        for (int vertex = 0; vertex < 3; vertex++)
+        {
+            indices.push_back(static_cast<uint32_t>(positions.size()));
+            positions.push_back(center + glm::vec3(offset(random), offset(random), offset(random)));
+        }
+    }
+    TriangleBvh bvh;
+    bvh.Build(positions, indices);
+
+    for (uint32_t i = 0; i < 200; i++)
+    {
+        // Aimed at a triangle centroid, so every ray hits something
+        const uint32_t target = i * 3;
+        const glm::vec3 centroid = (positions[target] + positions[target + 1] + positions[target + 2]) / 3.0f;
+        Ray ray;
+        ray.origin = glm::vec3(coordinate(random), coordinate(random), coordinate(random)) * 3.0f;
+        ray.direction = centroid - ray.origin;
+
+        float expected = std::numeric_limits<float>::max();
+        for (size_t triangle = 0; triangle < indices.size(); triangle += 3)
+        {
+            IntersectTriangle(ray,
+                              positions[indices[triangle]],
+                              positions[indices[triangle + 1]],
+                              positions[indices[triangle + 2]],
+                              expected);
+        }
+        float distance = std::numeric_limits<float>::max();
+        ASSERT_TRUE(bvh.Intersect(ray, distance));
+        EXPECT_NEAR(distance, expected, 1e-4f);
+    }
+}